@@ -0,0 +1,110 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AllocCounter.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> sAllocCount {0};
+std::atomic<uint64_t> sAllocByte {0};
+
+void*
+countedAlloc(const std::size_t size)
+{
+    sAllocCount.fetch_add(1, std::memory_order_relaxed);
+    sAllocByte.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc((size) ? size : 1);
+}
+
+void*
+countedAlignedAlloc(const std::size_t size, const std::align_val_t align)
+{
+    sAllocCount.fetch_add(1, std::memory_order_relaxed);
+    sAllocByte.fetch_add(size, std::memory_order_relaxed);
+    void* ptr = nullptr;
+    const std::size_t alignment = std::max(static_cast<std::size_t>(align), sizeof(void*));
+    if (posix_memalign(&ptr, alignment, (size) ? size : 1) != 0) return nullptr;
+    return ptr; // released by std::free()
+}
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    void* ptr = countedAlloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+    void* ptr = countedAlloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+
+// over-aligned types (alignas > __STDCPP_DEFAULT_NEW_ALIGNMENT__ : e.g. SIMD vectors, cache line aligned data)
+void* operator new(std::size_t size, std::align_val_t align)
+{
+    void* ptr = countedAlignedAlloc(size, align);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t align)
+{
+    void* ptr = countedAlignedAlloc(size, align);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    return countedAlignedAlloc(size, align);
+}
+
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    return countedAlignedAlloc(size, align);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+namespace mergeBench {
+
+AllocCount
+getAllocCount()
+{
+    return {sAllocCount.load(std::memory_order_relaxed), sAllocByte.load(std::memory_order_relaxed)};
+}
+
+size_t
+getPeakRssByte()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<size_t>(usage.ru_maxrss) * 1024; // ru_maxrss is KByte on Linux
+}
+
+} // namespace mergeBench
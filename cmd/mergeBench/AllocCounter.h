@@ -0,0 +1,33 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+//
+// Heap allocation counter of the merge pipeline benchmark
+//
+// This executable replaces the global operator new/delete (including the std::align_val_t overloads for
+// over-aligned types) and counts the number of allocations and the allocated bytes of the entire process
+// (all threads). Each benchmark stage takes a snapshot before and
+// after the stage and reports the difference.
+//
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mergeBench {
+
+struct AllocCount
+{
+    uint64_t mCount {0}; // number of allocations
+    uint64_t mByte {0};  // total allocated byte
+
+    AllocCount operator - (const AllocCount& src) const { return {mCount - src.mCount, mByte - src.mByte}; }
+    AllocCount& operator += (const AllocCount& src) { mCount += src.mCount; mByte += src.mByte; return *this; }
+};
+
+AllocCount getAllocCount(); // MTsafe
+
+size_t getPeakRssByte(); // peak resident set size of this process
+
+} // namespace mergeBench
@@ -0,0 +1,523 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MergeBench.h"
+
+#include <mcrt_dataio/engine/merger/FbMsgMultiFrames.h>
+#include <mcrt_dataio/engine/merger/MergeActionTracker.h>
+
+#include <scene_rdl2/common/grid_util/FbReferenceType.h>
+#include <scene_rdl2/common/grid_util/PackTiles.h>
+#include <scene_rdl2/common/rec_time/RecTime.h>
+#include <scene_rdl2/render/util/StrUtil.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+//#define SINGLE_THREAD
+
+namespace mergeBench {
+
+bool
+MergeBench::main(int ac, char **av)
+{
+    mShow = false;
+    mRun = false;
+    mTileSetBenchLoop = 0;
+    if (!mParser.main(scene_rdl2::grid_util::Arg(ac, av))) return false;
+
+    if (mShow) std::cerr << showConfig() << '\n';
+    if (mTileSetBenchLoop) std::cout << mcrt_dataio::MergeActionTracker::benchTileSet(mTileSetBenchLoop) << '\n';
+    if (mRun) return run();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+void
+MergeBench::StageStats::update(const float sec, const AllocCount& alloc)
+{
+    if (mCount == 0) {
+        mMinSec = sec;
+        mMaxSec = sec;
+    } else {
+        mMinSec = std::min(mMinSec, sec);
+        mMaxSec = std::max(mMaxSec, sec);
+    }
+    mCount++;
+    mTotalSec += sec;
+    mAlloc += alloc;
+}
+
+std::string
+MergeBench::StageStats::jsonStr() const
+{
+    const float avgSec = (mCount) ? mTotalSec / static_cast<float>(mCount) : 0.0f;
+
+    std::ostringstream ostr;
+    ostr << "{ \"count\": " << mCount
+         << ", \"totalMs\": " << mTotalSec * 1000.0f
+         << ", \"avgMs\": " << avgSec * 1000.0f
+         << ", \"minMs\": " << mMinSec * 1000.0f
+         << ", \"maxMs\": " << mMaxSec * 1000.0f
+         << ", \"allocCount\": " << mAlloc.mCount
+         << ", \"allocByte\": " << mAlloc.mByte << " }";
+    return ostr.str();
+}
+
+//------------------------------------------------------------------------------------------
+
+bool
+MergeBench::run()
+{
+    if (!mNumMachines || !mWidth || !mHeight || !mPassTotal) {
+        std::cerr << "ERROR: machines, resolution and passes should be non zero\n";
+        return false;
+    }
+
+    for (StageStats& stats : mStageStats) stats = StageStats();
+    mInputByte = 0;
+    mOutputByte = 0;
+
+    const scene_rdl2::math::Viewport rezedViewport(0, 0, mWidth - 1, mHeight - 1);
+    const uint32_t syncId = 1;
+
+    std::vector<std::unique_ptr<SyntheticMcrt>> mcrt(mNumMachines);
+    for (unsigned machineId = 0; machineId < mNumMachines; ++machineId) {
+        mcrt[machineId].reset(new SyntheticMcrt(machineId, mNumMachines, rezedViewport, mMultiplexPix, mAovSet));
+    }
+
+    bool feedback = false;
+    mcrt_dataio::FbMsgMultiFrames fbMsgMultiFrames(nullptr, &feedback);
+    if (!fbMsgMultiFrames.initTotalCacheFrames(1) ||
+        !fbMsgMultiFrames.initNumMachines(static_cast<int>(mNumMachines)) ||
+        !fbMsgMultiFrames.initFb(rezedViewport)) {
+        std::cerr << "ERROR: FbMsgMultiFrames initialization failed\n";
+        return false;
+    }
+    fbMsgMultiFrames.changeTaskType((mMultiplexPix) ?
+                                    mcrt_dataio::FbMsgSingleFrame::TaskType::MULTIPLEX_PIX :
+                                    mcrt_dataio::FbMsgSingleFrame::TaskType::NON_OVERLAPPED_TILE);
+    if (mAovSet.mRenderOutputTotal) {
+        // renderOutput AOVs are sent with their own numSample (see SyntheticMcrt.h)
+        fbMsgMultiFrames.getDisplayFbMsgSingleFrame()->setSubMergeInput(true);
+    }
+
+    mcrt_dataio::MergeFbSender fbSender;
+    PrecisionControl precisionControl = mSendPrecision;
+    fbSender.setPrecisionControl(precisionControl);
+    fbSender.init(rezedViewport);
+
+    const unsigned coarsePassTotal =
+        static_cast<unsigned>(std::lround(std::min(std::max(mCoarseRatio, 0.0f), 1.0f) *
+                                          static_cast<float>(mPassTotal)));
+
+    std::vector<mcrt::ProgressiveFrame::Ptr> messages(mNumMachines);
+    for (unsigned passId = 0; passId < mPassTotal; ++passId) {
+        const bool coarsePass = passId < coarsePassTotal;
+
+        measure(Stage::GENERATE, [&]() {
+#               ifdef SINGLE_THREAD
+                for (unsigned machineId = 0; machineId < mNumMachines; ++machineId) {
+                    messages[machineId] =
+                        mcrt[machineId]->generate(syncId, passId, mPassTotal, coarsePass, mFinePrecision);
+                }
+#               else // else SINGLE_THREAD
+                tbb::parallel_for(0U, mNumMachines, [&](unsigned machineId) {
+                        messages[machineId] =
+                            mcrt[machineId]->generate(syncId, passId, mPassTotal, coarsePass, mFinePrecision);
+                    });
+#               endif // end !SINGLE_THREAD
+            });
+        for (const auto& currMcrt : mcrt) mInputByte += currMcrt->getLastMessageByte();
+
+        // Each machine's messages are pushed by a single thread like the network receive threads.
+        std::vector<char> pushResult(mNumMachines, static_cast<char>(true));
+        auto feedbackInitCallBack = []() -> bool { return true; };
+        measure(Stage::PUSH, [&]() {
+#               ifdef SINGLE_THREAD
+                for (unsigned machineId = 0; machineId < mNumMachines; ++machineId) {
+                    pushResult[machineId] = fbMsgMultiFrames.push(*messages[machineId], feedbackInitCallBack);
+                }
+#               else // else SINGLE_THREAD
+                tbb::parallel_for(0U, mNumMachines, [&](unsigned machineId) {
+                        pushResult[machineId] = fbMsgMultiFrames.push(*messages[machineId], feedbackInitCallBack);
+                    });
+#               endif // end !SINGLE_THREAD
+            });
+        for (auto& message : messages) message.reset(); // payloads are kept by FbMsgMultiFrames
+        if (std::find(pushResult.begin(), pushResult.end(), static_cast<char>(false)) != pushResult.end()) {
+            std::cerr << "ERROR: FbMsgMultiFrames::push() failed. passId:" << passId << '\n';
+            return false;
+        }
+
+        mcrt_dataio::FbMsgSingleFrame* frame = fbMsgMultiFrames.getDisplayFbMsgSingleFrame();
+        if (!frame) {
+            std::cerr << "ERROR: could not get display frame. passId:" << passId << '\n';
+            return false;
+        }
+
+        measure(Stage::DECODE, [&]() { frame->decodeAll(); });
+
+        fbSender.setHeaderInfoAndFbReset(frame, nullptr);
+        measure(Stage::MERGE, [&]() {
+                frame->merge(mPartialMergeTilesTotal, fbSender.getFb(), fbSender.getLatencyLog());
+            });
+
+        mcrt::ProgressiveFrame::Ptr output = std::make_shared<mcrt::ProgressiveFrame>();
+        measure(Stage::ENCODE, [&]() {
+                // The whole merged result is sent every pass (i.e. no delta between passes)
+                scene_rdl2::grid_util::Fb& fb = fbSender.getFb();
+                scene_rdl2::grid_util::FbActivePixels& fbActivePixels = fbSender.getFbActivePixels();
+                fbActivePixels.getActivePixels().copy(fb.getActivePixels());
+                fbSender.addBeautyBuff(output);
+                if (fb.getPixelInfoStatus()) {
+                    fbActivePixels.getActivePixelsPixelInfo().copy(fb.getActivePixelsPixelInfo());
+                    fbSender.addPixelInfo(output);
+                }
+                if (fb.getHeatMapStatus()) {
+                    fbActivePixels.getActivePixelsHeatMap().copy(fb.getActivePixelsHeatMap());
+                    fbSender.addHeatMap(output);
+                }
+                if (fb.getWeightBufferStatus()) {
+                    fbActivePixels.getActivePixelsWeightBuffer().copy(fb.getActivePixelsWeightBuffer());
+                    fbSender.addWeightBuffer(output);
+                }
+                if (fb.getRenderBufferOddStatus()) {
+                    fbActivePixels.getActivePixelsRenderBufferOdd().copy(fb.getActivePixelsRenderBufferOdd());
+                    fbSender.addRenderBufferOdd(output);
+                }
+                if (fb.getRenderOutputStatus()) addRenderOutput(fb, output);
+            });
+        for (const mcrt::BaseFrame::DataBuffer& buffer : output->mBuffers) mOutputByte += buffer.mDataLength;
+    }
+
+    mFbDenseByte = fbMsgMultiFrames.getDisplayFbMsgSingleFrame()->getFbMemStats().mDenseByte;
+    mSenderWorkByte = fbSender.getWorkByte();
+
+    return outputJson();
+}
+
+template <typename F>
+void
+MergeBench::measure(const Stage stage, F func)
+{
+    const AllocCount startAlloc = getAllocCount();
+    scene_rdl2::rec_time::RecTime recTime;
+    recTime.start();
+    func();
+    const float sec = recTime.end();
+    mStageStats[static_cast<unsigned>(stage)].update(sec, getAllocCount() - startAlloc);
+}
+
+void
+MergeBench::addRenderOutput(scene_rdl2::grid_util::Fb& fb, mcrt::ProgressiveFrame::Ptr message)
+//
+// Encode all the regular renderOutput AOVs of the merged result concurrently by the same PackTiles
+// encoding as MergeFbSender::addRenderOutput(). The active pixels of each AOV are taken from the merged
+// Fb itself because this benchmark sends the whole merged result every pass.
+//
+{
+    static const bool sha1HashSw = false;
+
+    const PackTilePrecision precision =
+        (mSendPrecision == PrecisionControl::FULL16 || mSendPrecision == PrecisionControl::AUTO16) ?
+        PackTilePrecision::H16 : PackTilePrecision::F32;
+
+    std::vector<scene_rdl2::grid_util::Fb::FbAovShPtr> aovTbl;
+    for (unsigned id = 0; id < fb.getTotalRenderOutput(); ++id) {
+        scene_rdl2::grid_util::Fb::FbAovShPtr fbAov;
+        if (!fb.getAov2(id, fbAov) || !fbAov->getStatus()) continue;
+        if (fbAov->getReferenceType() != scene_rdl2::grid_util::FbReferenceType::UNDEF) continue;
+        aovTbl.push_back(fbAov);
+    }
+
+    std::vector<mcrt_dataio::MergeSendBufferPool::Buffer> workTbl(aovTbl.size());
+    std::vector<size_t> dataSizeTbl(aovTbl.size(), 0);
+    for (auto& work : workTbl) work = mRenderOutputBufferPool.acquire(0);
+    auto encodeAov = [&](const size_t id) {
+        const scene_rdl2::grid_util::Fb::FbAovShPtr& fbAov = aovTbl[id];
+        dataSizeTbl[id] =
+            scene_rdl2::grid_util::PackTiles::
+            encodeRenderOutputMerge(fbAov->getActivePixels(),
+                                    fbAov->getBufferTiled(),
+                                    fbAov->getDefaultValue(),
+                                    *workTbl[id],
+                                    precision,
+                                    fbAov->getClosestFilterStatus(),
+                                    fbAov->getCoarsePassPrecision(),
+                                    fbAov->getFinePassPrecision(),
+                                    sha1HashSw);
+    };
+#   ifdef SINGLE_THREAD
+    for (size_t id = 0; id < aovTbl.size(); ++id) encodeAov(id);
+#   else // else SINGLE_THREAD
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, aovTbl.size(), 1),
+                      [&](const tbb::blocked_range<size_t>& r) {
+                          for (size_t id = r.begin(); id < r.end(); ++id) encodeAov(id);
+                      });
+#   endif // end !SINGLE_THREAD
+
+    for (size_t id = 0; id < aovTbl.size(); ++id) {
+        message->addBuffer(mcrt_dataio::MergeSendBufferPool::toDataPtr(workTbl[id]),
+                           dataSizeTbl[id],
+                           aovTbl[id]->getAovName().c_str(),
+                           mcrt::BaseFrame::ENCODING_UNKNOWN);
+    }
+}
+
+bool
+MergeBench::setAovSet(const std::string& aovList)
+//
+// aovList : comma separated AOV names (pixelInfo,heatMap,weight,beautyOdd) or "none".
+// Beauty is always included.
+//
+{
+    SyntheticMcrt::AovSet aovSet;
+    aovSet.mRenderOutputTotal = mAovSet.mRenderOutputTotal; // set by -renderOutput
+    std::istringstream istr(aovList);
+    std::string aov;
+    while (std::getline(istr, aov, ',')) {
+        if (aov == "pixelInfo") aovSet.mPixelInfo = true;
+        else if (aov == "heatMap") aovSet.mHeatMap = true;
+        else if (aov == "weight") aovSet.mWeight = true;
+        else if (aov == "beautyOdd") aovSet.mBeautyOdd = true;
+        else if (aov == "none" || aov.empty()) {}
+        else {
+            std::cerr << "ERROR: unknown AOV:" << aov << '\n';
+            return false;
+        }
+    }
+    mAovSet = aovSet;
+    return true;
+}
+
+bool
+MergeBench::outputJson() const
+{
+    if (mJsonFileName.empty()) {
+        std::cout << jsonStr() << std::endl;
+        return true;
+    }
+
+    std::ofstream ofs(mJsonFileName);
+    if (!ofs) {
+        std::cerr << "ERROR: could not open file:" << mJsonFileName << '\n';
+        return false;
+    }
+    ofs << jsonStr() << '\n';
+    return true;
+}
+
+// static function
+std::string
+MergeBench::stageStr(const Stage stage)
+{
+    switch (stage) {
+    case Stage::GENERATE : return "generate";
+    case Stage::PUSH : return "push";
+    case Stage::DECODE : return "decode";
+    case Stage::MERGE : return "merge";
+    case Stage::ENCODE : return "encode";
+    default : return "?";
+    }
+}
+
+// static function
+std::string
+MergeBench::precisionStr(const PackTilePrecision precision)
+{
+    switch (precision) {
+    case PackTilePrecision::UC8 : return "uc8";
+    case PackTilePrecision::H16 : return "h16";
+    case PackTilePrecision::F32 : return "f32";
+    default : return "?";
+    }
+}
+
+// static function
+std::string
+MergeBench::sendPrecisionStr(const PrecisionControl precisionControl)
+{
+    switch (precisionControl) {
+    case PrecisionControl::FULL32 : return "full32";
+    case PrecisionControl::FULL16 : return "full16";
+    case PrecisionControl::AUTO32 : return "auto32";
+    case PrecisionControl::AUTO16 : return "auto16";
+    default : return "?";
+    }
+}
+
+std::string
+MergeBench::aovSetJsonStr() const
+{
+    std::ostringstream ostr;
+    ostr << "[\"beauty\"";
+    if (mAovSet.mPixelInfo) ostr << ", \"pixelInfo\"";
+    if (mAovSet.mHeatMap) ostr << ", \"heatMap\"";
+    if (mAovSet.mWeight) ostr << ", \"weight\"";
+    if (mAovSet.mBeautyOdd) ostr << ", \"beautyOdd\"";
+    ostr << "]";
+    return ostr.str();
+}
+
+std::string
+MergeBench::jsonStr() const
+{
+    auto getSec = [&](const Stage stage) { return mStageStats[static_cast<unsigned>(stage)].mTotalSec; };
+    auto perSec = [](const double v, const float sec) { return (sec > 0.0f) ? v / static_cast<double>(sec) : 0.0; };
+
+    const float mergeSec = getSec(Stage::PUSH) + getSec(Stage::DECODE) + getSec(Stage::MERGE) + getSec(Stage::ENCODE);
+    const double pixTotal = static_cast<double>(mWidth) * static_cast<double>(mHeight) * mPassTotal;
+
+    std::ostringstream ostr;
+    ostr << "{\n"
+         << "  \"config\": {\n"
+         << "    \"machines\": " << mNumMachines << ",\n"
+         << "    \"width\": " << mWidth << ",\n"
+         << "    \"height\": " << mHeight << ",\n"
+         << "    \"aov\": " << aovSetJsonStr() << ",\n"
+         << "    \"renderOutput\": " << mAovSet.mRenderOutputTotal << ",\n"
+         << "    \"precision\": \"" << precisionStr(mFinePrecision) << "\",\n"
+         << "    \"sendPrecision\": \"" << sendPrecisionStr(mSendPrecision) << "\",\n"
+         << "    \"coarseRatio\": " << mCoarseRatio << ",\n"
+         << "    \"taskType\": \"" << ((mMultiplexPix) ? "multiplex" : "tile") << "\",\n"
+         << "    \"passes\": " << mPassTotal << ",\n"
+         << "    \"partialMergeTiles\": " << mPartialMergeTilesTotal << "\n"
+         << "  },\n"
+         << "  \"stages\": {\n";
+    for (unsigned i = 0; i < sStageTotal; ++i) {
+        ostr << "    \"" << stageStr(static_cast<Stage>(i)) << "\": " << mStageStats[i].jsonStr()
+             << ((i + 1 < sStageTotal) ? ",\n" : "\n");
+    }
+    ostr << "  },\n"
+         << "  \"throughput\": {\n"
+         << "    \"inputByte\": " << mInputByte << ",\n"
+         << "    \"outputByte\": " << mOutputByte << ",\n"
+         << "    \"passPerSec\": " << perSec(mPassTotal, mergeSec) << ",\n" // push + decode + merge + encode
+         << "    \"inputMBytePerSec\": "
+         << perSec(mInputByte / (1024.0 * 1024.0), getSec(Stage::PUSH) + getSec(Stage::DECODE)) << ",\n"
+         << "    \"mergeMPixPerSec\": " << perSec(pixTotal / 1000000.0, getSec(Stage::MERGE)) << ",\n"
+         << "    \"outputMBytePerSec\": " << perSec(mOutputByte / (1024.0 * 1024.0), getSec(Stage::ENCODE)) << "\n"
+         << "  },\n"
+         << "  \"memory\": {\n"
+         << "    \"peakRssByte\": " << getPeakRssByte() << ",\n"
+         << "    \"fbDenseByte\": " << mFbDenseByte << ",\n"
+         << "    \"senderWorkByte\": " << mSenderWorkByte << "\n"
+         << "  }\n"
+         << "}";
+    return ostr.str();
+}
+
+std::string
+MergeBench::showConfig() const
+{
+    using scene_rdl2::str_util::boolStr;
+
+    std::ostringstream ostr;
+    ostr << "MergeBench {\n"
+         << "  mNumMachines:" << mNumMachines << '\n'
+         << "  reso:" << mWidth << 'x' << mHeight << '\n'
+         << "  aov:" << aovSetJsonStr() << '\n'
+         << "  renderOutput:" << mAovSet.mRenderOutputTotal << '\n'
+         << "  mFinePrecision:" << precisionStr(mFinePrecision) << '\n'
+         << "  mSendPrecision:" << sendPrecisionStr(mSendPrecision) << '\n'
+         << "  mCoarseRatio:" << mCoarseRatio << '\n'
+         << "  mMultiplexPix:" << boolStr(mMultiplexPix) << '\n'
+         << "  mPassTotal:" << mPassTotal << '\n'
+         << "  mPartialMergeTilesTotal:" << mPartialMergeTilesTotal << '\n'
+         << "  mJsonFileName:" << ((mJsonFileName.empty()) ? "(stdout)" : mJsonFileName) << '\n'
+         << "}";
+    return ostr.str();
+}
+
+void
+MergeBench::parserConfigure()
+{
+    mParser.description("synthetic merge pipeline benchmark command");
+    mParser.opt("-machines", "<n>", "set number of MCRT computations",
+                [&](Arg& arg) -> bool { mNumMachines = (arg++).as<unsigned>(0); return true; });
+    mParser.opt("-reso", "<width> <height>", "set image resolution",
+                [&](Arg& arg) -> bool {
+                    mWidth = (arg++).as<unsigned>(0);
+                    mHeight = (arg++).as<unsigned>(0);
+                    return true;
+                });
+    mParser.opt("-aov", "<aovList>", "set comma separated AOVs (pixelInfo,heatMap,weight,beautyOdd or none) "
+                "in addition to beauty",
+                [&](Arg& arg) -> bool { return setAovSet((arg++)()); });
+    mParser.opt("-renderOutput", "<n>", "set number of renderOutput AOVs (0 ~ 64, 15 ~ 30 is a typical production "
+                "AOV set)",
+                [&](Arg& arg) -> bool {
+                    const unsigned n = (arg++).as<unsigned>(0);
+                    if (n > sRenderOutputMax) {
+                        std::cerr << "ERROR: renderOutput:" << n << " > max:" << sRenderOutputMax << '\n';
+                        return false;
+                    }
+                    mAovSet.mRenderOutputTotal = n;
+                    return true;
+                });
+    mParser.opt("-precision", "<f32|h16>", "set fine pass precision of the MCRT messages",
+                [&](Arg& arg) -> bool {
+                    const std::string str = (arg++)();
+                    if (str == "f32") mFinePrecision = PackTilePrecision::F32;
+                    else if (str == "h16") mFinePrecision = PackTilePrecision::H16;
+                    else {
+                        std::cerr << "ERROR: unknown precision:" << str << '\n';
+                        return false;
+                    }
+                    return true;
+                });
+    mParser.opt("-sendPrecision", "<full32|full16|auto32|auto16>", "set precision control of the merge output",
+                [&](Arg& arg) -> bool {
+                    const std::string str = (arg++)();
+                    if (str == "full32") mSendPrecision = PrecisionControl::FULL32;
+                    else if (str == "full16") mSendPrecision = PrecisionControl::FULL16;
+                    else if (str == "auto32") mSendPrecision = PrecisionControl::AUTO32;
+                    else if (str == "auto16") mSendPrecision = PrecisionControl::AUTO16;
+                    else {
+                        std::cerr << "ERROR: unknown sendPrecision:" << str << '\n';
+                        return false;
+                    }
+                    return true;
+                });
+    mParser.opt("-coarseRatio", "<ratio>", "set ratio of the coarse pass messages (0.0 ~ 1.0)",
+                [&](Arg& arg) -> bool { mCoarseRatio = (arg++).as<float>(0); return true; });
+    mParser.opt("-taskType", "<multiplex|tile>", "set task distribution type of MCRT computations",
+                [&](Arg& arg) -> bool {
+                    const std::string str = (arg++)();
+                    if (str == "multiplex") mMultiplexPix = true;
+                    else if (str == "tile") mMultiplexPix = false;
+                    else {
+                        std::cerr << "ERROR: unknown taskType:" << str << '\n';
+                        return false;
+                    }
+                    return true;
+                });
+    mParser.opt("-passes", "<n>", "set number of messages of each MCRT computation",
+                [&](Arg& arg) -> bool { mPassTotal = (arg++).as<unsigned>(0); return true; });
+    mParser.opt("-partialMergeTiles", "<n>", "set partial merge tiles total (0 : non-partial-merge-mode)",
+                [&](Arg& arg) -> bool { mPartialMergeTilesTotal = (arg++).as<unsigned>(0); return true; });
+    mParser.opt("-json", "<fileName|->", "set output JSON file name. '-' is stdout",
+                [&](Arg& arg) -> bool {
+                    mJsonFileName = (arg++)();
+                    if (mJsonFileName == "-") mJsonFileName.clear();
+                    return true;
+                });
+    mParser.opt("-show", "", "show configuration after all the options are parsed",
+                [&](Arg& arg) -> bool { mShow = true; return true; });
+    mParser.opt("-tileSetBench", "<loopMax>", "measure size and encode/decode time of the partial merge tile set "
+                "encodings of the feedback merge action sequence",
+                [&](Arg& arg) -> bool { mTileSetBenchLoop = (arg++).as<unsigned>(0); return true; });
+    mParser.opt("-run", "", "run benchmark after all the options are parsed and output result by JSON",
+                [&](Arg& arg) -> bool { mRun = true; return true; });
+}
+
+} // namespace mergeBench
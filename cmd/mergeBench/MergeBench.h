@@ -0,0 +1,115 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+//
+// Synthetic merge pipeline benchmark
+//
+// Measures the merge computation without a full Arras session. SyntheticMcrt generates ProgressiveFrame
+// messages of all the machines for every pass and they are processed by the same sequence as the merge
+// computation.
+//   generate : SyntheticMcrt::generate() (MCRT side cost, not a part of the merge computation)
+//   push     : FbMsgMultiFrames::push() of all machines (concurrent by machine)
+//   decode   : FbMsgSingleFrame::decodeAll()
+//   merge    : FbMsgSingleFrame::merge()
+//   encode   : MergeFbSender::add*() for the client output message
+// Time, heap allocations (see AllocCounter.h) of each stage, throughput and peak RSS are reported by JSON.
+// Options are able to be specified in any order. The benchmark runs after all the options are parsed.
+// -tileSetBench measures the partial merge tile set encodings of the feedback merge action sequence
+// (MergeActionTracker::benchTileSet()) independently from the pipeline benchmark.
+//
+
+#include "AllocCounter.h"
+#include "SyntheticMcrt.h"
+
+#include <mcrt_dataio/engine/merger/MergeFbSender.h>
+#include <mcrt_dataio/engine/merger/MergeSendBufferPool.h>
+
+#include <scene_rdl2/common/grid_util/Arg.h>
+#include <scene_rdl2/common/grid_util/Parser.h>
+
+#include <array>
+#include <string>
+
+namespace mergeBench {
+
+class MergeBench
+{
+public:
+    using Arg = scene_rdl2::grid_util::Arg;
+    using Parser = scene_rdl2::grid_util::Parser;
+    using PackTilePrecision = SyntheticMcrt::PackTilePrecision;
+    using PrecisionControl = mcrt_dataio::MergeFbSender::PrecisionControl;
+
+    MergeBench() { parserConfigure(); }
+
+    bool main(int ac, char **av);
+
+private:
+    enum class Stage : unsigned {
+        GENERATE,
+        PUSH,
+        DECODE,
+        MERGE,
+        ENCODE,
+        SIZE
+    };
+
+    struct StageStats
+    {
+        unsigned mCount {0};
+        float mTotalSec {0.0f};
+        float mMinSec {0.0f};
+        float mMaxSec {0.0f};
+        AllocCount mAlloc;
+
+        void update(const float sec, const AllocCount& alloc);
+        std::string jsonStr() const;
+    };
+
+    static constexpr unsigned sStageTotal = static_cast<unsigned>(Stage::SIZE);
+    static constexpr unsigned sRenderOutputMax = 64;
+
+    unsigned mNumMachines {4};
+    unsigned mWidth {1920};
+    unsigned mHeight {1080};
+    SyntheticMcrt::AovSet mAovSet;
+    PackTilePrecision mFinePrecision {PackTilePrecision::F32}; // MCRT side fine pass precision
+    PrecisionControl mSendPrecision {PrecisionControl::AUTO16}; // merge side output precision
+    float mCoarseRatio {0.1f};   // ratio of the coarse pass messages of all passes
+    bool mMultiplexPix {true};   // false : non-overlapped tile
+    unsigned mPassTotal {32};    // messages of each machine
+    unsigned mPartialMergeTilesTotal {0}; // 0 : non-partial-merge-mode
+    std::string mJsonFileName;   // empty : stdout
+    bool mShow {false};          // show configuration after all the options are parsed
+    bool mRun {false};           // run benchmark after all the options are parsed
+    unsigned mTileSetBenchLoop {0}; // 0 : skip tile set encoding benchmark
+
+    std::array<StageStats, sStageTotal> mStageStats;
+    size_t mInputByte {0};       // total encoded byte of all the synthetic MCRT messages
+    size_t mOutputByte {0};      // total encoded byte of the merge output messages
+    size_t mFbDenseByte {0};     // per-machine Fbs after the last pass
+    size_t mSenderWorkByte {0};  // MergeFbSender work buffers after the last pass
+    mcrt_dataio::MergeSendBufferPool mRenderOutputBufferPool;
+
+    Parser mParser;
+
+    bool run();
+    template <typename F> void measure(const Stage stage, F func);
+    void addRenderOutput(scene_rdl2::grid_util::Fb& fb, mcrt::ProgressiveFrame::Ptr message);
+
+    bool setAovSet(const std::string& aovList);
+    bool outputJson() const;
+
+    static std::string stageStr(const Stage stage);
+    static std::string precisionStr(const PackTilePrecision precision);
+    static std::string sendPrecisionStr(const PrecisionControl precisionControl);
+    std::string aovSetJsonStr() const;
+    std::string jsonStr() const;
+    std::string showConfig() const;
+
+    void parserConfigure();
+}; // MergeBench
+
+} // namespace mergeBench
@@ -0,0 +1,296 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SyntheticMcrt.h"
+
+#include <mcrt_dataio/engine/merger/SubMergeAovNumSample.h>
+
+#include <scene_rdl2/common/grid_util/ProgressiveFrameBufferName.h>
+#include <scene_rdl2/scene/rdl2/ValueContainerEnq.h>
+
+#include <iomanip>
+#include <sstream>
+
+namespace mergeBench {
+
+SyntheticMcrt::SyntheticMcrt(const unsigned machineId,
+                             const unsigned numMachines,
+                             const scene_rdl2::math::Viewport& rezedViewport,
+                             const bool multiplexPix,
+                             const AovSet& aovSet)
+    : mMachineId(machineId)
+    , mNumMachines(numMachines)
+    , mRezedViewport(rezedViewport)
+    , mAovSet(aovSet)
+{
+    mFb.init(mRezedViewport);
+    if (mAovSet.mPixelInfo) mFb.setupPixelInfo(nullptr, "pixelInfo");
+    if (mAovSet.mHeatMap) mFb.setupHeatMap(nullptr, "heatMap");
+    if (mAovSet.mWeight) mFb.setupWeightBuffer(nullptr, "weight");
+    if (mAovSet.mBeautyOdd) mFb.setupRenderBufferOdd(nullptr);
+
+    setupTileMask(multiplexPix);
+    setupRenderOutput();
+}
+
+mcrt::ProgressiveFrame::Ptr
+SyntheticMcrt::generate(const uint32_t syncId,
+                        const unsigned passId,
+                        const unsigned passTotal,
+                        const bool coarsePass,
+                        const PackTilePrecision finePrecision)
+{
+    static const bool sha1HashSw = false;
+
+    updatePixels(passId);
+
+    const PackTilePrecision precision = (coarsePass) ? PackTilePrecision::UC8 : finePrecision;
+
+    mcrt::ProgressiveFrame::Ptr message = std::make_shared<mcrt::ProgressiveFrame>();
+    message->mMachineId = static_cast<int>(mMachineId);
+    message->mSnapshotId = passId;
+    message->mSendImageActionId = passId;
+    message->mCoarsePassStatus = (coarsePass) ? 0 : 1;
+    message->mHeader.mFrameId = syncId;
+    message->mHeader.mProgress = static_cast<float>(passId + 1) / static_cast<float>(passTotal);
+    if (passId == 0) {
+        message->mHeader.mStatus = mcrt::BaseFrame::STARTED;
+    } else if (passId + 1 == passTotal) {
+        message->mHeader.mStatus = mcrt::BaseFrame::FINISHED;
+    } else {
+        message->mHeader.mStatus = mcrt::BaseFrame::RENDERING;
+    }
+    message->mHeader.setRezedViewport(mRezedViewport.mMinX, mRezedViewport.mMinY,
+                                      mRezedViewport.mMaxX, mRezedViewport.mMaxY);
+
+    mLastMessageByte = 0;
+    auto addBuffer = [&](const mcrt_dataio::MergeSendBufferPool::Buffer& work,
+                         const size_t dataSize,
+                         const char* name) {
+        message->addBuffer(mcrt_dataio::MergeSendBufferPool::toDataPtr(work),
+                           dataSize,
+                           name,
+                           mcrt::BaseFrame::ENCODING_UNKNOWN);
+        mLastMessageByte += dataSize;
+    };
+
+    {
+        mcrt_dataio::MergeSendBufferPool::Buffer work = mBufferPool.acquire(0);
+        const size_t dataSize =
+            scene_rdl2::grid_util::PackTiles::
+            encode(false, // renderBufferOdd
+                   mFb.getActivePixels(),
+                   mFb.getRenderBufferTiled(),
+                   mFb.getNumSampleBufferTiled(),
+                   *work,
+                   precision,
+                   mFb.getRenderBufferCoarsePassPrecision(),
+                   mFb.getRenderBufferFinePassPrecision(),
+                   sha1HashSw); // RGBA + numSample : float * 4 + u_int
+        addBuffer(work, dataSize, scene_rdl2::grid_util::ProgressiveFrameBufferName::Beauty);
+    }
+    if (mAovSet.mPixelInfo) {
+        mcrt_dataio::MergeSendBufferPool::Buffer work = mBufferPool.acquire(0);
+        const size_t dataSize =
+            scene_rdl2::grid_util::PackTiles::
+            encodePixelInfo(mFb.getActivePixelsPixelInfo(),
+                            mFb.getPixelInfoBufferTiled(),
+                            *work,
+                            precision,
+                            mFb.getPixelInfoCoarsePassPrecision(),
+                            mFb.getPixelInfoFinePassPrecision(),
+                            sha1HashSw);
+        addBuffer(work, dataSize, mFb.getPixelInfoName().c_str());
+    }
+    if (mAovSet.mHeatMap) {
+        mcrt_dataio::MergeSendBufferPool::Buffer work = mBufferPool.acquire(0);
+        const size_t dataSize =
+            scene_rdl2::grid_util::PackTiles::
+            encodeHeatMap(mFb.getActivePixelsHeatMap(),
+                          mFb.getHeatMapSecBufferTiled(),
+                          *work,
+                          sha1HashSw);
+        addBuffer(work, dataSize, mFb.getHeatMapName().c_str());
+    }
+    if (mAovSet.mWeight) {
+        mcrt_dataio::MergeSendBufferPool::Buffer work = mBufferPool.acquire(0);
+        const size_t dataSize =
+            scene_rdl2::grid_util::PackTiles::
+            encodeWeightBuffer(mFb.getActivePixelsWeightBuffer(),
+                               mFb.getWeightBufferTiled(),
+                               *work,
+                               precision,
+                               mFb.getWeightBufferCoarsePassPrecision(),
+                               mFb.getWeightBufferFinePassPrecision(),
+                               sha1HashSw);
+        addBuffer(work, dataSize, mFb.getWeightBufferName().c_str());
+    }
+    if (mAovSet.mBeautyOdd) {
+        mcrt_dataio::MergeSendBufferPool::Buffer work = mBufferPool.acquire(0);
+        const size_t dataSize =
+            scene_rdl2::grid_util::PackTiles::
+            encode(true, // renderBufferOdd
+                   mFb.getActivePixelsRenderBufferOdd(),
+                   mFb.getRenderBufferOddTiled(),
+                   *work,
+                   precision,
+                   mFb.getRenderBufferCoarsePassPrecision(), // dummy value
+                   mFb.getRenderBufferFinePassPrecision(), // dummy value
+                   sha1HashSw); // RGBA : float * 4
+        addBuffer(work, dataSize, scene_rdl2::grid_util::ProgressiveFrameBufferName::RenderBufferOdd);
+    }
+    if (!mRenderOutputTbl.empty()) {
+        std::vector<mcrt_dataio::SubMergeAovNumSample::Aov> numSampleTbl;
+        for (const auto& aov : mRenderOutputTbl) {
+            mcrt_dataio::MergeSendBufferPool::Buffer work = mBufferPool.acquire(0);
+            const size_t dataSize =
+                scene_rdl2::grid_util::PackTiles::
+                encodeRenderOutputMerge(aov->mActivePixels,
+                                        aov->mBufferTiled,
+                                        0.0f, // defaultValue
+                                        *work,
+                                        precision,
+                                        false, // closestFilterStatus
+                                        mFb.getRenderBufferCoarsePassPrecision(), // dummy value
+                                        mFb.getRenderBufferFinePassPrecision(), // dummy value
+                                        sha1HashSw);
+            addBuffer(work, dataSize, aov->mName.c_str());
+            numSampleTbl.push_back({aov->mName, &aov->mActivePixels, aov->mNumSampleTiled.data()});
+        }
+
+        mcrt_dataio::MergeSendBufferPool::Buffer work = mBufferPool.acquire(0);
+        scene_rdl2::rdl2::ValueContainerEnq cEnq(work.get());
+        mcrt_dataio::SubMergeAovNumSample::encode(static_cast<unsigned>(mTileMask.size()), numSampleTbl, cEnq);
+        const size_t dataSize = cEnq.finalize();
+        addBuffer(work, dataSize, mcrt_dataio::SubMergeAovNumSample::sBuffName);
+    }
+
+    return message;
+}
+
+void
+SyntheticMcrt::setupTileMask(const bool multiplexPix)
+//
+// MULTIPLEX_PIX : pixels of every tile are interleaved by all machines.
+// non-overlapped tile : each tile is owned by a single machine.
+// Pixels outside of the viewport are never activated.
+//
+{
+    const unsigned width = mRezedViewport.width();
+    const unsigned height = mRezedViewport.height();
+    const unsigned numTilesX = mFb.getNumTilesX();
+    const size_t totalTiles = mFb.getTotalTiles();
+
+    mTileMask.assign(totalTiles, 0x0);
+    mActivePixelsTotal = 0;
+    for (size_t tileId = 0; tileId < totalTiles; ++tileId) {
+        if (!multiplexPix && tileId % mNumMachines != mMachineId) continue;
+
+        const unsigned tileX = static_cast<unsigned>(tileId % numTilesX) * 8;
+        const unsigned tileY = static_cast<unsigned>(tileId / numTilesX) * 8;
+        uint64_t mask = 0x0;
+        for (unsigned pixId = 0; pixId < 64; ++pixId) {
+            if (tileX + (pixId & 0x7) >= width || tileY + (pixId >> 3) >= height) continue;
+            if (multiplexPix && (pixId + tileId) % mNumMachines != mMachineId) continue;
+            mask |= (static_cast<uint64_t>(0x1) << pixId);
+            mActivePixelsTotal++;
+        }
+        mTileMask[tileId] = mask;
+
+        mFb.getActivePixels().setTileMask(tileId, mask);
+        if (mAovSet.mPixelInfo) mFb.getActivePixelsPixelInfo().setTileMask(tileId, mask);
+        if (mAovSet.mHeatMap) mFb.getActivePixelsHeatMap().setTileMask(tileId, mask);
+        if (mAovSet.mWeight) mFb.getActivePixelsWeightBuffer().setTileMask(tileId, mask);
+        if (mAovSet.mBeautyOdd) mFb.getActivePixelsRenderBufferOdd().setTileMask(tileId, mask);
+    }
+}
+
+void
+SyntheticMcrt::setupRenderOutput()
+//
+// The AOV format is cycled by FLOAT3 (albedo, normal, light path expressions), FLOAT (depth, coverage)
+// and FLOAT2 (motion vector). All AOVs have the same pixels as the beauty.
+//
+{
+    using Format = scene_rdl2::fb_util::VariablePixelBuffer::Format;
+    static const Format formatTbl[] = {Format::FLOAT3, Format::FLOAT3, Format::FLOAT, Format::FLOAT2};
+
+    const unsigned numTilesX = mFb.getNumTilesX();
+    const unsigned alignedWidth = numTilesX * 8;
+    const unsigned alignedHeight = static_cast<unsigned>(mTileMask.size() / numTilesX) * 8;
+
+    mRenderOutputTbl.clear();
+    for (unsigned aovId = 0; aovId < mAovSet.mRenderOutputTotal; ++aovId) {
+        std::ostringstream ostr;
+        ostr << "renderOutput" << std::setw(2) << std::setfill('0') << aovId;
+
+        std::unique_ptr<RenderOutput> aov(new RenderOutput);
+        aov->mName = ostr.str();
+        aov->mActivePixels.init(mRezedViewport.width(), mRezedViewport.height());
+        aov->mBufferTiled.init(formatTbl[aovId % 4], alignedWidth, alignedHeight);
+        aov->mNumSampleTiled.assign(mTileMask.size() * 64, 0);
+        for (size_t tileId = 0; tileId < mTileMask.size(); ++tileId) {
+            aov->mActivePixels.setTileMask(tileId, mTileMask[tileId]);
+        }
+        mRenderOutputTbl.push_back(std::move(aov));
+    }
+}
+
+void
+SyntheticMcrt::updatePixels(const unsigned passId)
+{
+    static constexpr unsigned samplesPerPass = 4;
+
+    scene_rdl2::math::Vec4f* c = mFb.getRenderBufferTiled().getData();
+    unsigned* numSample = mFb.getNumSampleBufferTiled().getData();
+    float* pixelInfo = (mAovSet.mPixelInfo) ?
+        reinterpret_cast<float*>(mFb.getPixelInfoBufferTiled().getData()) : nullptr; // depth
+    float* heatMap = (mAovSet.mHeatMap) ?
+        reinterpret_cast<float*>(mFb.getHeatMapSecBufferTiled().getData()) : nullptr;
+    float* weight = (mAovSet.mWeight) ?
+        reinterpret_cast<float*>(mFb.getWeightBufferTiled().getData()) : nullptr;
+    scene_rdl2::math::Vec4f* cOdd = (mAovSet.mBeautyOdd) ?
+        reinterpret_cast<scene_rdl2::math::Vec4f*>(mFb.getRenderBufferOddTiled().getData()) : nullptr;
+
+    const unsigned currNumSample = (passId + 1) * samplesPerPass;
+    for (size_t tileId = 0; tileId < mTileMask.size(); ++tileId) {
+        const uint64_t mask = mTileMask[tileId];
+        if (!mask) continue;
+        for (unsigned pixId = 0; pixId < 64; ++pixId) {
+            if (!(mask & (static_cast<uint64_t>(0x1) << pixId))) continue;
+
+            const size_t offset = tileId * 64 + pixId;
+            // cheap deterministic LDR pattern which changes for every pass
+            const float v =
+                static_cast<float>((offset * 7 + mMachineId * 17 + passId * 29) & 0xff) / 256.0f;
+            c[offset] = scene_rdl2::math::Vec4f(v, 1.0f - v, 0.5f * v, 1.0f);
+            numSample[offset] = currNumSample;
+            if (pixelInfo) pixelInfo[offset] = 1.0f + v * 100.0f;
+            if (heatMap) heatMap[offset] = v * 0.001f;
+            if (weight) weight[offset] = static_cast<float>(currNumSample);
+            if (cOdd) cOdd[offset] = scene_rdl2::math::Vec4f(0.5f * v, 0.5f * (1.0f - v), 0.25f * v, 1.0f);
+        }
+    }
+
+    for (auto& aov : mRenderOutputTbl) {
+        float* p = reinterpret_cast<float*>(aov->mBufferTiled.getData());
+        const size_t chanTotal = aov->mBufferTiled.getSizeOfPixel() / sizeof(float);
+        for (size_t tileId = 0; tileId < mTileMask.size(); ++tileId) {
+            const uint64_t mask = mTileMask[tileId];
+            if (!mask) continue;
+            for (unsigned pixId = 0; pixId < 64; ++pixId) {
+                if (!(mask & (static_cast<uint64_t>(0x1) << pixId))) continue;
+
+                const size_t offset = tileId * 64 + pixId;
+                const float v =
+                    static_cast<float>((offset * 13 + mMachineId * 17 + passId * 29) & 0xff) / 256.0f;
+                for (size_t chan = 0; chan < chanTotal; ++chan) {
+                    p[offset * chanTotal + chan] = v * static_cast<float>(chan + 1);
+                }
+                aov->mNumSampleTiled[offset] = currNumSample;
+            }
+        }
+    }
+}
+
+} // namespace mergeBench
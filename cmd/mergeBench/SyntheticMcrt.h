@@ -0,0 +1,96 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+//
+// Synthetic MCRT computation for the merge pipeline benchmark
+//
+// Each SyntheticMcrt keeps its own Fb and generates the same kind of ProgressiveFrame message which a
+// single MCRT computation sends to the merge computation (beauty with numSample and optional AOV
+// buffers encoded by PackTiles). Pixels are distributed to the machines by MULTIPLEX_PIX (pixels in
+// every tile are interleaved) or by non-overlapped tiles. Each generate() call updates all the pixels
+// owned by this machine as one render pass.
+//
+// RenderOutput AOVs (optional, typical production mix of FLOAT3/FLOAT/FLOAT2 buffers) are encoded in the
+// same way as the sub-merge output of the hierarchical merge (see MergeFbSender::addRenderOutputWithNumSample()):
+// each AOV by PackTiles::encodeRenderOutputMerge() and the own numSample of all AOVs by a single
+// SubMergeAovNumSample buffer. The merge side should be configured as sub-merge input to receive them.
+//
+
+#include <mcrt_dataio/engine/merger/MergeSendBufferPool.h>
+
+#include <mcrt_messages/ProgressiveFrame.h>
+#include <scene_rdl2/common/fb_util/ActivePixels.h>
+#include <scene_rdl2/common/fb_util/VariablePixelBuffer.h>
+#include <scene_rdl2/common/grid_util/Fb.h>
+#include <scene_rdl2/common/grid_util/PackTiles.h>
+#include <scene_rdl2/common/math/Viewport.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mergeBench {
+
+class SyntheticMcrt
+{
+public:
+    using PackTilePrecision = scene_rdl2::grid_util::PackTiles::PrecisionMode;
+
+    struct AovSet {
+        bool mPixelInfo {false};
+        bool mHeatMap {false};
+        bool mWeight {false};
+        bool mBeautyOdd {false};
+        unsigned mRenderOutputTotal {0}; // number of renderOutput AOVs
+    };
+
+    SyntheticMcrt(const unsigned machineId,
+                  const unsigned numMachines,
+                  const scene_rdl2::math::Viewport& rezedViewport,
+                  const bool multiplexPix,
+                  const AovSet& aovSet);
+
+    // Non-copyable
+    SyntheticMcrt &operator = (const SyntheticMcrt) = delete;
+    SyntheticMcrt(const SyntheticMcrt &) = delete;
+
+    // Update all the pixels of this machine for the pass and encode them into a new message.
+    // Coarse pass messages are encoded by UC8 and fine pass messages are encoded by finePrecision.
+    mcrt::ProgressiveFrame::Ptr generate(const uint32_t syncId,
+                                         const unsigned passId,
+                                         const unsigned passTotal,
+                                         const bool coarsePass,
+                                         const PackTilePrecision finePrecision);
+
+    size_t getActivePixelsTotal() const { return mActivePixelsTotal; }
+    size_t getLastMessageByte() const { return mLastMessageByte; }
+
+private:
+    struct RenderOutput {
+        std::string mName;
+        scene_rdl2::fb_util::ActivePixels mActivePixels;
+        scene_rdl2::fb_util::VariablePixelBuffer mBufferTiled;
+        std::vector<unsigned> mNumSampleTiled;
+    };
+
+    unsigned mMachineId {0};
+    unsigned mNumMachines {0};
+    scene_rdl2::math::Viewport mRezedViewport;
+    AovSet mAovSet;
+
+    scene_rdl2::grid_util::Fb mFb;
+    std::vector<uint64_t> mTileMask; // [tileId] : pixels of this machine
+    size_t mActivePixelsTotal {0};
+    std::vector<std::unique_ptr<RenderOutput>> mRenderOutputTbl;
+
+    mcrt_dataio::MergeSendBufferPool mBufferPool;
+    size_t mLastMessageByte {0};
+
+    void setupTileMask(const bool multiplexPix);
+    void setupRenderOutput();
+    void updatePixels(const unsigned passId);
+}; // SyntheticMcrt
+
+} // namespace mergeBench
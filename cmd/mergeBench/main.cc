@@ -0,0 +1,18 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MergeBench.h"
+
+#include <iostream>
+
+int
+main(int ac, char **av)
+{
+    mergeBench::MergeBench mergeBench;
+    if (!mergeBench.main(ac, av)) {
+        std::cerr << "error\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -6,11 +6,97 @@
 #include <scene_rdl2/common/fb_util/GammaF2C.h>
 #include <scene_rdl2/common/fb_util/ReGammaC2F.h>
 
+#include <tbb/parallel_for.h>
+
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t sPixGrainSize = 16384; // pixels of a single parallel task
+constexpr size_t sFBDPixByte = 27;      // "xxxxxxxx xxxxxxxx xxxxxxxx " : 3 hex floats for each pixel
+
+//
+// Read only memory mapped file. The file is closed and unmapped by the destructor.
+//
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& filename)
+    {
+        mFd = open(filename.c_str(), O_RDONLY);
+        if (mFd < 0) return;
+
+        struct stat st;
+        if (fstat(mFd, &st) != 0 || st.st_size <= 0) return;
+        void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, mFd, 0);
+        if (addr == MAP_FAILED) return;
+
+        madvise(addr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+        mData = static_cast<const char*>(addr);
+        mSize = static_cast<size_t>(st.st_size);
+    }
+    ~MappedFile()
+    {
+        if (mData) munmap(const_cast<char*>(mData), mSize);
+        if (mFd >= 0) close(mFd);
+    }
+
+    // Non-copyable
+    MappedFile &operator = (const MappedFile) = delete;
+    MappedFile(const MappedFile &) = delete;
+
+    bool isValid() const { return mData != nullptr; }
+    const char* getData() const { return mData; }
+    size_t getSize() const { return mSize; }
+
+private:
+    int mFd {-1};
+    const char* mData {nullptr};
+    size_t mSize {0};
+};
+
+inline int
+hexNibble(const char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+inline bool
+hexFloat2f(const char* hexFloat, float& f)
+//
+// Same byte order as Fb::saveFBDMain() : 4 bytes of the float by memory order.
+//
+{
+    unsigned char uc[4];
+    for (int i = 0; i < 4; ++i) {
+        const int a = hexNibble(hexFloat[i * 2]);
+        const int b = hexNibble(hexFloat[i * 2 + 1]);
+        if (a < 0 || b < 0) return false;
+        uc[i] = static_cast<unsigned char>((a << 4) | b);
+    }
+    std::memcpy(&f, uc, sizeof(float));
+    return true;
+}
+
+} // namespace
+
 namespace verifyFeedback {
 
+static_assert(sizeof(Fb::Pix) == sizeof(float) * 3, "Fb::Pix should be 3 packed floats");
+
 Fb::Fb(const std::string& filename, bool isBeauty)
 {
     std::string msgBuff;
@@ -54,39 +140,72 @@ Fb::isSame(const Fb& src) const
         return true;
     };
 
-    return crawlAllPix([&](unsigned x, unsigned y) -> bool { return isSamePix(getPix(x, y), src.getPix(x, y)); });
+    return crawlAllPixRange([&](size_t start, size_t end) -> bool {
+            for (size_t offset = start; offset < end; ++offset) {
+                if (!isSamePix(mFb[offset], src.mFb[offset])) return false;
+            }
+            return true;
+        });
 }
 
 bool
 Fb::isZero() const
 {
-    return crawlAllPix([&](unsigned x, unsigned y) -> bool {
-            return (getPix(x, y)[0] == 0.0f && getPix(x, y)[1] == 0.0f && getPix(x, y)[2] == 0.0f);
+    const float* f = getFloatData();
+    return crawlAllPixRange([&](size_t start, size_t end) -> bool {
+            for (size_t i = start * 3; i < end * 3; ++i) {
+                if (f[i] != 0.0f) return false;
+            }
+            return true;
         });
 }
 
+//
+// add/sub/mul process the pixels as a flat float array in order to make the inner loop vectorizable.
+//
 void
 Fb::add(const Fb& v)
 {
-    crawlAllPix([&](unsigned x, unsigned y) -> bool { addPix(x, y, v.getPix(x, y)); return true; });
+    float* __restrict dst = getFloatData();
+    const float* __restrict src = v.getFloatData();
+    crawlAllPixRange([&](size_t start, size_t end) -> bool {
+            for (size_t i = start * 3; i < end * 3; ++i) dst[i] += src[i];
+            return true;
+        });
 }
 
 void
 Fb::sub(const Fb& v)
 {
-    crawlAllPix([&](unsigned x, unsigned y) -> bool { subPix(x, y, v.getPix(x, y)); return true; });
+    float* __restrict dst = getFloatData();
+    const float* __restrict src = v.getFloatData();
+    crawlAllPixRange([&](size_t start, size_t end) -> bool {
+            for (size_t i = start * 3; i < end * 3; ++i) dst[i] -= src[i];
+            return true;
+        });
 }
 
 void
 Fb::mul(const Fb& v)
 {
-    crawlAllPix([&](unsigned x, unsigned y) -> bool { mulPix(x, y, v.getPix(x, y)); return true; });
+    float* __restrict dst = getFloatData();
+    const float* __restrict src = v.getFloatData();
+    crawlAllPixRange([&](size_t start, size_t end) -> bool {
+            for (size_t i = start * 3; i < end * 3; ++i) dst[i] *= src[i];
+            return true;
+        });
 }
 
 void
 Fb::div(const Fb& v)
 {
-    crawlAllPix([&](unsigned x, unsigned y) -> bool { divPix(x, y, v.getPix(x, y)); return true; });
+    crawlAllPixRange([&](size_t start, size_t end) -> bool {
+            for (size_t offset = start; offset < end; ++offset) {
+                Pix& currPix = mFb[offset];
+                if (!isZeroPix(currPix)) currPix = currPix / v.mFb[offset];
+            }
+            return true;
+        });
 }
 
 // static function
@@ -104,45 +223,49 @@ Fb::merge(Fb& beautyOut, Fb& beautyNumSampleOut,
         return false;
     }
 
-    for (unsigned y = 0; y < srcBeauty.getHeight(); ++y) {
-        for (unsigned x = 0; x < srcBeauty.getWidth(); ++x) {
-            Fb::Pix& allC = beautyOut.getPix(x, y);
-            Fb::Pix& allN = beautyNumSampleOut.getPix(x, y);
-            const Fb::Pix& currC = srcBeauty.getPix(x, y);
-            const Fb::Pix& currN = srcBeautyNumSample.getPix(x, y);
-
-            float totalN = allN[0] + currN[0];
-            if (totalN > 0.0f) {
-                float scaleA = allN[0] / totalN;
-                float scaleB = currN[0] / totalN;
-
-                Fb::Pix newC;
-                newC = allC * scaleA + currC * scaleB;
-
-                allC = newC;
-                allN = {totalN, totalN, totalN};
-            } else {
-                allC = {0.0f, 0.0f, 0.0f};
-                allN = {0.0f, 0.0f, 0.0f};
+    beautyOut.crawlAllPixRange([&](size_t start, size_t end) -> bool {
+            for (size_t offset = start; offset < end; ++offset) {
+                Fb::Pix& allC = beautyOut.mFb[offset];
+                Fb::Pix& allN = beautyNumSampleOut.mFb[offset];
+                const Fb::Pix& currC = srcBeauty.mFb[offset];
+                const Fb::Pix& currN = srcBeautyNumSample.mFb[offset];
+
+                float totalN = allN[0] + currN[0];
+                if (totalN > 0.0f) {
+                    float scaleA = allN[0] / totalN;
+                    float scaleB = currN[0] / totalN;
+
+                    Fb::Pix newC;
+                    newC = allC * scaleA + currC * scaleB;
+
+                    allC = newC;
+                    allN = {totalN, totalN, totalN};
+                } else {
+                    allC = {0.0f, 0.0f, 0.0f};
+                    allN = {0.0f, 0.0f, 0.0f};
+                }
             }
-        }
-    }
+            return true;
+        });
     return true;
 }
 
 void
 Fb::abs()
 {
-    crawlAllPix([&](unsigned x, unsigned y) -> bool { absPix(x, y); return true; });
+    float* f = getFloatData();
+    crawlAllPixRange([&](size_t start, size_t end) -> bool {
+            for (size_t i = start * 3; i < end * 3; ++i) f[i] = std::fabs(f[i]);
+            return true;
+        });
 }
 
 void
 Fb::normalize()
 {
     Pix scale = 1.0f / getMaxPix();
-    crawlAllPix([&](unsigned x, unsigned y) -> bool {
-            Pix& currPix = getPix(x, y);
-            currPix = currPix * scale;
+    crawlAllPixRange([&](size_t start, size_t end) -> bool {
+            for (size_t offset = start; offset < end; ++offset) mFb[offset] = mFb[offset] * scale;
             return true;
         });
 }
@@ -325,6 +448,30 @@ bool Fb::crawlAllPix(PixFunc pixFunc) const
     return true;
 }
 
+template <typename RangeFunc>
+bool
+Fb::crawlAllPixRange(RangeFunc rangeFunc) const
+//
+// Parallel version of crawlAllPix(). rangeFunc(startPixOffset, endPixOffset) is executed concurrently
+// for the sub-ranges of the pixel offset. If rangeFunc returns false, all the remaining sub-ranges are
+// skipped and crawlAllPixRange() returns false.
+//
+{
+    std::atomic<bool> flag(true);
+    auto rangeMain = [&](const size_t start, const size_t end) {
+        if (!flag.load(std::memory_order_relaxed)) return;
+        if (!rangeFunc(start, end)) flag = false;
+    };
+
+#   ifdef SINGLE_THREAD
+    rangeMain(0, mFb.size());
+#   else // else SINGLE_THREAD
+    tbb::blocked_range<size_t> range(0, mFb.size(), sPixGrainSize);
+    tbb::parallel_for(range, [&](const tbb::blocked_range<size_t>& r) { rangeMain(r.begin(), r.end()); });
+#   endif // end !SINGLE_THREAD
+    return flag;
+}
+
 template <typename GetPixFunc, typename MsgOutFunc>
 bool
 Fb::savePPMMain(const std::string& msg,
@@ -499,27 +646,42 @@ Fb::loadFBDMain(const std::string& msg,
                 const std::string& filename,
                 SetPixFunc setPixFunc,
                 MsgOutFunc msgOutFunc)
+//
+// The file is memory mapped and parsed directly from the mapped memory.
+//
 {
     if (!msg.empty()) {
         if (!msgOutFunc("load " + msg + " filename:" + filename)) return false;
     }
 
-    std::ifstream ifs(filename);
-    if (!ifs) {
+    MappedFile file(filename);
+    if (!file.isValid()) {
         msgOutFunc("read open filed. filename:" + filename);
         return false;
     }
 
+    const char* curr = file.getData();
+    const char* const end = curr + file.getSize();
+    auto getLine = [&](std::string& line) -> bool {
+        const char* eol = static_cast<const char*>(std::memchr(curr, '\n', end - curr));
+        if (!eol) return false;
+        line.assign(curr, eol);
+        curr = eol + 1;
+        return true;
+    };
+
     std::string line;
     {
-        getline(ifs, line);
-        if (line != "FbDump") {
+        if (!getLine(line) || line != "FbDump") {
             msgOutFunc("not support format. " + line);
             return false;
         }
     }
     {
-        getline(ifs, line);
+        if (!getLine(line)) {
+            msgOutFunc("not support format. no resolution info. filename:" + filename);
+            return false;
+        }
         std::istringstream istr(line);
         unsigned width, height;
         istr >> width >> height;
@@ -531,36 +693,67 @@ Fb::loadFBDMain(const std::string& msg,
         resize(width, height);
     }
 
-    auto hexFloat2f = [](const std::string& hexFloat) -> float {
-        auto hex2uc = [](char hexA, char hexB) -> unsigned char {
-            char buff[3] = {hexA, hexB, 0x0};
-            // buff[0] = hexA; buff[1] = hexB; buff[2] = 0x0;
-            return static_cast<unsigned char>(std::strtol(buff, nullptr, 16));
+    if (!parseFBDBody(curr, static_cast<size_t>(end - curr), setPixFunc)) {
+        msgOutFunc("FBD data parse failed. filename:" + filename);
+        return false;
+    }
+
+    // if (!msgOutFunc("done")) return false; // useful debug message
+
+    return true;
+}
+
+template <typename SetPixFunc>
+bool
+Fb::parseFBDBody(const char* body, const size_t bodySize, SetPixFunc setPixFunc)
+//
+// If the body has the exact layout of saveFBDMain() output, each scanline is parsed in parallel.
+// Otherwise (i.e. edited by hand), whitespace separated tokens are parsed sequentially.
+// setPixFunc is called concurrently for different pixels in the parallel case.
+//
+{
+    const size_t rowByte = static_cast<size_t>(mWidth) * sFBDPixByte;
+    if (bodySize == rowByte * mHeight) {
+        std::atomic<bool> flag(true);
+        auto parseRows = [&](const unsigned startRow, const unsigned endRow) {
+            for (unsigned row = startRow; row < endRow; ++row) {
+                const char* pix = body + row * rowByte;
+                const int v = static_cast<int>(mHeight - 1 - row); // bottom scanline is saved first
+                for (int u = 0; u < static_cast<int>(mWidth); ++u, pix += sFBDPixByte) {
+                    float c[3];
+                    if (!hexFloat2f(pix, c[0]) || !hexFloat2f(pix + 9, c[1]) || !hexFloat2f(pix + 18, c[2])) {
+                        flag = false;
+                        return;
+                    }
+                    setPixFunc(u, v, c);
+                }
+            }
         };
-        union {
-            float f;
-            unsigned char uc[4];
-        } uni;
-        uni.uc[0] = hex2uc(hexFloat[0], hexFloat[1]);
-        uni.uc[1] = hex2uc(hexFloat[2], hexFloat[3]);
-        uni.uc[2] = hex2uc(hexFloat[4], hexFloat[5]);
-        uni.uc[3] = hex2uc(hexFloat[6], hexFloat[7]);
-        return uni.f;
-    };
 
+#       ifdef SINGLE_THREAD
+        parseRows(0, mHeight);
+#       else // else SINGLE_THREAD
+        tbb::blocked_range<unsigned> range(0, mHeight);
+        tbb::parallel_for(range, [&](const tbb::blocked_range<unsigned>& r) { parseRows(r.begin(), r.end()); });
+#       endif // end !SINGLE_THREAD
+        return flag;
+    }
+
+    const char* curr = body;
+    const char* const end = body + bodySize;
+    auto nextToken = [&](float& f) -> bool {
+        while (curr < end && std::isspace(static_cast<unsigned char>(*curr))) ++curr;
+        if (end - curr < 8 || !hexFloat2f(curr, f)) return false;
+        curr += 8;
+        return true;
+    };
     for (int v = static_cast<int>(mHeight) - 1; v >= 0; --v) {
         for (int u = 0; u < static_cast<int>(mWidth); ++u) {
-            std::string r, g, b;
-            ifs >> r >> g >> b;
-            float c[3] = {hexFloat2f(r), hexFloat2f(g), hexFloat2f(b)};
+            float c[3];
+            if (!nextToken(c[0]) || !nextToken(c[1]) || !nextToken(c[2])) return false;
             setPixFunc(u, v, c);
         }
     }
-
-    ifs.close();
-
-    // if (!msgOutFunc("done")) return false; // useful debug message
-
     return true;
 }
 
@@ -68,27 +68,16 @@ public:
 private:
 
     template <typename PixFunc> bool crawlAllPix(PixFunc pixFunc) const;
+    template <typename RangeFunc> bool crawlAllPixRange(RangeFunc rangeFunc) const;
+
+    float* getFloatData() { return reinterpret_cast<float*>(mFb.data()); }
+    const float* getFloatData() const { return reinterpret_cast<const float*>(mFb.data()); }
 
     unsigned pixOffset(unsigned x, unsigned y) const { return (y * mWidth + x); }
 
     bool isZeroPix(Pix& p) { return (p[0] == 0.0f && p[1] == 0.0f && p[2] == 0.0f); }
 
     void setPix(unsigned x, unsigned y, Pix col) { mFb[pixOffset(x, y)] = col; }
-    void addPix(unsigned x, unsigned y, Pix col) { mFb[pixOffset(x, y)] += col; }
-    void subPix(unsigned x, unsigned y, Pix col) { mFb[pixOffset(x, y)] -= col; }
-    void mulPix(unsigned x, unsigned y, Pix col) { mFb[pixOffset(x, y)] = mFb[pixOffset(x, y)] * col; }
-    void divPix(unsigned x, unsigned y, Pix col)
-    {
-        Pix& currPix = mFb[pixOffset(x, y)];
-        if (!isZeroPix(currPix)) currPix = currPix / col;
-    }
-    void absPix(unsigned x, unsigned y)
-    {
-        Pix& currPix = mFb[pixOffset(x, y)];
-        currPix[0] = static_cast<float>(std::abs(static_cast<float>(currPix[0])));
-        currPix[1] = static_cast<float>(std::abs(static_cast<float>(currPix[1])));
-        currPix[2] = static_cast<float>(std::abs(static_cast<float>(currPix[2])));
-    }
 
     template <typename GetPixFunc, typename MsgOutFunc>
     bool savePPMMain(const std::string& msg,
@@ -110,6 +99,8 @@ private:
                      const std::string& filename,
                      SetPixFunc setPixFunc,
                      MsgOutFunc msgOutFunc);
+    template <typename SetPixFunc>
+    bool parseFBDBody(const char* body, const size_t bodySize, SetPixFunc setPixFunc);
 
     uint8_t f2c255Gamma22(const float f) const;
     float c2552fReGamma22(const uint8_t uc) const;
@@ -9,10 +9,11 @@ namespace verifyFeedback {
 
 bool
 McrtMachine::readPPM(const std::string& filePath,
-                     const unsigned feedbackId, const unsigned machineId)
+                     const unsigned feedbackId, const unsigned machineId,
+                     const bool verbose)
 {
-    auto msgOut = [](const std::string& msg) -> bool {
-        std::cerr << msg << '\n';
+    auto msgOut = [&](const std::string& msg) -> bool {
+        if (verbose) std::cerr << msg << '\n';
         return true;
     };
 
@@ -32,10 +33,11 @@ McrtMachine::readPPM(const std::string& filePath,
 
 bool
 McrtMachine::readFBD(const std::string& filePath,
-                     const unsigned feedbackId, const unsigned machineId)
+                     const unsigned feedbackId, const unsigned machineId,
+                     const bool verbose)
 {
-    auto msgOut = [](const std::string& msg) -> bool {
-        std::cerr << msg << '\n';
+    auto msgOut = [&](const std::string& msg) -> bool {
+        if (verbose) std::cerr << msg << '\n';
         return true;
     };
 
@@ -134,12 +136,13 @@ McrtMachine::makeFilename(const std::string& filePath, bool isPpm)
 
 bool
 Mcrt::readPPM(const std::string& filePath, // ended by '/'
-              const unsigned feedbackId)
+              const unsigned feedbackId,
+              const bool verbose)
 {
     mFeedbackId = feedbackId;
 
     for (unsigned machineId = 0; machineId < mMachineTbl.size(); ++machineId) {
-        if (!mMachineTbl[machineId].readPPM(filePath, mFeedbackId, machineId)) {
+        if (!mMachineTbl[machineId].readPPM(filePath, mFeedbackId, machineId, verbose)) {
             return false;
         }
     }
@@ -148,12 +151,13 @@ Mcrt::readPPM(const std::string& filePath, // ended by '/'
 
 bool
 Mcrt::readFBD(const std::string& filePath, // ended by '/'
-              const unsigned feedbackId)
+              const unsigned feedbackId,
+              const bool verbose)
 {
     mFeedbackId = feedbackId;
 
     for (unsigned machineId = 0; machineId < mMachineTbl.size(); ++machineId) {
-        if (!mMachineTbl[machineId].readFBD(filePath, mFeedbackId, machineId)) {
+        if (!mMachineTbl[machineId].readFBD(filePath, mFeedbackId, machineId, verbose)) {
             return false;
         }
     }
@@ -13,9 +13,11 @@ public:
     McrtMachine() = default;
 
     bool readPPM(const std::string& filePath, // ended by '/'
-                 const unsigned feedbackId, const unsigned machineId);
+                 const unsigned feedbackId, const unsigned machineId,
+                 const bool verbose = true);
     bool readFBD(const std::string& filePath, // ended by '/'
-                 const unsigned feedbackId, const unsigned machineId);
+                 const unsigned feedbackId, const unsigned machineId,
+                 const bool verbose = true);
 
     unsigned getWidth() const { return mFeedbackBeauty.getWidth(); }
     unsigned getHeight() const { return mFeedbackBeauty.getHeight(); }
@@ -68,9 +70,11 @@ public:
     {}
 
     bool readPPM(const std::string& filePath, // ended by '/'
-                 const unsigned feedbackId);
+                 const unsigned feedbackId,
+                 const bool verbose = true);
     bool readFBD(const std::string& filePath, // ended by '/'
-                 const unsigned feedbackId);
+                 const unsigned feedbackId,
+                 const bool verbose = true);
 
     unsigned getWidth() const;
     unsigned getHeight() const;
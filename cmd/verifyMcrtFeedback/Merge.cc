@@ -9,10 +9,11 @@ namespace verifyFeedback {
 
 bool
 MergeMachine::readPPM(const std::string& filePath, // ended by '/'
-                      const unsigned feedbackId, const unsigned machineId)
+                      const unsigned feedbackId, const unsigned machineId,
+                      const bool verbose)
 {
-    auto msgOut = [](const std::string& msg) -> bool {
-        std::cerr << msg << '\n';
+    auto msgOut = [&](const std::string& msg) -> bool {
+        if (verbose) std::cerr << msg << '\n';
         return true;
     };
 
@@ -26,10 +27,11 @@ MergeMachine::readPPM(const std::string& filePath, // ended by '/'
 
 bool
 MergeMachine::readFBD(const std::string& filePath, // ended by '/'
-                      const unsigned feedbackId, const unsigned machineId)
+                      const unsigned feedbackId, const unsigned machineId,
+                      const bool verbose)
 {
-    auto msgOut = [](const std::string& msg) -> bool {
-        std::cerr << msg << '\n';
+    auto msgOut = [&](const std::string& msg) -> bool {
+        if (verbose) std::cerr << msg << '\n';
         return true;
     };
 
@@ -81,12 +83,13 @@ MergeMachine::makeFilename(const std::string& filePath, // ended by '/'
 
 bool
 Merge::readPPM(const std::string& filePath, // ended by '/'
-               const unsigned feedbackId)
+               const unsigned feedbackId,
+               const bool verbose)
 {
     mFeedbackId = feedbackId;
 
-    auto msgOut = [](const std::string& msg) -> bool {
-        std::cerr << msg << '\n';
+    auto msgOut = [&](const std::string& msg) -> bool {
+        if (verbose) std::cerr << msg << '\n';
         return true;
     };
 
@@ -97,7 +100,7 @@ Merge::readPPM(const std::string& filePath, // ended by '/'
     }
 
     for (unsigned machineId = 0; machineId < mMachineTbl.size(); ++machineId) {
-        if (!mMachineTbl[machineId].readPPM(filePath, mFeedbackId, machineId)) {
+        if (!mMachineTbl[machineId].readPPM(filePath, mFeedbackId, machineId, verbose)) {
             return false;
         }
     }
@@ -106,12 +109,13 @@ Merge::readPPM(const std::string& filePath, // ended by '/'
 
 bool
 Merge::readFBD(const std::string& filePath, // ended by '/'
-               const unsigned feedbackId)
+               const unsigned feedbackId,
+               const bool verbose)
 {
     mFeedbackId = feedbackId;
 
-    auto msgOut = [](const std::string& msg) -> bool {
-        std::cerr << msg << '\n';
+    auto msgOut = [&](const std::string& msg) -> bool {
+        if (verbose) std::cerr << msg << '\n';
         return true;
     };
 
@@ -122,7 +126,7 @@ Merge::readFBD(const std::string& filePath, // ended by '/'
     }
 
     for (unsigned machineId = 0; machineId < mMachineTbl.size(); ++machineId) {
-        if (!mMachineTbl[machineId].readFBD(filePath, mFeedbackId, machineId)) {
+        if (!mMachineTbl[machineId].readFBD(filePath, mFeedbackId, machineId, verbose)) {
             return false;
         }
     }
@@ -16,9 +16,11 @@ public:
     {}
 
     bool readPPM(const std::string& filePath, // ended by '/'
-                 const unsigned feedbackId, const unsigned machineId);
+                 const unsigned feedbackId, const unsigned machineId,
+                 const bool verbose = true);
     bool readFBD(const std::string& filePath, // ended by '/'
-                 const unsigned feedbackId, const unsigned machineId);
+                 const unsigned feedbackId, const unsigned machineId,
+                 const bool verbose = true);
 
     const Fb& getBeauty() const { return mBeauty; }
     const Fb& getBeautyNumSample() const { return mBeautyNumSample; }
@@ -48,9 +50,11 @@ public:
     {}
 
     bool readPPM(const std::string& filePath, // ended by '/'
-                 const unsigned feedbackId);
+                 const unsigned feedbackId,
+                 const bool verbose = true);
     bool readFBD(const std::string& filePath, // ended by '/'
-                 const unsigned feedbackId);
+                 const unsigned feedbackId,
+                 const bool verbose = true);
 
     const Fb& getMergeAllBeauty() const { return mMergeAllBeauty; }
     const Fb& getMergeAllBeautyNumSample() const { return mMergeAllBeautyNumSample; }
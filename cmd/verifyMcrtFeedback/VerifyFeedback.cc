@@ -3,8 +3,16 @@
 
 #include "VerifyFeedback.h"
 
+#include <scene_rdl2/common/rec_time/RecTime.h>
 #include <scene_rdl2/render/util/StrUtil.h>
 
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_pipeline.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
 namespace verifyFeedback {
 
 bool
@@ -66,62 +74,65 @@ VerifyFeedback::verify() const
     if (!mMerge || !mMcrt) return false;
 
     bool flag = true;
-    if (!verifyMergeAllWithMcrtFeedback()) flag = false;
-    if (!verifyMergeWithMcrtDecoded()) flag = false;
-    if (!verifyReconstructMergeWithFeedback()) flag = false;
-    if (!verifyMinusOne()) flag = false;
+    if (!verifyMergeAllWithMcrtFeedback(*mMerge, *mMcrt, true)) flag = false;
+    if (!verifyMergeWithMcrtDecoded(*mMerge, *mMcrt, true)) flag = false;
+    if (!verifyReconstructMergeWithFeedback(*mMcrt, true)) flag = false;
+    if (!verifyMinusOne(*mMcrt, true)) flag = false;
 
     return flag;
 }
 
+// static function
 bool
-VerifyFeedback::verifyMergeAllWithMcrtFeedback() const
+VerifyFeedback::verifyMergeAllWithMcrtFeedback(const Merge& merge, const Mcrt& mcrt, const bool verbose)
 {
-    std::cerr << "Verify MergeAll with MCRT feedback start ...";
+    if (verbose) std::cerr << "Verify MergeAll with MCRT feedback start ...";
 
-    if (!mMcrt->crawlAllMachine([&](const McrtMachine& mcrt) -> bool {
-                return mcrt.isSameFeedback(mMerge->getMergeAllBeauty(), mMerge->getMergeAllBeautyNumSample());
+    if (!mcrt.crawlAllMachine([&](const McrtMachine& mcrtMachine) -> bool {
+                return mcrtMachine.isSameFeedback(merge.getMergeAllBeauty(), merge.getMergeAllBeautyNumSample());
             })) {
-        std::cerr << "Verify MergeAll with MCRT feedback failed.\n";
+        if (verbose) std::cerr << "Verify MergeAll with MCRT feedback failed.\n";
         return false;
     }
 
-    std::cerr << " OK!\n";
+    if (verbose) std::cerr << " OK!\n";
     return true;
 }
 
+// static function
 bool
-VerifyFeedback::verifyMergeWithMcrtDecoded() const
+VerifyFeedback::verifyMergeWithMcrtDecoded(const Merge& merge, const Mcrt& mcrt, const bool verbose)
 {
-    std::cerr << "Verify Merge with McrtDecoded start ...";
+    if (verbose) std::cerr << "Verify Merge with McrtDecoded start ...";
 
-    if (!mMcrt->crawlAllMachine([&](const McrtMachine& mcrt) -> bool {
-                return mcrt.isSameDecoded(mMerge->getMachine(mcrt.getMachineId()).getBeauty(),
-                                          mMerge->getMachine(mcrt.getMachineId()).getBeautyNumSample());
+    if (!mcrt.crawlAllMachine([&](const McrtMachine& mcrtMachine) -> bool {
+                const MergeMachine& mergeMachine = merge.getMachine(mcrtMachine.getMachineId());
+                return mcrtMachine.isSameDecoded(mergeMachine.getBeauty(), mergeMachine.getBeautyNumSample());
             })) {
-        std::cerr << "Verify Merge with McrtDecoded failed.\n";
+        if (verbose) std::cerr << "Verify Merge with McrtDecoded failed.\n";
         return false;
     }
 
-    std::cerr << " OK!\n";
+    if (verbose) std::cerr << " OK!\n";
     return true;
 }
 
+// static function
 bool
-VerifyFeedback::verifyReconstructMergeWithFeedback() const    
+VerifyFeedback::verifyReconstructMergeWithFeedback(const Mcrt& mcrt, const bool verbose)
 {
-    std::cerr << "Verify reconstruct merge data with feedback start ...";
+    if (verbose) std::cerr << "Verify reconstruct merge data with feedback start ...";
 
     Fb mergeBeauty, mergeBeautyNumSample;
-    if (!mMcrt->combineMergedAll(mergeBeauty, mergeBeautyNumSample)) {
-        std::cerr << "combine merged all action failed.\n";
+    if (!mcrt.combineMergedAll(mergeBeauty, mergeBeautyNumSample)) {
+        if (verbose) std::cerr << "combine merged all action failed.\n";
         return false;
     }
 
-    if (!mMcrt->crawlAllMachine([&](const McrtMachine& mcrt) -> bool {
-                return mcrt.isSameFeedback(mergeBeauty, mergeBeautyNumSample);
+    if (!mcrt.crawlAllMachine([&](const McrtMachine& mcrtMachine) -> bool {
+                return mcrtMachine.isSameFeedback(mergeBeauty, mergeBeautyNumSample);
             })) {
-        std::cerr << "Verify reconstruct merge data with feedback failed\n";
+        if (verbose) std::cerr << "Verify reconstruct merge data with feedback failed\n";
         return false;
     }
 
@@ -155,14 +166,15 @@ VerifyFeedback::verifyReconstructMergeWithFeedback() const
                                                  });
     */
 
-    std::cerr << " OK!\n";
+    if (verbose) std::cerr << " OK!\n";
     return true;
 }
 
+// static function
 bool
-VerifyFeedback::verifyMinusOne() const
+VerifyFeedback::verifyMinusOne(const Mcrt& mcrt, const bool verbose)
 {
-    std::cerr << "Verify minusOne data start ...";
+    if (verbose) std::cerr << "Verify minusOne data start ...";
 
     auto minusOneGen = [&](const unsigned omitMachineId,
                            Fb& minusOneBeauty, Fb& minusOneBeautyNumSample) -> bool {
@@ -170,11 +182,11 @@ VerifyFeedback::verifyMinusOne() const
         minusOneBeautyNumSample.clear();
 
         bool flag = true;
-        mMcrt->crawlAllMachine([&](const McrtMachine& mcrt) -> bool {
-                if (mcrt.getMachineId() != omitMachineId) {
+        mcrt.crawlAllMachine([&](const McrtMachine& mcrtMachine) -> bool {
+                if (mcrtMachine.getMachineId() != omitMachineId) {
                     if (!Fb::merge(minusOneBeauty, minusOneBeautyNumSample,
-                                   mcrt.getMergedBeauty(), mcrt.getMergedBeautyNumSample())) {
-                        std::cerr << "minusOneGen failed\n";
+                                   mcrtMachine.getMergedBeauty(), mcrtMachine.getMergedBeautyNumSample())) {
+                        if (verbose) std::cerr << "minusOneGen failed\n";
                         flag = false;
                         return false;
                     }
@@ -185,11 +197,13 @@ VerifyFeedback::verifyMinusOne() const
     };
 
     bool flag = true;
-    if (!mMcrt->crawlAllMachine([&](const McrtMachine& mcrt) -> bool {
-                Fb minusOneBeauty(mMcrt->getWidth(), mMcrt->getHeight());
-                Fb minusOneBeautyNumSample(mMcrt->getWidth(), mMcrt->getHeight());
-                if (!minusOneGen(mcrt.getMachineId(), minusOneBeauty, minusOneBeautyNumSample)) {
-                    std::cerr << "verifyMinusOne failed. machineId:" << mcrt.getMachineId() << '\n';
+    if (!mcrt.crawlAllMachine([&](const McrtMachine& mcrtMachine) -> bool {
+                Fb minusOneBeauty(mcrt.getWidth(), mcrt.getHeight());
+                Fb minusOneBeautyNumSample(mcrt.getWidth(), mcrt.getHeight());
+                if (!minusOneGen(mcrtMachine.getMachineId(), minusOneBeauty, minusOneBeautyNumSample)) {
+                    if (verbose) {
+                        std::cerr << "verifyMinusOne failed. machineId:" << mcrtMachine.getMachineId() << '\n';
+                    }
                     flag = false;
                     return false;
                 }
@@ -197,7 +211,7 @@ VerifyFeedback::verifyMinusOne() const
                 /* useful debug code
                 {
                     std::ostringstream ostr;
-                    ostr << "/usr/home/tkato/ppm/minusOneVerify_mId" << mcrt.getMachineId() << ".ppm";
+                    ostr << "/usr/home/tkato/ppm/minusOneVerify_mId" << mcrtMachine.getMachineId() << ".ppm";
                     minusOneBeauty.writeBeautyPPM(ostr.str(),
                                                   [&](const std::string& msg) -> bool {
                                                       std::cerr << msg << '\n';
@@ -206,8 +220,8 @@ VerifyFeedback::verifyMinusOne() const
                 }
                 {
                     std::ostringstream ostr;
-                    ostr << "/usr/home/tkato/ppm/minusOneVerify_mId" << mcrt.getMachineId() << "_diff.ppm";
-                    Fb diff = minusOneBeauty - mcrt.getMinusOneBeauty();
+                    ostr << "/usr/home/tkato/ppm/minusOneVerify_mId" << mcrtMachine.getMachineId() << "_diff.ppm";
+                    Fb diff = minusOneBeauty - mcrtMachine.getMinusOneBeauty();
                     diff.abs();
                     diff.normalize();
                     diff.writeBeautyPPM(ostr.str(),
@@ -218,9 +232,12 @@ VerifyFeedback::verifyMinusOne() const
                 }
                 */
 
-                if (minusOneBeauty != mcrt.getMinusOneBeauty() ||
-                    minusOneBeautyNumSample != mcrt.getMinusOneBeautyNumSample()) {
-                    std::cerr << "verifyMinusOne failed. result mismatch. machineId:" << mcrt.getMachineId() << '\n';
+                if (minusOneBeauty != mcrtMachine.getMinusOneBeauty() ||
+                    minusOneBeautyNumSample != mcrtMachine.getMinusOneBeautyNumSample()) {
+                    if (verbose) {
+                        std::cerr << "verifyMinusOne failed. result mismatch. machineId:"
+                                  << mcrtMachine.getMachineId() << '\n';
+                    }
                     flag = false;
                     return false;
                 }
@@ -228,10 +245,136 @@ VerifyFeedback::verifyMinusOne() const
             })) {
     }
 
-    if (flag) std::cerr << " OK!\n";
+    if (flag && verbose) std::cerr << " OK!\n";
     return flag;
 }
 
+bool
+VerifyFeedback::batch(const unsigned startFeedbackId, const unsigned endFeedbackId, const bool isPpm)
+{
+    if (!mNumMachines) {
+        std::cerr << "ERROR: batch requires -init <numMachine>\n";
+        return false;
+    }
+    if (startFeedbackId > endFeedbackId) {
+        std::cerr << "ERROR: batch wrong feedbackId range\n";
+        return false;
+    }
+
+    std::vector<BatchResult> resultTbl(endFeedbackId - startFeedbackId + 1);
+    for (size_t i = 0; i < resultTbl.size(); ++i) {
+        resultTbl[i].mFeedbackId = startFeedbackId + static_cast<unsigned>(i);
+    }
+
+    scene_rdl2::rec_time::RecTime recTime;
+    recTime.start();
+
+#   ifdef SINGLE_THREAD
+    for (auto& result : resultTbl) batchSingle(isPpm, result);
+#   else // else SINGLE_THREAD
+    // The pipeline tokens limit the number of in-flight feedbackIds in order to control the memory usage.
+    // The pipeline runs in the caller's (default) arena, so the Fb arithmetic inside each feedbackId still
+    // uses all the threads.
+    size_t nextId = 0;
+    auto inputFilter = [&](tbb::flow_control& fc) -> BatchResult* {
+        if (nextId >= resultTbl.size()) {
+            fc.stop();
+            return nullptr;
+        }
+        return &resultTbl[nextId++];
+    };
+    auto verifyFilter = [&](BatchResult* result) { batchSingle(isPpm, *result); };
+    tbb::parallel_pipeline(std::max(static_cast<size_t>(mBatchConcurrency), static_cast<size_t>(1)),
+                           tbb::make_filter<void, BatchResult*>(tbb::filter_mode::serial_in_order, inputFilter) &
+                           tbb::make_filter<BatchResult*, void>(tbb::filter_mode::parallel, verifyFilter));
+#   endif // end !SINGLE_THREAD
+
+    const std::string summary = showBatchSummary(resultTbl, recTime.end());
+    if (mBatchOutFilename.empty()) {
+        std::cout << summary << '\n';
+    } else {
+        std::ofstream ofs(mBatchOutFilename);
+        if (!ofs) {
+            std::cerr << "ERROR: batch summary file open failed. filename:" << mBatchOutFilename << '\n';
+            return false;
+        }
+        ofs << summary << '\n';
+    }
+
+    return std::all_of(resultTbl.begin(), resultTbl.end(), [](const BatchResult& result) { return result.isPass(); });
+}
+
+void
+VerifyFeedback::batchSingle(const bool isPpm, BatchResult& result) const
+{
+    scene_rdl2::rec_time::RecTime recTime;
+    recTime.start();
+
+    Merge merge(mNumMachines);
+    Mcrt mcrt(mNumMachines);
+    if (isPpm) {
+        result.mRead = (merge.readPPM(mFilePath, result.mFeedbackId, false) &&
+                        mcrt.readPPM(mFilePath, result.mFeedbackId, false));
+    } else {
+        result.mRead = (merge.readFBD(mFilePath, result.mFeedbackId, false) &&
+                        mcrt.readFBD(mFilePath, result.mFeedbackId, false));
+    }
+    if (result.mRead) {
+        result.mMergeAll = verifyMergeAllWithMcrtFeedback(merge, mcrt, false);
+        result.mDecoded = verifyMergeWithMcrtDecoded(merge, mcrt, false);
+        result.mReconstruct = verifyReconstructMergeWithFeedback(mcrt, false);
+        result.mMinusOne = verifyMinusOne(mcrt, false);
+    }
+
+    result.mSec = recTime.end();
+}
+
+std::string
+VerifyFeedback::showBatchSummary(const std::vector<BatchResult>& resultTbl, const float sec) const
+{
+    auto okStr = [](const bool flag) { return (flag) ? "OK" : "NG"; };
+
+    size_t passTotal = 0;
+    size_t readErrorTotal = 0;
+
+    std::ostringstream ostr;
+    ostr << "VerifyFeedback batch summary {\n"
+         << "  mFilePath:" << mFilePath << '\n'
+         << "  mNumMachines:" << mNumMachines << '\n'
+         << "  mBatchConcurrency:" << mBatchConcurrency << '\n'
+         << "  " << std::setw(10) << "feedbackId"
+         << std::setw(6) << "read"
+         << std::setw(10) << "mergeAll"
+         << std::setw(9) << "decoded"
+         << std::setw(13) << "reconstruct"
+         << std::setw(10) << "minusOne"
+         << std::setw(8) << "result"
+         << std::setw(10) << "sec" << '\n';
+    for (const auto& result : resultTbl) {
+        ostr << "  " << std::setw(10) << result.mFeedbackId
+             << std::setw(6) << okStr(result.mRead);
+        if (result.mRead) {
+            ostr << std::setw(10) << okStr(result.mMergeAll)
+                 << std::setw(9) << okStr(result.mDecoded)
+                 << std::setw(13) << okStr(result.mReconstruct)
+                 << std::setw(10) << okStr(result.mMinusOne);
+        } else {
+            ostr << std::setw(10) << '-' << std::setw(9) << '-' << std::setw(13) << '-' << std::setw(10) << '-';
+            readErrorTotal++;
+        }
+        ostr << std::setw(8) << ((result.isPass()) ? "PASS" : "FAIL")
+             << std::setw(10) << std::fixed << std::setprecision(3) << result.mSec << '\n';
+        if (result.isPass()) passTotal++;
+    }
+    ostr << "  total:" << resultTbl.size()
+         << " pass:" << passTotal
+         << " fail:" << (resultTbl.size() - passTotal)
+         << " (readError:" << readErrorTotal << ")"
+         << " elapsed:" << std::fixed << std::setprecision(3) << sec << " sec\n"
+         << "}";
+    return ostr.str();
+}
+
 std::string
 VerifyFeedback::show() const
 {
@@ -271,6 +414,22 @@ VerifyFeedback::parserConfigure()
                 [&](Arg& arg) -> bool { return arg.msg(show() + '\n'); });
     mParser.opt("-verify", "", "run verify",
                 [&](Arg& arg) -> bool { return verify(); });
+    mParser.opt("-batchConcurrency", "<n>", "set max concurrently verified feedbackIds of batch mode",
+                [&](Arg& arg) -> bool { mBatchConcurrency = (arg++).as<unsigned>(0); return true; });
+    mParser.opt("-batchOut", "<filename>", "set batch summary table output filename. empty:stdout",
+                [&](Arg& arg) -> bool { mBatchOutFilename = (arg++)(); return true; });
+    mParser.opt("-batch", "<startFeedbackId> <endFeedbackId> <ppm|fbd>",
+                "read and verify all feedbackIds in the range and output the summary table",
+                [&](Arg& arg) -> bool {
+                    const unsigned startFeedbackId = (arg++).as<unsigned>(0);
+                    const unsigned endFeedbackId = (arg++).as<unsigned>(0);
+                    const std::string format = (arg++)();
+                    if (format != "ppm" && format != "fbd") {
+                        std::cerr << "ERROR: batch unknown format:" << format << " (ppm or fbd)\n";
+                        return false;
+                    }
+                    return batch(startFeedbackId, endFeedbackId, format == "ppm");
+                });
 }
 
 } // namespace verifyFeedback
@@ -10,6 +10,7 @@
 #include "Merge.h"
 
 #include <memory> // unique_ptr
+#include <vector>
 
 namespace verifyFeedback {
 
@@ -38,10 +39,32 @@ private:
     bool readFBD(const unsigned feedbackId);    
 
     bool verify() const;
-    bool verifyMergeAllWithMcrtFeedback() const;
-    bool verifyMergeWithMcrtDecoded() const;
-    bool verifyReconstructMergeWithFeedback() const;
-    bool verifyMinusOne() const;
+    static bool verifyMergeAllWithMcrtFeedback(const Merge& merge, const Mcrt& mcrt, const bool verbose);
+    static bool verifyMergeWithMcrtDecoded(const Merge& merge, const Mcrt& mcrt, const bool verbose);
+    static bool verifyReconstructMergeWithFeedback(const Mcrt& mcrt, const bool verbose);
+    static bool verifyMinusOne(const Mcrt& mcrt, const bool verbose);
+
+    //
+    // Batch mode verifies all the feedbackIds between startFeedbackId and endFeedbackId. Each feedbackId
+    // has its own Merge and Mcrt data and up to mBatchConcurrency feedbackIds are in flight at the same time
+    // (tokens of tbb::parallel_pipeline). The verification of each feedbackId runs in parallel on all threads.
+    // The result is output as a summary table (to mBatchOutFilename if it is set).
+    //
+    struct BatchResult {
+        unsigned mFeedbackId {0};
+        bool mRead {false};
+        bool mMergeAll {false};
+        bool mDecoded {false};
+        bool mReconstruct {false};
+        bool mMinusOne {false};
+        float mSec {0.0f};
+
+        bool isPass() const { return mRead && mMergeAll && mDecoded && mReconstruct && mMinusOne; }
+    };
+
+    bool batch(const unsigned startFeedbackId, const unsigned endFeedbackId, const bool isPpm);
+    void batchSingle(const bool isPpm, BatchResult& result) const;
+    std::string showBatchSummary(const std::vector<BatchResult>& resultTbl, const float sec) const;
 
     std::string show() const;
 
@@ -55,6 +78,9 @@ private:
     std::unique_ptr<Merge> mMerge;
     std::unique_ptr<Mcrt> mMcrt;
 
+    unsigned mBatchConcurrency {4}; // max in-flight feedbackIds. each keeps (10 x numMachines + 2) images
+    std::string mBatchOutFilename;  // empty : stdout
+
     Parser mParser;
 };
 
@@ -25,6 +25,7 @@ static constexpr char CMD_CLOCKOFFSET[] = "clockOffset <hostName> <offsetMs>";
 static constexpr char CMD_COMPLETED[] = "completed <syncId>";
 static constexpr char CMD_GLOBALPROGRESS[] = "globalProgress <syncId> <fraction>";
 static constexpr char CMD_FORCE_RENDERSTART[] = "forceRenderStart";
+static constexpr char CMD_SENDRATEHINT[] = "sendRateHint <syncId> <intervalMs>";
 
 using TokenArray = std::vector<std::string>;
 using callBackEvalCmd = std::function<void(const TokenArray &tokenArray)>;
@@ -54,7 +55,8 @@ isCmd(const std::string& cmdLine,
       const callBackEvalCmd& callBack_clockOffset = nullptr,
       const callBackEvalCmd& callBack_completed = nullptr,
       const callBackEvalCmd& callBack_globalProgress = nullptr,
-      const callBackEvalCmd& callBack_forceRenderStart = nullptr)
+      const callBackEvalCmd& callBack_forceRenderStart = nullptr,
+      const callBackEvalCmd& callBack_sendRateHint = nullptr)
 {
     auto convCmdLineToTokenArray = [&]() -> std::vector<std::string> {
         std::vector<std::string> tokenArray;
@@ -100,6 +102,10 @@ isCmd(const std::string& cmdLine,
         if (callBack_forceRenderStart) {
             callBack_forceRenderStart(tokenArray);
         }
+    } else if (isMcrtControlCommand(CMD_SENDRATEHINT, tokenArray)) {
+        if (callBack_sendRateHint) {
+            callBack_sendRateHint(tokenArray);
+        }
     } else {
         return false;
     }
@@ -171,6 +177,18 @@ McrtControl::msgGen_forceRenderStart()
     return ostr.str();
 }
 
+// static function
+std::string
+McrtControl::msgGen_sendRateHint(const uint32_t syncId,
+                                 const float intervalMs)
+{
+    std::ostringstream ostr;
+    ostr << MCRT_CONTROL_COMMAND << ' ' << getCmdName(CMD_SENDRATEHINT)
+         << ' ' << syncId
+         << ' ' << intervalMs;
+    return ostr.str();
+}
+
 // static function
 bool
 McrtControl::isCommand(const std::string& cmdLine)
@@ -182,7 +200,8 @@ bool
 McrtControl::run(const std::string& cmdLine,
                  const std::function<bool(uint32_t syncId)>& callBackRenderStopProcedure,
                  const std::function<void(uint32_t syncId, float fraction)>& callBackGlobalProgressUpdate,
-                 const std::function<void()>& callBackForceRenderStart)
+                 const std::function<void()>& callBackForceRenderStart,
+                 const std::function<void(uint32_t syncId, float intervalMs)>& callBackSendRateHint)
 {
     bool returnFlag = true;
     isCmd(cmdLine,
@@ -241,6 +260,18 @@ McrtControl::run(const std::string& cmdLine,
               std::cerr << ">> McrtControl.cc ===>>> run forceRenderStart <<<===\n";
 #             endif // end DEBUG_MESSAGE              
               callBackForceRenderStart();
+          },
+
+          [&](const std::vector<std::string>& tokenArray) {
+              // MCRT-control sendRateHint <syncId> <intervalMs>
+              uint32_t syncId = static_cast<uint32_t>(std::stoul(tokenArray[2]));
+              float intervalMs = std::stof(tokenArray[3]);
+#             ifdef DEBUG_MESSAGE
+              std::cerr << ">> McrtControl.cc ===>>> run sendRateHint <<<==="
+                        << " syncId:" << syncId
+                        << " intervalMs:" << intervalMs << '\n';
+#             endif // end DEBUG_MESSAGE
+              if (callBackSendRateHint) callBackSendRateHint(syncId, intervalMs);
           }
           );
     return returnFlag;
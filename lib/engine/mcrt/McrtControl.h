@@ -73,6 +73,19 @@ public:
     /// This API is used to create a message string for "ForceRenderStart" McrtControl-command.
     static std::string msgGen_forceRenderStart();
 
+    /// @brief Create "SendRateHint" command string for McrtControl-command
+    /// @param syncId Intended syncId value condition to execute command
+    /// @param intervalMs Requested minimum interval of the snapshot/send by millisec. 0 releases the hint
+    /// @return Return message string that is used for "SendRateHint" McrtControl-command.
+    ///
+    /// @detail
+    /// This API is used to create a message string for "SendRateHint" McrtControl-command.
+    /// The merge computation sends this command when it can not keep up with the incoming messages
+    /// (see MergeSendRateController). An older McrtControl which does not know this command returns
+    /// false from isCommand() and run(), and the MCRT computation keeps its own send cadence.
+    static std::string msgGen_sendRateHint(const uint32_t syncId,
+                                           const float intervalMs);
+
     //------------------------------
 
     /// @brief Check given msgStr is McrtControl command line or not.
@@ -96,11 +109,13 @@ public:
     /// @param callBackRenderCompleteProcedure call-back function if command is "RenderCompleted".
     /// @param callBackGlobalProgressUpdate call-back function if command is "GlobalProgress".
     /// @param callBackForceRenderStart call-back function if command is "ForceRenderStart".
+    /// @param callBackSendRateHint call-back function if command is "SendRateHint". Might be nullptr.
     /// @Return Return callBack result status or false is it's not a McrtCommand or error happened.
     ///
     /// @detail
-    /// So far we only have 3 McrtControl commands. This is why we only have 3 call-back arguments.
-    /// We will have more than 3 call-back function definitions when we add more McrtCommands in the future.
+    /// So far we only have 4 McrtControl commands which need call-back functions. This is why we only
+    /// have 4 call-back arguments. We will have more call-back function definitions when we add more
+    /// McrtCommands in the future.
     /// If given msgStr is not McrtControl command or command format is wrong, this API returns false.
     /// Otherwise, this API executes the callback and returns its result.
     ///
@@ -129,10 +144,17 @@ public:
     /// downstream. After that, the suspending received queue is resumed processing.
     /// This is the only solution if you don't want to process all the received messages at once.
     ///
+    /// CallBackSendRateHint for "SendRateHint" MCRT-control message is the backpressure from the merge
+    /// computation. The 2nd argument is the requested minimum snapshot/send interval by millisec and
+    /// the MCRT computation should not send messages more frequently than this interval for the syncId.
+    /// The interval 0 means the hint is released and the MCRT computation goes back to its own cadence.
+    /// This command is simply ignored if callBackSendRateHint is nullptr.
+    ///
     bool run(const std::string& cmdLine,
              const std::function<bool(uint32_t /*syncId*/)>& callBackRenderCompleteProcedure,
              const std::function<void(uint32_t /*syncId*/, float /*fraction*/)>& callBackGlobalProgressUpdate,
-             const std::function<void()>& callBackForceRenderStart);
+             const std::function<void()>& callBackForceRenderStart,
+             const std::function<void(uint32_t /*syncId*/, float /*intervalMs*/)>& callBackSendRateHint = nullptr);
 
 protected:    
     int mMachineId;
@@ -0,0 +1,63 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "FbMsgChanArena.h"
+
+#include <sstream>
+
+namespace mcrt_dataio {
+
+FbMsgChanArena::FbMsgSingleChanShPtr
+FbMsgChanArena::acquire(const FbMsgSingleChan::DataType dataType)
+{
+    FbMsgSingleChanShPtr chan;
+    if (!mFreeChans.empty()) {
+        chan = std::move(mFreeChans.back());
+        mFreeChans.pop_back();
+        chan->reuse(dataType);
+        mReuseTotal++;
+    } else {
+        chan = std::make_shared<FbMsgSingleChan>(dataType);
+        mAllocTotal++;
+    }
+
+    mAcquireTotal++;
+    mLiveTotal++;
+    if (mHighWaterMark < mLiveTotal) mHighWaterMark = mLiveTotal;
+    return chan;
+}
+
+void
+FbMsgChanArena::release(const FbMsgSingleChanShPtr& chan)
+{
+    if (!chan) return;
+
+    chan->reset(); // release data but keep the capacity
+    mFreeChans.push_back(chan);
+    if (mLiveTotal > 0) mLiveTotal--;
+}
+
+size_t
+FbMsgChanArena::getFreeSlotsCapacity() const
+{
+    size_t total = 0;
+    for (const auto& chan : mFreeChans) total += chan->getCapacity();
+    return total;
+}
+
+std::string
+FbMsgChanArena::show() const
+{
+    std::ostringstream ostr;
+    ostr << "FbMsgChanArena {\n"
+         << "  mLiveTotal:" << mLiveTotal << '\n'
+         << "  mFreeChans:" << mFreeChans.size() << " (slotsCapacity:" << getFreeSlotsCapacity() << ")\n"
+         << "  mHighWaterMark:" << mHighWaterMark << '\n'
+         << "  mAcquireTotal:" << mAcquireTotal << '\n'
+         << "  mReuseTotal:" << mReuseTotal << '\n'
+         << "  mAllocTotal:" << mAllocTotal << '\n'
+         << "}";
+    return ostr.str();
+}
+
+} // namespace mcrt_dataio
@@ -0,0 +1,56 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+//
+// -- Recycling arena of FbMsgSingleChan --
+//
+// FbMsgMultiChans creates FbMsgSingleChan for each buffer name of the received messages and throws
+// all of them away at every merge cycle. This arena keeps the released FbMsgSingleChan (with the
+// capacity of their internal arrays) and hands them out again at the next cycle. So, steady state
+// message receiving does not need any heap allocation for channel construction. The number of kept
+// channels only grows up to the high-water mark of the simultaneously used channels.
+//
+// This class is not thread-safe. Access is serialized by the owner FbMsgMultiChans.
+//
+
+#include "FbMsgSingleChan.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mcrt_dataio {
+
+class FbMsgChanArena
+{
+public:
+    using FbMsgSingleChanShPtr = std::shared_ptr<FbMsgSingleChan>;
+
+    // Return an empty channel of dataType. Might throw std::bad_alloc.
+    FbMsgSingleChanShPtr acquire(const FbMsgSingleChan::DataType dataType);
+    // Return the channel to this arena. Data inside the channel is released but the array capacity is kept.
+    void release(const FbMsgSingleChanShPtr& chan);
+
+    size_t getLiveTotal() const { return mLiveTotal; }
+    size_t getFreeTotal() const { return mFreeChans.size(); }
+    size_t getHighWaterMark() const { return mHighWaterMark; }
+    uint64_t getAcquireTotal() const { return mAcquireTotal; }
+    uint64_t getReuseTotal() const { return mReuseTotal; }
+    uint64_t getAllocTotal() const { return mAllocTotal; }
+    size_t getFreeSlotsCapacity() const; // total message slot capacity of the free channels
+
+    std::string show() const;
+
+private:
+    std::vector<FbMsgSingleChanShPtr> mFreeChans;
+
+    size_t mLiveTotal {0};     // current number of the acquired channels
+    size_t mHighWaterMark {0}; // max number of the simultaneously acquired channels
+    uint64_t mAcquireTotal {0};
+    uint64_t mReuseTotal {0};
+    uint64_t mAllocTotal {0};
+}; // FbMsgChanArena
+
+} // namespace mcrt_dataio
@@ -0,0 +1,203 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "FbMsgFbPool.h"
+
+#include <sstream>
+
+namespace mcrt_dataio {
+
+FbMsgFbPool::FbShPtr
+FbMsgFbPool::acquire(const scene_rdl2::math::Viewport& rezedViewport)
+{
+    FbShPtr fb;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mAcquireTotal++;
+        while (!mFreeFbs.empty()) {
+            fb = std::move(mFreeFbs.back());
+            mFreeFbs.pop_back();
+            mFreeByte -= getAccountedByte(fb);
+            if (fb->getRezedViewport() == rezedViewport) {
+                mReuseTotal++;
+                break;
+            }
+            fb.reset(); // resolution changed. free this Fb
+            mFreeTotal++;
+        }
+        mLiveTotal++;
+    }
+    if (fb) return fb;
+
+    std::unique_ptr<scene_rdl2::grid_util::Fb> newFb;
+    try {
+        newFb = std::make_unique<scene_rdl2::grid_util::Fb>();
+        newFb->init(rezedViewport);
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLiveTotal--;
+        throw;
+    }
+
+    const size_t byte = calcFbByte(*newFb);
+    fb = FbShPtr(newFb.release(), FbDeleter {mTotalByte, byte});
+
+    const size_t currTotalByte = mTotalByte->fetch_add(byte, std::memory_order_relaxed) + byte;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mAllocTotal++;
+    }
+    updateHighWaterByte(currTotalByte);
+    return fb;
+}
+
+void
+FbMsgFbPool::release(FbShPtr&& fb)
+{
+    if (!fb) return;
+
+    // reset() deactivates all the optional buffers and AOVs, then garbageCollectUnusedBuffers() frees them.
+    // The next owner only needs the buffers which it receives. This is done outside the lock.
+    fb->reset();
+    fb->garbageCollectUnusedBuffers();
+    updateByte(fb);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFreeByte += getAccountedByte(fb);
+    mFreeFbs.push_back(std::move(fb));
+    if (mLiveTotal > 0) mLiveTotal--;
+}
+
+void
+FbMsgFbPool::updateByte(const FbShPtr& fb)
+{
+    if (!fb) return;
+    FbDeleter* deleter = std::get_deleter<FbDeleter>(fb);
+    if (!deleter) return; // not allocated by this pool
+
+    const size_t byte = calcFbByte(*fb);
+    if (byte > deleter->mByte) {
+        const size_t delta = byte - deleter->mByte;
+        updateHighWaterByte(mTotalByte->fetch_add(delta, std::memory_order_relaxed) + delta);
+    } else if (byte < deleter->mByte) {
+        mTotalByte->fetch_sub(deleter->mByte - byte, std::memory_order_relaxed);
+    }
+    deleter->mByte = byte;
+}
+
+void
+FbMsgFbPool::shrink(const size_t byteLimit)
+{
+    std::vector<FbShPtr> freeFbs; // actual free is done outside the lock
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        size_t currTotalByte = getTotalByte();
+        while (!mFreeFbs.empty() && currTotalByte > byteLimit) {
+            const size_t byte = getAccountedByte(mFreeFbs.back());
+            freeFbs.push_back(std::move(mFreeFbs.back()));
+            mFreeFbs.pop_back();
+            mFreeByte -= byte;
+            currTotalByte = (currTotalByte > byte) ? currTotalByte - byte : 0;
+            mFreeTotal++;
+        }
+    }
+}
+
+size_t
+FbMsgFbPool::getFreeByte() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mFreeByte;
+}
+
+size_t
+FbMsgFbPool::getLiveTotal() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mLiveTotal;
+}
+
+size_t
+FbMsgFbPool::getFreeTotal() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mFreeFbs.size();
+}
+
+size_t
+FbMsgFbPool::getHighWaterByte() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mHighWaterByte;
+}
+
+// static function
+size_t
+FbMsgFbPool::calcFbByte(const scene_rdl2::grid_util::Fb& fb)
+//
+// Estimated byte of all the allocated buffers of fb. Each pixel buffer has the tile aligned resolution
+// and each active pixels info has a 64 bit mask for each tile.
+//
+{
+    const size_t pixTotal = static_cast<size_t>(fb.getTotalTiles()) * 64;
+    const size_t maskByte = static_cast<size_t>(fb.getTotalTiles()) * sizeof(uint64_t);
+    const size_t rgbaByte = pixTotal * (sizeof(float) * 4 + sizeof(unsigned int)); // RGBA float + numSample
+
+    size_t byte = rgbaByte + maskByte; // beauty
+    if (fb.getPixelInfoStatus()) byte += pixTotal * sizeof(float) + maskByte; // depth
+    if (fb.getHeatMapStatus()) byte += pixTotal * (sizeof(float) + sizeof(unsigned int)) + maskByte;
+    if (fb.getWeightBufferStatus()) byte += pixTotal * sizeof(float) + maskByte;
+    if (fb.getRenderBufferOddStatus()) byte += rgbaByte + maskByte;
+
+    for (unsigned id = 0; id < fb.getTotalRenderOutput(); ++id) {
+        scene_rdl2::grid_util::Fb::FbAovShPtr fbAov;
+        if (!fb.getAov2(id, fbAov)) continue;
+        // AOV buffers are allocated by the decoder based on the received format. Reference type AOVs
+        // have no buffer and are always 0 byte here.
+        const scene_rdl2::grid_util::FbAov::VariablePixelBuffer& buff = fbAov->getBufferTiled();
+        const scene_rdl2::grid_util::FbAov::NumSampleBuffer& numSampleBuff = fbAov->getNumSampleBufferTiled();
+        const scene_rdl2::grid_util::FbAov::ActivePixels& activePixels = fbAov->getActivePixels();
+        byte += (static_cast<size_t>(buff.getWidth()) * buff.getHeight() * buff.getSizeOfPixel() +
+                 static_cast<size_t>(numSampleBuff.getWidth()) * numSampleBuff.getHeight() * sizeof(unsigned int) +
+                 static_cast<size_t>(activePixels.getAlignedWidth()) * activePixels.getAlignedHeight() / 64 *
+                 sizeof(uint64_t));
+    }
+    return byte;
+}
+
+// static function
+size_t
+FbMsgFbPool::getAccountedByte(const FbShPtr& fb)
+{
+    const FbDeleter* deleter = std::get_deleter<FbDeleter>(fb);
+    return (deleter) ? deleter->mByte : calcFbByte(*fb);
+}
+
+void
+FbMsgFbPool::updateHighWaterByte(const size_t currTotalByte)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mHighWaterByte < currTotalByte) mHighWaterByte = currTotalByte;
+}
+
+std::string
+FbMsgFbPool::show() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::ostringstream ostr;
+    ostr << "FbMsgFbPool {\n"
+         << "  totalByte:" << getTotalByte() << '\n'
+         << "  mFreeByte:" << mFreeByte << '\n'
+         << "  mHighWaterByte:" << mHighWaterByte << '\n'
+         << "  mLiveTotal:" << mLiveTotal << '\n'
+         << "  mFreeFbs:" << mFreeFbs.size() << '\n'
+         << "  mAcquireTotal:" << mAcquireTotal << '\n'
+         << "  mReuseTotal:" << mReuseTotal << '\n'
+         << "  mAllocTotal:" << mAllocTotal << '\n'
+         << "  mFreeTotal:" << mFreeTotal << '\n'
+         << "}";
+    return ostr.str();
+}
+
+} // namespace mcrt_dataio
@@ -0,0 +1,102 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+//
+// -- Shared pool of per-machine Fb --
+//
+// Under SYNCID_LINEUP mode, FbMsgMultiFrames keeps multiple FbMsgSingleFrame and each of them has
+// a full resolution Fb for every machine. Most of the cached frames only receive data from a part of
+// the machines (or nothing at all), so allocating all Fbs up front wastes lots of memory. This pool
+// is shared by all cached frames. A frame acquires the Fb of a particular machine when it receives
+// the first data from that machine and returns all Fbs to this pool when the frame is recycled.
+//
+// Memory usage is tracked by an estimated byte size of each Fb which is computed from all the allocated
+// buffers (beauty, numSample, pixelInfo, heatMap, weight, renderBufferOdd and renderOutput AOVs) of the
+// tile aligned resolution. Optional buffers and AOVs are allocated on demand by the decoder, so the owner
+// of the Fb should call updateByte() after decode or garbageCollectUnusedBuffers(). release() frees all
+// the optional buffers and AOVs before pooling the Fb. The estimated byte of all existing Fbs (i.e.
+// acquired by frames and kept in this pool) is available by getTotalByte() and this value is used by
+// FbMsgMultiFrames for its memory budget control.
+//
+// acquire()/release()/updateByte() are thread-safe. Multiple push threads might acquire Fbs in parallel.
+// updateByte() of a particular Fb should only be called by the owner of that Fb.
+//
+
+#include <scene_rdl2/common/grid_util/Fb.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mcrt_dataio {
+
+class FbMsgFbPool
+{
+public:
+    using FbShPtr = std::shared_ptr<scene_rdl2::grid_util::Fb>;
+
+    FbMsgFbPool() : mTotalByte(std::make_shared<std::atomic<size_t>>(0)) {}
+
+    // Non-copyable
+    FbMsgFbPool &operator = (const FbMsgFbPool) = delete;
+    FbMsgFbPool(const FbMsgFbPool &) = delete;
+
+    // Return an Fb which is initialized by rezedViewport. Data inside the returned Fb is not cleared
+    // (same as the recycled Fb of the cached frame). Might throw std::bad_alloc.
+    FbShPtr acquire(const scene_rdl2::math::Viewport& rezedViewport);
+    // Return the Fb to this pool. All the optional buffers and AOVs of the Fb are freed.
+    void release(FbShPtr&& fb);
+    // Re-compute the byte of the acquired fb after its buffers are allocated or freed.
+    void updateByte(const FbShPtr& fb);
+
+    // Free the pooled Fbs until the total byte becomes equal or less than byteLimit.
+    void shrink(const size_t byteLimit);
+    void clear() { shrink(0); }
+
+    size_t getTotalByte() const { return mTotalByte->load(std::memory_order_relaxed); }
+    size_t getFreeByte() const;
+    size_t getLiveTotal() const;
+    size_t getFreeTotal() const;
+    size_t getHighWaterByte() const;
+
+    static size_t calcFbByte(const scene_rdl2::grid_util::Fb& fb);
+
+    std::string show() const;
+
+private:
+    // Keeps the accounted byte of each Fb. The deleter keeps the total byte info by shared_ptr because
+    // the Fb might outlive this pool.
+    struct FbDeleter
+    {
+        void operator()(scene_rdl2::grid_util::Fb* ptr) const
+        {
+            mTotalByte->fetch_sub(mByte, std::memory_order_relaxed);
+            delete ptr;
+        }
+
+        std::shared_ptr<std::atomic<size_t>> mTotalByte;
+        size_t mByte {0}; // accounted byte of this Fb
+    };
+
+    static size_t getAccountedByte(const FbShPtr& fb);
+    void updateHighWaterByte(const size_t currTotalByte);
+
+    mutable std::mutex mMutex;
+    std::vector<FbShPtr> mFreeFbs;
+    size_t mFreeByte {0};
+
+    // Decremented by the deleter of each Fb. The Fb might outlive this pool.
+    std::shared_ptr<std::atomic<size_t>> mTotalByte;
+
+    size_t mLiveTotal {0};     // current number of the acquired Fbs
+    size_t mHighWaterByte {0}; // max total byte
+    uint64_t mAcquireTotal {0};
+    uint64_t mReuseTotal {0};
+    uint64_t mAllocTotal {0};
+    uint64_t mFreeTotal {0};   // total freed Fbs by shrink() or viewport change
+}; // FbMsgFbPool
+
+} // namespace mcrt_dataio
@@ -0,0 +1,49 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+//
+// -- Lock set for the concurrent message ingest --
+//
+// FbMsgSingleFrame::push() is called by multiple network receive threads at the same time.
+// Each machine has its own mutex (= per-machine shard) and the heavy part of the push (i.e. message
+// decode/store) only holds this per-machine mutex. The aggregate mutex protects the data which is
+// shared by all machines (i.e. active machines total, progress total, frame status) and is only held
+// for a short period. The lock order is always per-machine mutex -> aggregate mutex.
+//
+// Mutexes are never copied. A copy has its own fresh mutexes for the same number of machines. This
+// makes the owner class (which is kept inside std::vector) copyable.
+//
+
+#include <memory>
+#include <mutex>
+
+namespace mcrt_dataio {
+
+class FbMsgIngestLock
+{
+public:
+    FbMsgIngestLock() = default;
+    FbMsgIngestLock(const FbMsgIngestLock& src) { init(src.mMachineTotal); }
+    FbMsgIngestLock& operator = (const FbMsgIngestLock& src)
+    {
+        if (this != &src) init(src.mMachineTotal);
+        return *this;
+    }
+
+    void init(const size_t machineTotal)
+    {
+        mMachineMutex.reset((machineTotal) ? new std::mutex[machineTotal] : nullptr);
+        mMachineTotal = machineTotal;
+    }
+
+    std::mutex& getMachineMutex(const size_t machineId) { return mMachineMutex[machineId]; }
+    std::mutex& getAggregateMutex() { return mAggregateMutex; }
+
+private:
+    size_t mMachineTotal {0};
+    std::unique_ptr<std::mutex[]> mMachineMutex; // [machineId]
+    std::mutex mAggregateMutex;
+}; // FbMsgIngestLock
+
+} // namespace mcrt_dataio
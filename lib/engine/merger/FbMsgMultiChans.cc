@@ -3,14 +3,18 @@
 #include "FbMsgMultiChans.h"
 #include "GlobalNodeInfo.h"
 #include "MergeActionTracker.h"
+#include "SubMergeAovNumSample.h"
 
 #include <scene_rdl2/common/fb_util/ActivePixels.h>
+#include <scene_rdl2/common/grid_util/FbReferenceType.h>
 #include <scene_rdl2/common/grid_util/PackTiles.h>
 #include <scene_rdl2/common/grid_util/ProgressiveFrameBufferName.h>
 #include <scene_rdl2/scene/rdl2/ValueContainerDeq.h>
 #include <scene_rdl2/scene/rdl2/ValueContainerEnq.h>
 
+#include <algorithm>
 #include <iomanip>
+#include <iostream>
 #include <sstream>
 
 //#define DEBUG_DECODE_MSG // debug message for decode action
@@ -45,6 +49,7 @@ FbMsgMultiChans::push(const bool delayDecode,
         // std::cerr << ">> FbMsgMultiChans.cc FbMsgMultiChans::push() STARTED fb.reset\n"; // useful debug message
         fb.reset();
         reset();
+        resetChanTbl(); // new session : buffer names are interned again from this message
         mHasStartedStatus = true;
     }
 
@@ -65,6 +70,14 @@ FbMsgMultiChans::push(const bool delayDecode,
         mSnapshotStartTime = progressive.mSnapshotStartTime;
     }
 
+    //
+    // Resolve all buffer names to the channel IDs by single thread first. The result is stored into
+    // mBufferChanIdCache[bufferId] and the following pushBuffer() only uses channel IDs.
+    //
+    for (size_t bufferId = 0; bufferId < progressive.mBuffers.size(); ++bufferId) {
+        resolveChanId(bufferId, progressive.mBuffers[bufferId].mName);
+    }
+
     //
     // We have to consider 2 different environment.
     // a) Merge action processing at Merge computation
@@ -74,10 +87,11 @@ FbMsgMultiChans::push(const bool delayDecode,
     //    computation itself more but we also consider MT run depending on feedback processing cost.
     //        
     if (!parallelExec) {
-        for (const mcrt::BaseFrame::DataBuffer &buffer: progressive.mBuffers) {
+        for (size_t bufferId = 0; bufferId < progressive.mBuffers.size(); ++bufferId) {
+            const mcrt::BaseFrame::DataBuffer &buffer = progressive.mBuffers[bufferId];
             if (!pushBuffer(delayDecode,
                             skipLatencyLog,
-                            buffer.mName,
+                            mBufferChanIdCache[bufferId],
                             buffer.mData,
                             buffer.mDataLength,
                             fb)) {
@@ -89,10 +103,11 @@ FbMsgMultiChans::push(const bool delayDecode,
             // This is single thread execution. Under delayDecode mode,
             // We don't need to run by multi-thread because we only copy shared_ptr.
             // Single thread is enough.
-            for (const mcrt::BaseFrame::DataBuffer &buffer: progressive.mBuffers) {
+            for (size_t bufferId = 0; bufferId < progressive.mBuffers.size(); ++bufferId) {
+                const mcrt::BaseFrame::DataBuffer &buffer = progressive.mBuffers[bufferId];
                 if (!pushBuffer(delayDecode,
                                 skipLatencyLog,
-                                buffer.mName,
+                                mBufferChanIdCache[bufferId],
                                 buffer.mData,
                                 buffer.mDataLength,
                                 fb)) {
@@ -103,19 +118,35 @@ FbMsgMultiChans::push(const bool delayDecode,
             // This is non-delayDecode mode, we have to decode everything here and
             // it requires multi-thread execution.
             if (!progressive.mBuffers.empty()) {
-                std::vector<const mcrt::BaseFrame::DataBuffer *> bufferArray(progressive.mBuffers.size());
-                for (size_t id = 0; id < progressive.mBuffers.size(); ++id) {
-                    bufferArray[id] = &progressive.mBuffers[id];
+                // Only the image data is decoded in parallel. Other buffers are queued into mMsgArray by
+                // single thread because mChanArena is not thread-safe.
+                std::vector<size_t> bufferIdArray;
+                for (size_t bufferId = 0; bufferId < progressive.mBuffers.size(); ++bufferId) {
+                    const unsigned chanId = mBufferChanIdCache[bufferId];
+                    if (mChanTbl[chanId].mKind == ChanKind::FB_DATA) {
+                        bufferIdArray.push_back(bufferId);
+                        continue;
+                    }
+                    const mcrt::BaseFrame::DataBuffer &buffer = progressive.mBuffers[bufferId];
+                    if (!pushBuffer(delayDecode,
+                                    skipLatencyLog,
+                                    chanId,
+                                    buffer.mData,
+                                    buffer.mDataLength,
+                                    fb)) {
+                        return false;       // error
+                    }
                 }
                 bool errorST = false;
-                tbb::blocked_range<size_t> range(0, bufferArray.size());
+                tbb::blocked_range<size_t> range(0, bufferIdArray.size());
                 tbb::parallel_for(range, [&](const tbb::blocked_range<size_t> &r) {
                         for (size_t id = r.begin(); id < r.end(); ++id) {
+                            const mcrt::BaseFrame::DataBuffer &buffer = progressive.mBuffers[bufferIdArray[id]];
                             if (!pushBuffer(delayDecode,
                                             skipLatencyLog,
-                                            bufferArray[id]->mName,
-                                            bufferArray[id]->mData,
-                                            bufferArray[id]->mDataLength,
+                                            mBufferChanIdCache[bufferIdArray[id]],
+                                            buffer.mData,
+                                            buffer.mDataLength,
                                             fb)) {
                                 errorST = true;
                             }
@@ -126,17 +157,28 @@ FbMsgMultiChans::push(const bool delayDecode,
         }
     }
 
+    if (!delayDecode) {
+        // All AOV data of this message are already decoded. Apply the AOV numSample of the sub-merge output.
+        if (!applySubMergeAovNumSample(fb)) return false;
+    }
+
     return true;
 }
 
 void
 FbMsgMultiChans::encodeLatencyLog(scene_rdl2::rdl2::ValueContainerEnq &vContainerEnq)
 {
-    const bool sw = (mMsgArray.find(latencyLogName) != mMsgArray.end())? true: false;
+    const FbMsgSingleChan* latencyLogChan = nullptr;
+    for (size_t chanId = 0; chanId < mMsgArray.size(); ++chanId) {
+        if (mMsgArray[chanId] && mChanTbl[chanId].mKind == ChanKind::LATENCY_LOG) {
+            latencyLogChan = mMsgArray[chanId].get();
+            break;
+        }
+    }
 
-    vContainerEnq.enqBool(sw);
-    if (sw) {
-        mMsgArray[latencyLogName]->encode(vContainerEnq);
+    vContainerEnq.enqBool(latencyLogChan != nullptr);
+    if (latencyLogChan) {
+        latencyLogChan->encode(vContainerEnq);
     }
 }
 
@@ -145,24 +187,20 @@ FbMsgMultiChans::encodeVecPacket(const VecPacketAddBuffFunc& addBuffFunc)
 {
     if (!hasVecPacket()) return; // early exit
 
-    auto itr = mMsgArray.cbegin();
-    while (true) {
-        if (itr == mMsgArray.cend()) break; // end of data
+    for (size_t chanId = 0; chanId < mMsgArray.size(); ++chanId) {
+        const FbMsgSingleChanShPtr& chan = mMsgArray[chanId];
+        if (!chan || chan->getDataType() != FbMsgSingleChan::DataType::VEC_PACKET) continue; // skip data
 
-        if (itr->second->getDataType() != FbMsgSingleChan::DataType::VEC_PACKET) {
-            itr++; // skip data
-        } else {
-            const std::string& buffName = itr->first;
-            const std::vector<DataPtr>& datas = itr->second->dataArray();
-            const std::vector<size_t>& dataSize = itr->second->dataSize();
+        const std::string& buffName = mChanTbl[chanId].mName;
+        const std::vector<DataPtr>& datas = chan->dataArray();
+        const std::vector<size_t>& dataSize = chan->dataSize();
 
-            // We only keep the latest vecPacket data. This means we only need to process the first one.
-            addBuffFunc(buffName, datas[0], dataSize[0]);
+        // We only keep the latest vecPacket data. This means we only need to process the first one.
+        addBuffFunc(buffName, datas[0], dataSize[0]);
 
-            // VecPacket has a fixed buffer name. This means we only have a single FbMsgSingleChan for VecPacket.
-            // We don't need to process other data buffers here and can safely exit this loop.
-            break;
-        }
+        // VecPacket has a fixed buffer name. This means we only have a single FbMsgSingleChan for VecPacket.
+        // We don't need to process other data buffers here and can safely exit this loop.
+        break;
     }
 }
 
@@ -176,9 +214,10 @@ FbMsgMultiChans::show(const std::string &hd) const
     ostr << hd << "  mHasPixelInfo   :" << ((mHasPixelInfo   )? "true ": "false") << '\n';
     ostr << hd << "  mHasRenderOutput:" << ((mHasRenderOutput)? "true ": "false") << '\n';
     ostr << hd << "  mCoarsePass     :" << ((mCoarsePass     )? "true ": "false") << '\n';
-    for (auto &&itr : mMsgArray) {
-        ostr << hd << "  name:" << itr.first << " {\n";
-        ostr << (itr.second)->show(hd + "    ") << '\n';
+    for (size_t chanId = 0; chanId < mMsgArray.size(); ++chanId) {
+        if (!mMsgArray[chanId]) continue;
+        ostr << hd << "  name:" << mChanTbl[chanId].mName << " {\n";
+        ostr << mMsgArray[chanId]->show(hd + "    ") << '\n';
         ostr << hd << "  }\n";
     }
     ostr << hd << "}";
@@ -223,9 +262,10 @@ FbMsgMultiChans::show() const
     auto showMsgArray = [&]() -> std::string {
         std::ostringstream ostr;
         ostr << "mMsgArray size:" << mMsgArray.size() << " {\n";
-        for (auto &&itr : mMsgArray) {
-            ostr << "  name:" << itr.first << " {\n"
-                 << addIndent((itr.second)->show(), 2) << '\n'
+        for (size_t chanId = 0; chanId < mMsgArray.size(); ++chanId) {
+            if (!mMsgArray[chanId]) continue;
+            ostr << "  chanId:" << chanId << " name:" << mChanTbl[chanId].mName << " {\n"
+                 << addIndent(mMsgArray[chanId]->show(), 2) << '\n'
                  << "  }\n";
         }
         ostr << "}";
@@ -256,9 +296,10 @@ std::string
 FbMsgMultiChans::showVecPacketInfo() const
 {
     auto showVecPacketMsg = [&]() -> std::string {
-        for (const auto& itr : mMsgArray) {
-            if (itr.second->getDataType() == FbMsgSingleChan::DataType::VEC_PACKET) {
-                return "name:" + itr.first + ' ' + itr.second->show();
+        for (size_t chanId = 0; chanId < mMsgArray.size(); ++chanId) {
+            const FbMsgSingleChanShPtr& chan = mMsgArray[chanId];
+            if (chan && chan->getDataType() == FbMsgSingleChan::DataType::VEC_PACKET) {
+                return "name:" + mChanTbl[chanId].mName + ' ' + chan->show();
             }
         }
         return "empty";
@@ -275,55 +316,144 @@ FbMsgMultiChans::showVecPacketInfo() const
 
 //-------------------------------------------------------------------------------------------------------------
 
+void
+FbMsgMultiChans::resetChanTbl()
+{
+    // reset() already returned all channels to mChanArena.
+    mMsgArray.clear();
+    mChanTbl.clear();
+    mChanIdMap.clear();
+    mBufferChanIdCache.clear();
+}
+
+unsigned
+FbMsgMultiChans::resolveChanId(const size_t bufferId, const char* name)
+//
+// Return the channel ID of the bufferId-th buffer of the message and update mBufferChanIdCache.
+// This function is not thread-safe and should be called by single thread.
+//
+{
+    if (bufferId < mBufferChanIdCache.size()) {
+        // Fast path : most of the case, each message has the same buffer order as the last message.
+        const unsigned chanId = mBufferChanIdCache[bufferId];
+        if (!strcmp(mChanTbl[chanId].mName.c_str(), name)) return chanId;
+    } else {
+        mBufferChanIdCache.resize(bufferId + 1);
+    }
+
+    unsigned chanId;
+    auto itr = mChanIdMap.find(name);
+    if (itr != mChanIdMap.end()) {
+        chanId = itr->second;
+    } else {
+        // new buffer name : intern it
+        chanId = static_cast<unsigned>(mChanTbl.size());
+        mChanTbl.push_back(ChanInfo {name, calcChanKind(name)});
+        mChanIdMap.emplace(name, chanId);
+        mMsgArray.resize(mChanTbl.size());
+    }
+    mBufferChanIdCache[bufferId] = chanId;
+    return chanId;
+}
+
+// static function
+FbMsgMultiChans::ChanKind
+FbMsgMultiChans::calcChanKind(const char* name)
+{
+    if (!strcmp(name, latencyLogName)) return ChanKind::LATENCY_LOG;
+
+    // Actually, the latencyLogUpstream info is generated by the merge node and is usually sent
+    // to the client. However, latencyLogUpStream is also sent to the MCRT computation via the
+    // progressiveFeedback message for the latency measurement feedback loop. In this case, the
+    // decode action inside the MCRT computation is processed by FbMsgMultiChans. (i.e.,
+    // FbMsgMultiChans are used for both of the mcrt computation and the merge computation.).
+    // So, LATENCY_LOG_UPSTREAM is possibly used only if this class is used inside the
+    // mcrt-computation.
+    if (!strcmp(name, latencyLogUpstreamName)) return ChanKind::LATENCY_LOG_UPSTREAM;
+
+    if (!strcmp(name, auxInfoName)) return ChanKind::AUX_INFO;
+
+    if (!strcmp(name, SubMergeAovNumSample::sBuffName)) return ChanKind::SUBMERGE_AOV_NUMSAMPLE;
+
+    int vecPacketRankId;
+    if (scene_rdl2::grid_util::ProgressiveFrameBufferName::isVecPacket(name, vecPacketRankId)) {
+        return ChanKind::VEC_PACKET;
+    }
+    return ChanKind::FB_DATA;
+}
+
+// static function
+std::string
+FbMsgMultiChans::chanKindStr(const ChanKind kind)
+{
+    switch (kind) {
+    case ChanKind::FB_DATA : return "FB_DATA";
+    case ChanKind::LATENCY_LOG : return "LATENCY_LOG";
+    case ChanKind::LATENCY_LOG_UPSTREAM : return "LATENCY_LOG_UPSTREAM";
+    case ChanKind::AUX_INFO : return "AUX_INFO";
+    case ChanKind::VEC_PACKET : return "VEC_PACKET";
+    case ChanKind::SUBMERGE_AOV_NUMSAMPLE : return "SUBMERGE_AOV_NUMSAMPLE";
+    default : return "?";
+    }
+}
+
+std::string
+FbMsgMultiChans::showChanTbl() const
+{
+    const int w = scene_rdl2::str_util::getNumberOfDigits(static_cast<unsigned>(mChanTbl.size()));
+
+    std::ostringstream ostr;
+    ostr << "chanTbl (size:" << mChanTbl.size() << ") {\n";
+    for (size_t chanId = 0; chanId < mChanTbl.size(); ++chanId) {
+        ostr << "  chanId:" << std::setw(w) << chanId
+             << " kind:" << chanKindStr(mChanTbl[chanId].mKind)
+             << " name:" << mChanTbl[chanId].mName << '\n';
+    }
+    ostr << "}";
+    return ostr.str();
+}
+
 bool
 FbMsgMultiChans::pushBuffer(const bool delayDecode,
                             const bool skipLatencyLog,
-                            const char *name,
+                            const unsigned chanId,
                             DataPtr dataPtr,
                             const size_t dataSize,
                             scene_rdl2::grid_util::Fb &fb)
 //
 // fb internal information is accumulatively updated (and not initialized every call).
 // fb is initialized (resized) internally based on message if needed (like resize situation).
+// The chanId should be resolved by resolveChanId() in advance.
 //
 {
-    const bool latencyLogFlag = !strcmp(name, latencyLogName);
-
-    // Actually, the latencyLogUpstream info is generated by the merge node and is usually sent
-    // to the client. However, latencyLogUpStream is also sent to the MCRT computation via the
-    // progressiveFeedback message for the latency measurement feedback loop. In this case, the
-    // decode action inside the MCRT computation is processed by FbMsgMultiChans. (i.e.,
-    // FbMsgMultiChans are used for both of the mcrt computation and the merge computation.).
-    // So, latencyLogUpstreamFlag is possibly turned on only if this class is used inside the
-    // mcrt-computation.
-    const bool latencyLogUpstreamFlag = !strcmp(name, latencyLogUpstreamName);
-    if (skipLatencyLog && (latencyLogFlag || latencyLogUpstreamFlag)) {
+    const ChanKind kind = mChanTbl[chanId].mKind;
+    if (skipLatencyLog && (kind == ChanKind::LATENCY_LOG || kind == ChanKind::LATENCY_LOG_UPSTREAM)) {
         // Special mode for image feedback logic. Skip all latencyLog and latencyLogUpstream data.
         return true;
     }
-    if (!strcmp(name, auxInfoName)) {
+    if (kind == ChanKind::AUX_INFO) {
         pushAuxInfo(dataPtr.get(), dataSize);
         return true;
     }
 
-    bool vecPacketFlag {false};
-    if (!latencyLogFlag) {
-        int vecPacketRankId;
-        vecPacketFlag = scene_rdl2::grid_util::ProgressiveFrameBufferName::isVecPacket(name, vecPacketRankId);
-        if (vecPacketFlag) mHasVecPacket = vecPacketFlag; // update vecPacket existence status 
-    }
+    const bool latencyLogFlag = (kind == ChanKind::LATENCY_LOG);
+    const bool vecPacketFlag = (kind == ChanKind::VEC_PACKET);
+    if (vecPacketFlag) mHasVecPacket = vecPacketFlag; // update vecPacket existence status
+    // AOV numSample of the sub-merge output is always queued and applied after the decode of the AOV data.
+    const bool subMergeAovNumSampleFlag = (kind == ChanKind::SUBMERGE_AOV_NUMSAMPLE);
 
-    if (delayDecode || latencyLogFlag || vecPacketFlag) {
+    if (delayDecode || latencyLogFlag || vecPacketFlag || subMergeAovNumSampleFlag) {
         //
-        // delayDecode mode or latencyLog information
+        // delayDecode mode, latencyLog information or sub-merge AOV numSample
         //
-        if (mMsgArray.find(name) == mMsgArray.end()) {
+        FbMsgSingleChanShPtr& chan = mMsgArray[chanId];
+        if (!chan) {
             FbMsgSingleChan::DataType dataType = FbMsgSingleChan::DataType::UNKNOWN;
             if (latencyLogFlag) dataType = FbMsgSingleChan::DataType::LATENCY_LOG;
             else if (vecPacketFlag) dataType = FbMsgSingleChan::DataType::VEC_PACKET;
             else dataType = FbMsgSingleChan::DataType::FB_DATA;
             try {
-                mMsgArray[name] = std::make_shared<FbMsgSingleChan>(dataType);
+                chan = mChanArena.acquire(dataType);
             }
             catch (...) {
                 return false;
@@ -332,14 +462,14 @@ FbMsgMultiChans::pushBuffer(const bool delayDecode,
         /* useful test dump
         if (latencyLogFlag) {
             std::cerr << ">> FbMsgMultiChans.cc latencyLog {\n"
-                      << mMsgArray[latencyLogName]->showLatencyLog("  ") << '\n'
+                      << chan->showLatencyLog("  ") << '\n'
                       << "}" << std::endl;
         }
         */
-        return mMsgArray[name]->push(dataPtr, dataSize);
+        return chan->push(dataPtr, dataSize);
     }
 
-    decodeData(name, dataPtr.get(), dataSize, fb);
+    decodeData(mChanTbl[chanId].mName.c_str(), dataPtr.get(), dataSize, fb);
     
     return true;
 }
@@ -355,63 +485,65 @@ FbMsgMultiChans::pushAuxInfo(const void *data, const size_t dataSize)
 }
 
 void
-FbMsgMultiChans::decodeAll(scene_rdl2::grid_util::Fb& fb, MergeActionTracker* mergeActionTracker)
+FbMsgMultiChans::decodeAll(scene_rdl2::grid_util::Fb& fb,
+                           MergeActionTracker* mergeActionTracker,
+                           std::vector<char>* deltaTilesTbl)
+//
+// deltaTilesTbl is updated (not cleared) by the tiles which are touched by this decode action
+// if deltaTilesTbl is not nullptr. Table size is adjusted to the fb's total tiles.
+//
 {
 #   ifdef SINGLE_THREAD
-    auto itr = mMsgArray.cbegin();
-    while (1) {
-        if (itr == mMsgArray.cend()) break; // end of loop
-
-        if (itr->second->getDataType() != FbMsgSingleChan::DataType::FB_DATA) {
-            itr++;              // skip decode if vecPacket
-        } else {
-            const std::string &name = itr->first;
-            const std::vector<DataPtr>& datas = (itr->second)->dataArray();
-            const std::vector<size_t>& dataSize = (itr->second)->dataSize();
-            for (size_t i = 0; i < datas.size(); ++i) {
-                decodeData(name.c_str(), datas[i].get(), dataSize[i], fb);
-            }
-            itr = mMsgArray.erase(itr); // remove data
-        }
+    for (size_t chanId = 0; chanId < mMsgArray.size(); ++chanId) {
+        FbMsgSingleChanShPtr& chan = mMsgArray[chanId];
+        if (!chan || chan->getDataType() != FbMsgSingleChan::DataType::FB_DATA) continue; // skip if vecPacket
+        if (mChanTbl[chanId].mKind != ChanKind::FB_DATA) continue; // sub-merge AOV numSample
+        decodeSingleChan(mChanTbl[chanId], *chan, fb, deltaTilesTbl,
+                         mCoalesceSkipTotal, mCoalesceProbeMissTotal);
+        mChanArena.release(chan); // remove data
+        chan.reset();
     }
 #   else // else SINGLE_THREAD
     //
     // each AOV data is decoded in parallel
     //
-    std::vector<const std::string *> ptrSingleChanNameArray;
-    std::vector<FbMsgSingleChan *> ptrSingleChanArray;
-    auto itr = mMsgArray.cbegin();
-    while (1) {
-        if (itr == mMsgArray.cend()) break;
-        if (itr->second->getDataType() == FbMsgSingleChan::DataType::FB_DATA) {
+    std::vector<unsigned> chanIdArray;
+    for (size_t chanId = 0; chanId < mMsgArray.size(); ++chanId) {
+        if (mMsgArray[chanId] && mMsgArray[chanId]->getDataType() == FbMsgSingleChan::DataType::FB_DATA &&
+            mChanTbl[chanId].mKind == ChanKind::FB_DATA) {
             // non latencyLog/vecPacket case, we should push info
-            ptrSingleChanNameArray.push_back(&(itr->first));
-            ptrSingleChanArray.push_back((itr->second).get());
+            chanIdArray.push_back(static_cast<unsigned>(chanId));
         }
-        itr++;
     }
-    tbb::blocked_range<size_t> range(0, ptrSingleChanArray.size());
+    // Each AOV decode task has own deltaTilesTbl and coalesce counters in order to avoid the race condition
+    std::vector<std::vector<char>> deltaTilesTblArray((deltaTilesTbl) ? chanIdArray.size() : 0);
+    std::vector<uint64_t> coalesceSkipArray(chanIdArray.size(), 0);
+    std::vector<uint64_t> coalesceProbeMissArray(chanIdArray.size(), 0);
+    tbb::blocked_range<size_t> range(0, chanIdArray.size());
     tbb::parallel_for(range, [&](const tbb::blocked_range<size_t> &r) {
         for (size_t id = r.begin(); id < r.end(); ++id) {
-            const std::string &name = *ptrSingleChanNameArray[id];
-            const std::vector<DataPtr> &datas = ptrSingleChanArray[id]->dataArray();
-            const std::vector<size_t> &dataSize = ptrSingleChanArray[id]->dataSize();
-            for (size_t i = 0; i < datas.size(); ++i) {
-                decodeData(name.c_str(), datas[i].get(), dataSize[i], fb);
-            }
+            const unsigned chanId = chanIdArray[id];
+            std::vector<char>* currDeltaTilesTbl = (deltaTilesTbl) ? &deltaTilesTblArray[id] : nullptr;
+            decodeSingleChan(mChanTbl[chanId], *mMsgArray[chanId], fb, currDeltaTilesTbl,
+                             coalesceSkipArray[id], coalesceProbeMissArray[id]);
         } // id
     });
-    itr = mMsgArray.cbegin();
-    while (1) {
-        if (itr == mMsgArray.cend()) break;
-        if (itr->second->getDataType() != FbMsgSingleChan::DataType::FB_DATA) {
-            itr++;
-        } else {
-            itr = mMsgArray.erase(itr); // remove data
-        }
+    for (const auto& currDeltaTilesTbl : deltaTilesTblArray) {
+        orDeltaTilesTbl(currDeltaTilesTbl, *deltaTilesTbl);
+    }
+    for (size_t id = 0; id < chanIdArray.size(); ++id) {
+        mCoalesceSkipTotal += coalesceSkipArray[id];
+        mCoalesceProbeMissTotal += coalesceProbeMissArray[id];
+    }
+    for (const unsigned chanId : chanIdArray) {
+        mChanArena.release(mMsgArray[chanId]); // remove data
+        mMsgArray[chanId].reset();
     }
 #   endif // end else SINGLE_THREAD     
 
+    // AOV numSample of the sub-merge output should be applied after the AOV decode is completed.
+    (void)applySubMergeAovNumSample(fb);
+
     //------------------------------
     //
     // Update mergeActionTracker
@@ -420,13 +552,94 @@ FbMsgMultiChans::decodeAll(scene_rdl2::grid_util::Fb& fb, MergeActionTracker* me
         mergeActionTracker->decodeAll(mSendImageActionIdData);
     }
     mSendImageActionIdData.clear();
+
+    if (deltaTilesTbl && !deltaTilesTbl->empty() && deltaTilesTbl->size() != fb.getTotalTiles()) {
+        // resolution changed, all tiles are considered as updated.
+        deltaTilesTbl->assign(fb.getTotalTiles(), static_cast<char>(true));
+    }
+}
+
+size_t
+FbMsgMultiChans::getQueuedByte() const
+{
+    size_t total = 0;
+    for (const auto& chan : mMsgArray) {
+        if (!chan || chan->getDataType() != FbMsgSingleChan::DataType::FB_DATA) continue;
+        for (const size_t currSize : chan->dataSize()) total += currSize;
+    }
+    return total;
+}
+
+size_t
+FbMsgMultiChans::getQueuedDepth() const
+{
+    size_t depth = 0;
+    for (const auto& chan : mMsgArray) {
+        if (!chan || chan->getDataType() != FbMsgSingleChan::DataType::FB_DATA) continue;
+        depth = std::max(depth, chan->dataArray().size());
+    }
+    return depth;
+}
+
+void
+FbMsgMultiChans::decodeSingleChan(ChanInfo& chanInfo,
+                                  const FbMsgSingleChan& singleChan,
+                                  scene_rdl2::grid_util::Fb& fb,
+                                  std::vector<char>* deltaTilesTbl,
+                                  uint64_t& coalesceSkip,
+                                  uint64_t& coalesceProbeMiss)
+//
+// Decode all the queued data of a single buffer in received order. If the newest data of the previous
+// decodeAll() covered all the pixels, the newest data is decoded first and older data is skipped if the
+// newest data fully replaces them (see setCoalesceDecode()). The coverage of the newest data is always
+// updated by its decode, so the probe does not need any extra decode when it is skipped.
+// The sendImageActionId bookkeeping for MergeActionTracker is not changed by coalescing because the
+// decoded result is exactly the same as decoding all the data in order.
+// This function only updates chanInfo of this buffer and is safe to run for different buffers in parallel.
+//
+{
+    const std::vector<DataPtr>& datas = singleChan.dataArray();
+    const std::vector<size_t>& dataSize = singleChan.dataSize();
+    if (datas.empty()) return;
+
+    const char* name = chanInfo.mName.c_str();
+    const size_t newestId = datas.size() - 1;
+    if (mCoalesceDecode &&
+        chanInfo.mLastFullCoverage &&
+        datas.size() >= std::max(mCoalesceDecodeMinQueue, static_cast<size_t>(2)) &&
+        isCoalesceTarget(datas[newestId].get(), dataSize[newestId])) {
+        bool fullCoverage = false;
+        decodeData(name, datas[newestId].get(), dataSize[newestId], fb, deltaTilesTbl, &fullCoverage);
+        chanInfo.mLastFullCoverage = fullCoverage;
+        if (fullCoverage) {
+            coalesceSkip += newestId; // all older data is overwritten by the newest data
+            return;
+        }
+        // The newest data does not cover all the pixels. We have to decode all the data in order and
+        // the newest data is decoded again at the end in order to overwrite older pixel values.
+        // The next decodeAll() of this buffer skips the probe.
+        coalesceProbeMiss++;
+        for (size_t i = 0; i < datas.size(); ++i) {
+            decodeData(name, datas[i].get(), dataSize[i], fb, deltaTilesTbl);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < newestId; ++i) {
+        decodeData(name, datas[i].get(), dataSize[i], fb, deltaTilesTbl);
+    }
+    bool fullCoverage = false;
+    decodeData(name, datas[newestId].get(), dataSize[newestId], fb, deltaTilesTbl, &fullCoverage);
+    chanInfo.mLastFullCoverage = fullCoverage;
 }
 
 void    
 FbMsgMultiChans::decodeData(const char* name,
                             const void* data,
                             const size_t dataSize,
-                            scene_rdl2::grid_util::Fb& fb)
+                            scene_rdl2::grid_util::Fb& fb,
+                            std::vector<char>* deltaTilesTbl,
+                            bool* fullCoverage)
 {
     // scene_rdl2::grid_util::PackTiles::debugMode(true); // for PackTiles debug
 
@@ -439,14 +652,14 @@ FbMsgMultiChans::decodeData(const char* name,
 #       ifdef DEBUG_DECODE_MSG
         std::cerr << ">> FbMsgMultiChans.cc decodeData() passA\n";
 #       endif // end DEBUG_DECODE_MSG
-        decodeBeautyWithNumSample(data, dataSize, fb);
+        decodeBeautyWithNumSample(data, dataSize, fb, deltaTilesTbl, fullCoverage);
         break;
     case scene_rdl2::grid_util::PackTiles::DataType::BEAUTY :
         // beauty only (not include numSample)
 #       ifdef DEBUG_DECODE_MSG
         std::cerr << ">> FbMsgMultiChans.cc decodeData() passB\n";
 #       endif // end DEBUG_DECODE_MSG
-        decodeBeauty(data, dataSize, fb);
+        decodeBeauty(data, dataSize, fb, deltaTilesTbl, fullCoverage);
         break;
     case scene_rdl2::grid_util::PackTiles::DataType::BEAUTYODD_WITH_NUMSAMPLE :
         // beautyOdd with numSample
@@ -454,7 +667,7 @@ FbMsgMultiChans::decodeData(const char* name,
 #       ifdef DEBUG_DECODE_MSG
         std::cerr << ">> FbMsgMultiChans.cc decodeData() passC\n";
 #       endif // end DEBUG_DECODE_MSG
-        decodeBeautyOddWithNumSample(data, dataSize, fb);
+        decodeBeautyOddWithNumSample(data, dataSize, fb, deltaTilesTbl, fullCoverage);
         break;
     case scene_rdl2::grid_util::PackTiles::DataType::BEAUTYODD :
         // beautyOdd only (not include numSample)
@@ -462,35 +675,35 @@ FbMsgMultiChans::decodeData(const char* name,
 #       ifdef DEBUG_DECODE_MSG
         std::cerr << ">> FbMsgMultiChans.cc decodeData() passD\n";
 #       endif // end DEBUG_DECODE_MSG
-        decodeBeautyOdd(data, dataSize, fb);
+        decodeBeautyOdd(data, dataSize, fb, deltaTilesTbl, fullCoverage);
         break;
     case scene_rdl2::grid_util::PackTiles::DataType::PIXELINFO :
         // pixelInfo
 #       ifdef DEBUG_DECODE_MSG
         std::cerr << ">> FbMsgMultiChans.cc decodeData() passE\n";
 #       endif // end DEBUG_DECODE_MSG
-        decodePixelInfo(name, data, dataSize, fb);
+        decodePixelInfo(name, data, dataSize, fb, deltaTilesTbl, fullCoverage);
         break;
     case scene_rdl2::grid_util::PackTiles::DataType::HEATMAP_WITH_NUMSAMPLE :
         // heatMap with numSample
 #       ifdef DEBUG_DECODE_MSG
         std::cerr << ">> FbMsgMultiChans.cc decodeData() passF\n";
 #       endif // end DEBUG_DECODE_MSG
-        decodeHeatMapWithNumSample(name, data, dataSize, fb);
+        decodeHeatMapWithNumSample(name, data, dataSize, fb, deltaTilesTbl, fullCoverage);
         break;
     case scene_rdl2::grid_util::PackTiles::DataType::HEATMAP :
         // heatMap only (not include numSample)
 #       ifdef DEBUG_DECODE_MSG
         std::cerr << ">> FbMsgMultiChans.cc decodeData() passG\n";
 #       endif // end DEBUG_DECODE_MSG
-        decodeHeatMap(name, data, dataSize, fb);
+        decodeHeatMap(name, data, dataSize, fb, deltaTilesTbl, fullCoverage);
         break;
     case scene_rdl2::grid_util::PackTiles::DataType::WEIGHT :
         // weight buffer
 #       ifdef DEBUG_DECODE_MSG
         std::cerr << ">> FbMsgMultiChans.cc decodeData() passH\n";
 #       endif // end DEBUG_DECODE_MSG
-        decodeWeight(name, data, dataSize, fb);
+        decodeWeight(name, data, dataSize, fb, deltaTilesTbl, fullCoverage);
         break;
     case scene_rdl2::grid_util::PackTiles::DataType::REFERENCE :
         // renderOutput reference AOVs (Beauty, Alpha, HeatMap, Weight, BeautyAux, AlphaAux)
@@ -510,7 +723,7 @@ FbMsgMultiChans::decodeData(const char* name,
 #       ifdef DEBUG_DECODE_MSG
         std::cerr << ">> FbMsgMultiChans.cc decodeData() passK\n";
 #       endif // end DEBUG_DECODE_MSG
-        decodeRenderOutputAOV(name, data, dataSize, fb);
+        decodeRenderOutputAOV(name, data, dataSize, fb, deltaTilesTbl, fullCoverage);
         break;
     }
     scene_rdl2::grid_util::PackTiles::debugMode(false);
@@ -522,7 +735,9 @@ FbMsgMultiChans::decodeData(const char* name,
 void
 FbMsgMultiChans::decodeBeautyWithNumSample(const void* data,
                                            const size_t dataSize,
-                                           scene_rdl2::grid_util::Fb& fb)
+                                           scene_rdl2::grid_util::Fb& fb,
+                                           std::vector<char>* deltaTilesTbl,
+                                           bool* fullCoverage)
 {
     scene_rdl2::fb_util::ActivePixels workActivePixels;
     bool activeDecodeAction {false};
@@ -556,17 +771,22 @@ FbMsgMultiChans::decodeBeautyWithNumSample(const void* data,
     if (!workActivePixels.isSameSize(fb.getActivePixels())) {
         // resolution changed, we should pick current workActivePixels
         fb.getActivePixels().copy(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, true, deltaTilesTbl);
     } else {
         // update activePixels info by OR bitmask operation
         (void)fb.getActivePixels().orOp(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, false, deltaTilesTbl);
     }
+    if (fullCoverage) *fullCoverage = isFullCoverage(workActivePixels, fb.getWidth(), fb.getHeight());
     mHasBeauty = true;
 }
 
 void
 FbMsgMultiChans::decodeBeauty(const void* data,
                               const size_t dataSize,
-                              scene_rdl2::grid_util::Fb& fb)
+                              scene_rdl2::grid_util::Fb& fb,
+                              std::vector<char>* deltaTilesTbl,
+                              bool* fullCoverage)
 {
     scene_rdl2::fb_util::ActivePixels workActivePixels;
     bool activeDecodeAction {false};
@@ -598,16 +818,21 @@ FbMsgMultiChans::decodeBeauty(const void* data,
     if (!workActivePixels.isSameSize(fb.getActivePixels())) {
         // resolution changed, we should pick current workActivePixels
         fb.getActivePixels().copy(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, true, deltaTilesTbl);
     } else {
         // update activePixels info by OR bitmask operation
         fb.getActivePixels().orOp(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, false, deltaTilesTbl);
     }
+    if (fullCoverage) *fullCoverage = isFullCoverage(workActivePixels, fb.getWidth(), fb.getHeight());
 }
 
 void
 FbMsgMultiChans::decodeBeautyOddWithNumSample(const void* data,
                                               const size_t dataSize,
-                                              scene_rdl2::grid_util::Fb& fb)
+                                              scene_rdl2::grid_util::Fb& fb,
+                                              std::vector<char>* deltaTilesTbl,
+                                              bool* fullCoverage)
 {
     scene_rdl2::fb_util::ActivePixels workActivePixels;
     bool activeDecodeAction {false};
@@ -644,17 +869,22 @@ FbMsgMultiChans::decodeBeautyOddWithNumSample(const void* data,
     if (!workActivePixels.isSameSize(fb.getActivePixelsRenderBufferOdd())) {
         // resolution changed, we should pick current workActivePixels.
         fb.getActivePixelsRenderBufferOdd().copy(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, true, deltaTilesTbl);
     } else {
         // update activePixels info by OR bitmask operation
         (void)fb.getActivePixelsRenderBufferOdd().orOp(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, false, deltaTilesTbl);
     }
+    if (fullCoverage) *fullCoverage = isFullCoverage(workActivePixels, fb.getWidth(), fb.getHeight());
     mHasRenderBufferOdd = true;
 }
 
 void
 FbMsgMultiChans::decodeBeautyOdd(const void* data,
                                  const size_t dataSize,
-                                 scene_rdl2::grid_util::Fb& fb)
+                                 scene_rdl2::grid_util::Fb& fb,
+                                 std::vector<char>* deltaTilesTbl,
+                                 bool* fullCoverage)
 {
     scene_rdl2::fb_util::ActivePixels workActivePixels;
     bool activeDecodeAction {false};
@@ -689,10 +919,13 @@ FbMsgMultiChans::decodeBeautyOdd(const void* data,
     if (!workActivePixels.isSameSize(fb.getActivePixelsRenderBufferOdd())) {
         // resolution changed, we should pick current workActivePixels.
         fb.getActivePixelsRenderBufferOdd().copy(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, true, deltaTilesTbl);
     } else {
         // update activePixels info by OR bitmask operation
         (void)fb.getActivePixelsRenderBufferOdd().orOp(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, false, deltaTilesTbl);
     }
+    if (fullCoverage) *fullCoverage = isFullCoverage(workActivePixels, fb.getWidth(), fb.getHeight());
     mHasRenderBufferOdd = true;
 }
 
@@ -700,7 +933,9 @@ void
 FbMsgMultiChans::decodePixelInfo(const char* name,
                                  const void *data,
                                  const size_t dataSize,
-                                 scene_rdl2::grid_util::Fb& fb)
+                                 scene_rdl2::grid_util::Fb& fb,
+                                 std::vector<char>* deltaTilesTbl,
+                                 bool* fullCoverage)
 {
     scene_rdl2::fb_util::ActivePixels workActivePixels;
     bool activeDecodeAction {false};
@@ -732,10 +967,13 @@ FbMsgMultiChans::decodePixelInfo(const char* name,
     if (!workActivePixels.isSameSize(fb.getActivePixelsPixelInfo())) {
         // resolution changed, we should pick current workActivePixels.
         fb.getActivePixelsPixelInfo().copy(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, true, deltaTilesTbl);
     } else {
         // update activePixels info by OR bitmask operation
         (void)fb.getActivePixelsPixelInfo().orOp(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, false, deltaTilesTbl);
     }
+    if (fullCoverage) *fullCoverage = isFullCoverage(workActivePixels, fb.getWidth(), fb.getHeight());
     mHasPixelInfo = true;
 }
     
@@ -743,7 +981,9 @@ void
 FbMsgMultiChans::decodeHeatMapWithNumSample(const char* name,
                                             const void *data,
                                             const size_t dataSize,
-                                            scene_rdl2::grid_util::Fb& fb)
+                                            scene_rdl2::grid_util::Fb& fb,
+                                            std::vector<char>* deltaTilesTbl,
+                                            bool* fullCoverage)
 {
     scene_rdl2::fb_util::ActivePixels workActivePixels;
     bool activeDecodeAction {false};
@@ -775,10 +1015,13 @@ FbMsgMultiChans::decodeHeatMapWithNumSample(const char* name,
     if (!workActivePixels.isSameSize(fb.getActivePixelsHeatMap())) {
         // resolution changed, we should pick current workActivePixels.
         fb.getActivePixelsHeatMap().copy(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, true, deltaTilesTbl);
     } else {
         // update activePixels info by OR bitmask operation
         (void)fb.getActivePixelsHeatMap().orOp(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, false, deltaTilesTbl);
     }
+    if (fullCoverage) *fullCoverage = isFullCoverage(workActivePixels, fb.getWidth(), fb.getHeight());
     mHasHeatMap = true;
 }
 
@@ -786,7 +1029,9 @@ void
 FbMsgMultiChans::decodeHeatMap(const char* name,
                                const void *data,
                                const size_t dataSize,
-                               scene_rdl2::grid_util::Fb& fb)
+                               scene_rdl2::grid_util::Fb& fb,
+                               std::vector<char>* deltaTilesTbl,
+                               bool* fullCoverage)
 {
     scene_rdl2::fb_util::ActivePixels workActivePixels;
     bool activeDecodeAction {false};
@@ -816,10 +1061,13 @@ FbMsgMultiChans::decodeHeatMap(const char* name,
     if (!workActivePixels.isSameSize(fb.getActivePixelsHeatMap())) {
         // resolution changed, we should pick current workActivePixels.
         fb.getActivePixelsHeatMap().copy(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, true, deltaTilesTbl);
     } else {
         // update activePixels info by OR bitmask operation
         (void)fb.getActivePixelsHeatMap().orOp(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, false, deltaTilesTbl);
     }
+    if (fullCoverage) *fullCoverage = isFullCoverage(workActivePixels, fb.getWidth(), fb.getHeight());
     mHasHeatMap = true;
 }
     
@@ -827,7 +1075,9 @@ void
 FbMsgMultiChans::decodeWeight(const char* name,
                               const void *data,
                               const size_t dataSize,
-                              scene_rdl2::grid_util::Fb& fb)
+                              scene_rdl2::grid_util::Fb& fb,
+                              std::vector<char>* deltaTilesTbl,
+                              bool* fullCoverage)
 {
     scene_rdl2::fb_util::ActivePixels workActivePixels;
     bool activeDecodeAction {false};
@@ -859,10 +1109,13 @@ FbMsgMultiChans::decodeWeight(const char* name,
     if (!workActivePixels.isSameSize(fb.getActivePixelsWeightBuffer())) {
         // resolution changed, we should pick current workActivePixels.
         fb.getActivePixelsWeightBuffer().copy(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, true, deltaTilesTbl);
     } else {
         // update activePixels info by OR bitmask operation
         (void)fb.getActivePixelsWeightBuffer().orOp(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, false, deltaTilesTbl);
     }
+    if (fullCoverage) *fullCoverage = isFullCoverage(workActivePixels, fb.getWidth(), fb.getHeight());
 }
     
 void
@@ -893,7 +1146,9 @@ void
 FbMsgMultiChans::decodeRenderOutputAOV(const char* name,
                                        const void *data,
                                        const size_t dataSize,
-                                       scene_rdl2::grid_util::Fb& fb)
+                                       scene_rdl2::grid_util::Fb& fb,
+                                       std::vector<char>* deltaTilesTbl,
+                                       bool* fullCoverage)
 {
     scene_rdl2::fb_util::ActivePixels workActivePixels;
     bool activeDecodeAction {false};
@@ -925,19 +1180,177 @@ FbMsgMultiChans::decodeRenderOutputAOV(const char* name,
     if (oldFmt != fbAov->getFormat() || !workActivePixels.isSameSize(fbAov->getActivePixels())) {
         // resolution/format changed, we should pick current workActivePixels
         fbAov->getActivePixels().copy(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, true, deltaTilesTbl);
     } else {
         // update activePixels information by OR bitmask operation
         (void)fbAov->getActivePixels().orOp(workActivePixels);
+        updateDeltaTilesTbl(workActivePixels, false, deltaTilesTbl);
     }
+    if (fullCoverage) *fullCoverage = isFullCoverage(workActivePixels, fb.getWidth(), fb.getHeight());
     mHasRenderOutput = true;
 }
 
+bool
+FbMsgMultiChans::applySubMergeAovNumSample(scene_rdl2::grid_util::Fb& fb)
+//
+// A sub-merge node sends renderOutput AOVs by the same encoding as the client output which does not
+// include numSample, and sends the numSample of each AOV by an additional SubMergeAovNumSample buffer.
+// This function applies all the queued SubMergeAovNumSample data in received order to the numSample
+// buffer of the decoded AOVs and releases them. Then the root merge accumulates each sub-merge result as
+// one machine weighted by the own numSample of each AOV. The queued data is simply released if this is
+// not the sub-merge input mode.
+//
+{
+    auto numSampleBuffFunc = [&](const std::string& aovName, const unsigned totalTiles) -> unsigned* {
+        if (!fb.findAov(aovName) || fb.getTotalTiles() != totalTiles) return nullptr;
+        FbAovShPtr fbAov = fb.getAov(aovName);
+        if (!fbAov->getStatus() ||
+            fbAov->getReferenceType() != scene_rdl2::grid_util::FbReferenceType::UNDEF) {
+            return nullptr; // reference type AOV does not have own data
+        }
+        return fbAov->getNumSampleBufferTiled().getData();
+    };
+
+    bool result = true;
+    for (size_t chanId = 0; chanId < mMsgArray.size(); ++chanId) {
+        FbMsgSingleChanShPtr& chan = mMsgArray[chanId];
+        if (!chan || mChanTbl[chanId].mKind != ChanKind::SUBMERGE_AOV_NUMSAMPLE) continue;
+
+        if (mSubMergeInput) {
+            const std::vector<DataPtr>& datas = chan->dataArray();
+            const std::vector<size_t>& dataSize = chan->dataSize();
+            for (size_t i = 0; i < datas.size(); ++i) {
+                std::string error;
+                if (!SubMergeAovNumSample::decode(datas[i].get(), dataSize[i], numSampleBuffFunc, error)) {
+                    std::cerr << ">> FbMsgMultiChans.cc applySubMergeAovNumSample() " << error << '\n';
+                    result = false;
+                }
+            }
+        }
+        mChanArena.release(chan); // remove data
+        chan.reset();
+    }
+    return result;
+}
+
+// static function
+bool
+FbMsgMultiChans::isCoalesceTarget(const void* data, const size_t dataSize)
+//
+// Return true if the data fully replaces the pixel values of the older data of the same buffer.
+//
+{
+    switch (scene_rdl2::grid_util::PackTiles::decodeDataType(data, dataSize)) {
+    case scene_rdl2::grid_util::PackTiles::DataType::REFERENCE : return false; // no pixel data
+    case scene_rdl2::grid_util::PackTiles::DataType::UNDEF : return false;
+    default : return true;
+    }
+}
+
+// static function
+bool
+FbMsgMultiChans::isFullCoverage(const scene_rdl2::fb_util::ActivePixels& workActivePixels,
+                                const unsigned width,
+                                const unsigned height)
+//
+// Return true if workActivePixels has all the pixels inside the width x height image.
+//
+{
+    const unsigned alignedWidth = (width + 7) & ~static_cast<unsigned>(7);
+    const unsigned alignedHeight = (height + 7) & ~static_cast<unsigned>(7);
+    if (workActivePixels.getAlignedWidth() != alignedWidth ||
+        workActivePixels.getAlignedHeight() != alignedHeight) {
+        return false; // resolution mismatch
+    }
+
+    const unsigned numTilesX = alignedWidth >> 3;
+    const unsigned numTilesY = alignedHeight >> 3;
+    for (unsigned tileY = 0; tileY < numTilesY; ++tileY) {
+        const unsigned validH = std::min(height - tileY * 8, 8U);
+        for (unsigned tileX = 0; tileX < numTilesX; ++tileX) {
+            const unsigned validW = std::min(width - tileX * 8, 8U);
+            const uint64_t rowMask = (validW == 8) ? 0xffULL : ((1ULL << validW) - 1ULL);
+            uint64_t validMask = 0x0ULL;
+            for (unsigned y = 0; y < validH; ++y) validMask |= (rowMask << (y * 8));
+
+            const uint64_t tileMask = workActivePixels.getTileMask(tileY * numTilesX + tileX);
+            if ((tileMask & validMask) != validMask) return false;
+        }
+    }
+    return true;
+}
+
+// static function
+void
+FbMsgMultiChans::updateDeltaTilesTbl(const scene_rdl2::fb_util::ActivePixels& workActivePixels,
+                                     const bool allTiles,
+                                     std::vector<char>* deltaTilesTbl)
+//
+// Set the tiles which have active pixels inside workActivePixels to the deltaTilesTbl.
+// All tiles are set if allTiles is true (i.e. resolution or format changed case).
+//
+{
+    if (!deltaTilesTbl) return;
+
+    const unsigned numTiles =
+        (workActivePixels.getAlignedWidth() >> 3) * (workActivePixels.getAlignedHeight() >> 3);
+    if (deltaTilesTbl->size() != numTiles) {
+        // Very first update (empty table) or resolution changed. All tiles are considered as updated
+        // if the resolution is changed.
+        const bool all = allTiles || !deltaTilesTbl->empty();
+        deltaTilesTbl->assign(numTiles, static_cast<char>(all));
+        if (all) return;
+    } else if (allTiles) {
+        std::fill(deltaTilesTbl->begin(), deltaTilesTbl->end(), static_cast<char>(true));
+        return;
+    }
+    for (unsigned tileId = 0; tileId < numTiles; ++tileId) {
+        if (workActivePixels.getTileMask(tileId)) (*deltaTilesTbl)[tileId] = static_cast<char>(true);
+    }
+}
+
+// static function
+void
+FbMsgMultiChans::orDeltaTilesTbl(const std::vector<char>& srcTbl, std::vector<char>& dstTbl)
+{
+    if (srcTbl.empty()) return; // no updated tiles
+
+    if (dstTbl.empty()) {
+        dstTbl = srcTbl;
+        return;
+    }
+    if (dstTbl.size() != srcTbl.size()) {
+        // resolution changed. We pick new size and all tiles are considered as updated.
+        dstTbl.assign(srcTbl.size(), static_cast<char>(true));
+        return;
+    }
+    for (size_t tileId = 0; tileId < srcTbl.size(); ++tileId) {
+        if (srcTbl[tileId]) dstTbl[tileId] = static_cast<char>(true);
+    }
+}
+
 void
 FbMsgMultiChans::parserConfigure()
 {
     mParser.description("FbMsgMultiChan command");
     mParser.opt("show", "", "show internal status. might be pretty long info",
                 [&](Arg& arg) -> bool { return arg.msg(show() + '\n'); });
+    mParser.opt("coalesce", "", "show coalescing decode info",
+                [&](Arg& arg) -> bool {
+                    return arg.fmtMsg("coalesceDecode:%s minQueue:%d skipTotal:%d probeMissTotal:%d\n",
+                                      scene_rdl2::str_util::boolStr(mCoalesceDecode).c_str(),
+                                      static_cast<int>(mCoalesceDecodeMinQueue),
+                                      static_cast<int>(mCoalesceSkipTotal),
+                                      static_cast<int>(mCoalesceProbeMissTotal));
+                });
+    mParser.opt("subMergeInput", "", "show sub-merge input mode",
+                [&](Arg& arg) -> bool {
+                    return arg.fmtMsg("subMergeInput %s\n", scene_rdl2::str_util::boolStr(mSubMergeInput).c_str());
+                });
+    mParser.opt("chanTbl", "", "show interned buffer name table",
+                [&](Arg& arg) -> bool { return arg.msg(showChanTbl() + '\n'); });
+    mParser.opt("chanArena", "", "show recycling arena info of channels",
+                [&](Arg& arg) -> bool { return arg.msg(mChanArena.show() + '\n'); });
 }
 
 } // namespace mcrt_dataio
@@ -9,6 +9,7 @@
 // all of them internally over the multiple ProgressiveFrame messages.
 //
 
+#include "FbMsgChanArena.h"
 #include "FbMsgSingleChan.h"
 
 #include <mcrt_messages/BaseFrame.h>
@@ -22,6 +23,7 @@
 
 #include <memory>               // shared_ptr
 #include <unordered_map>
+#include <vector>
 
 // Basically we should use multi-thread version.
 // This single thread mode is used debugging and performance comparison reason mainly.
@@ -30,6 +32,7 @@
 namespace scene_rdl2 {
     namespace rdl2 { class ValueContainerEnq; }
     namespace grid_util { class FbAov; }
+    namespace fb_util { class ActivePixels; }
 } // namespace scene_rdl2
 
 namespace mcrt_dataio {
@@ -67,7 +70,37 @@ public:
               scene_rdl2::grid_util::Fb &fb,
               const bool parallelExec = true,
               const bool skipLatencyLog = false);
-    void decodeAll(scene_rdl2::grid_util::Fb& fb, MergeActionTracker* mergeActionTracker);
+    void decodeAll(scene_rdl2::grid_util::Fb& fb,
+                   MergeActionTracker* mergeActionTracker,
+                   std::vector<char>* deltaTilesTbl = nullptr); // updated tiles by this decode : empty = none
+
+    // Coalescing of queued data under delay decode mode. If the queue of a buffer has at least
+    // coalesceDecodeMinQueue data and the newest data of the previous decodeAll() of this buffer covered
+    // all the pixels, the newest data is decoded first (probe). When the newest data covers all the pixels,
+    // older data is skipped because the newest data fully replaces them (latest-wins). Otherwise, all the
+    // data is decoded in order and the newest data is decoded again at the end. The probe is skipped when
+    // the previous newest data did not cover all the pixels, so a buffer which is never fully covered has
+    // the same decode cost as without coalescing. The decoded result is exactly the same as decoding all
+    // the data in order. Off by default and has to be turned on explicitly by setCoalesceDecode(true)
+    // (or the "coalesceDecode on" command of FbMsgSingleFrame).
+    void setCoalesceDecode(const bool flag) { mCoalesceDecode = flag; }
+    bool getCoalesceDecode() const { return mCoalesceDecode; }
+    void setCoalesceDecodeMinQueue(const size_t minQueue) { mCoalesceDecodeMinQueue = minQueue; }
+    size_t getCoalesceDecodeMinQueue() const { return mCoalesceDecodeMinQueue; }
+    uint64_t getCoalesceSkipTotal() const { return mCoalesceSkipTotal; }
+    uint64_t getCoalesceProbeMissTotal() const { return mCoalesceProbeMissTotal; }
+
+    // Queued image data under delay decode mode (used by the memory accounting).
+    size_t getQueuedByte() const;  // total byte of the queued data which are not decoded yet
+    size_t getQueuedDepth() const; // max number of the queued data of a single buffer
+
+    // Sub-merge input mode for the root merge of the hierarchical merge tree. The received data is the
+    // merged result of a sub-merge node which is sent by MergeFbSender::addSubMergeOutput(). The beauty
+    // and renderBufferOdd data include numSample. RenderOutput AOV data is encoded without numSample and
+    // the own numSample of each AOV is sent by a SubMergeAovNumSample buffer of the same message. This
+    // numSample is applied after the decode of all AOV data.
+    void setSubMergeInput(const bool flag) { mSubMergeInput = flag; }
+    bool getSubMergeInput() const { return mSubMergeInput; }
 
     float getProgress() const { return mProgress; }
     mcrt::BaseFrame::Status getStatus() const { return mStatus; }
@@ -94,6 +127,8 @@ public:
     std::string show() const;
     std::string showVecPacketInfo() const;
 
+    const FbMsgChanArena& getChanArena() const { return mChanArena; }
+
     Parser& getParser() { return mParser; }
 
 protected:
@@ -144,37 +179,115 @@ protected:
     // In this case, all received data is stored into mMsgArray and properly selected then decoded at
     // merge time.
     //
-    std::unordered_map<std::string, FbMsgSingleChanShPtr> mMsgArray;
+    // mMsgArray is indexed by the channel ID (see ChanInfo) and nullptr means no data for this channel.
+    //
+    std::vector<FbMsgSingleChanShPtr> mMsgArray; // mMsgArray[chanId]
+    FbMsgChanArena mChanArena; // recycling arena of mMsgArray's channel. survives over reset()
+
+    //
+    // Interned buffer name table.
+    // Each buffer name is resolved to a small integer channel ID only once per session and the kind of the
+    // buffer is precomputed at the same time. The table is rebuilt when the STARTED message arrives.
+    // Under the steady state, buffer names are resolved by mBufferChanIdCache with a single string compare
+    // and no hashing because each message has the same buffer order.
+    //
+    enum class ChanKind : char {
+        FB_DATA,
+        LATENCY_LOG,
+        LATENCY_LOG_UPSTREAM,
+        AUX_INFO,
+        VEC_PACKET,
+        SUBMERGE_AOV_NUMSAMPLE // per AOV numSample of the sub-merge output (see SubMergeAovNumSample)
+    };
+    struct ChanInfo {
+        std::string mName;
+        ChanKind mKind;
+        bool mLastFullCoverage {false}; // newest data of the last decodeAll() covered all the pixels
+    };
+    std::vector<ChanInfo> mChanTbl; // mChanTbl[chanId]
+    std::unordered_map<std::string, unsigned> mChanIdMap; // buffer name -> chanId
+    std::vector<unsigned> mBufferChanIdCache; // [bufferId] : chanId of the bufferId-th buffer of the last message
+
+    bool mCoalesceDecode {false};
+    size_t mCoalesceDecodeMinQueue {3};
+    uint64_t mCoalesceSkipTotal {0};      // total skipped data by coalescing
+    uint64_t mCoalesceProbeMissTotal {0}; // total newest data probe which did not cover all pixels
+
+    bool mSubMergeInput {false};
 
     Parser mParser;
 
     //------------------------------
 
+    void resetChanTbl();
+    unsigned resolveChanId(const size_t bufferId, const char* name);
+    static ChanKind calcChanKind(const char* name);
+    static std::string chanKindStr(const ChanKind kind);
+    std::string showChanTbl() const;
+
     bool pushBuffer(const bool delayDecode,
                     const bool skipLatencyLog,
-                    const char *name,
+                    const unsigned chanId,
                     DataPtr dataPtr,
                     const size_t dataSize,
                     scene_rdl2::grid_util::Fb &fb);
     void pushAuxInfo(const void *data, const size_t dataSize);
 
-    void decodeData(const char* name, const void* data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb);
-    void decodeBeautyWithNumSample(const void* data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb);
-    void decodeBeauty(const void* data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb);
-    void decodeBeautyOddWithNumSample(const void* data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb);
-    void decodeBeautyOdd(const void* data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb);
+    void decodeData(const char* name, const void* data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb,
+                    std::vector<char>* deltaTilesTbl = nullptr,
+                    bool* fullCoverage = nullptr);
+    void decodeBeautyWithNumSample(const void* data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb,
+                                   std::vector<char>* deltaTilesTbl = nullptr,
+                                   bool* fullCoverage = nullptr);
+    void decodeBeauty(const void* data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb,
+                      std::vector<char>* deltaTilesTbl = nullptr,
+                      bool* fullCoverage = nullptr);
+    void decodeBeautyOddWithNumSample(const void* data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb,
+                                      std::vector<char>* deltaTilesTbl = nullptr,
+                                      bool* fullCoverage = nullptr);
+    void decodeBeautyOdd(const void* data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb,
+                         std::vector<char>* deltaTilesTbl = nullptr,
+                         bool* fullCoverage = nullptr);
     void decodePixelInfo(const char* name,
-                         const void* data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb);
+                         const void* data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb,
+                         std::vector<char>* deltaTilesTbl = nullptr,
+                         bool* fullCoverage = nullptr);
     void decodeHeatMapWithNumSample(const char* name,
-                                    const void *data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb);
+                                    const void *data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb,
+                                    std::vector<char>* deltaTilesTbl = nullptr,
+                                    bool* fullCoverage = nullptr);
     void decodeHeatMap(const char* name,
-                       const void *data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb);
+                       const void *data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb,
+                       std::vector<char>* deltaTilesTbl = nullptr,
+                       bool* fullCoverage = nullptr);
     void decodeWeight(const char* name,
-                      const void *data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb);
+                      const void *data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb,
+                      std::vector<char>* deltaTilesTbl = nullptr,
+                      bool* fullCoverage = nullptr);
     void decodeReference(const char* name,
                          const void *data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb);
     void decodeRenderOutputAOV(const char* name,
-                               const void *data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb);
+                               const void *data, const size_t dataSize, scene_rdl2::grid_util::Fb& fb,
+                               std::vector<char>* deltaTilesTbl = nullptr,
+                               bool* fullCoverage = nullptr);
+
+    void decodeSingleChan(ChanInfo& chanInfo,
+                          const FbMsgSingleChan& singleChan,
+                          scene_rdl2::grid_util::Fb& fb,
+                          std::vector<char>* deltaTilesTbl,
+                          uint64_t& coalesceSkip,
+                          uint64_t& coalesceProbeMiss);
+    bool applySubMergeAovNumSample(scene_rdl2::grid_util::Fb& fb);
+
+    static bool isCoalesceTarget(const void* data, const size_t dataSize);
+    static bool isFullCoverage(const scene_rdl2::fb_util::ActivePixels& workActivePixels,
+                               const unsigned width,
+                               const unsigned height);
+
+    static void updateDeltaTilesTbl(const scene_rdl2::fb_util::ActivePixels& workActivePixels,
+                                    const bool allTiles,
+                                    std::vector<char>* deltaTilesTbl);
+    static void orDeltaTilesTbl(const std::vector<char>& srcTbl, std::vector<char>& dstTbl);
 
     void parserConfigure();
 }; // FbMsgMultiChans
@@ -200,7 +313,12 @@ FbMsgMultiChans::reset()
 
     mSnapshotStartTime = 0;     // initialize
 
-    mMsgArray.clear();
+    for (auto& chan : mMsgArray) {
+        if (chan) {
+            mChanArena.release(chan);
+            chan.reset();
+        }
+    }
 }
 
 } // namespace mcrt_dataio
@@ -7,6 +7,7 @@
 #include <scene_rdl2/scene/rdl2/ValueContainerDeq.h>
 
 #include <iomanip>
+#include <mutex>
 #include <sstream>
 
 //#define DEBUG_MSG_PUSH
@@ -20,7 +21,10 @@ FbMsgMultiFrames::initTotalCacheFrames(const size_t totalCacheFrames)
         mMergeType == MergeType::PICKUP_LATEST) {
         // This case, we don't use mPtrTable because mFbMsgMultiFrames is stable and only keep one item.
         mFbMsgMultiFrames.resize(1); // we don't need more than 1 in this case
+        mFbMsgMultiFrames[0].setFbPool(nullptr); // allocates all Fbs without pool
+        mFbPool.clear();
         mFbMsgMultiFrames[0].setGlobalNodeInfo(mGlobalNodeInfo);
+        mFbMsgMultiFrames[0].setMemAccountant(mMemAccountant);
         mFbMsgMultiFrames[0].setTunnelMachineIdStaged(mTunnelMachineId);
 
         mDisplaySyncFrameInitialize = false;
@@ -37,14 +41,18 @@ FbMsgMultiFrames::initTotalCacheFrames(const size_t totalCacheFrames)
 
         mPtrTable.resize(totalCacheFrames);
         for (size_t frameId = 0; frameId < mFbMsgMultiFrames.size(); ++frameId) {
+            mFbMsgMultiFrames[frameId].setFbPool(&mFbPool); // lazy Fb allocation by shared pool
             mFbMsgMultiFrames[frameId].setGlobalNodeInfo(mGlobalNodeInfo);
+            mFbMsgMultiFrames[frameId].setMemAccountant(mMemAccountant);
             mFbMsgMultiFrames[frameId].setTunnelMachineIdStaged(mTunnelMachineId);
             if (!mFbMsgMultiFrames[frameId].init(mNumMachines)) return false;
             if (!mFbMsgMultiFrames[frameId].initFb(mRezedViewport)) return false;
             mPtrTable[frameId] = &mFbMsgMultiFrames[frameId];
         }
+        mPtrTableTop = 0;
         mStartSyncFrameId = 0;
         mEndSyncFrameId = 0;
+        mEvictedEndSyncFrameId = 0;
 
         mDisplaySyncFrameInitialize = false;
         mDisplaySyncFrameId = 0;
@@ -67,6 +75,7 @@ FbMsgMultiFrames::initNumMachines(const int numMachines)
             mPtrTable[frameId] = &mFbMsgMultiFrames[frameId];
         }
     }
+    mPtrTableTop = 0;
 
     return true;
 }
@@ -110,6 +119,58 @@ FbMsgMultiFrames::changeTaskType(const FbMsgSingleFrame::TaskType &taskType)
     }
 }
 
+void
+FbMsgMultiFrames::changeDecodeMode(const FbMsgSingleFrame::DecodeMode &decodeMode)
+{
+    for (FbMsgSingleFrame &frame : mFbMsgMultiFrames) {
+        frame.changeDecodeMode(decodeMode);
+    }
+}
+
+void
+FbMsgMultiFrames::setMemAccountant(MergeMemAccountant* accountant)
+{
+    mMemAccountant = accountant;
+    for (FbMsgSingleFrame &frame : mFbMsgMultiFrames) {
+        frame.setMemAccountant(mMemAccountant);
+    }
+}
+
+void
+FbMsgMultiFrames::updateMemAccount()
+{
+    if (!mMemAccountant) return;
+
+    std::shared_lock<std::shared_mutex> lock(mPushMutex);
+    updateMemAccountMain();
+}
+
+void
+FbMsgMultiFrames::updateMemAccountMain()
+//
+// Should be called under the shared or exclusive lock of mPushMutex. All the frame stats are lock-free
+// snapshots (see FbMsgSingleFrame::getQueuedByte()) and this is safe to run concurrently with push().
+//
+{
+    if (!mMemAccountant) return;
+
+    size_t fbByte = 0;
+    size_t queuedByte = 0;
+    size_t trackerByte = 0;
+    for (const FbMsgSingleFrame &frame : mFbMsgMultiFrames) {
+        if (mMergeType != MergeType::SYNCID_LINEUP) fbByte += frame.getFbByte();
+        queuedByte += frame.getQueuedByte();
+        trackerByte += frame.getMergeActionTrackerByte();
+    }
+    if (mMergeType == MergeType::SYNCID_LINEUP) {
+        fbByte = mFbPool.getTotalByte(); // includes the pooled Fbs
+    }
+
+    mMemAccountant->setByte(MergeMemAccountant::Category::FB, fbByte);
+    mMemAccountant->setByte(MergeMemAccountant::Category::QUEUED_PAYLOAD, queuedByte);
+    mMemAccountant->setByte(MergeMemAccountant::Category::ACTION_TRACKER, trackerByte);
+}
+
 bool
 FbMsgMultiFrames::push(const mcrt::ProgressiveFrame &progressive,
                        const std::function<bool()>& feedbackInitCallBack)
@@ -138,9 +199,30 @@ FbMsgMultiFrames::push(const mcrt::ProgressiveFrame &progressive,
     case MergeType::PICKUP_LATEST: rt = push_pickupLatest(progressive, feedbackInitCallBack); break;
     case MergeType::SYNCID_LINEUP: rt = push_syncidLineup(progressive); break;
     }
+    if (rt) refreshMemAccount(progressive.mHeader.mFrameId);
     return rt;
 }
 
+void
+FbMsgMultiFrames::refreshMemAccount(const uint32_t syncFrameId)
+//
+// Update the accountant after each push() regardless of the merge type. Under SYNCID_LINEUP mode,
+// stale frames are dropped if the accountant is over budget.
+//
+{
+    if (!mMemAccountant) return;
+
+    {
+        std::shared_lock<std::shared_mutex> lock(mPushMutex);
+        updateMemAccountMain();
+    }
+
+    if (mMergeType == MergeType::SYNCID_LINEUP && mMemAccountant->isOverBudget()) {
+        std::unique_lock<std::shared_mutex> uniqueLock(mPushMutex);
+        applyMemPressure(syncFrameId);
+    }
+}
+
 void
 FbMsgMultiFrames::resetDisplayFbMsgSingleFrame()
 {
@@ -169,6 +251,9 @@ FbMsgMultiFrames::showPtrTableInfo(const std::string &hd) const
     ostr << hd << "  mStartSyncFrameId:" << mStartSyncFrameId << '\n';
     ostr << hd << "  mEndSyncFrameId:" << mEndSyncFrameId << '\n';
     ostr << hd << "  mDisplaySyncFrameId:" << mDisplaySyncFrameId << '\n';
+    ostr << hd << "  mPtrTableTop:" << mPtrTableTop << '\n';
+    ostr << hd << "  mCacheByteBudget:" << mCacheByteBudget << '\n';
+    ostr << hd << "  mEvictFrameTotal:" << mEvictFrameTotal << '\n';
     ostr << hd << "  mPtrTable (total:" << mPtrTable.size() << ") {\n";
     for (size_t i = 0; i < mPtrTable.size(); ++i) {
         ostr << hd << "    i:" << std::setw(2) << std::setfill('0') << i
@@ -197,25 +282,34 @@ FbMsgMultiFrames::push_seamlessCombine(const mcrt::ProgressiveFrame &progressive
 //    
 {
     uint32_t syncFrameId = progressive.mHeader.mFrameId;
-    
-    if (!mDisplaySyncFrameInitialize) {
-        // initialize start/end/display frameIds
-        mDisplaySyncFrameId = syncFrameId; // set syncFrameId as display for initial condition.
-        mDisplaySyncFrameInitialize = true;
-#       ifdef DEBUG_MSG_PUSH
-        std::cerr << ">+> FbMsg.cc FbMsgMultiFrames::push_seamlessCombine() INIT :"
-                  << " displaySyncFrameId:" << mDisplaySyncFrameId << std::endl;
-#       endif // end DEBUG_MSG_PUSH
 
-        /* Probably need to think about resetWholeHistory and resetAllReceivedMessagesCount
-           for seamless mode as well here. Work in progress Toshi. (Mar/11/2019)
-        */
-    }
-
-    if (mDisplaySyncFrameId < syncFrameId) {
-        mDisplaySyncFrameId = syncFrameId; // update display syncFrameId when get newer id
+    {
+        std::shared_lock<std::shared_mutex> lock(mPushMutex);
+        if (!mDisplaySyncFrameInitialize || mDisplaySyncFrameId < syncFrameId) {
+            lock.unlock();
+
+            // display syncFrameId update requires exclusive access
+            std::unique_lock<std::shared_mutex> uniqueLock(mPushMutex);
+            if (!mDisplaySyncFrameInitialize) {
+                // initialize start/end/display frameIds
+                mDisplaySyncFrameId = syncFrameId; // set syncFrameId as display for initial condition.
+                mDisplaySyncFrameInitialize = true;
+#               ifdef DEBUG_MSG_PUSH
+                std::cerr << ">+> FbMsg.cc FbMsgMultiFrames::push_seamlessCombine() INIT :"
+                          << " displaySyncFrameId:" << mDisplaySyncFrameId << std::endl;
+#               endif // end DEBUG_MSG_PUSH
+
+                /* Probably need to think about resetWholeHistory and resetAllReceivedMessagesCount
+                   for seamless mode as well here. Work in progress Toshi. (Mar/11/2019)
+                */
+            }
+            if (mDisplaySyncFrameId < syncFrameId) {
+                mDisplaySyncFrameId = syncFrameId; // update display syncFrameId when get newer id
+            }
+        }
     }
 
+    std::shared_lock<std::shared_mutex> lock(mPushMutex);
     FbMsgSingleFrame *currFbMsgSingleFrame = &mFbMsgMultiFrames[0]; // SEAMLESS_COMBINE mode only has 1 item
     if (!currFbMsgSingleFrame->push(progressive)) {
 #       ifdef DEBUG_MSG_PUSH
@@ -243,56 +337,68 @@ FbMsgMultiFrames::push_pickupLatest(const mcrt::ProgressiveFrame &progressive,
 //    
 {
     uint32_t syncFrameId = progressive.mHeader.mFrameId;
-    
-    if (!mDisplaySyncFrameInitialize) {
-        // initialize start/end/display frameIds
-        mDisplaySyncFrameId = syncFrameId; // set syncFrameId as display for initial condition.
-        mDisplaySyncFrameInitialize = true;
-#       ifdef DEBUG_MSG_PUSH
-        std::cerr << ">+> FbMsg.cc FbMsgMultiFrames::push_pickupLatest() INIT :"
-                  << " displaySyncFrameId:" << mDisplaySyncFrameId << std::endl;
-#       endif // end DEBUG_MSG_PUSH
-
-        FbMsgSingleFrame *currFbMsgSingleFrame = &mFbMsgMultiFrames[0]; // SEAMLESS_COMBINE only has 1 item
-        currFbMsgSingleFrame->resetWholeHistory(syncFrameId); // reset whole history
-        currFbMsgSingleFrame->resetAllReceivedMessagesCount();
-        currFbMsgSingleFrame->resetFeedback(*mFeedback);
-        if (!feedbackInitCallBack()) return false;
-    }
-
-    if (syncFrameId < mDisplaySyncFrameId) {
-        // We don't care about old message
-#       ifdef DEBUG_MSG_PUSH
-        std::cerr << ">+> FbMsg.cc FbMsgMultiFrames::push_pickupLatest() RM OLD :"
-                  << " syncFrameId:" << syncFrameId
-                  << " < mDisplaySyncFrameId:" << mDisplaySyncFrameId << std::endl;
-#       endif // end DEBUG_MSG_PUSH
-        return true;            // early exit
-    }
-
-    FbMsgSingleFrame *currFbMsgSingleFrame = &mFbMsgMultiFrames[0]; // PICKUP_LATEST mode only has 1 item
 
-    if (mDisplaySyncFrameId < syncFrameId) {
-        // We got new syncFrameId and need to work on this syncFrameId with full reset
-        mDisplaySyncFrameId = syncFrameId;
-        currFbMsgSingleFrame->resetWholeHistory(syncFrameId); // reset whole history
-        currFbMsgSingleFrame->resetAllReceivedMessagesCount();
-        currFbMsgSingleFrame->resetFeedback(*mFeedback);
-        if (!feedbackInitCallBack()) return false;
-#       ifdef DEBUG_MSG_PUSH
-        std::cerr << ">+> Fbmsg.cc FbMsgMultiFrames::push_pickupLatest() NEW-SYNCID :"
-                  << " mDisplaySyncFrameId:" << mDisplaySyncFrameId << std::endl;
-#       endif // end DEBUG_MSG_PUSH            
-    }
+    while (true) {
+        {
+            // Fast path : message for the current display syncFrameId is pushed under the shared lock
+            std::shared_lock<std::shared_mutex> lock(mPushMutex);
+            if (mDisplaySyncFrameInitialize) {
+                if (syncFrameId < mDisplaySyncFrameId) {
+                    // We don't care about old message
+#                   ifdef DEBUG_MSG_PUSH
+                    std::cerr << ">+> FbMsg.cc FbMsgMultiFrames::push_pickupLatest() RM OLD :"
+                              << " syncFrameId:" << syncFrameId
+                              << " < mDisplaySyncFrameId:" << mDisplaySyncFrameId << std::endl;
+#                   endif // end DEBUG_MSG_PUSH
+                    return true;            // early exit
+                }
+                if (syncFrameId == mDisplaySyncFrameId) {
+                    FbMsgSingleFrame *currFbMsgSingleFrame = &mFbMsgMultiFrames[0]; // only has 1 item
+                    if (!currFbMsgSingleFrame->push(progressive)) {
+#                       ifdef DEBUG_MSG_PUSH
+                        std::cerr << ">+> Fbmsg.cc FbMsgMultiFrames::push_pickupLatest() push() failed"
+                                  << std::endl;
+#                       endif // end DEBUG_MSG_PUSH
+                        return false; // failed to store progressive messages data
+                    }
+                    return true;
+                }
+            }
+        }
 
-    if (!currFbMsgSingleFrame->push(progressive)) {
-#       ifdef DEBUG_MSG_PUSH
-        std::cerr << ">+> Fbmsg.cc FbMsgMultiFrames::push_seamlessCombine() push() failed" << std::endl;
-#       endif // end DEBUG_MSG_PUSH
-        return false; // failed to store progressive messages data
+        //
+        // Slow path : initialize or switch to the new syncFrameId under the exclusive lock, then retry.
+        // Another thread might already finish the switch. So we have to check the condition again.
+        //
+        std::unique_lock<std::shared_mutex> uniqueLock(mPushMutex);
+        FbMsgSingleFrame *currFbMsgSingleFrame = &mFbMsgMultiFrames[0]; // PICKUP_LATEST mode only has 1 item
+        if (!mDisplaySyncFrameInitialize) {
+            // initialize start/end/display frameIds
+            mDisplaySyncFrameId = syncFrameId; // set syncFrameId as display for initial condition.
+            mDisplaySyncFrameInitialize = true;
+#           ifdef DEBUG_MSG_PUSH
+            std::cerr << ">+> FbMsg.cc FbMsgMultiFrames::push_pickupLatest() INIT :"
+                      << " displaySyncFrameId:" << mDisplaySyncFrameId << std::endl;
+#           endif // end DEBUG_MSG_PUSH
+
+            currFbMsgSingleFrame->resetWholeHistory(syncFrameId); // reset whole history
+            currFbMsgSingleFrame->resetAllReceivedMessagesCount();
+            currFbMsgSingleFrame->resetFeedback(*mFeedback);
+            if (!feedbackInitCallBack()) return false;
+
+        } else if (mDisplaySyncFrameId < syncFrameId) {
+            // We got new syncFrameId and need to work on this syncFrameId with full reset
+            mDisplaySyncFrameId = syncFrameId;
+            currFbMsgSingleFrame->resetWholeHistory(syncFrameId); // reset whole history
+            currFbMsgSingleFrame->resetAllReceivedMessagesCount();
+            currFbMsgSingleFrame->resetFeedback(*mFeedback);
+            if (!feedbackInitCallBack()) return false;
+#           ifdef DEBUG_MSG_PUSH
+            std::cerr << ">+> Fbmsg.cc FbMsgMultiFrames::push_pickupLatest() NEW-SYNCID :"
+                      << " mDisplaySyncFrameId:" << mDisplaySyncFrameId << std::endl;
+#           endif // end DEBUG_MSG_PUSH            
+        }
     }
-
-    return true;
 }
 
 bool
@@ -315,77 +421,164 @@ FbMsgMultiFrames::push_syncidLineup(const mcrt::ProgressiveFrame &progressive)
 //    
 {
     uint32_t syncFrameId = progressive.mHeader.mFrameId;
-    
-    if (!mDisplaySyncFrameInitialize) {
-        // initialize start/end/display frameIds
-        mStartSyncFrameId = syncFrameId;
-        mEndSyncFrameId = mStartSyncFrameId + static_cast<uint32_t>(mFbMsgMultiFrames.size()) - 1;
-        mDisplaySyncFrameId = mStartSyncFrameId; // set oldest frame as display for initial condition.
-        mDisplayFrame = getFbMsgSingleFrame(mDisplaySyncFrameId);
 
-        mDisplaySyncFrameInitialize = true;
+    {
+        std::shared_lock<std::shared_mutex> lock(mPushMutex);
+        if (!mDisplaySyncFrameInitialize || syncFrameId > mEndSyncFrameId) {
+            lock.unlock();
+
+            // pointer table update requires exclusive access
+            std::unique_lock<std::shared_mutex> uniqueLock(mPushMutex);
+            if (!mDisplaySyncFrameInitialize) {
+                // initialize start/end/display frameIds
+                mStartSyncFrameId = syncFrameId;
+                mEndSyncFrameId = mStartSyncFrameId + static_cast<uint32_t>(mFbMsgMultiFrames.size()) - 1;
+                mDisplaySyncFrameId = mStartSyncFrameId; // set oldest frame as display for initial condition.
+                mDisplayFrame = getFbMsgSingleFrame(mDisplaySyncFrameId);
+
+                mDisplaySyncFrameInitialize = true;
+
+#               ifdef DEBUG_MSG_PUSH
+                std::cerr << ">+> FbMsg.cc FbMsgMultiFrames::push_syncidLineup() INIT :"
+                          << " startSyncFrameId:" << mStartSyncFrameId
+                          << " endSyncFrameId:" << mEndSyncFrameId
+                          << " displaySyncFrameId:" << mDisplaySyncFrameId << std::endl;
+#               endif // end DEBUG_MSG_PUSH
+            }
 
-#       ifdef DEBUG_MSG_PUSH
-        std::cerr << ">+> FbMsg.cc FbMsgMultiFrames::push_syncidLineup() INIT :"
-                  << " startSyncFrameId:" << mStartSyncFrameId
-                  << " endSyncFrameId:" << mEndSyncFrameId
-                  << " displaySyncFrameId:" << mDisplaySyncFrameId << std::endl;
-#       endif // end DEBUG_MSG_PUSH
-    }
+            // Update FbMsgFrame pointer table
+            if (syncFrameId > mEndSyncFrameId) {
+                uint32_t shiftOffset = syncFrameId - mEndSyncFrameId;
 
-    // Early exit test
-    if (syncFrameId < mDisplaySyncFrameId) {
-        // We don't care about messages older than displaySyncFrameId
-#       ifdef DEBUG_MSG_PUSH
-        std::cerr << ">+> FbMsg.cc FbMsgMultiFrames::push_syncidLineup() RM OLD :"
-                  << " syncFrameId:" << syncFrameId
-                  << " < mDisplaySyncFrameId:" << mDisplaySyncFrameId << std::endl;
-#       endif // end DEBUG_MSG_PUSH
-        return true;            // early exit
+#               ifdef DEBUG_MSG_PUSH
+                std::cerr << ">+> FbMsg.cc FbMsgMultiFrames::push_syncidLineup() SHIFT "
+                          << " syncFrameId:" << syncFrameId
+                          << " shiftOffset:" << shiftOffset << std::endl;
+#               endif // end DEBUG_MSG_PUSH
+                shiftPtrTable(shiftOffset);
+            }
+        }
     }
 
-    // Update FbMsgFrame pointer table
-    if (syncFrameId > mEndSyncFrameId) {
-        uint32_t shiftOffset = syncFrameId - mEndSyncFrameId;
-
-#       ifdef DEBUG_MSG_PUSH
-        std::cerr << ">+> FbMsg.cc FbMsgMultiFrames::push_syncidLineup() SHIFT "
-                  << " syncFrameId:" << syncFrameId
-                  << " shiftOffset:" << shiftOffset << std::endl;
-#       endif // end DEBUG_MSG_PUSH
-        for (uint32_t i = 0; i < shiftOffset; ++i) {
-            shiftPtrTable();    // shift 1 sync frame advance.
+    bool readyAllUpdated = false;
+    {
+        std::shared_lock<std::shared_mutex> lock(mPushMutex);
+
+        // Early exit test
+        if (syncFrameId < mDisplaySyncFrameId || syncFrameId < mStartSyncFrameId ||
+            (mDisplaySyncFrameId < syncFrameId && syncFrameId <= mEvictedEndSyncFrameId)) {
+            // We don't care about messages older than displaySyncFrameId and messages of the evicted frames.
+            // (The table might be shifted by another thread after the above pointer table update)
+#           ifdef DEBUG_MSG_PUSH
+            std::cerr << ">+> FbMsg.cc FbMsgMultiFrames::push_syncidLineup() RM OLD :"
+                      << " syncFrameId:" << syncFrameId
+                      << " < mDisplaySyncFrameId:" << mDisplaySyncFrameId << std::endl;
+#           endif // end DEBUG_MSG_PUSH
+            return true;            // early exit
         }
-    }
 
-    FbMsgSingleFrame *currFbMsgSingleFrame = getFbMsgSingleFrame(syncFrameId);
-    bool prevReadyCondition = currFbMsgSingleFrame->isReadyAll(); // save previous status for condition check
-    if (!currFbMsgSingleFrame->push(progressive)) {
-#       ifdef DEBUG_MSG_PUSH
-        std::cerr << ">+> Fbmsg.cc FbMsgMultiFrames::push() currFbMsgSingleFrame->push() failed" << std::endl;
-#       endif // end DEBUG_MSG_PUSH
-        return false; // failed to store progressive messages data
+        FbMsgSingleFrame *currFbMsgSingleFrame = getFbMsgSingleFrame(syncFrameId);
+        if (!currFbMsgSingleFrame->push(progressive, &readyAllUpdated)) {
+#           ifdef DEBUG_MSG_PUSH
+            std::cerr << ">+> Fbmsg.cc FbMsgMultiFrames::push() currFbMsgSingleFrame->push() failed" << std::endl;
+#           endif // end DEBUG_MSG_PUSH
+            return false; // failed to store progressive messages data
+        }
     }
 
-    if (!prevReadyCondition && currFbMsgSingleFrame->isReadyAll()) {
-        // previous condition is OFF and current condition is ON.
-        // This means this timing is completed to received at least on message from all MCRT
-        // computations.
-        if (mDisplaySyncFrameId < syncFrameId) {
-                // If current syncFrameId is newer than mDisplaySyncFrameId, we should update
-                // displaySyncFrameId as current syncFrameId
+    if (readyAllUpdated) {
+        // This push completed to received at least on message from all MCRT computations.
+        std::unique_lock<std::shared_mutex> uniqueLock(mPushMutex);
+        if (mDisplaySyncFrameId < syncFrameId && syncFrameId <= mEndSyncFrameId) {
+            // If current syncFrameId is newer than mDisplaySyncFrameId, we should update
+            // displaySyncFrameId as current syncFrameId
             mDisplaySyncFrameId = syncFrameId;
             mDisplayFrame = getFbMsgSingleFrame(mDisplaySyncFrameId);
+            releaseOlderThanDisplayFrames();
         }
     }
 
-    return true;
+    if (mCacheByteBudget && mFbPool.getTotalByte() > mCacheByteBudget) {
+        std::unique_lock<std::shared_mutex> uniqueLock(mPushMutex);
+        applyCacheByteBudget(syncFrameId);
+    }
+
+    return true; // memory pressure is handled by refreshMemAccount()
+}
+
+void
+FbMsgMultiFrames::releaseOlderThanDisplayFrames()
+//
+// Frames which are older than the display frame never receive data anymore (messages older than
+// mDisplaySyncFrameId are ignored). Return their Fbs to the pool immediately instead of keeping them
+// until the ring buffer is shifted. Should be called under the exclusive lock.
+//
+{
+    for (uint32_t syncFrameId = mStartSyncFrameId; syncFrameId < mDisplaySyncFrameId; ++syncFrameId) {
+        FbMsgSingleFrame *ptr = getFbMsgSingleFrame(syncFrameId);
+        if (ptr->getAllocatedFbTotal() > 0) ptr->recycle(syncFrameId);
+    }
+}
+
+bool
+FbMsgMultiFrames::evictStaleFrame(const uint32_t syncFrameId)
+//
+// Drop the oldest frame between the display frame and syncFrameId (i.e. the frame which just received
+// the data) which still keeps data. The display frame and the frame of syncFrameId are never dropped.
+// Frames older than the display frame are already released by releaseOlderThanDisplayFrames().
+// All the frames up to the evicted one are considered as dropped and their later messages are ignored.
+// Return false if there is no frame to drop. Should be called under the exclusive lock.
+//
+{
+    const uint32_t startSyncFrameId = std::max(mDisplaySyncFrameId, mEvictedEndSyncFrameId) + 1;
+    for (uint32_t currSyncFrameId = startSyncFrameId; currSyncFrameId < syncFrameId; ++currSyncFrameId) {
+        FbMsgSingleFrame *ptr = getFbMsgSingleFrame(currSyncFrameId);
+        if (ptr->getAllocatedFbTotal() == 0 && ptr->getActiveMachines() == 0) continue;
+
+        dropOldFrameMessage(currSyncFrameId);
+        ptr->recycle(currSyncFrameId);
+        ptr->resetFeedback(false); // does not support feedback under SYNCID_LINEUP mode
+        mEvictedEndSyncFrameId = currSyncFrameId;
+        mEvictFrameTotal++;
+        return true;
+    }
+    return false;
+}
+
+void
+FbMsgMultiFrames::applyCacheByteBudget(const uint32_t syncFrameId)
+//
+// Drop the stale frames early until the total byte of the Fbs fits in the budget (see evictStaleFrame()).
+// Should be called under the exclusive lock.
+//
+{
+    mFbPool.shrink(mCacheByteBudget); // free the pooled Fbs first
+    while (mFbPool.getTotalByte() > mCacheByteBudget && evictStaleFrame(syncFrameId)) {
+        mFbPool.shrink(mCacheByteBudget);
+    }
+}
+
+void
+FbMsgMultiFrames::applyMemPressure(const uint32_t syncFrameId)
+//
+// The merge computation is over the memory budget. Free all the pooled Fbs and drop the stale frames
+// (see evictStaleFrame()) until the accountant is back in the budget. The accountant is updated after
+// each drop. Should be called under the exclusive lock.
+//
+{
+    mFbPool.clear();
+    updateMemAccountMain();
+    while (mMemAccountant->isOverBudget() && evictStaleFrame(syncFrameId)) {
+        mMemAccountant->countAction(MergeMemAccountant::Action::DROP_FRAME);
+        mFbPool.clear();
+        updateMemAccountMain();
+    }
 }
 
 void
-FbMsgMultiFrames::dropOldFrameMessage()
+FbMsgMultiFrames::dropOldFrameMessage(const uint32_t syncFrameId)
 {
-    std::cerr << ">> drop frame. (start syncFrameId:" << mStartSyncFrameId << ")" << std::endl;
+    std::cerr << ">> drop frame. (syncFrameId:" << syncFrameId << ")" << std::endl;
 }
     
 std::string
@@ -396,6 +589,9 @@ FbMsgMultiFrames::showPtrTable(const std::string &hd) const
     ostr << hd << "  mStartSyncFrameId:" << mStartSyncFrameId << '\n';
     ostr << hd << "  mEndSyncFrameId:" << mEndSyncFrameId << '\n';
     ostr << hd << "  mDisplaySyncFrameId:" << mDisplaySyncFrameId << '\n';
+    ostr << hd << "  mPtrTableTop:" << mPtrTableTop << '\n';
+    ostr << hd << "  fbPool totalByte:" << mFbPool.getTotalByte()
+         << " freeByte:" << mFbPool.getFreeByte() << " budget:" << mCacheByteBudget << '\n';
     ostr << hd << "  ptrTable (total:" << mPtrTable.size() << ") {\n";
     for (size_t i = 0; i < mPtrTable.size(); ++i) {
         ostr << hd << "    i:" << std::setw(2) << std::setfill('0') << i << '\n';
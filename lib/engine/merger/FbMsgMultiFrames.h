@@ -15,9 +15,20 @@
 // Actually we only use stream mode for arras_gui type application so far and multiframe
 // mode is not tested well by arras_vr yet.
 //
+// Under SYNCID_LINEUP mode, cached frames share the per-machine Fbs by FbMsgFbPool and each frame
+// only allocates the Fbs of the machines which actually sent data for its syncFrameId. The cached
+// frames are managed by a ring buffer of pointers and the total memory of the Fbs can be limited by
+// setCacheByteBudget(). If the budget is exceeded, the stale frames (between the display frame and the
+// frame which just received the data) are dropped early from the oldest one. Stale frames are also
+// dropped early when the MergeMemAccountant is over budget. The display frame is never dropped.
+//
 
+#include "FbMsgFbPool.h"
 #include "FbMsgSingleFrame.h"
 
+#include <algorithm>
+#include <shared_mutex>
+
 namespace mcrt_dataio {
 
 class GlobalNodeInfo;
@@ -44,7 +55,36 @@ public:
 
     bool changeMergeType(const MergeType type, const size_t totalCacheFrames);
     void changeTaskType(const FbMsgSingleFrame::TaskType &taskType);
-
+    void changeDecodeMode(const FbMsgSingleFrame::DecodeMode &decodeMode);
+
+    // Max total byte of the per-machine Fbs of all cached frames under SYNCID_LINEUP mode (estimated by
+    // FbMsgFbPool). 0 is unlimited. This budget is applied at the next push().
+    void setCacheByteBudget(const size_t byte) { mCacheByteBudget = byte; }
+    size_t getCacheByteBudget() const { return mCacheByteBudget; }
+    uint64_t getEvictFrameTotal() const { return mEvictFrameTotal; }
+    const FbMsgFbPool& getFbPool() const { return mFbPool; }
+
+    // Memory accounting and memory pressure control of all frames (nullptr : disabled).
+    // updateMemAccount() updates FB, QUEUED_PAYLOAD and ACTION_TRACKER categories of the accountant.
+    // The accountant is also updated by each push() for all merge types. updateMemAccount() is able to be
+    // called concurrently with push().
+    void setMemAccountant(MergeMemAccountant* accountant);
+    void updateMemAccount();
+
+    // push() is able to be called concurrently by multiple network receive threads. Messages of different
+    // machines are processed in parallel. Messages of the same machine are processed in the call order,
+    // so each machine's messages should be pushed by the same thread. The frame selection (syncFrameId
+    // switch, pointer table shift) is processed exclusively.
+    //
+    // The internal lock (mPushMutex) only serializes push() calls with each other. It is not held by the
+    // consumer side. The caller has to serialize all the push() calls against the following APIs by its
+    // own lock (e.g. the receive threads and the merge thread share a mutex, and the merge thread takes it
+    // exclusively while it runs these APIs).
+    //   - getDisplayFbMsgSingleFrame() and decodeAll()/merge() of the returned frame
+    //   - resetDisplayFbMsgSingleFrame()
+    //   - init*(), change*() and show*()
+    // getDisplayFbMsgSingleFrame() might switch to a newer frame and older frames might be recycled by
+    // push(), so the returned pointer is only valid until the next push().
     bool push(const mcrt::ProgressiveFrame &progressive, const std::function<bool()>& feedbackInitCallBack);
 
     FbMsgSingleFrame *getDisplayFbMsgSingleFrame() { return mDisplayFrame; }
@@ -64,11 +104,18 @@ protected:
     MergeType mMergeType {MergeType::PICKUP_LATEST};
     bool* mFeedback {nullptr};
 
+    FbMsgFbPool mFbPool; // shared by all frames under SYNCID_LINEUP mode. Should outlive mFbMsgMultiFrames
+    size_t mCacheByteBudget {0}; // 0 : unlimited
+    uint64_t mEvictFrameTotal {0}; // total frames which are dropped early by the byte budget
+    uint32_t mEvictedEndSyncFrameId {0}; // newest evicted syncFrameId. Messages for evicted frames are ignored
+    MergeMemAccountant* mMemAccountant {nullptr};
+
     std::vector<FbMsgSingleFrame> mFbMsgMultiFrames;
 
     uint32_t mStartSyncFrameId {0}; // oldest syncFrameId which keeps data in memory
     uint32_t mEndSyncFrameId {0};   // newest syncFrameId which keeps data in memory
-    std::vector<FbMsgSingleFrame *> mPtrTable; // pointer table to mFbMsgMultiFrames items
+    std::vector<FbMsgSingleFrame *> mPtrTable; // ring buffer of the pointers to mFbMsgMultiFrames items
+    size_t mPtrTableTop {0};                   // mPtrTable index of mStartSyncFrameId
 
     FbMsgSingleFrame *mDisplayFrame {nullptr};
     bool mDisplaySyncFrameInitialize {false};
@@ -76,40 +123,60 @@ protected:
 
     int* mTunnelMachineId {nullptr};
 
+    // Only used by push(). The consumer APIs are serialized with push() by the caller (see push()).
+    // Shared lock : push the message into the already selected frame (concurrent)
+    // Exclusive lock : update the frame selection (display syncFrameId, pointer table)
+    std::shared_mutex mPushMutex;
+
     bool push_seamlessCombine(const mcrt::ProgressiveFrame &progressive);
     bool push_pickupLatest(const mcrt::ProgressiveFrame &progressive,
                            const std::function<bool()>& feedbackInitCallBack);
     bool push_syncidLineup(const mcrt::ProgressiveFrame &progressive);
 
-    finline void shiftPtrTable();
+    finline void shiftPtrTable(const uint32_t shiftOffset);
+    void releaseOlderThanDisplayFrames();
+    bool evictStaleFrame(const uint32_t syncFrameId);
+    void applyCacheByteBudget(const uint32_t syncFrameId);
+    void applyMemPressure(const uint32_t syncFrameId);
+
+    void updateMemAccountMain();
+    void refreshMemAccount(const uint32_t syncFrameId);
 
     finline int getLocalSyncFrameId(const uint32_t syncFrameId) const;
     finline FbMsgSingleFrame *getFbMsgSingleFrame(const uint32_t syncFrameId);
 
-    void dropOldFrameMessage();
+    void dropOldFrameMessage(const uint32_t syncFrameId);
 
     std::string showPtrTable(const std::string &hd) const;
 }; // FbMsgMultiFrames
 
 finline void
-FbMsgMultiFrames::shiftPtrTable()
+FbMsgMultiFrames::shiftPtrTable(const uint32_t shiftOffset)
+//
+// Advance the ring buffer by shiftOffset syncFrameIds. Only the head index of the ring is moved and
+// the recycled entries are reset. The cost is O(min(shiftOffset, mPtrTable.size())).
+//
 {
-    FbMsgSingleFrame *ptr = mPtrTable[0];
-    if (!ptr) return;
-    if (ptr->getActiveMachines() > 0) dropOldFrameMessage();
+    const size_t tableSize = mPtrTable.size();
+    if (!tableSize || !shiftOffset) return;
+    const uint32_t recycleTotal = static_cast<uint32_t>(std::min(static_cast<size_t>(shiftOffset), tableSize));
 
-    size_t lastId = mPtrTable.size() - 1;
-    for (size_t i = 0; i < lastId; ++i) {
-        mPtrTable[i] = mPtrTable[i+1];
+    for (uint32_t i = 0; i < recycleTotal; ++i) {
+        FbMsgSingleFrame *ptr = mPtrTable[(mPtrTableTop + i) % tableSize];
+        if (ptr->getActiveMachines() > 0) dropOldFrameMessage(mStartSyncFrameId + i);
     }
 
-    ptr->resetWholeHistory(mEndSyncFrameId + 1); // reset whole history about new recycled entry
-    ptr->resetAllReceivedMessagesCount();
-    ptr->resetFeedback(false); // does not support feedback under SYNCID_LINEUP mode
-    mPtrTable[lastId] = ptr;
+    mPtrTableTop = (mPtrTableTop + shiftOffset) % tableSize;
+    mStartSyncFrameId += shiftOffset;
+    mEndSyncFrameId += shiftOffset;
+
+    for (uint32_t syncFrameId = mEndSyncFrameId - recycleTotal + 1; ; ++syncFrameId) {
+        FbMsgSingleFrame *ptr = getFbMsgSingleFrame(syncFrameId);
+        ptr->recycle(syncFrameId); // reset whole history about new recycled entry and release Fbs
+        ptr->resetFeedback(false); // does not support feedback under SYNCID_LINEUP mode
+        if (syncFrameId == mEndSyncFrameId) break;
+    }
 
-    mStartSyncFrameId++;
-    mEndSyncFrameId++;
     if (mDisplaySyncFrameId < mStartSyncFrameId) {
         // If displaySyncFrameId is wiped out, set oldest syncFrameId in the memory as display candidate
         mDisplaySyncFrameId = mStartSyncFrameId;
@@ -118,7 +185,7 @@ FbMsgMultiFrames::shiftPtrTable()
 
     /* useful debug message
     std::cerr << ">+> shiftPtrTable() start:" << mStartSyncFrameId
-              << " end:" << mEndSyncFrameId << "/last:" << mPtrTable[lastId]->getSyncId()
+              << " end:" << mEndSyncFrameId << "/last:" << getFbMsgSingleFrame(mEndSyncFrameId)->getSyncId()
               << " disp:" << mDisplaySyncFrameId << std::endl;
     */
 }
@@ -132,7 +199,7 @@ FbMsgMultiFrames::getLocalSyncFrameId(const uint32_t syncFrameId) const
 finline FbMsgSingleFrame *
 FbMsgMultiFrames::getFbMsgSingleFrame(const uint32_t syncFrameId)
 {
-    return mPtrTable[getLocalSyncFrameId(syncFrameId)];
+    return mPtrTable[(mPtrTableTop + getLocalSyncFrameId(syncFrameId)) % mPtrTable.size()];
 }
 
 } // namespace mcrt_dataio
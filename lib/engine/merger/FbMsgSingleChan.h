@@ -50,10 +50,14 @@ public:
         : mDataType {dataType}
     {}
 
-    finline void reset();
+    finline void reset(); // keep the capacity of the internal arrays for the next use
     finline bool push(DataPtr dataPtr, const size_t dataLength);
 
+    // Reset and change the dataType. Used when FbMsgChanArena recycles this channel.
+    finline void reuse(const DataType dataType);
+
     DataType getDataType() const { return mDataType; }
+    size_t getCapacity() const { return mDataArray.capacity(); } // message slot capacity
 
     // encode data and store into vContainerPush : used by latencyLog info
     void encode(scene_rdl2::rdl2::ValueContainerEnq &vContainerEnq) const;
@@ -70,7 +74,7 @@ public:
     static std::string dataTypeStr(const DataType type);
 
 protected:
-    const DataType mDataType {DataType::UNKNOWN};
+    DataType mDataType {DataType::UNKNOWN};
 
     //
     // We are keeping shared_ptr instead data itself here.
@@ -83,10 +87,17 @@ protected:
 finline void
 FbMsgSingleChan::reset()
 {
+    // We don't shrink arrays here. This channel is recycled by FbMsgChanArena and the array capacity
+    // only grows up to the high-water mark of the messages per merge cycle.
     mDataArray.clear();
-    mDataArray.shrink_to_fit();
     mDataSize.clear();
-    mDataSize.shrink_to_fit();
+}
+
+finline void
+FbMsgSingleChan::reuse(const DataType dataType)
+{
+    reset();
+    mDataType = dataType;
 }
 
 finline bool
@@ -1,10 +1,19 @@
 // Copyright 2023-2025 DreamWorks Animation LLC
 // SPDX-License-Identifier: Apache-2.0
 #include "FbMsgSingleFrame.h"
+#include "GlobalNodeInfo.h"
+#include "HdriTest.h"
+#include "MergeKernel.h"
 
 #include <scene_rdl2/common/grid_util/LatencyLog.h>
 #include <scene_rdl2/scene/rdl2/ValueContainerEnq.h>
 
+#include <tbb/parallel_invoke.h>
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 
@@ -28,6 +37,211 @@ FbMsgSingleFrame::changeTaskType(const TaskType &type)
     if (mTaskType == type) return;
 
     mTaskType = type;
+    mOccupiedTilesUnknown = true; // occupied tiles might not be tracked until the next frame
+}
+
+void
+FbMsgSingleFrame::changeDecodeMode(const DecodeMode &mode)
+{
+    if (mDecodeMode == mode) return;
+
+    decodeAll(); // decode all queued data if the current mode is DELAY
+
+    mDecodeMode = mode;
+    mOccupiedTilesUnknown = true; // decoded tiles by ONTHEFLY mode are not tracked
+    mDeltaTilesInvalid = true;    // next merge should be a full merge
+}
+
+void
+FbMsgSingleFrame::setIncrementalMerge(const bool flag)
+{
+    if (mIncrementalMerge == flag) return;
+
+    mIncrementalMerge = flag;
+    mDeltaTilesInvalid = true; // next merge should be a full merge
+    for (auto& currDeltaTilesTbl : mDeltaTilesTbl) {
+        currDeltaTilesTbl.clear();
+    }
+}
+
+void
+FbMsgSingleFrame::setCoalesceDecode(const bool flag)
+{
+    mCoalesceDecode = flag;
+    for (auto& currMessage : mMessage) {
+        currMessage.setCoalesceDecode(flag);
+    }
+}
+
+void
+FbMsgSingleFrame::setSubMergeInput(const bool flag)
+{
+    mSubMergeInput = flag;
+    for (auto& currMessage : mMessage) {
+        currMessage.setSubMergeInput(flag);
+    }
+}
+
+void
+FbMsgSingleFrame::setSparseMerge(const bool flag)
+{
+    if (mSparseMerge == flag) return;
+
+    mSparseMerge = flag;
+    if (mSparseMerge) {
+        mOccupiedTilesUnknown = true; // decoded tiles before this call are not tracked
+    }
+}
+
+void
+FbMsgSingleFrame::setCompactTileSet(const bool flag)
+{
+    mCompactTileSet = flag;
+    for (auto& currMergeActionTracker : mMergeActionTracker) {
+        currMergeActionTracker.setCompactTileSet(flag);
+    }
+}
+
+FbMsgSingleFrame::FbMemStats
+FbMsgSingleFrame::getFbMemStats() const
+{
+    FbMemStats stats;
+    for (size_t machineId = 0; machineId < mFb.size(); ++machineId) {
+        if (!mFb[machineId]) continue;
+        const scene_rdl2::grid_util::Fb& currFb = *mFb[machineId];
+        const size_t fbByte = FbMsgFbPool::calcFbByte(currFb);
+        const size_t totalTiles = currFb.getTotalTiles();
+
+        size_t occupiedTiles = totalTiles; // all tiles if not tracked
+        const std::vector<char>& occupiedTbl = mOccupiedTilesTbl[machineId];
+        if (isSparseMergeActive() && !mOccupiedTilesUnknown && occupiedTbl.size() == totalTiles) {
+            occupiedTiles = std::count(occupiedTbl.begin(), occupiedTbl.end(), static_cast<char>(true));
+        }
+
+        stats.mAllocatedFbTotal++;
+        stats.mDenseByte += fbByte;
+        stats.mTotalTiles += totalTiles;
+        stats.mOccupiedTilesTotal += occupiedTiles;
+    }
+    stats.mSparseSkipTilesTotal = mSparseSkipTilesTotal;
+    return stats;
+}
+
+size_t
+FbMsgSingleFrame::getFbByte() const
+{
+    size_t total = 0;
+    for (const auto& currStat : mMachineMemStat) total += currStat.mFbByte.load();
+    return total;
+}
+
+size_t
+FbMsgSingleFrame::getQueuedByte() const
+{
+    size_t total = 0;
+    for (const auto& currStat : mMachineMemStat) total += currStat.mQueuedByte.load();
+    return total;
+}
+
+size_t
+FbMsgSingleFrame::getQueuedDepthMax() const
+{
+    size_t depth = 0;
+    for (const auto& currStat : mMachineMemStat) depth = std::max(depth, currStat.mQueuedDepth.load());
+    return depth;
+}
+
+size_t
+FbMsgSingleFrame::getMergeActionTrackerByte() const
+//
+// The modification of the MergeActionTracker through getMergeActionTracker() is reflected at the next
+// update of this machine's snapshot (i.e. next push, decode or merge).
+//
+{
+    size_t total = 0;
+    for (const auto& currStat : mMachineMemStat) total += currStat.mTrackerByte.load();
+    return total;
+}
+
+void
+FbMsgSingleFrame::setFbPool(FbMsgFbPool* fbPool)
+{
+    if (mFbPool == fbPool) return;
+
+    releaseFb();
+    for (auto& currFb : mFb) currFb.reset(); // Fbs which are not managed by the new fbPool
+    mFbPool = fbPool;
+    if (!mFbPool) {
+        for (size_t machineId = 0; machineId < mFb.size(); ++machineId) {
+            allocFb(machineId);
+            updateMachineMemStat(machineId);
+        }
+    }
+    resetWholeHistory(0);
+    resetAllReceivedMessagesCount();
+}
+
+size_t
+FbMsgSingleFrame::getAllocatedFbTotal() const
+{
+    size_t total = 0;
+    for (const auto& currFb : mFb) {
+        if (currFb) total++;
+    }
+    return total;
+}
+
+void
+FbMsgSingleFrame::recycle(const uint32_t syncId)
+{
+    resetWholeHistory(syncId);
+    resetAllReceivedMessagesCount();
+    releaseFb();
+    for (size_t machineId = 0; machineId < mMachineMemStat.size(); ++machineId) updateMachineMemStat(machineId);
+}
+
+void
+FbMsgSingleFrame::setPartialMergeFocusViewport(const scene_rdl2::math::Viewport& roi)
+{
+    mPartialMergeFocusRoi = true;
+    mPartialMergeFocusViewport = roi;
+    mPartialMergeTileWeight.clear(); // need to update
+}
+
+void
+FbMsgSingleFrame::resetPartialMergeFocusViewport()
+{
+    mPartialMergeFocusRoi = false;
+    mPartialMergeTileWeight.clear(); // need to update
+}
+
+void
+FbMsgSingleFrame::setPartialMergeFocusGain(const float gain)
+{
+    mPartialMergeFocusGain = std::max(gain, 0.0f);
+    mPartialMergeTileWeight.clear(); // need to update
+}
+
+void
+FbMsgSingleFrame::setDirtyTilesTracking(const bool flag)
+{
+    if (mDirtyTilesTracking == flag) return;
+
+    mDirtyTilesTracking = flag;
+    mDeltaTilesInvalid = true; // we don't know the updated tiles until the next merge
+    mMergedDirtyTilesAll = true;
+    for (auto& currDeltaTilesTbl : mDeltaTilesTbl) {
+        currDeltaTilesTbl.clear();
+    }
+}
+
+void
+FbMsgSingleFrame::setBeautyHdriTileCount(const bool flag)
+{
+    if (mBeautyHdriTileCount == flag) return;
+
+    mBeautyHdriTileCount = flag;
+    mBeautyHdriTileCountValid = false; // we don't know the HDRI pixel count until the next merge
 }
 
 void
@@ -43,11 +257,52 @@ FbMsgSingleFrame::resetFeedback(const bool feedbackActive)
     for (auto& currMergeActionTracker: mMergeActionTracker) {
         currMergeActionTracker.resetEncode(); // free previous memory and reset all
     }
+    for (size_t machineId = 0; machineId < mMachineMemStat.size(); ++machineId) updateMachineMemStat(machineId);
+    mFeedbackTileDeltaTracker.invalidateAll(); // MCRT side feedback Fb is not trusted anymore
+}
+
+void
+FbMsgSingleFrame::setFeedbackTileDelta(const bool flag)
+{
+    if (mFeedbackTileDelta == flag) return;
+
+    mFeedbackTileDelta = flag;
+    mFeedbackTileDeltaTracker.invalidateAll(); // we don't know the updated tiles until the next feedback
+}
+
+const std::vector<char>*
+FbMsgSingleFrame::calcFeedbackDeltaTiles(const unsigned machineId)
+{
+    if (!mFeedbackTileDelta) return nullptr;
+    return mFeedbackTileDeltaTracker.calcDeltaTiles(machineId);
+}
+
+void
+FbMsgSingleFrame::feedbackSent(const unsigned machineId)
+{
+    if (!mFeedbackTileDelta) return;
+
+    mFeedbackTileDeltaTracker.markSent(machineId);
+    if (mGlobalNodeInfo) {
+        mGlobalNodeInfo->setMergeFeedbackTileDeltaRatio(mFeedbackTileDeltaTracker.getSentTilesRatio());
+    }
 }
 
 bool
-FbMsgSingleFrame::push(const mcrt::ProgressiveFrame &progressive)
+FbMsgSingleFrame::push(const mcrt::ProgressiveFrame &progressive, bool* readyAllUpdated)
+//
+// This function is able to be called concurrently by multiple threads (i.e. network receive threads).
+// The message decode/store is processed under the per-machine lock and different machines' messages are
+// processed in parallel. The data shared by all machines is updated under the short aggregate lock.
+// Messages from the same machine are processed in the order of the call. This means the caller should
+// push messages of a particular machine from a single thread (or keep the order by itself).
+// Other APIs should not be called concurrently with push().
+//
+// readyAllUpdated is set to true when this push completes receiving data from all MCRT computations.
+//
 {
+    if (readyAllUpdated) *readyAllUpdated = false;
+
     const int currMachineId = progressive.mMachineId;
     if (currMachineId < 0 || static_cast<int>(mMessage.size()) <= currMachineId) {
         return false; // out of machineId range
@@ -55,18 +310,37 @@ FbMsgSingleFrame::push(const mcrt::ProgressiveFrame &progressive)
 
     const bool delayDecode = (mDecodeMode == DecodeMode::DELAY)? true: false;
 
+    std::lock_guard<std::mutex> machineLock(mIngestLock.getMachineMutex(currMachineId));
+
 #   ifdef DEBUG_TIMING_LOG
     uint64_t cMicroSec = 0;
     if (currMachineId == 0) cMicroSec = getCurrentMicroSec();        
 #   endif // end DEBUG_TIMING_LOG
 
-    if (!mMessage[currMachineId].push(delayDecode, progressive, mFb[currMachineId])) {
+    if (!mFb[currMachineId]) {
+        // lazy Fb mode : very first data of this machine for this frame
+        try {
+            allocFb(currMachineId);
+        }
+        catch (...) {
+            return false; // could not allocate fb
+        }
+    }
+    if (!mMessage[currMachineId].push(delayDecode, progressive, *mFb[currMachineId])) {
         return false; // error
     }
-
-    if (mMessage[currMachineId].hasVecPacket()) {
-        mHasVecPacket = true;
-        /* for debug
+    if (delayDecode && isMemPressure() &&
+        mMessage[currMachineId].getQueuedDepth() >= mMemPressureDecodeDepth) {
+        // Under memory pressure, we don't keep the queued data until the next decodeAll().
+        // Only this machine's data is decoded here under the per-machine lock.
+        decodeSingleMachine(currMachineId);
+        mMemAccountant->countAction(MergeMemAccountant::Action::COALESCE);
+    } else {
+        updateMachineMemStat(currMachineId);
+    }
+    const bool hasVecPacket = mMessage[currMachineId].hasVecPacket();
+    /* for debug
+    if (hasVecPacket) {
         std::cerr << ">> FbMsgSingleFrame.cc push()"
                   << " hasVecPacket=ON"
                   << " currMachineId:" << currMachineId
@@ -74,8 +348,8 @@ FbMsgSingleFrame::push(const mcrt::ProgressiveFrame &progressive)
                   << " progressive.SnapshotId:" << progressive.mSnapshotId
                   << " progressive.mSendImageActionId:" << progressive.mSendImageActionId
                   << "\n";
-        */
     }
+    */
 
 #   ifdef DEBUG_TIMING_LOG
     if (currMachineId == 0) {
@@ -87,12 +361,20 @@ FbMsgSingleFrame::push(const mcrt::ProgressiveFrame &progressive)
         //
         // Special progressiveFrame data which does not include image information
         //
+        std::lock_guard<std::mutex> aggregateLock(mIngestLock.getAggregateMutex());
+        if (hasVecPacket) mHasVecPacket = true;
         mReceivedInfoOnlyMessagesTotal++;
         mReceivedInfoOnlyMessagesAll++;
         return true;
     }
 
-    if (progressive.getStatus() == mcrt::BaseFrame::STARTED) {
+    //------------------------------
+    //
+    // per-machine information update
+    //
+    const bool startedStatus = (progressive.getStatus() == mcrt::BaseFrame::STARTED);
+    const bool prevReceivedAll = mReceivedAll[currMachineId];
+    if (startedStatus) {
         //
         // This is very first snapshot of current rendering frame on single frame mode.
         // Also we need to reset about whole iteration status.
@@ -102,9 +384,6 @@ FbMsgSingleFrame::push(const mcrt::ProgressiveFrame &progressive)
         //
 
         // reset whole iteration related information
-        if (mReceivedAll[currMachineId]) {
-            mActiveMachines--;  // We need to reset condition (subtract 1 from total) regarding this machineId
-        }
         mReceivedAll[currMachineId] = static_cast<char>(false); // reset condition to false
 
         mReceivedMessagesTotalAll[currMachineId] = 0; // reset
@@ -114,44 +393,16 @@ FbMsgSingleFrame::push(const mcrt::ProgressiveFrame &progressive)
 
         mCoarsePassAll[currMachineId] = static_cast<char>(true); // reset condition to coarse pass
 
-        // update denoiser albedo/normal input name
-        if (mDenoiserAlbedoInputName.empty() && progressive.mDenoiserAlbedoInputName.size()) {
-            mDenoiserAlbedoInputName = progressive.mDenoiserAlbedoInputName;
-        }
-        if (mDenoiserNormalInputName.empty() && progressive.mDenoiserNormalInputName.size()) {
-            mDenoiserNormalInputName = progressive.mDenoiserNormalInputName;
-        }
-
-        // update tunnelMachineIdRuntime when the new render started
-        mTunnelMachineIdRuntime = (mTunnelMachineIdStaged) ? (*mTunnelMachineIdStaged) : -1;
-        if (mTunnelMachineIdRuntime >= 0) {
-            std::cerr << "TunnelMahcineIdRuntime:" << mTunnelMachineIdRuntime << '\n';
-        }
-
     } else if (progressive.getStatus() == mcrt::BaseFrame::FINISHED) {
 #       ifdef DEBUG_MSG
         std::cerr << ">> FbMsgSingleFrame.cc push mId:" << currMachineId << " FINISHED" << std::endl;
 #       endif // end DEBUG_MSG
     }
-    mReceivedMessagesTotal++;   // increment total received message count
-    mReceivedMessagesAll++;
-
-    /* useful debug message
-    std::cerr << ">> FbMsgSingleFrame.cc"
-              << " mySyncId:" << mMySyncId
-              << " currMachineId:" << currMachineId
-              << " receivedMessateTotal:" << mReceivedMessagesTotal << std::endl;
-    */
 
-    // update received condition flag and total active machine info
+    // update received condition flag
     mReceived[currMachineId] = static_cast<char>(true);
-    if (!mReceivedAll[currMachineId]) {
-        mReceivedAll[currMachineId] = static_cast<char>(true);
-        mActiveMachines++;
-        if (mActiveMachines == 1) {
-            mFirstMachineId = currMachineId; // This is a very first data to receive
-        }
-    }
+    const bool newReceivedAll = !mReceivedAll[currMachineId];
+    mReceivedAll[currMachineId] = static_cast<char>(true);
 
     // GarbageCollect status tracking
     mReceivedMessagesTotalAll[currMachineId]++;
@@ -181,6 +432,56 @@ FbMsgSingleFrame::push(const mcrt::ProgressiveFrame &progressive)
         }
     }
 
+    //------------------------------
+    //
+    // aggregate information update
+    //
+    std::lock_guard<std::mutex> aggregateLock(mIngestLock.getAggregateMutex());
+
+    if (hasVecPacket) mHasVecPacket = true;
+
+    if (startedStatus) {
+        if (prevReceivedAll) {
+            mActiveMachines--;  // We need to reset condition (subtract 1 from total) regarding this machineId
+        }
+
+        // This machine's fb was reset and previous merge result is not valid anymore.
+        mDeltaTilesInvalid = true;
+        resetPartialMergeTilesPriority();
+
+        // update denoiser albedo/normal input name
+        if (mDenoiserAlbedoInputName.empty() && progressive.mDenoiserAlbedoInputName.size()) {
+            mDenoiserAlbedoInputName = progressive.mDenoiserAlbedoInputName;
+        }
+        if (mDenoiserNormalInputName.empty() && progressive.mDenoiserNormalInputName.size()) {
+            mDenoiserNormalInputName = progressive.mDenoiserNormalInputName;
+        }
+
+        // update tunnelMachineIdRuntime when the new render started
+        mTunnelMachineIdRuntime = (mTunnelMachineIdStaged) ? (*mTunnelMachineIdStaged) : -1;
+        if (mTunnelMachineIdRuntime >= 0) {
+            std::cerr << "TunnelMahcineIdRuntime:" << mTunnelMachineIdRuntime << '\n';
+        }
+    }
+    mReceivedMessagesTotal++;   // increment total received message count
+    mReceivedMessagesAll++;
+
+    /* useful debug message
+    std::cerr << ">> FbMsgSingleFrame.cc"
+              << " mySyncId:" << mMySyncId
+              << " currMachineId:" << currMachineId
+              << " receivedMessateTotal:" << mReceivedMessagesTotal << std::endl;
+    */
+
+    // update total active machine info
+    if (newReceivedAll) {
+        mActiveMachines++;
+        if (mActiveMachines == 1) {
+            mFirstMachineId = currMachineId; // This is a very first data to receive
+        }
+        if (readyAllUpdated && isReadyAll()) *readyAllUpdated = true;
+    }
+
     // update progress value table
     if (mTunnelMachineIdRuntime < 0 ||
         (mTunnelMachineIdRuntime >= 0 && mTunnelMachineIdRuntime == currMachineId)) {
@@ -229,9 +530,17 @@ FbMsgSingleFrame::merge(const unsigned partialMergeTilesTotal,
     //
     // garbage collection 
     //
+    const bool memPressure = isMemPressure();
     for (size_t machineId = 0; machineId < static_cast<size_t>(mNumMachines); ++machineId) {
         if (!mReceived[machineId]) continue;
 
+        if (memPressure && !mGarbageCollectReady[machineId]) {
+            // We don't wait for the heuristic condition of push() under memory pressure
+            mGarbageCollectReady[machineId] = static_cast<char>(true);
+            mGarbageCollectCompleted[machineId] = static_cast<char>(false);
+            mMemAccountant->countAction(MergeMemAccountant::Action::FORCE_GC);
+        }
+
         // Garbage Collection for fb data
         if (mGarbageCollectReady[machineId]) {
             // We are ready to do garbage collection for fb.
@@ -239,8 +548,9 @@ FbMsgSingleFrame::merge(const unsigned partialMergeTilesTotal,
 #               ifdef DEBUG_MSG
                 std::cerr << "FbMsgSingleFrame.cc garbageCollectUnusedBuffers() " << machineId << std::endl;
 #               endif // end DEBUG_MSG
-                mFb[machineId].garbageCollectUnusedBuffers();
+                mFb[machineId]->garbageCollectUnusedBuffers();
                 mGarbageCollectCompleted[machineId] = static_cast<char>(true);
+                updateMachineMemStat(machineId);
             }
         }
     }
@@ -253,7 +563,7 @@ FbMsgSingleFrame::merge(const unsigned partialMergeTilesTotal,
     for (size_t machineId = 0; machineId < static_cast<size_t>(mNumMachines); ++machineId) {
         if (!mReceivedAll[machineId]) continue;
 
-        if (fb.getRezedViewport() != mFb[machineId].getRezedViewport()) {
+        if (fb.getRezedViewport() != mFb[machineId]->getRezedViewport()) {
             // resolution mismatch between received fb reso and output fb reso
             // viewport message is not received yet ? We can not process this data anyway.
             return;             // skip combine
@@ -272,18 +582,74 @@ FbMsgSingleFrame::merge(const unsigned partialMergeTilesTotal,
     //
     // Merge all current MCRT's receive fb into one image
     //
-    if (mMergeCountTotal == 0) {
+    const bool firstMerge = (mMergeCountTotal == 0);
+    if (firstMerge) {
         // Very first received data need to be processed without partialMerge mode.
         mergeFirstFb(fb, latencyLog);
     }
 
+    // Updated tiles by decode since the last merge. This is used by both of incremental merge and
+    // dirty tiles tracking.
+    const bool deltaTilesValid = isDeltaTilesValid(fb);
+    if (deltaTilesValid) deltaTilesUnionGen(fb.getTotalTiles());
+
+    // Partial merge tiles total might be decided by the closed-loop controller
+    unsigned currPartialMergeTilesTotal = partialMergeTilesTotal;
+    if (partialMergeTilesTotal != 0 && mPartialMergeBudgetControl) {
+        currPartialMergeTilesTotal =
+            mPartialMergeTilesController.getTilesTotal(fb.getTotalTiles(), partialMergeTilesTotal);
+    }
+    if (currPartialMergeTilesTotal != 0 && mLastMergeFb != &fb) {
+        // Not-merged tiles of fb are not the previous merge result. We need a full merge.
+        currPartialMergeTilesTotal = 0;
+    }
+
+    beautyHdriTileCountPrep(fb, firstMerge);
+
     // Will merge all of the packet which received.
-    if (partialMergeTilesTotal == 0) {
-        mergeAllFb(fb, latencyLog);
+    const std::vector<char>* mergedTilesTbl = nullptr; // merged tiles by this merge. nullptr : all tiles
+    if (currPartialMergeTilesTotal == 0) {
+        if (mIncrementalMerge && deltaTilesValid) {
+            mergeDeltaFb(fb, latencyLog);
+            if (mDeltaTilesUnionTotal != fb.getTotalTiles()) mergedTilesTbl = &mDeltaTilesUnionTbl;
+        } else {
+            mergeAllFb(fb, latencyLog);
+        }
     } else {
-        mergeAllFb(partialMergeTilesTotal, fb, latencyLog);
+        mergeAllFb(currPartialMergeTilesTotal, fb, latencyLog);
+        mergedTilesTbl = &mPartialMergeTilesTbl;
+        if (mPartialMergeBudgetControl) {
+            mPartialMergeTilesController.update(currPartialMergeTilesTotal,
+                                                mLastPartialMergeFbResetMs,
+                                                mLastPartialMergeAccumulateMs);
+            if (mGlobalNodeInfo) {
+                mGlobalNodeInfo->setMergePartialMergeTiles(static_cast<int>(currPartialMergeTilesTotal));
+                mGlobalNodeInfo->setMergePartialMergeCost(mPartialMergeTilesController.getLastCostMs());
+            }
+        }
     }
     mMergeCountTotal++;
+    mLastMergeFb = &fb;
+
+    updateMergedDirtyTiles(firstMerge, (currPartialMergeTilesTotal != 0), deltaTilesValid);
+    updateBeautyHdriTileCount(mergedTilesTbl, fb);
+
+    if (mFeedbackActive && mFeedbackTileDelta) {
+        // Non-incremental full merge only changes the delta tiles if the dirty tiles are tracked.
+        const std::vector<char>* feedbackTilesTbl = (mergedTilesTbl) ? mergedTilesTbl : getMergedDirtyTilesTbl();
+        mFeedbackTileDeltaTracker.updateMergedTiles(fb.getTotalTiles(), (firstMerge) ? nullptr : feedbackTilesTbl);
+    }
+
+    if (isDeltaTilesTrackingActive()) {
+        // Partial merge mode might leave not-merged updated tiles and we need a full merge
+        // when the next incremental merge happens.
+        mDeltaTilesInvalid = (currPartialMergeTilesTotal != 0);
+        mDeltaTilesLastFb = &fb;
+        mDeltaTilesLastViewport = fb.getRezedViewport();
+        for (auto& currDeltaTilesTbl : mDeltaTilesTbl) {
+            currDeltaTilesTbl.clear(); // keep memory
+        }
+    }
 }
 
 void
@@ -462,58 +828,185 @@ FbMsgSingleFrame::getCurrentMicroSec() const
 }
 
 void
-FbMsgSingleFrame::decodeFirstPushedData()
-//
-// Only decode 1st received data for this frame
-//
+FbMsgSingleFrame::allocFb(const size_t machineId)
 {
-    if (mActiveMachines == 0) return;
+    if (mFbPool) {
+        mFb[machineId] = mFbPool->acquire(mRezedViewport);
+    } else {
+        if (!mFb[machineId]) mFb[machineId] = std::make_shared<scene_rdl2::grid_util::Fb>();
+        mFb[machineId]->init(mRezedViewport);
+    }
 
-    //
-    // only decode first received data
-    //
-    const int machineId = mFirstMachineId;
-    if (!mReceived[machineId]) return;
+    std::ostringstream ostr;
+    ostr << "FbMsgSingleFrame-mId:" << machineId;
+    mFb[machineId]->setDebugTag(ostr.str());
+}
 
-#   ifdef DEBUG_TIMING_LOG
-    uint64_t startMicroSec = getCurrentMicroSec();
-#   endif // end DEBUG_TIMING_LOG
+void
+FbMsgSingleFrame::releaseFb()
+{
+    if (!mFbPool) return; // non lazy Fb mode keeps all Fbs
 
-    MergeActionTracker* mergeActionTrackerPtr = (mFeedbackActive) ? &mMergeActionTracker[machineId] : nullptr;
-    mMessage[machineId].decodeAll(mFb[machineId], mergeActionTrackerPtr);
+    for (auto& currFb : mFb) {
+        if (currFb) mFbPool->release(std::move(currFb));
+        currFb.reset(); // just in case
+    }
+    for (auto& currStat : mMachineMemStat) currStat.mFbByte = 0;
+}
 
-#   ifdef DEBUG_TIMING_LOG
-    const uint64_t deltaMicroSec = getCurrentMicroSec() - startMicroSec;
-    const float deltaMillSec = static_cast<float>(deltaMicroSec) / 1000.0f;
-    std::cerr << ">> FbMsgSingleFrame.cc decodeFirst " << deltaMillSec << " ms" << std::endl;
-#   endif // end DEBUG_TIMING_LOG
+const scene_rdl2::grid_util::Fb*
+FbMsgSingleFrame::getRefFb() const
+{
+    for (const auto& currFb : mFb) {
+        if (currFb) return currFb.get();
+    }
+    return nullptr;
+}
+
+bool
+FbMsgSingleFrame::isSparseMergeActive() const
+{
+    // We can not track the decoded tiles under ON_THE_FLY decode mode.
+    return mSparseMerge && mTaskType == TaskType::MULTIPLEX_PIX && mDecodeMode == DecodeMode::DELAY;
+}
+
+std::vector<char>*
+FbMsgSingleFrame::getDecodeTilesTbl(const int machineId)
+//
+// Return the table which is updated by the decode of machineId. The delta tiles table is shared with
+// the occupied tiles tracking if the delta tiles tracking is active.
+//
+{
+    if (isDeltaTilesTrackingActive()) return &mDeltaTilesTbl[machineId];
+    if (isSparseMergeActive()) return &mDecodedTilesTbl[machineId];
+    return nullptr;
 }
 
 void
-FbMsgSingleFrame::decodeAllPushedData()
+FbMsgSingleFrame::updateOccupiedTiles(const int machineId)
 //
-// Decode all received data which is not decoded for this frame.
+// OR the decoded tiles into the occupied tiles of machineId. This is called right after the decode and
+// is safe to be called in parallel for different machines.
 //
 {
-#   ifdef DEBUG_TIMING_LOG
-    const uint64_t cMicroSec = getCurrentMicroSec();
-#   endif // end DEBUG_TIMING_LOG
+    if (!isSparseMergeActive()) return;
 
-#   ifdef SINGLE_THREAD
-    for (int machineId = 0; machineId < mNumMachines; ++machineId) {
+    const bool deltaTilesTracking = isDeltaTilesTrackingActive();
+    const std::vector<char>& decodedTbl =
+        (deltaTilesTracking) ? mDeltaTilesTbl[machineId] : mDecodedTilesTbl[machineId];
+    if (decodedTbl.empty()) return; // nothing decoded
+
+    std::vector<char>& occupiedTbl = mOccupiedTilesTbl[machineId];
+    if (occupiedTbl.size() != decodedTbl.size()) {
+        // very first decode or resolution changed (all tiles are set to decodedTbl in this case)
+        occupiedTbl.assign(decodedTbl.size(), static_cast<char>(false));
+    }
+    for (size_t tileId = 0; tileId < decodedTbl.size(); ++tileId) {
+        if (decodedTbl[tileId]) occupiedTbl[tileId] = static_cast<char>(true);
+    }
+    if (!deltaTilesTracking) mDecodedTilesTbl[machineId].clear(); // keep memory
+}
+
+const std::vector<char>*
+FbMsgSingleFrame::sparseMergeTilesTblGen(const std::vector<char>* partialMergeTilesTbl,
+                                         const int machineId,
+                                         std::vector<char>& workTbl)
+//
+// Return the tiles table for the accumulation of machineId. The result is the intersection of
+// partialMergeTilesTbl (nullptr : all tiles) and the occupied tiles of machineId and is stored into
+// workTbl. workTbl is empty after this call if there is no tile to accumulate. partialMergeTilesTbl is
+// returned as is if sparse merge is not active.
+//
+{
+    workTbl.clear();
+    if (!isSparseMergeActive() || mOccupiedTilesUnknown) return partialMergeTilesTbl;
+
+    const std::vector<char>& occupiedTbl = mOccupiedTilesTbl[machineId];
+    const size_t totalTiles = mFb[machineId]->getTotalTiles();
+    if (occupiedTbl.size() != totalTiles) return partialMergeTilesTbl; // not decoded yet. just in case
+    if (partialMergeTilesTbl && partialMergeTilesTbl->size() != totalTiles) return partialMergeTilesTbl;
+
+    size_t activeTotal = 0;
+    size_t skipTotal = 0;
+    workTbl.resize(totalTiles);
+    for (size_t tileId = 0; tileId < totalTiles; ++tileId) {
+        const bool target = (!partialMergeTilesTbl || (*partialMergeTilesTbl)[tileId]);
+        const bool active = target && occupiedTbl[tileId];
+        workTbl[tileId] = static_cast<char>(active);
+        if (active) activeTotal++;
+        else if (target) skipTotal++;
+    }
+    mSparseSkipTilesTotal += skipTotal;
+
+    if (!skipTotal) {
+        workTbl.clear();
+        return partialMergeTilesTbl; // all target tiles are occupied
+    }
+    if (!activeTotal) workTbl.clear(); // empty table : nothing to accumulate
+    return &workTbl;
+}
+
+void
+FbMsgSingleFrame::decodeSingleMachine(const int machineId)
+//
+// Decode all the queued data of machineId. This only touches machineId's data and is safe to be called
+// in parallel for different machines.
+//
+{
+    MergeActionTracker* mergeActionTrackerPtr = (mFeedbackActive) ? &mMergeActionTracker[machineId] : nullptr;
+    mMessage[machineId].decodeAll(*mFb[machineId], mergeActionTrackerPtr, getDecodeTilesTbl(machineId));
+    updateOccupiedTiles(machineId);
+    updateMachineMemStat(machineId);
+}
+
+void
+FbMsgSingleFrame::decodeFirstPushedData()
+//
+// Only decode 1st received data for this frame
+//
+{
+    if (mActiveMachines == 0) return;
+
+    //
+    // only decode first received data
+    //
+    const int machineId = mFirstMachineId;
+    if (!mReceived[machineId]) return;
+
+#   ifdef DEBUG_TIMING_LOG
+    uint64_t startMicroSec = getCurrentMicroSec();
+#   endif // end DEBUG_TIMING_LOG
+
+    decodeSingleMachine(machineId);
+
+#   ifdef DEBUG_TIMING_LOG
+    const uint64_t deltaMicroSec = getCurrentMicroSec() - startMicroSec;
+    const float deltaMillSec = static_cast<float>(deltaMicroSec) / 1000.0f;
+    std::cerr << ">> FbMsgSingleFrame.cc decodeFirst " << deltaMillSec << " ms" << std::endl;
+#   endif // end DEBUG_TIMING_LOG
+}
+
+void
+FbMsgSingleFrame::decodeAllPushedData()
+//
+// Decode all received data which is not decoded for this frame.
+//
+{
+#   ifdef DEBUG_TIMING_LOG
+    const uint64_t cMicroSec = getCurrentMicroSec();
+#   endif // end DEBUG_TIMING_LOG
+
+#   ifdef SINGLE_THREAD
+    for (int machineId = 0; machineId < mNumMachines; ++machineId) {
         if (!mReceived[machineId]) continue;
-        MergeActionTracker* mergeActionTrackerPtr =
-            (mFeedbackActive) ? &mMergeActionTracker[machineId] : nullptr;
-        mMessage[machineId].decodeAll(mFb[machineId], mergeActionTrackerPtr);
+        decodeSingleMachine(machineId);
     }
 #   else // else SINGLE_THREAD
     tbb::blocked_range<size_t> range(0, mNumMachines);
     tbb::parallel_for(range, [&](const tbb::blocked_range<size_t> &r) {
             for (size_t machineId = r.begin(); machineId < r.end(); ++machineId) {
                 if (!mReceived[machineId]) continue;
-                MergeActionTracker* mergeActionTrackerPtr =
-                    (mFeedbackActive) ? &mMergeActionTracker[machineId] : nullptr;
-                mMessage[machineId].decodeAll(mFb[machineId], mergeActionTrackerPtr);
+                decodeSingleMachine(static_cast<int>(machineId));
             }
         });
 #   endif // end !SINGLE_THREAD
@@ -560,16 +1053,20 @@ FbMsgSingleFrame::mergeAllFb(scene_rdl2::grid_util::Fb& fb,
 
     fb.reset(); // clear beauty and set nonactive condition to all other buffers.
     latencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_DEQ_FBRESET);
-    for (int machineId = 0; machineId < mNumMachines; ++machineId) {
-        mergeSingleFb(nullptr, machineId, fb);
+    if (mTileMajorMerge) {
+        mergeAllMachinesTileMajor(nullptr, fb);
+    } else {
+        for (int machineId = 0; machineId < mNumMachines; ++machineId) {
+            mergeSingleFb(nullptr, machineId, fb);
 
-        /* useful debug code
-        if (mReceivedAll[machineId]) {
-            if (!verifyMergedResultNumSampleSingleHost(machineId, fb)) {
-                std::cerr << ">> FbMsgSingleFrame.cc mergeAllFb RUNTIME-VERIFY failed. machineId:" << machineId << " +++++++++++++\n";
+            /* useful debug code
+            if (mReceivedAll[machineId]) {
+                if (!verifyMergedResultNumSampleSingleHost(machineId, fb)) {
+                    std::cerr << ">> FbMsgSingleFrame.cc mergeAllFb RUNTIME-VERIFY failed. machineId:" << machineId << " +++++++++++++\n";
+                }
             }
+            */
         }
-        */
     }
     latencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_DEQ_ACCUMULATE);
 
@@ -599,22 +1096,152 @@ FbMsgSingleFrame::mergeAllFb(const unsigned partialMergeTilesTotal,
 #   endif // end DEBUG_TIMING_LOG
 
     // generate partialMergeTiles table first to control merge task volume
-    std::vector<char> partialMergeTilesTbl;
+    std::vector<char>& partialMergeTilesTbl = mPartialMergeTilesTbl;
+    partialMergeTilesTbl.clear();
     partialMergeTilesTblGen(partialMergeTilesTotal, partialMergeTilesTbl);
 
     // merge main stage
+    // Each stage cost is measured for the closed-loop partial merge tiles total control.
+    scene_rdl2::rec_time::RecTime recTime;
+    recTime.start();
     fb.reset(partialMergeTilesTbl); // clear beauty and set nonactive condition to all other buffers.
     latencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_DEQ_FBRESET);
-    for (int machineId = 0; machineId < mNumMachines; ++machineId) {
-        mergeSingleFb(&partialMergeTilesTbl, machineId, fb);
+    mLastPartialMergeFbResetMs = recTime.end() * 1000.0f;
+
+    recTime.start();
+    if (mTileMajorMerge) {
+        mergeAllMachinesTileMajor(&partialMergeTilesTbl, fb);
+    } else {
+        for (int machineId = 0; machineId < mNumMachines; ++machineId) {
+            mergeSingleFb(&partialMergeTilesTbl, machineId, fb);
+        }
     }
     latencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_DEQ_ACCUMULATE);
+    mLastPartialMergeAccumulateMs = recTime.end() * 1000.0f;
 
 #   ifdef DEBUG_TIMING_LOG
     timeLogUpdate("-- merge --", mDebugTimeLogMerge, cMicroSec);
 #   endif // end DEBUG_TIMING_LOG
 }
 
+bool
+FbMsgSingleFrame::isDeltaTilesValid(const scene_rdl2::grid_util::Fb& fb) const
+//
+// Return true if the delta tiles can be used for this merge. Delta tiles are only valid when the
+// previous merge result is kept inside the same fb and there is no reset operation on the fb.
+//
+{
+    if (!isDeltaTilesTrackingActive() || mDeltaTilesInvalid) return false;
+    if (mDecodeMode != DecodeMode::DELAY) return false; // we don't track updated tiles by on-the-fly decode
+
+    // The previous merge result should be kept inside the same fb
+    if (mDeltaTilesLastFb != &fb) return false;
+    if (mDeltaTilesLastViewport != fb.getRezedViewport()) return false;
+
+    const unsigned totalTiles = fb.getTotalTiles();
+    for (int machineId = 0; machineId < mNumMachines; ++machineId) {
+        if (!mDeltaTilesTbl[machineId].empty() && mDeltaTilesTbl[machineId].size() != totalTiles) {
+            return false; // resolution mismatch
+        }
+    }
+    return true;
+}
+
+void
+FbMsgSingleFrame::deltaTilesUnionGen(const unsigned totalTiles)
+//
+// Generate updated tiles table by OR operation of all machines' updated tiles
+//
+{
+    mDeltaTilesUnionTbl.assign(totalTiles, static_cast<char>(false));
+    auto orTiles = [&](const size_t startTileId, const size_t endTileId) {
+        for (int machineId = 0; machineId < mNumMachines; ++machineId) {
+            const std::vector<char>& currTbl = mDeltaTilesTbl[machineId];
+            if (currTbl.empty()) continue;
+            for (size_t tileId = startTileId; tileId < endTileId; ++tileId) {
+                if (currTbl[tileId]) mDeltaTilesUnionTbl[tileId] = static_cast<char>(true);
+            }
+        }
+    };
+#   ifdef SINGLE_THREAD
+    orTiles(0, totalTiles);
+#   else // else SINGLE_THREAD
+    tbb::blocked_range<size_t> range(0, totalTiles);
+    tbb::parallel_for(range, [&](const tbb::blocked_range<size_t>& r) { orTiles(r.begin(), r.end()); });
+#   endif // end !SINGLE_THREAD
+    mDeltaTilesUnionTotal =
+        static_cast<unsigned>(std::count(mDeltaTilesUnionTbl.begin(), mDeltaTilesUnionTbl.end(),
+                                         static_cast<char>(true)));
+}
+
+void
+FbMsgSingleFrame::updateMergedDirtyTiles(const bool firstMerge,
+                                         const bool partialMerge,
+                                         const bool deltaTilesValid)
+//
+// Update the tiles which are updated by this merge.
+// Partial merge only updates partial merge tiles. Non-partial merge result is only changed at the
+// delta tiles if delta tiles are valid because the accumulation of non-updated tiles creates exactly
+// the same result as the previous merge.
+//
+{
+    if (!mDirtyTilesTracking || firstMerge) {
+        mMergedDirtyTilesAll = true;
+    } else if (partialMerge) {
+        mMergedDirtyTilesAll = false;
+        mMergedDirtyTilesTbl = mPartialMergeTilesTbl;
+    } else if (deltaTilesValid) {
+        mMergedDirtyTilesAll = false;
+        mMergedDirtyTilesTbl = mDeltaTilesUnionTbl;
+    } else {
+        mMergedDirtyTilesAll = true;
+    }
+}
+
+void
+FbMsgSingleFrame::mergeDeltaFb(scene_rdl2::grid_util::Fb& fb,
+                               scene_rdl2::grid_util::LatencyLog& latencyLog)
+//
+// Merge only the tiles which are updated since the last merge (incremental merge).
+// mDeltaTilesUnionTbl should be ready before calling this function.
+//
+// The Fb only supports the accumulate operation and we can not subtract the previous contribution of
+// a particular machine from the merged result (and some of the AOVs like closest filter or min/max
+// are not reversible anyway). Instead, we clean up the updated tiles and re-accumulate all machines'
+// data for these tiles only. Other tiles keep the previous merge result. The merge cost is proportional
+// to the number of the updated tiles instead of the entire image.
+//
+{
+#   ifdef DEBUG_TIMING_LOG
+    const uint64_t cMicroSec = getCurrentMicroSec();
+#   endif // end DEBUG_TIMING_LOG
+
+    const unsigned totalTiles = fb.getTotalTiles();
+    mIncrementalMergeCountTotal++;
+
+    if (mDeltaTilesUnionTotal == totalTiles) {
+        mergeAllFb(fb, latencyLog); // all tiles are updated. Full merge is cheaper
+        return;
+    }
+
+    fb.reset(mDeltaTilesUnionTbl); // clear updated tiles only
+    latencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_DEQ_FBRESET);
+    if (mDeltaTilesUnionTotal > 0) {
+        if (mTileMajorMerge) {
+            mergeAllMachinesTileMajor(&mDeltaTilesUnionTbl, fb);
+        } else {
+            for (int machineId = 0; machineId < mNumMachines; ++machineId) {
+                mergeSingleFb(&mDeltaTilesUnionTbl, machineId, fb);
+            }
+        }
+    }
+    latencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_DEQ_ACCUMULATE);
+
+#   ifdef DEBUG_TIMING_LOG
+    timeLogUpdate("-- mergeDelta --", mDebugTimeLogMerge, cMicroSec);
+#   endif // end DEBUG_TIMING_LOG
+}
+
 void
 FbMsgSingleFrame::mergeSingleFb(const std::vector<char>* partialMergeTilesTbl,
                                 const int machineId,
@@ -622,6 +1249,49 @@ FbMsgSingleFrame::mergeSingleFb(const std::vector<char>* partialMergeTilesTbl,
 //
 // Merge one mcrt info with partial merge tile logic
 //
+{
+    if (!isMergeTargetMachine(machineId)) return;
+
+    const std::vector<char>* accumulateTilesTbl =
+        sparseMergeTilesTblGen(partialMergeTilesTbl, machineId, mSparseMergeTilesTbl);
+    const bool noOccupiedTiles = (accumulateTilesTbl == &mSparseMergeTilesTbl && mSparseMergeTilesTbl.empty());
+    if (!noOccupiedTiles) {
+        accumulateSingleFb(accumulateTilesTbl, machineId, fb);
+    }
+    updateMergeActionTracker(partialMergeTilesTbl, machineId);
+}
+
+void
+FbMsgSingleFrame::mergeAllMachinesTileMajor(const std::vector<char>* partialMergeTilesTbl,
+                                            scene_rdl2::grid_util::Fb& fb)
+//
+// Merge all mcrt info by tile-major task distribution.
+//
+// The tile space is split into tile range partitions and each partition is processed by a different
+// thread. Each thread loops over all machines for the beauty tiles of its own range. Other buffers are
+// accumulated machine-major (see accumulateAllFbTileMajor()). The accumulation order of the machines for
+// each pixel is the same as the machine-major loop (i.e. mergeSingleFb() for all machines). So the result
+// is bit-identical to the machine-major merge.
+//
+{
+    // Beauty HDRI tile count is fused into the partition merge and counted while the tiles are
+    // still in the cache.
+    std::vector<unsigned char>* hdriTileCountTbl = nullptr;
+    if (mBeautyHdriTileCount && mBeautyHdriTileCountTbl.size() == fb.getTotalTiles()) {
+        hdriTileCountTbl = &mBeautyHdriTileCountTbl;
+    }
+    accumulateAllFbTileMajor(partialMergeTilesTbl, fb, hdriTileCountTbl);
+    if (hdriTileCountTbl) mBeautyHdriTileCountFused = true;
+
+    for (int machineId = 0; machineId < mNumMachines; ++machineId) {
+        if (isMergeTargetMachine(machineId)) {
+            updateMergeActionTracker(partialMergeTilesTbl, machineId);
+        }
+    }
+}
+
+bool
+FbMsgSingleFrame::isMergeTargetMachine(const int machineId) const
 {
     if (mTunnelMachineIdRuntime >= 0 && mTunnelMachineIdRuntime == machineId) {
         // The tunnel operation is designed for debugging purposes and only specified single machine data
@@ -629,31 +1299,227 @@ FbMsgSingleFrame::mergeSingleFb(const std::vector<char>* partialMergeTilesTbl,
         // bypassed and the merge node simply sends incoming particular MCRT data to the client as is.
         // This operation is useful for debugging to narrow down the reason the bug is inside the merge
         // operation or not.
-        return; // skip merge operation
+        return false; // skip merge operation
     }
 
-    if (!mReceivedAll[machineId]) return;
+    return mReceivedAll[machineId];
+}
 
+void
+FbMsgSingleFrame::accumulateSingleFb(const std::vector<char>* partialMergeTilesTbl,
+                                     const int machineId,
+                                     scene_rdl2::grid_util::Fb& fb)
+{
 #   ifdef SINGLE_THREAD
-    fb.accumulateRenderBuffer(partialMergeTilesTbl,    mFb[machineId]);
-    fb.accumulatePixelInfo(partialMergeTilesTbl,       mFb[machineId]);
-    fb.accumulateHeatMap(partialMergeTilesTbl,         mFb[machineId]);
-    fb.accumulateWeightBuffer(partialMergeTilesTbl,    mFb[machineId]);
-    fb.accumulateRenderBufferOdd(partialMergeTilesTbl, mFb[machineId]);
-    fb.accumulateRenderOutput(partialMergeTilesTbl,    mFb[machineId]);
+    accumulateRenderBuffer(partialMergeTilesTbl,       machineId, fb);
+    fb.accumulatePixelInfo(partialMergeTilesTbl,       *mFb[machineId]);
+    fb.accumulateHeatMap(partialMergeTilesTbl,         *mFb[machineId]);
+    fb.accumulateWeightBuffer(partialMergeTilesTbl,    *mFb[machineId]);
+    fb.accumulateRenderBufferOdd(partialMergeTilesTbl, *mFb[machineId]);
+    fb.accumulateRenderOutput(partialMergeTilesTbl,    *mFb[machineId]);
 #   else // else SINGLE_THREAD
     tbb::parallel_for(0, 6, [&](unsigned id) {
             switch (id) {
-            case 0 : fb.accumulateRenderBuffer(partialMergeTilesTbl,    mFb[machineId]); break;
-            case 1 : fb.accumulatePixelInfo(partialMergeTilesTbl,       mFb[machineId]); break;
-            case 2 : fb.accumulateHeatMap(partialMergeTilesTbl,         mFb[machineId]); break;
-            case 3 : fb.accumulateWeightBuffer(partialMergeTilesTbl,    mFb[machineId]); break;
-            case 4 : fb.accumulateRenderBufferOdd(partialMergeTilesTbl, mFb[machineId]); break;
-            case 5 : fb.accumulateRenderOutput(partialMergeTilesTbl,    mFb[machineId]); break;
+            case 0 : accumulateRenderBuffer(partialMergeTilesTbl,       machineId, fb); break;
+            case 1 : fb.accumulatePixelInfo(partialMergeTilesTbl,       *mFb[machineId]); break;
+            case 2 : fb.accumulateHeatMap(partialMergeTilesTbl,         *mFb[machineId]); break;
+            case 3 : fb.accumulateWeightBuffer(partialMergeTilesTbl,    *mFb[machineId]); break;
+            case 4 : fb.accumulateRenderBufferOdd(partialMergeTilesTbl, *mFb[machineId]); break;
+            case 5 : fb.accumulateRenderOutput(partialMergeTilesTbl,    *mFb[machineId]); break;
             }
         });
 #   endif // end !SINGLE_THREAD
+}
+
+void
+FbMsgSingleFrame::accumulateRenderBuffer(const std::vector<char>* partialMergeTilesTbl,
+                                         const int machineId,
+                                         scene_rdl2::grid_util::Fb& fb)
+{
+    if (mSimdMerge) {
+        MergeKernel::accumulateRenderBuffer(partialMergeTilesTbl, *mFb[machineId], fb);
+    } else {
+        fb.accumulateRenderBuffer(partialMergeTilesTbl, *mFb[machineId]);
+    }
+}
+
+void
+FbMsgSingleFrame::accumulateAllFbTileMajor(const std::vector<char>* partialMergeTilesTbl,
+                                           scene_rdl2::grid_util::Fb& fb,
+                                           std::vector<unsigned char>* hdriTileCountTbl)
+//
+// Accumulate all machines' fb into the fb by tile-major task distribution.
+// This function does not update mergeActionTracker.
+// If hdriTileCountTbl is not nullptr, beauty HDRI pixel count of the accumulated tiles is updated
+// by each partition right after the accumulation.
+//
+// Only the beauty buffer is accumulated by tile-major partitions. Each partition is a tile range and
+// accumulated by MergeKernel::accumulateRenderBufferTiles() which only touches the tiles inside its own
+// range. All other buffers are accumulated by Fb::accumulate*() which might construct the destination
+// buffers (like AOV buffers) internally. So they are accumulated machine-major and each buffer type is
+// processed by a single task (the same as accumulateSingleFb()). This also takes care of all the internal
+// memory setup of the destination fb before the accumulation regardless of partialMergeTilesTbl.
+// If simdMerge is off, the beauty buffer is also accumulated machine-major by Fb.
+// Under sparse merge, each machine only accumulates its occupied tiles (see sparseMergeTilesTblGen()).
+//
+{
+    const unsigned totalTiles = fb.getTotalTiles();
+    if (totalTiles == 0) return;
+
+    // accumulate tiles table of each machine. nullptr : skip this machine
+    std::vector<const std::vector<char>*> accumulateTilesTblArray(mNumMachines, nullptr);
+    std::vector<char> accumulateAllTiles(mNumMachines, static_cast<char>(false));
+    for (int machineId = 0; machineId < mNumMachines; ++machineId) {
+        if (!isMergeTargetMachine(machineId)) continue;
+        std::vector<char>& workTbl = mSparseMergeTilesTblArray[machineId];
+        const std::vector<char>* tbl = sparseMergeTilesTblGen(partialMergeTilesTbl, machineId, workTbl);
+        if (tbl == &workTbl && workTbl.empty()) continue; // no occupied tiles
+        if (!tbl) accumulateAllTiles[machineId] = static_cast<char>(true);
+        accumulateTilesTblArray[machineId] = tbl;
+    }
+    auto isAccumulateTarget = [&](const int machineId) {
+        return accumulateTilesTblArray[machineId] || accumulateAllTiles[machineId];
+    };
+
+    unsigned partitionTotal = mTileMajorMergePartitionTotal;
+    if (partitionTotal == 0) {
+        partitionTotal = static_cast<unsigned>(tbb::this_task_arena::max_concurrency());
+    }
+    partitionTotal = std::max(1U, std::min(partitionTotal, totalTiles));
+    const unsigned tilesPerPartition = (totalTiles + partitionTotal - 1) / partitionTotal;
+
+    auto accumulateBuffer = [&](const unsigned bufferId) {
+        for (int machineId = 0; machineId < mNumMachines; ++machineId) {
+            if (!isAccumulateTarget(machineId)) continue;
+            const std::vector<char>* tbl = accumulateTilesTblArray[machineId];
+            switch (bufferId) {
+            case 0 : fb.accumulateRenderBuffer(tbl,    *mFb[machineId]); break;
+            case 1 : fb.accumulatePixelInfo(tbl,       *mFb[machineId]); break;
+            case 2 : fb.accumulateHeatMap(tbl,         *mFb[machineId]); break;
+            case 3 : fb.accumulateWeightBuffer(tbl,    *mFb[machineId]); break;
+            case 4 : fb.accumulateRenderBufferOdd(tbl, *mFb[machineId]); break;
+            case 5 : fb.accumulateRenderOutput(tbl,    *mFb[machineId]); break;
+            }
+        }
+    };
+    auto mergePartition = [&](const unsigned partitionId) {
+        const unsigned startTileId = partitionId * tilesPerPartition;
+        const unsigned endTileId = std::min(startTileId + tilesPerPartition, totalTiles);
+        for (int machineId = 0; machineId < mNumMachines; ++machineId) {
+            if (!isAccumulateTarget(machineId)) continue;
+            MergeKernel::accumulateRenderBufferTiles(accumulateTilesTblArray[machineId], startTileId, endTileId,
+                                                     *mFb[machineId], fb);
+        }
+        if (hdriTileCountTbl) {
+            countBeautyHdriTiles(partialMergeTilesTbl, startTileId, endTileId, fb, *hdriTileCountTbl);
+        }
+    };
+    auto countAllPartitions = [&]() {
+        if (!hdriTileCountTbl) return;
+        countBeautyHdriTiles(partialMergeTilesTbl, 0, totalTiles, fb, *hdriTileCountTbl);
+    };
+
+    const unsigned bufferStartId = (mSimdMerge) ? 1 : 0;
+#   ifdef SINGLE_THREAD
+    for (unsigned bufferId = bufferStartId; bufferId < 6; ++bufferId) accumulateBuffer(bufferId);
+    if (mSimdMerge) {
+        for (unsigned partitionId = 0; partitionId < partitionTotal; ++partitionId) mergePartition(partitionId);
+    } else {
+        countAllPartitions();
+    }
+#   else // else SINGLE_THREAD
+    if (mSimdMerge) {
+        // The beauty partitions and the other buffers touch different memory of the fb.
+        tbb::parallel_invoke(
+            [&]() {
+                tbb::parallel_for(bufferStartId, 6U, [&](unsigned bufferId) { accumulateBuffer(bufferId); });
+            },
+            [&]() {
+                tbb::parallel_for(0U, partitionTotal, [&](unsigned partitionId) { mergePartition(partitionId); });
+            });
+    } else {
+        tbb::parallel_for(bufferStartId, 6U, [&](unsigned bufferId) { accumulateBuffer(bufferId); });
+        countAllPartitions();
+    }
+#   endif // end !SINGLE_THREAD
+}
 
+void
+FbMsgSingleFrame::beautyHdriTileCountPrep(const scene_rdl2::grid_util::Fb& fb, const bool firstMerge)
+//
+// Prepare the beauty HDRI tile count table before the merge. If the previous count result can not be
+// used for this merge's output fb, all tiles are counted after the merge.
+//
+{
+    mBeautyHdriTileCountFused = false;
+    if (!mBeautyHdriTileCount) return;
+
+    const unsigned totalTiles = fb.getTotalTiles();
+    mBeautyHdriTileCountStale = (firstMerge ||
+                                 !mBeautyHdriTileCountValid ||
+                                 mBeautyHdriTileCountFb != &fb ||
+                                 mBeautyHdriTileCountTbl.size() != totalTiles);
+    if (mBeautyHdriTileCountStale) {
+        mBeautyHdriTileCountTbl.assign(totalTiles, 0);
+    }
+    mBeautyHdriTileCountValid = false; // during the merge
+}
+
+void
+FbMsgSingleFrame::updateBeautyHdriTileCount(const std::vector<char>* mergedTilesTbl,
+                                            scene_rdl2::grid_util::Fb& fb)
+//
+// Update the beauty HDRI tile count of the merged tiles. The cost is proportional to the merged tiles.
+//
+{
+    if (!mBeautyHdriTileCount) return;
+
+    const unsigned totalTiles = fb.getTotalTiles();
+    if (mBeautyHdriTileCountTbl.size() != totalTiles) return; // just in case
+
+    // Merged tiles are already counted if the tile-major merge is used. Stale table needs all tiles.
+    if (mBeautyHdriTileCountStale || !mBeautyHdriTileCountFused) {
+        const std::vector<char>* countTilesTbl = (mBeautyHdriTileCountStale) ? nullptr : mergedTilesTbl;
+#       ifdef SINGLE_THREAD
+        countBeautyHdriTiles(countTilesTbl, 0, totalTiles, fb, mBeautyHdriTileCountTbl);
+#       else // else SINGLE_THREAD
+        tbb::blocked_range<unsigned> range(0, totalTiles);
+        tbb::parallel_for(range, [&](const tbb::blocked_range<unsigned>& r) {
+                countBeautyHdriTiles(countTilesTbl, r.begin(), r.end(), fb, mBeautyHdriTileCountTbl);
+            });
+#       endif // end !SINGLE_THREAD
+    }
+
+    mBeautyHdriTileCountStale = false;
+    mBeautyHdriTileCountValid = true;
+    mBeautyHdriTileCountFb = &fb;
+}
+
+// static function
+void
+FbMsgSingleFrame::countBeautyHdriTiles(const std::vector<char>* tilesTbl,
+                                       const unsigned startTileId,
+                                       const unsigned endTileId,
+                                       scene_rdl2::grid_util::Fb& fb,
+                                       std::vector<unsigned char>& hdriTileCountTbl)
+//
+// Count beauty HDRI pixels of the tiles between startTileId and endTileId.
+// Only count the tiles which are set by tilesTbl. nullptr tilesTbl means all tiles.
+//
+{
+    constexpr unsigned tilePixTotal = 64; // 8 x 8 pixels
+    const scene_rdl2::math::Vec4f* c = fb.getRenderBufferTiled().getData();
+    for (unsigned tileId = startTileId; tileId < endTileId; ++tileId) {
+        if (tilesTbl && !(*tilesTbl)[tileId]) continue;
+        hdriTileCountTbl[tileId] =
+            static_cast<unsigned char>(HdriTest::countBeautyPix(c + tileId * tilePixTotal, tilePixTotal));
+    }
+}
+
+void
+FbMsgSingleFrame::updateMergeActionTracker(const std::vector<char>* partialMergeTilesTbl,
+                                           const int machineId)
+{
     if (mFeedbackActive) {
         //
         // Update mergeActionTracker
@@ -663,9 +1529,93 @@ FbMsgSingleFrame::mergeSingleFb(const std::vector<char>* partialMergeTilesTbl,
         } else {
             mMergeActionTracker[machineId].mergePartial(*partialMergeTilesTbl);
         }
+        mMachineMemStat[machineId].mTrackerByte = mMergeActionTracker[machineId].getData().size();
     }
 }
 
+void
+FbMsgSingleFrame::updateMachineMemStat(const size_t machineId)
+//
+// Update the memory snapshot of machineId. This should be called by the owner of machineId's data
+// (i.e. under the per-machine lock inside push()).
+//
+{
+    MachineMemStat& currStat = mMachineMemStat[machineId];
+    if (mFbPool && mFb[machineId]) mFbPool->updateByte(mFb[machineId]); // decode/GC might change the Fb byte
+    currStat.mFbByte = (mFb[machineId]) ? FbMsgFbPool::calcFbByte(*mFb[machineId]) : 0;
+    currStat.mQueuedByte = mMessage[machineId].getQueuedByte();
+    currStat.mQueuedDepth = mMessage[machineId].getQueuedDepth();
+    currStat.mTrackerByte = mMergeActionTracker[machineId].getData().size();
+}
+
+std::string
+FbMsgSingleFrame::mergeBench(const unsigned loopMax)
+//
+// Merge performance test and verify result between machine-major and tile-major merge
+// by using current received data. Execution time is measured with 1 to N threads.
+// This function does not update mergeActionTracker.
+//
+{
+    if (mActiveMachines == 0) return "mergeBench : no received data";
+
+    scene_rdl2::grid_util::Fb machineMajorFb;
+    scene_rdl2::grid_util::Fb tileMajorFb;
+    machineMajorFb.init(mRezedViewport);
+    tileMajorFb.init(mRezedViewport);
+
+    auto mergeMachineMajor = [&]() {
+        machineMajorFb.reset();
+        for (int machineId = 0; machineId < mNumMachines; ++machineId) {
+            if (isMergeTargetMachine(machineId)) accumulateSingleFb(nullptr, machineId, machineMajorFb);
+        }
+    };
+    auto mergeTileMajor = [&]() {
+        tileMajorFb.reset();
+        accumulateAllFbTileMajor(nullptr, tileMajorFb);
+    };
+    auto bench = [&](const int threadTotal, const std::function<void()>& mergeFunc) -> float { // return ms
+        tbb::task_arena arena(threadTotal);
+        float sec = 0.0f;
+        arena.execute([&]() {
+                mergeFunc(); // warm up
+                scene_rdl2::rec_time::RecTime recTime;
+                recTime.start();
+                for (unsigned i = 0; i < loopMax; ++i) mergeFunc();
+                sec = recTime.end();
+            });
+        return sec / static_cast<float>(std::max(loopMax, 1U)) * 1000.0f;
+    };
+    auto verify = [&]() -> bool {
+        const size_t area = machineMajorFb.getAlignedWidth() * machineMajorFb.getAlignedHeight();
+        if (std::memcmp(machineMajorFb.getRenderBufferTiled().getData(),
+                        tileMajorFb.getRenderBufferTiled().getData(),
+                        area * sizeof(*machineMajorFb.getRenderBufferTiled().getData())) != 0) {
+            return false;
+        }
+        return (std::memcmp(machineMajorFb.getNumSampleBufferTiled().getData(),
+                            tileMajorFb.getNumSampleBufferTiled().getData(),
+                            area * sizeof(unsigned)) == 0);
+    };
+
+    std::ostringstream ostr;
+    ostr << "mergeBench (loopMax:" << loopMax << " activeMachines:" << mActiveMachines
+         << " totalTiles:" << tileMajorFb.getTotalTiles() << ") {\n";
+    const int maxThreads = tbb::this_task_arena::max_concurrency();
+    for (int threadTotal = 1; ; threadTotal = std::min(threadTotal * 2, maxThreads)) {
+        const float machineMajorMs = bench(threadTotal, mergeMachineMajor);
+        const float tileMajorMs = bench(threadTotal, mergeTileMajor);
+        ostr << "  threads:" << std::setw(3) << threadTotal
+             << " machineMajor:" << std::setw(10) << std::fixed << std::setprecision(3) << machineMajorMs << " ms"
+             << " tileMajor:" << std::setw(10) << tileMajorMs << " ms"
+             << " speedup:" << std::setprecision(2) << ((tileMajorMs > 0.0f) ? machineMajorMs / tileMajorMs : 0.0f)
+             << '\n';
+        if (threadTotal == maxThreads) break;
+    }
+    ostr << "  verify (beauty/numSample bit-identical):" << scene_rdl2::str_util::boolStr(verify()) << '\n'
+         << "}";
+    return ostr.str();
+}
+
 #ifdef TEST
 void
 FbMsgSingleFrame::mergeAllFb(scene_rdl2::grid_util::Fb& fb,
@@ -760,7 +1710,7 @@ FbMsgSingleFrame::verifyMergedResultNumSampleSingleHost(const int machineId,
             return true;
         };
 
-    const scene_rdl2::grid_util::Fb& srcFb = mFb[machineId];
+    const scene_rdl2::grid_util::Fb& srcFb = *mFb[machineId];
     if (srcFb.getWidth() != mergedFb.getWidth() || srcFb.getHeight() != mergedFb.getHeight()) {
         return false;
     }
@@ -782,13 +1732,14 @@ FbMsgSingleFrame::partialMergeTilesTblGen(const unsigned partialMergeTilesTotal,
 // partialMergeTilesTable generation function.
 //
 // This table defines which tile needs to merge under acynchronous partial merge mode.
-// So far table is very simple and created from bottom to top order based on scanlines.
-// But we can implemented other type easily and this is future work.
+// SCANLINE order creates the table from bottom to top order based on scanlines.
+// Other orders are handled by partialMergeTilesPriorityTblGen().
 //
 {
-    if (mFb.empty()) return;    // just in case
+    const scene_rdl2::grid_util::Fb* refFb = getRefFb();
+    if (!refFb) return;         // just in case
 
-    const unsigned totalTiles = mFb[0].getTotalTiles();
+    const unsigned totalTiles = refFb->getTotalTiles();
     partialMergeTileTbl.resize(totalTiles, (char)false);
 
     if (partialMergeTilesTotal == 0) {
@@ -798,6 +1749,11 @@ FbMsgSingleFrame::partialMergeTilesTblGen(const unsigned partialMergeTilesTotal,
         }
         return;
     }
+
+    if (mPartialMergeTilesOrder != PartialMergeTilesOrder::SCANLINE) {
+        partialMergeTilesPriorityTblGen(partialMergeTilesTotal, partialMergeTileTbl);
+        return;
+    }
     
     const unsigned activeStartId = std::min(mPartialMergeStartTileId, totalTiles - 1);
     unsigned activeEndId = activeStartId + std::min(partialMergeTilesTotal, totalTiles);
@@ -819,6 +1775,194 @@ FbMsgSingleFrame::partialMergeTilesTblGen(const unsigned partialMergeTilesTotal,
     mPartialMergeStartTileId = activeEndId; // update next partial merge start tileId
 }
 
+void
+FbMsgSingleFrame::partialMergeTilesPriorityTblGen(const unsigned partialMergeTilesTotal,
+                                                  std::vector<char>& partialMergeTileTbl)
+//
+// Priority-ordered partialMergeTilesTable generation function.
+//
+// Every tile has a priority score and the partialMergeTilesTotal tiles which have the highest scores
+// are selected. The age (= how many tables were generated since the tile was merged last time) is
+// always used as a score factor or a tie-breaker, so every tile is merged eventually. The selection
+// is fully deterministic (the last tie-breaker is the tileId).
+//
+{
+    const scene_rdl2::grid_util::Fb& fb0 = *getRefFb();
+    const unsigned totalTiles = fb0.getTotalTiles();
+    if (mPartialMergeTileLastMerged.size() != totalTiles) {
+        // initial call or resolution changed
+        mPartialMergeTileLastMerged.assign(totalTiles, mPartialMergeGenCount);
+        mPartialMergeTileMergedSamples.assign(totalTiles, 0);
+        mPartialMergeTileWeight.clear();
+    }
+    mPartialMergeGenCount++;
+
+    auto calcAge = [&](const unsigned tileId) -> uint32_t {
+        return mPartialMergeGenCount - mPartialMergeTileLastMerged[tileId];
+    };
+    auto calcSampleDelta = [&](const unsigned tileId) -> uint64_t {
+        const uint64_t curr = mPartialMergeTileSamples[tileId];
+        const uint64_t merged = mPartialMergeTileMergedSamples[tileId];
+        return (curr >= merged) ? curr - merged : curr; // fb might be reset
+    };
+
+    std::function<bool(const unsigned, const unsigned)> higherPriority;
+    switch (mPartialMergeTilesOrder) {
+    case PartialMergeTilesOrder::FOCUS :
+        if (mPartialMergeTileWeight.size() != totalTiles) partialMergeTileWeightGen(fb0);
+        higherPriority = [&](const unsigned a, const unsigned b) -> bool {
+            const float scoreA = static_cast<float>(calcAge(a)) * mPartialMergeTileWeight[a];
+            const float scoreB = static_cast<float>(calcAge(b)) * mPartialMergeTileWeight[b];
+            if (scoreA != scoreB) return scoreA > scoreB;
+            return a < b;
+        };
+        break;
+    case PartialMergeTilesOrder::SAMPLE_DELTA :
+        partialMergeTileSamplesGen(totalTiles);
+        higherPriority = [&](const unsigned a, const unsigned b) -> bool {
+            const uint64_t deltaA = calcSampleDelta(a);
+            const uint64_t deltaB = calcSampleDelta(b);
+            if (deltaA != deltaB) return deltaA > deltaB;
+            if (calcAge(a) != calcAge(b)) return calcAge(a) > calcAge(b);
+            return a < b;
+        };
+        break;
+    default : // OLDEST_MERGED
+        higherPriority = [&](const unsigned a, const unsigned b) -> bool {
+            if (calcAge(a) != calcAge(b)) return calcAge(a) > calcAge(b);
+            return a < b;
+        };
+        break;
+    }
+
+    mPartialMergeTileIdWork.resize(totalTiles);
+    for (unsigned tileId = 0; tileId < totalTiles; ++tileId) mPartialMergeTileIdWork[tileId] = tileId;
+    const unsigned selectTotal = std::min(partialMergeTilesTotal, totalTiles);
+    std::nth_element(mPartialMergeTileIdWork.begin(),
+                     mPartialMergeTileIdWork.begin() + selectTotal,
+                     mPartialMergeTileIdWork.end(),
+                     higherPriority);
+
+    for (unsigned i = 0; i < selectTotal; ++i) {
+        const unsigned tileId = mPartialMergeTileIdWork[i];
+        partialMergeTileTbl[tileId] = true;
+        mPartialMergeTileLastMerged[tileId] = mPartialMergeGenCount;
+        if (mPartialMergeTilesOrder == PartialMergeTilesOrder::SAMPLE_DELTA) {
+            mPartialMergeTileMergedSamples[tileId] = mPartialMergeTileSamples[tileId];
+        }
+    }
+}
+
+void
+FbMsgSingleFrame::partialMergeTileWeightGen(const scene_rdl2::grid_util::Fb& fb)
+//
+// Focus weight of each tile. Tiles inside the focus area have (1 + mPartialMergeFocusGain) and the
+// weight linearly falls off to 1 by the distance from the focus area.
+//
+{
+    const unsigned totalTiles = fb.getTotalTiles();
+    const unsigned numTilesX = fb.getNumTilesX();
+    const float width = static_cast<float>(fb.getWidth());
+    const float height = static_cast<float>(fb.getHeight());
+
+    float focusMinX, focusMinY, focusMaxX, focusMaxY;
+    if (mPartialMergeFocusRoi) {
+        focusMinX = static_cast<float>(mPartialMergeFocusViewport.mMinX);
+        focusMinY = static_cast<float>(mPartialMergeFocusViewport.mMinY);
+        focusMaxX = static_cast<float>(mPartialMergeFocusViewport.mMaxX);
+        focusMaxY = static_cast<float>(mPartialMergeFocusViewport.mMaxY);
+    } else {
+        focusMinX = focusMaxX = width * 0.5f; // screen center
+        focusMinY = focusMaxY = height * 0.5f;
+    }
+    const float maxDist = std::max(std::sqrt(width * width + height * height), 1.0f);
+
+    mPartialMergeTileWeight.resize(totalTiles);
+    for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+        const float tileCenterX = static_cast<float>((tileId % numTilesX) * 8) + 4.0f;
+        const float tileCenterY = static_cast<float>((tileId / numTilesX) * 8) + 4.0f;
+        const float dx = std::max({focusMinX - tileCenterX, 0.0f, tileCenterX - focusMaxX});
+        const float dy = std::max({focusMinY - tileCenterY, 0.0f, tileCenterY - focusMaxY});
+        const float t = std::min(std::sqrt(dx * dx + dy * dy) / maxDist, 1.0f);
+        mPartialMergeTileWeight[tileId] = 1.0f + mPartialMergeFocusGain * (1.0f - t);
+    }
+}
+
+void
+FbMsgSingleFrame::partialMergeTileSamplesGen(const unsigned totalTiles)
+//
+// Compute all machines' samples total for each tile.
+//
+{
+    mPartialMergeTileSamples.resize(totalTiles);
+
+    auto tileSamples = [&](const unsigned tileId) -> uint64_t {
+        uint64_t total = 0;
+        for (int machineId = 0; machineId < mNumMachines; ++machineId) {
+            if (!mReceivedAll[machineId]) continue;
+            const scene_rdl2::grid_util::Fb& currFb = *mFb[machineId];
+            if (currFb.getTotalTiles() != totalTiles) continue; // just in case
+            if (!currFb.getActivePixels().getTileMask(tileId)) continue;
+            const unsigned int* numSample = currFb.getNumSampleBufferTiled().getData() + tileId * 64;
+            for (unsigned pixId = 0; pixId < 64; ++pixId) total += numSample[pixId];
+        }
+        return total;
+    };
+
+#   ifdef SINGLE_THREAD
+    for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+        mPartialMergeTileSamples[tileId] = tileSamples(tileId);
+    }
+#   else // else SINGLE_THREAD
+    tbb::blocked_range<unsigned> range(0, totalTiles);
+    tbb::parallel_for(range, [&](const tbb::blocked_range<unsigned>& r) {
+        for (unsigned tileId = r.begin(); tileId < r.end(); ++tileId) {
+            mPartialMergeTileSamples[tileId] = tileSamples(tileId);
+        }
+    });
+#   endif // end else SINGLE_THREAD
+}
+
+void
+FbMsgSingleFrame::resetPartialMergeTilesPriority()
+{
+    mPartialMergeGenCount = 0;
+    mPartialMergeTileLastMerged.clear();
+    mPartialMergeTileSamples.clear();
+    mPartialMergeTileMergedSamples.clear();
+}
+
+// static function
+std::string
+FbMsgSingleFrame::partialMergeTilesOrderStr(const PartialMergeTilesOrder order)
+{
+    switch (order) {
+    case PartialMergeTilesOrder::SCANLINE : return "scanline";
+    case PartialMergeTilesOrder::FOCUS : return "focus";
+    case PartialMergeTilesOrder::SAMPLE_DELTA : return "sampleDelta";
+    case PartialMergeTilesOrder::OLDEST_MERGED : return "oldest";
+    default : return "?";
+    }
+}
+
+std::string
+FbMsgSingleFrame::showPartialMergeTilesOrder() const
+{
+    std::ostringstream ostr;
+    ostr << "partialMergeTilesOrder {\n"
+         << "  mPartialMergeTilesOrder:" << partialMergeTilesOrderStr(mPartialMergeTilesOrder) << '\n'
+         << "  mPartialMergeFocusRoi:" << scene_rdl2::str_util::boolStr(mPartialMergeFocusRoi) << '\n';
+    if (mPartialMergeFocusRoi) {
+        ostr << "  mPartialMergeFocusViewport:"
+             << "(" << mPartialMergeFocusViewport.mMinX << ',' << mPartialMergeFocusViewport.mMinY << ")-"
+             << "(" << mPartialMergeFocusViewport.mMaxX << ',' << mPartialMergeFocusViewport.mMaxY << ")\n";
+    }
+    ostr << "  mPartialMergeFocusGain:" << mPartialMergeFocusGain << '\n'
+         << "  mPartialMergeGenCount:" << mPartialMergeGenCount << '\n'
+         << "}";
+    return ostr.str();
+}
+
 void
 FbMsgSingleFrame::timeLogUpdate(const std::string& msg,
                                 scene_rdl2::rec_time::RecTimeLog& timeLog,
@@ -867,6 +2011,118 @@ FbMsgSingleFrame::showAllReceivedAndProgress(const std::string& hd) const
     return ostr.str();
 }
 
+std::string
+FbMsgSingleFrame::showCoalesceDecode() const
+{
+    std::ostringstream ostr;
+    ostr << "coalesceDecode (mCoalesceDecode:" << scene_rdl2::str_util::boolStr(mCoalesceDecode) << ") {\n";
+    for (size_t machineId = 0; machineId < mMessage.size(); ++machineId) {
+        ostr << "  machineId:" << std::setw(2) << std::setfill('0') << machineId << std::setfill(' ')
+             << " skipTotal:" << mMessage[machineId].getCoalesceSkipTotal()
+             << " probeMissTotal:" << mMessage[machineId].getCoalesceProbeMissTotal() << '\n';
+    }
+    ostr << "}";
+    return ostr.str();
+}
+
+std::string
+FbMsgSingleFrame::showFbMemStats() const
+{
+    auto showByte = [](const size_t byte) -> std::string {
+        std::ostringstream ostr;
+        ostr << std::fixed << std::setprecision(2) << static_cast<float>(byte) / (1024.0f * 1024.0f) << " MByte";
+        return ostr.str();
+    };
+
+    const FbMemStats stats = getFbMemStats();
+    std::ostringstream ostr;
+    ostr << "fbMem (estimation of all allocated buffers, see FbMsgFbPool::calcFbByte()) {\n"
+         << "  sparseMerge:" << scene_rdl2::str_util::boolStr(mSparseMerge)
+         << " active:" << scene_rdl2::str_util::boolStr(isSparseMergeActive() && !mOccupiedTilesUnknown) << '\n'
+         << "  allocatedFbTotal:" << stats.mAllocatedFbTotal << " (numMachines:" << mNumMachines << ")\n"
+         << "  denseByte:" << showByte(stats.mDenseByte) << '\n'
+         << "  occupiedTiles:" << stats.mOccupiedTilesTotal << '/' << stats.mTotalTiles << '\n'
+         << "  sparseSkipTilesTotal:" << stats.mSparseSkipTilesTotal << '\n'
+         << "}";
+    return ostr.str();
+}
+
+std::string
+FbMsgSingleFrame::showChanArena() const
+{
+    std::ostringstream ostr;
+    ostr << "chanArena {\n";
+    for (size_t machineId = 0; machineId < mMessage.size(); ++machineId) {
+        const FbMsgChanArena& arena = mMessage[machineId].getChanArena();
+        ostr << "  machineId:" << std::setw(2) << std::setfill('0') << machineId << std::setfill(' ')
+             << " live:" << arena.getLiveTotal()
+             << " free:" << arena.getFreeTotal()
+             << " highWaterMark:" << arena.getHighWaterMark()
+             << " acquire:" << arena.getAcquireTotal()
+             << " reuse:" << arena.getReuseTotal()
+             << " alloc:" << arena.getAllocTotal() << '\n';
+    }
+    ostr << "}";
+    return ostr.str();
+}
+
+std::string
+FbMsgSingleFrame::showBeautyHdriTileCount() const
+{
+    using scene_rdl2::str_util::boolStr;
+
+    size_t hdriTiles = 0;
+    size_t hdriPixTotal = 0;
+    for (const unsigned char count : mBeautyHdriTileCountTbl) {
+        if (count) hdriTiles++;
+        hdriPixTotal += count;
+    }
+
+    std::ostringstream ostr;
+    ostr << "beautyHdriTileCount {\n"
+         << "  mBeautyHdriTileCount:" << boolStr(mBeautyHdriTileCount) << '\n'
+         << "  mBeautyHdriTileCountValid:" << boolStr(mBeautyHdriTileCountValid) << '\n'
+         << "  hdriTiles:" << hdriTiles << '/' << mBeautyHdriTileCountTbl.size() << '\n'
+         << "  hdriPixTotal:" << hdriPixTotal << '\n'
+         << "}";
+    return ostr.str();
+}
+
+std::string
+FbMsgSingleFrame::showDeltaTiles() const
+{
+    using scene_rdl2::str_util::boolStr;
+
+    auto showDeltaTiles = [&]() -> std::string {
+        std::ostringstream ostr;
+        ostr << "mDeltaTilesTbl (machineTotal:" << mDeltaTilesTbl.size() << ") {\n";
+        for (size_t machineId = 0; machineId < mDeltaTilesTbl.size(); ++machineId) {
+            const std::vector<char>& currTbl = mDeltaTilesTbl[machineId];
+            ostr << "  machineId:" << std::setw(2) << std::setfill('0') << machineId
+                 << " deltaTiles:" << std::count(currTbl.begin(), currTbl.end(), static_cast<char>(true))
+                 << '/' << currTbl.size() << '\n';
+        }
+        ostr << "}";
+        return ostr.str();
+    };
+
+    std::ostringstream ostr;
+    ostr << "deltaTiles {\n"
+         << "  mIncrementalMerge:" << boolStr(mIncrementalMerge) << '\n'
+         << "  mDirtyTilesTracking:" << boolStr(mDirtyTilesTracking) << '\n'
+         << "  mDeltaTilesInvalid:" << boolStr(mDeltaTilesInvalid) << '\n'
+         << "  mDeltaTilesUnionTotal:" << mDeltaTilesUnionTotal << '\n'
+         << "  mIncrementalMergeCountTotal:" << mIncrementalMergeCountTotal << '\n'
+         << "  mMergeCountTotal:" << mMergeCountTotal << '\n'
+         << "  mMergedDirtyTilesAll:" << boolStr(mMergedDirtyTilesAll) << '\n'
+         << "  mergedDirtyTiles:"
+         << std::count(mMergedDirtyTilesTbl.begin(), mMergedDirtyTilesTbl.end(), static_cast<char>(true))
+         << '/' << mMergedDirtyTilesTbl.size() << '\n'
+         << scene_rdl2::str_util::addIndent(showDeltaTiles()) << '\n'
+         << "}";
+    return ostr.str();
+}
+
 void
 FbMsgSingleFrame::parserConfigure()
 {
@@ -875,6 +2131,152 @@ FbMsgSingleFrame::parserConfigure()
                 [&](Arg& arg) -> bool { return parserCommandMultiChan(arg); });
     mParser.opt("fb", "<machineId> ...command...", "show interl received fb data",
                 [&](Arg& arg) -> bool { return parserCommandFb(arg); });
+    mParser.opt("tileMajorMerge", "<on|off|show>", "set tile-major parallel merge mode",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mTileMajorMerge = (arg++).as<bool>(0);
+                    return arg.fmtMsg("tileMajorMerge %s\n", scene_rdl2::str_util::boolStr(mTileMajorMerge).c_str());
+                });
+    mParser.opt("tileMajorPartition", "<n|show>", "set tile partition total for tile-major merge. 0:auto",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mTileMajorMergePartitionTotal = (arg++).as<unsigned>(0);
+                    return arg.fmtMsg("tileMajorPartition %d\n", mTileMajorMergePartitionTotal);
+                });
+    mParser.opt("mergeBench", "<loopMax>", "merge performance test by 1 to N threads with current received data",
+                [&](Arg& arg) -> bool { return arg.msg(mergeBench((arg++).as<unsigned>(0)) + '\n'); });
+    mParser.opt("simdMerge", "<on|off|show>", "set beauty buffer accumulation by SIMD merge kernel",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else setSimdMerge((arg++).as<bool>(0));
+                    return arg.fmtMsg("simdMerge %s (isa:%s)\n",
+                                      scene_rdl2::str_util::boolStr(mSimdMerge).c_str(),
+                                      MergeKernel::isaStr(MergeKernel::getIsa()).c_str());
+                });
+    mParser.opt("mergeKernelIsa", "<scalar|avx2|avx512|show>", "set ISA of SIMD merge kernel",
+                [&](Arg& arg) -> bool {
+                    const std::string isa = (arg++)();
+                    bool flag = true;
+                    if (isa == "scalar") flag = MergeKernel::setIsa(MergeKernel::Isa::SCALAR);
+                    else if (isa == "avx2") flag = MergeKernel::setIsa(MergeKernel::Isa::AVX2);
+                    else if (isa == "avx512") flag = MergeKernel::setIsa(MergeKernel::Isa::AVX512);
+                    else if (isa != "show") return arg.msg("unknown isa:" + isa + '\n');
+                    if (!flag) arg.msg("not supported isa:" + isa + '\n');
+                    return arg.fmtMsg("mergeKernelIsa current:%s supported:%s\n",
+                                      MergeKernel::isaStr(MergeKernel::getIsa()).c_str(),
+                                      MergeKernel::isaStr(MergeKernel::getSupportedIsa()).c_str());
+                });
+    mParser.opt("mergeKernelBench", "<loopMax>", "SIMD merge kernel throughput test for all supported ISAs",
+                [&](Arg& arg) -> bool { return arg.msg(MergeKernel::bench((arg++).as<unsigned>(0)) + '\n'); });
+    mParser.opt("incrementalMerge", "<on|off|show>", "set incremental merge mode",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else setIncrementalMerge((arg++).as<bool>(0));
+                    return arg.msg(showDeltaTiles() + '\n');
+                });
+    mParser.opt("dirtyTilesTracking", "<on|off|show>", "set dirty tiles tracking mode for MergeFbSender HDRI test",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else setDirtyTilesTracking((arg++).as<bool>(0));
+                    return arg.msg(showDeltaTiles() + '\n');
+                });
+    mParser.opt("beautyHdriTileCount", "<on|off|show>",
+                "set per-tile beauty HDRI pixel count mode for MergeFbSender's precision decision",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else setBeautyHdriTileCount((arg++).as<bool>(0));
+                    return arg.msg(showBeautyHdriTileCount() + '\n');
+                });
+    mParser.opt("partialMergeOrder", "<scanline|focus|sampleDelta|oldest|show>",
+                "set tile order of asynchronous partial merge",
+                [&](Arg& arg) -> bool {
+                    const std::string order = (arg++)();
+                    if (order == "scanline") setPartialMergeTilesOrder(PartialMergeTilesOrder::SCANLINE);
+                    else if (order == "focus") setPartialMergeTilesOrder(PartialMergeTilesOrder::FOCUS);
+                    else if (order == "sampleDelta") setPartialMergeTilesOrder(PartialMergeTilesOrder::SAMPLE_DELTA);
+                    else if (order == "oldest") setPartialMergeTilesOrder(PartialMergeTilesOrder::OLDEST_MERGED);
+                    else if (order != "show") return arg.msg("unknown order:" + order + '\n');
+                    return arg.msg(showPartialMergeTilesOrder() + '\n');
+                });
+    mParser.opt("partialMergeFocus", "<minX> <minY> <maxX> <maxY>", "set focus ROI of partialMergeOrder focus",
+                [&](Arg& arg) -> bool {
+                    const int minX = (arg++).as<int>(0);
+                    const int minY = (arg++).as<int>(0);
+                    const int maxX = (arg++).as<int>(0);
+                    const int maxY = (arg++).as<int>(0);
+                    setPartialMergeFocusViewport(scene_rdl2::math::Viewport(minX, minY, maxX, maxY));
+                    return arg.msg(showPartialMergeTilesOrder() + '\n');
+                });
+    mParser.opt("partialMergeFocusCenter", "", "set screen center as focus of partialMergeOrder focus",
+                [&](Arg& arg) -> bool {
+                    resetPartialMergeFocusViewport();
+                    return arg.msg(showPartialMergeTilesOrder() + '\n');
+                });
+    mParser.opt("partialMergeFocusGain", "<gain|show>", "set focus gain of partialMergeOrder focus",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else setPartialMergeFocusGain((arg++).as<float>(0));
+                    return arg.msg(showPartialMergeTilesOrder() + '\n');
+                });
+    mParser.opt("partialMergeBudgetControl", "<on|off|show>", "set closed-loop partial merge tiles total control",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else setPartialMergeBudgetControl((arg++).as<bool>(0));
+                    return arg.fmtMsg("partialMergeBudgetControl %s\n",
+                                      scene_rdl2::str_util::boolStr(mPartialMergeBudgetControl).c_str());
+                });
+    mParser.opt("partialMergeController", "...command...", "partial merge tiles total controller command",
+                [&](Arg& arg) -> bool { return mPartialMergeTilesController.getParser().main(arg.childArg()); });
+    mParser.opt("coalesceDecode", "<on|off|show>", "set latest-wins coalescing of queued data for DELAY decode",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else setCoalesceDecode((arg++).as<bool>(0));
+                    return arg.msg(showCoalesceDecode() + '\n');
+                });
+    mParser.opt("subMergeInput", "<on|off|show>", "set sub-merge input mode for the root of the merge tree",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else setSubMergeInput((arg++).as<bool>(0));
+                    return arg.fmtMsg("subMergeInput %s\n", scene_rdl2::str_util::boolStr(mSubMergeInput).c_str());
+                });
+    mParser.opt("chanArena", "", "show channel recycling arena info of all machines",
+                [&](Arg& arg) -> bool { return arg.msg(showChanArena() + '\n'); });
+    mParser.opt("sparseMerge", "<on|off|show>", "set sparse merge for MULTIPLEX_PIX with DELAY decode",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else setSparseMerge((arg++).as<bool>(0));
+                    return arg.fmtMsg("sparseMerge %s (active:%s)\n",
+                                      scene_rdl2::str_util::boolStr(mSparseMerge).c_str(),
+                                      scene_rdl2::str_util::boolStr(isSparseMergeActive()).c_str());
+                });
+    mParser.opt("compactTileSet", "<on|off|show>", "set run-length/bitmap tile set encodings of feedback",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else setCompactTileSet((arg++).as<bool>(0));
+                    return arg.fmtMsg("compactTileSet %s\n", scene_rdl2::str_util::boolStr(mCompactTileSet).c_str());
+                });
+    mParser.opt("fbMem", "", "show per-machine fb memory info",
+                [&](Arg& arg) -> bool { return arg.msg(showFbMemStats() + '\n'); });
+    mParser.opt("memPressureDecodeDepth", "<n|show>", "set queue depth which triggers the decode at push under memory pressure",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else setMemPressureDecodeDepth((arg++).as<size_t>(0));
+                    return arg.fmtMsg("memPressureDecodeDepth %zu\n", mMemPressureDecodeDepth);
+                });
+    mParser.opt("feedbackTileDelta", "<on|off|show>", "set tile delta mode of the feedback image",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else setFeedbackTileDelta((arg++).as<bool>(0));
+                    return arg.msg(scene_rdl2::str_util::stringCat("feedbackTileDelta ",
+                                                                   scene_rdl2::str_util::boolStr(mFeedbackTileDelta),
+                                                                   '\n',
+                                                                   mFeedbackTileDeltaTracker.show(), '\n'));
+                });
+    mParser.opt("memAccount", "", "show memory accountant info",
+                [&](Arg& arg) -> bool {
+                    if (!mMemAccountant) return arg.msg("memory accountant is not set\n");
+                    return arg.msg(mMemAccountant->show() + '\n');
+                });
 }
 
 bool
@@ -897,8 +2299,12 @@ FbMsgSingleFrame::parserCommandFb(Arg& arg)
         arg.fmtMsg("machineId:%d is out of range. max:%d\n", machineId, mMessage.size());
         return false;
     }
+    if (!mFb[machineId]) {
+        arg.fmtMsg("machineId:%d fb is not allocated yet (lazy fb mode)\n", machineId);
+        return false;
+    }
 
-    return mFb[machineId].getParser().main(arg.childArg());
+    return mFb[machineId]->getParser().main(arg.childArg());
 }
 
 } // namespace mcrt_dataio
@@ -14,8 +14,13 @@
 // interval).
 //
 
+#include "FbMsgFbPool.h"
+#include "FbMsgIngestLock.h"
 #include "FbMsgMultiChans.h"
 #include "MergeActionTracker.h"
+#include "MergeFeedbackTileDelta.h"
+#include "MergeMemAccountant.h"
+#include "PartialMergeTilesController.h"
 
 #include <mcrt_messages/ProgressiveFrame.h>
 #include <scene_rdl2/common/grid_util/Arg.h>
@@ -27,6 +32,7 @@
 #include <scene_rdl2/render/cache/CacheDequeue.h>
 #include <scene_rdl2/render/cache/CacheEnqueue.h>
 
+#include <atomic>
 #include <vector>
 
 namespace scene_rdl2 {
@@ -56,6 +62,16 @@ public:
         MULTIPLEX_PIX        // multiplex pixel distribution mode
     };
 
+    // Tile order for asynchronous partial merge. SCANLINE is the original bottom to top scanline order.
+    // Other orders pick partialMergeTilesTotal tiles by priority for every partial merge. Any tile set
+    // is encoded by MergeActionTracker::mergePartial() and MCRT side feedback replay stays exact.
+    enum class PartialMergeTilesOrder : unsigned {
+        SCANLINE,     // bottom to top scanline order
+        FOCUS,        // tiles near the focus area (ROI or screen center) are merged more frequently
+        SAMPLE_DELTA, // tiles with the largest sample count delta since the last merge first
+        OLDEST_MERGED // tiles which are not merged for the longest time first
+    };
+
     FbMsgSingleFrame()
     {
         parserConfigure();
@@ -66,7 +82,123 @@ public:
 
     finline bool init(const int numMachines);
     finline bool initFb(const scene_rdl2::math::Viewport &rezedViewport); // original w, h. not needed tile aligned
+
+    // Lazy Fb mode. If fbPool is set, the per-machine Fb is acquired from fbPool when this frame receives
+    // the first data from that machine and is returned by recycle(). Without fbPool (default), all
+    // per-machine Fbs are allocated by init(). Changing the fbPool discards all the received data.
+    void setFbPool(FbMsgFbPool* fbPool);
+    FbMsgFbPool* getFbPool() const { return mFbPool; }
+    size_t getAllocatedFbTotal() const;
+
+    // Reset whole history by syncId and return all the per-machine Fbs to the fbPool under the lazy Fb
+    // mode. This is used when the frame is reused for a different syncId.
+    void recycle(const uint32_t syncId);
     void changeTaskType(const TaskType &type);
+    // Decode mode change should be done between frames. Queued data of the DELAY decode mode is decoded
+    // before switching to ONTHEFLY mode.
+    void changeDecodeMode(const DecodeMode &mode);
+
+    // Incremental merge mode only re-merges the tiles which are updated since the last merge and
+    // keeps the previous merge result for other tiles. This mode is only used under DELAY decode mode
+    // with non-partial-merge-mode and requires the same output fb for every merge() call.
+    void setIncrementalMerge(const bool flag);
+    bool getIncrementalMerge() const { return mIncrementalMerge; }
+
+    // Dirty tiles tracking keeps the tiles which are updated by the last merge() call. This info is
+    // handed to MergeFbSender and only limits the beauty/renderOutput HDRI scans of the runtime precision
+    // decision (and the feedback tile delta) to the updated tiles. The FbActivePixels snapshot and the
+    // PackTiles encode are done by scene_rdl2 and still walk the whole frame.
+    void setDirtyTilesTracking(const bool flag);
+    bool getDirtyTilesTracking() const { return mDirtyTilesTracking; }
+    finline const std::vector<char>* getMergedDirtyTilesTbl() const; // nullptr : all tiles are dirty
+
+    // Beauty HDRI tile count keeps the number of HDRI pixels (any channel > 1.0) of each tile of the
+    // output fb. The table is updated by merge() only for the merged tiles right after the accumulation.
+    // MergeFbSender uses this table for the runtime precision decision instead of scanning the beauty
+    // buffer. The table is consistent with the output fb as long as the fb is only updated by merge().
+    void setBeautyHdriTileCount(const bool flag);
+    bool getBeautyHdriTileCount() const { return mBeautyHdriTileCount; }
+    finline const std::vector<unsigned char>* getBeautyHdriTileCountTbl() const; // nullptr : not available
+
+    // Tile-major merge mode splits the tile space into partitions and each thread merges all
+    // machines and all buffers for its own tiles. The result is bit-identical to the default
+    // machine-major merge.
+    void setTileMajorMerge(const bool flag) { mTileMajorMerge = flag; }
+    bool getTileMajorMerge() const { return mTileMajorMerge; }
+    void setTileMajorMergePartitionTotal(const unsigned total) { mTileMajorMergePartitionTotal = total; } // 0:auto
+
+    // SIMD merge mode uses project-local MergeKernel (runtime selected AVX-512/AVX2/scalar kernel) for the beauty
+    // buffer accumulation instead of Fb::accumulateRenderBuffer(). Other buffers always use Fb.
+    void setSimdMerge(const bool flag) { mSimdMerge = flag; }
+    bool getSimdMerge() const { return mSimdMerge; }
+
+    void setPartialMergeTilesOrder(const PartialMergeTilesOrder order) { mPartialMergeTilesOrder = order; }
+    PartialMergeTilesOrder getPartialMergeTilesOrder() const { return mPartialMergeTilesOrder; }
+    void setPartialMergeFocusViewport(const scene_rdl2::math::Viewport& roi); // pixel coordinate
+    void resetPartialMergeFocusViewport(); // back to the screen center
+    void setPartialMergeFocusGain(const float gain); // focus tiles are merged up to (1 + gain) times more often
+
+    // Closed-loop control of the partial merge tiles total. If this is enabled, non-zero
+    // partialMergeTilesTotal of merge() is only used as the initial value and the controller decides the
+    // tiles total of each partial merge in order to keep the merge time inside the target budget.
+    // The chosen value and the measured cost are reported to GlobalNodeInfo.
+    void setPartialMergeBudgetControl(const bool flag) { mPartialMergeBudgetControl = flag; }
+    bool getPartialMergeBudgetControl() const { return mPartialMergeBudgetControl; }
+    PartialMergeTilesController& getPartialMergeTilesController() { return mPartialMergeTilesController; }
+
+    // Latest-wins coalescing of queued data under DELAY decode mode (see FbMsgMultiChans::setCoalesceDecode())
+    // Off by default. The flag is applied to all the machines.
+    void setCoalesceDecode(const bool flag);
+    bool getCoalesceDecode() const { return mCoalesceDecode; }
+
+    // Sub-merge input mode is used by the root merge of the hierarchical merge tree. Each machine of this
+    // frame is a sub-merge node which merges a subset of MCRT computations and sends its merged result by
+    // MergeFbSender::addSubMergeOutput(). Each sub-merge is treated as one machine which is weighted by
+    // numSample (see FbMsgMultiChans::setSubMergeInput()).
+    void setSubMergeInput(const bool flag);
+    bool getSubMergeInput() const { return mSubMergeInput; }
+
+    // Sparse merge mode is used under MULTIPLEX_PIX task type with DELAY decode mode. The tiles which
+    // are touched by the decode of each machine (occupied tiles) are tracked from the start of the frame
+    // and the accumulation of each machine only visits its occupied tiles (both machine-major and
+    // tile-major merge). This only reduces the accumulation cost and does not reduce memory usage because
+    // the per-machine Fb is still the dense layout of scene_rdl2::grid_util::Fb. (PackTiles decode and Fb
+    // accumulate access the dense tiled buffers directly, so a paged tile store is not possible here.)
+    // Off by default.
+    // Occupied tiles are unknown (i.e. all target tiles are merged) until the next frame if sparse merge
+    // is turned on, or the task type or decode mode is changed in the middle of the frame.
+    void setSparseMerge(const bool flag);
+    bool getSparseMerge() const { return mSparseMerge; }
+
+    // Run-length/bitmap tile set encodings of the feedback merge action sequence for all machines
+    // (see MergeActionTracker::setCompactTileSet()). Off by default and turn this on only when all MCRT
+    // computations can decode them.
+    void setCompactTileSet(const bool flag);
+    bool getCompactTileSet() const { return mCompactTileSet; }
+
+    // Memory pressure control by MergeMemAccountant (nullptr : disabled). If the accountant is over budget,
+    // garbageCollectUnusedBuffers() of each machine's Fb is executed by the next merge() without waiting
+    // for the heuristic condition, and push() decodes the queued data of the machine (with latest-wins
+    // coalescing if setCoalesceDecode(true)) when the queue depth of that machine reaches
+    // memPressureDecodeDepth.
+    void setMemAccountant(MergeMemAccountant* accountant) { mMemAccountant = accountant; }
+    void setMemPressureDecodeDepth(const size_t depth) { mMemPressureDecodeDepth = depth; }
+    size_t getMemPressureDecodeDepth() const { return mMemPressureDecodeDepth; }
+    // Following memory stats are able to be called concurrently with push(). They are the sum of the
+    // per-machine snapshot which is updated under the per-machine lock by push() and by decode/merge.
+    size_t getFbByte() const; // estimated byte of the allocated per-machine Fbs (see FbMsgFbPool)
+    size_t getQueuedByte() const; // total byte of the queued data of all machines
+    size_t getQueuedDepthMax() const; // max queue depth of all machines (see MergeSendRateController)
+    size_t getMergeActionTrackerByte() const; // total byte of the MergeActionTracker streams
+
+    struct FbMemStats {
+        size_t mAllocatedFbTotal {0};  // number of the allocated per-machine Fbs
+        size_t mDenseByte {0};         // estimated byte of the allocated per-machine Fbs (see FbMsgFbPool)
+        size_t mOccupiedTilesTotal {0}; // total occupied tiles of all machines
+        size_t mTotalTiles {0};        // total tiles of all allocated Fbs
+        uint64_t mSparseSkipTilesTotal {0}; // total tiles which are skipped by the sparse merge
+    };
+    FbMemStats getFbMemStats() const;
 
     finline void resetWholeHistory(const uint32_t syncId);
     finline void resetLastHistory();
@@ -81,8 +213,13 @@ public:
     finline bool isInitialFrameMessage(const mcrt::ProgressiveFrame& progressive,
                                        bool& forceSend) const;
 
-    bool push(const mcrt::ProgressiveFrame& progressive);
+    // Thread-safe for concurrent calls by multiple receive threads (see FbMsgSingleFrame.cc). Other APIs
+    // (decodeAll(), merge() and so on) should not be called concurrently with push(). The caller has to
+    // serialize them (see FbMsgMultiFrames::push()).
+    bool push(const mcrt::ProgressiveFrame& progressive, bool* readyAllUpdated = nullptr);
     void decodeAll();
+    // Partial merge keeps the not-merged tiles of fb from the previous merge. If fb is not the output fb
+    // of the previous merge (i.e. MergeFbSenderDoubleBuffer alternates 2 fbs), a full merge is used instead.
     void merge(const unsigned partialMergeTilesTotal, // 0:non-partial-merge-mode
                scene_rdl2::grid_util::Fb& fb,
                scene_rdl2::grid_util::LatencyLog& latencyLog); // fb is always clear internally and
@@ -94,8 +231,19 @@ public:
     static std::string decodeMergeActionTrackerAndDump(scene_rdl2::cache::CacheDequeue& dequeue,
                                                        const unsigned targetMachineId); // for test
 
+    // Feedback tile delta mode keeps the tiles which are updated by merge() since the last feedback of
+    // each machine (see MergeFeedbackTileDelta). The merge computation hands calcFeedbackDeltaTiles() to
+    // MergeFbSender::setFeedbackDeltaTilesTbl() before encoding the feedback image and calls feedbackSent()
+    // right after the feedback message is sent to the machine.
+    void setFeedbackTileDelta(const bool flag);
+    bool getFeedbackTileDelta() const { return mFeedbackTileDelta; }
+    const std::vector<char>* calcFeedbackDeltaTiles(const unsigned machineId); // nullptr : full feedback
+    void feedbackSent(const unsigned machineId);
+    MergeFeedbackTileDelta& getFeedbackTileDeltaTracker() { return mFeedbackTileDeltaTracker; }
+
     uint32_t getSyncId() const { return mMySyncId; }
     TaskType getTaskType() const { return mTaskType; }
+    DecodeMode getDecodeMode() const { return mDecodeMode; }
 
     size_t getReceivedMessagesTotal() const { return mReceivedMessagesTotal; }
     float getProgressTotal() const { return mProgressTotal; }
@@ -124,7 +272,8 @@ public:
 
     Parser& getParser() { return mParser; }
 
-    const scene_rdl2::grid_util::Fb& getFb(const unsigned machineId) const { return mFb[machineId]; } // for debug
+    // for debug. return nullptr if the fb is not allocated yet under the lazy Fb mode
+    const scene_rdl2::grid_util::Fb* getFb(const unsigned machineId) const { return mFb[machineId].get(); }
     const FbMsgMultiChans& getMultiChans(const unsigned machineId) const { return mMessage[machineId]; } // for debug
 
 private:
@@ -144,6 +293,8 @@ private:
     //    bool mFeedback {false}; // runtime feedback control condition
     bool mFeedbackActive {false}; // runtime feedback control condition
     std::vector<MergeActionTracker> mMergeActionTracker; // mMergeActionTracker[machineId]
+    bool mFeedbackTileDelta {false}; // send only the updated tiles since the last feedback of each machine
+    MergeFeedbackTileDelta mFeedbackTileDeltaTracker;
     size_t mReceivedInfoOnlyMessagesTotal {0}; // total recv info messages from last message sent
     size_t mReceivedInfoOnlyMessagesAll {0};   // all info messages total on this mySyncId 
     size_t mReceivedMessagesTotal {0};         // total recv msgs from last image sent on this mySyncId
@@ -176,8 +327,98 @@ private:
 
     bool mHasVecPacket {false};
 
+    FbMsgIngestLock mIngestLock; // per-machine and aggregate locks for the concurrent push()
+
     // combined result for each machine from start of rendering
-    std::vector<scene_rdl2::grid_util::Fb> mFb; // mFb[machineId] : auto resize by received ProgressiveFrame
+    // Under the lazy Fb mode, mFb[machineId] is nullptr until the first data of machineId is received.
+    FbMsgFbPool* mFbPool {nullptr}; // nullptr : all Fbs are allocated by init()
+    std::vector<FbMsgFbPool::FbShPtr> mFb; // mFb[machineId] : auto resize by received ProgressiveFrame
+
+    // delta tiles (= updated tiles by decode since last merge) related information
+    bool mIncrementalMerge {false};
+    bool mDirtyTilesTracking {false};
+    bool mDeltaTilesInvalid {true}; // previous merge result can not be used as the base of delta tiles
+    const scene_rdl2::grid_util::Fb* mDeltaTilesLastFb {nullptr}; // output fb of the last merge
+    scene_rdl2::math::Viewport mDeltaTilesLastViewport;
+    std::vector<std::vector<char>> mDeltaTilesTbl; // [machineId] : updated tiles since last merge
+    std::vector<char> mDeltaTilesUnionTbl;         // all machines' updated tiles
+    unsigned mDeltaTilesUnionTotal {0};            // updated tiles total of mDeltaTilesUnionTbl
+    unsigned mIncrementalMergeCountTotal {0};      // incremental merge total on this mySyncId
+    std::vector<char> mPartialMergeTilesTbl;       // last partial merge tiles table
+    const scene_rdl2::grid_util::Fb* mLastMergeFb {nullptr}; // output fb of the last merge (any mode)
+    bool mMergedDirtyTilesAll {true};              // all tiles are updated by the last merge
+    std::vector<char> mMergedDirtyTilesTbl;        // updated tiles by the last merge
+
+    // tile-major merge related information
+    bool mTileMajorMerge {false};
+    unsigned mTileMajorMergePartitionTotal {0};    // 0 : same as max concurrency
+
+    bool mSimdMerge {false}; // beauty buffer accumulation by MergeKernel
+
+    // per-tile beauty HDRI pixel count related information
+    bool mBeautyHdriTileCount {false};
+    bool mBeautyHdriTileCountValid {false};  // table is consistent with the output fb of the last merge
+    bool mBeautyHdriTileCountStale {false};  // all tiles need to be counted by the current merge
+    bool mBeautyHdriTileCountFused {false};  // merged tiles are already counted by tile-major merge
+    const scene_rdl2::grid_util::Fb* mBeautyHdriTileCountFb {nullptr}; // output fb of the last count
+    std::vector<unsigned char> mBeautyHdriTileCountTbl; // [tileId] : HDRI pixel count (0 ~ 64)
+
+    bool mCoalesceDecode {false}; // latest-wins coalescing of queued data under DELAY decode mode
+    bool mSubMergeInput {false}; // all machines are sub-merge nodes of the hierarchical merge tree
+
+    MergeMemAccountant* mMemAccountant {nullptr};
+    size_t mMemPressureDecodeDepth {2}; // queue depth which triggers the decode at push() under memory pressure
+
+    // Per-machine memory snapshot for the memory accounting. Each machine's item is only updated by the
+    // owner of the per-machine lock (or by the APIs which are not concurrent with push()) and is read
+    // without the lock by the getters. Copy is only used by std::vector resize.
+    struct MachineMemStat {
+        std::atomic<size_t> mFbByte {0};
+        std::atomic<size_t> mQueuedByte {0};
+        std::atomic<size_t> mQueuedDepth {0};
+        std::atomic<size_t> mTrackerByte {0};
+
+        MachineMemStat() = default;
+        MachineMemStat(const MachineMemStat& src) { *this = src; }
+        MachineMemStat& operator = (const MachineMemStat& src)
+        {
+            mFbByte = src.mFbByte.load();
+            mQueuedByte = src.mQueuedByte.load();
+            mQueuedDepth = src.mQueuedDepth.load();
+            mTrackerByte = src.mTrackerByte.load();
+            return *this;
+        }
+    };
+    std::vector<MachineMemStat> mMachineMemStat; // [machineId]
+
+    bool mCompactTileSet {false}; // run-length/bitmap tile set encodings for MergeActionTracker
+
+    // sparse merge related information
+    bool mSparseMerge {false};
+    bool mOccupiedTilesUnknown {false}; // occupied tiles are not tracked from the start of this frame
+    std::vector<std::vector<char>> mOccupiedTilesTbl; // [machineId][tileId] : touched by decode on this frame
+    std::vector<std::vector<char>> mDecodedTilesTbl;  // [machineId][tileId] : work memory for decode
+    std::vector<char> mSparseMergeTilesTbl;           // work memory for the accumulation of single machine
+    std::vector<std::vector<char>> mSparseMergeTilesTblArray; // [machineId] : work memory for tile-major merge
+    uint64_t mSparseSkipTilesTotal {0};
+
+    // priority-ordered partial merge related information
+    PartialMergeTilesOrder mPartialMergeTilesOrder {PartialMergeTilesOrder::SCANLINE};
+    bool mPartialMergeFocusRoi {false};                 // use ROI as focus area. false = screen center
+    scene_rdl2::math::Viewport mPartialMergeFocusViewport;
+    float mPartialMergeFocusGain {3.0f};
+    uint32_t mPartialMergeGenCount {0};                 // total priority-ordered partial merge tiles table gen
+    std::vector<uint32_t> mPartialMergeTileLastMerged;  // [tileId] : mPartialMergeGenCount of the last merge
+    std::vector<uint64_t> mPartialMergeTileSamples;     // [tileId] : all machines' samples total
+    std::vector<uint64_t> mPartialMergeTileMergedSamples; // [tileId] : samples total at the last merge
+    std::vector<float> mPartialMergeTileWeight;         // [tileId] : focus weight. empty = need to update
+    std::vector<unsigned> mPartialMergeTileIdWork;      // work memory for priority selection
+
+    // closed-loop partial merge tiles total control
+    bool mPartialMergeBudgetControl {false};
+    PartialMergeTilesController mPartialMergeTilesController;
+    float mLastPartialMergeFbResetMs {0.0f};     // last partial merge fb reset cost : millisec
+    float mLastPartialMergeAccumulateMs {0.0f};  // last partial merge accumulate cost : millisec
 
     uint32_t mDecodeCountTotal {0};
     uint32_t mMergeCountTotal {0};
@@ -198,26 +439,74 @@ private:
 
     uint64_t getCurrentMicroSec() const;
 
+    void allocFb(const size_t machineId); // might throw std::bad_alloc
+    void releaseFb(); // return all Fbs to the fbPool. Should be used with resetWholeHistory()
+    const scene_rdl2::grid_util::Fb* getRefFb() const; // first allocated fb for resolution info
+
+    bool isSparseMergeActive() const;
+    std::vector<char>* getDecodeTilesTbl(const int machineId);
+    void updateOccupiedTiles(const int machineId);
+    const std::vector<char>* sparseMergeTilesTblGen(const std::vector<char>* partialMergeTilesTbl,
+                                                    const int machineId,
+                                                    std::vector<char>& workTbl);
+
+    bool isMemPressure() const { return mMemAccountant && mMemAccountant->isOverBudget(); }
+    void updateMachineMemStat(const size_t machineId);
+    void decodeSingleMachine(const int machineId);
     void decodeFirstPushedData();
     void decodeAllPushedData();
     void mergeFirstFb(scene_rdl2::grid_util::Fb& fb, scene_rdl2::grid_util::LatencyLog& latencyLog);
     void mergeAllFb(scene_rdl2::grid_util::Fb& fb, scene_rdl2::grid_util::LatencyLog& latencyLog);
     void mergeAllFb(const unsigned partialMergeTilesTotal,
                     scene_rdl2::grid_util::Fb& fb, scene_rdl2::grid_util::LatencyLog& latencyLog);
+    bool isDeltaTilesTrackingActive() const { return mIncrementalMerge || mDirtyTilesTracking; }
+    bool isDeltaTilesValid(const scene_rdl2::grid_util::Fb& fb) const;
+    void deltaTilesUnionGen(const unsigned totalTiles);
+    void updateMergedDirtyTiles(const bool firstMerge, const bool partialMerge, const bool deltaTilesValid);
+    void mergeDeltaFb(scene_rdl2::grid_util::Fb& fb, scene_rdl2::grid_util::LatencyLog& latencyLog);
     void mergeSingleFb(const std::vector<char>* partialMergeTilesTbl, const int machineId,
                        scene_rdl2::grid_util::Fb& fb);
+    void mergeAllMachinesTileMajor(const std::vector<char>* partialMergeTilesTbl, scene_rdl2::grid_util::Fb& fb);
+    bool isMergeTargetMachine(const int machineId) const;
+    void accumulateSingleFb(const std::vector<char>* partialMergeTilesTbl, const int machineId,
+                            scene_rdl2::grid_util::Fb& fb);
+    void accumulateRenderBuffer(const std::vector<char>* partialMergeTilesTbl, const int machineId,
+                                scene_rdl2::grid_util::Fb& fb);
+    void accumulateAllFbTileMajor(const std::vector<char>* partialMergeTilesTbl, scene_rdl2::grid_util::Fb& fb,
+                                  std::vector<unsigned char>* hdriTileCountTbl = nullptr);
+    void beautyHdriTileCountPrep(const scene_rdl2::grid_util::Fb& fb, const bool firstMerge);
+    void updateBeautyHdriTileCount(const std::vector<char>* mergedTilesTbl, scene_rdl2::grid_util::Fb& fb);
+    static void countBeautyHdriTiles(const std::vector<char>* tilesTbl,
+                                     const unsigned startTileId,
+                                     const unsigned endTileId,
+                                     scene_rdl2::grid_util::Fb& fb,
+                                     std::vector<unsigned char>& hdriTileCountTbl);
+    void updateMergeActionTracker(const std::vector<char>* partialMergeTilesTbl, const int machineId);
+    std::string mergeBench(const unsigned loopMax);
     bool verifyMergedResultNumSample(const scene_rdl2::grid_util::Fb& mergedFb) const;
     bool verifyMergedResultNumSampleSingleHost(const int machineId,
                                                const scene_rdl2::grid_util::Fb& mergedFb) const;
 
     void partialMergeTilesTblGen(const unsigned partialMergeTilesTotal,
                                  std::vector<char>& partialMergeTilesTbl);
+    void partialMergeTilesPriorityTblGen(const unsigned partialMergeTilesTotal,
+                                         std::vector<char>& partialMergeTilesTbl);
+    void partialMergeTileWeightGen(const scene_rdl2::grid_util::Fb& fb);
+    void partialMergeTileSamplesGen(const unsigned totalTiles);
+    void resetPartialMergeTilesPriority();
+    static std::string partialMergeTilesOrderStr(const PartialMergeTilesOrder order);
+    std::string showPartialMergeTilesOrder() const;
 
     void timeLogUpdate(const std::string& msg,
                        scene_rdl2::rec_time::RecTimeLog& timeLog, const uint64_t startMicroSec) const;
 
     std::string showMessageAndReceived(const std::string& hd) const;
     std::string showAllReceivedAndProgress(const std::string& hd) const;
+    std::string showBeautyHdriTileCount() const;
+    std::string showDeltaTiles() const;
+    std::string showCoalesceDecode() const;
+    std::string showChanArena() const;
+    std::string showFbMemStats() const;
 
     void parserConfigure();
     bool parserCommandMultiChan(Arg& arg);
@@ -234,8 +523,14 @@ FbMsgSingleFrame::init(const int numMachines)
 
     try {
         mMessage.resize(numMachines);
+        mIngestLock.init(numMachines);
         mReceived.resize(numMachines);
         mMergeActionTracker.resize(numMachines);
+        mDeltaTilesTbl.resize(numMachines);
+        mOccupiedTilesTbl.resize(numMachines);
+        mMachineMemStat.resize(numMachines);
+        mSparseMergeTilesTblArray.resize(numMachines);
+        mDecodedTilesTbl.resize(numMachines);
 
         mReceivedAll.resize(numMachines);
         mReceivedMessagesTotalAll.resize(numMachines);
@@ -246,12 +541,17 @@ FbMsgSingleFrame::init(const int numMachines)
         mProgressAll.resize(numMachines);
         mStatusAll.resize(numMachines);
 
+        releaseFb(); // whole history is reset below
         mFb.resize(numMachines);
         // We need to update fb size here
         for (size_t machineId = 0; machineId < (size_t)numMachines; ++machineId) {
             mMessage[machineId].setGlobalNodeInfo(mGlobalNodeInfo);
+            mMessage[machineId].setCoalesceDecode(mCoalesceDecode);
+            mMessage[machineId].setSubMergeInput(mSubMergeInput);
             mMergeActionTracker[machineId].setMachineId(static_cast<unsigned>(machineId));
-            mFb[machineId].init(mRezedViewport);
+            mMergeActionTracker[machineId].setCompactTileSet(mCompactTileSet);
+            if (!mFbPool) allocFb(machineId); // lazy Fb mode allocates Fb when receiving data
+            updateMachineMemStat(machineId);
         }
     }
     catch (...) {
@@ -273,11 +573,10 @@ FbMsgSingleFrame::initFb(const scene_rdl2::math::Viewport& rezedViewport)
 
     try {
         for (size_t machineId = 0; machineId < mFb.size(); ++machineId) {
-            mFb[machineId].init(mRezedViewport);
-
-            std::ostringstream ostr;
-            ostr << "FbMsgSingleFrame-mId:" << machineId;
-            mFb[machineId].setDebugTag(ostr.str());
+            if (!mFb[machineId]) continue; // lazy Fb mode : not allocated yet
+            if (mFbPool) mFbPool->release(std::move(mFb[machineId])); // swap to the new resolution Fb
+            allocFb(machineId);
+            updateMachineMemStat(machineId);
         }
     }
     catch (...) {
@@ -302,7 +601,11 @@ FbMsgSingleFrame::resetWholeHistory(const uint32_t syncId)
         mCoarsePassAll[machineId] = static_cast<char>(true);
         mProgressAll[machineId] = 0.0f;
         mStatusAll[machineId] = mcrt::BaseFrame::FINISHED;
+        mDeltaTilesTbl[machineId].clear();
+        mOccupiedTilesTbl[machineId].clear();
+        mDecodedTilesTbl[machineId].clear();
     }
+    mOccupiedTilesUnknown = false;
     mActiveMachines = 0;
     mFirstMachineId = -1;
     mDenoiserAlbedoInputName.clear();
@@ -311,8 +614,15 @@ FbMsgSingleFrame::resetWholeHistory(const uint32_t syncId)
     mHasVecPacket = false;
     mDecodeCountTotal = 0;
     mMergeCountTotal = 0;
+    mLastMergeFb = nullptr;
     mEncodeLatencyLogCountTotal = 0;
+    mDeltaTilesInvalid = true;
+    mIncrementalMergeCountTotal = 0;
+    mMergedDirtyTilesAll = true;
+    mBeautyHdriTileCountValid = false;
     mSnapshotStartTimeTotal = 0;
+    resetPartialMergeTilesPriority();
+    mFeedbackTileDeltaTracker.reset(static_cast<unsigned>(mNumMachines), 0); // MCRT resets feedback Fb too
 }
 
 finline void    
@@ -357,6 +667,18 @@ FbMsgSingleFrame::isInitialFrameMessage(const mcrt::ProgressiveFrame& progressiv
     return false;
 }
 
+finline const std::vector<char>*
+FbMsgSingleFrame::getMergedDirtyTilesTbl() const
+{
+    return (mMergedDirtyTilesAll) ? nullptr : &mMergedDirtyTilesTbl;
+}
+
+finline const std::vector<unsigned char>*
+FbMsgSingleFrame::getBeautyHdriTileCountTbl() const
+{
+    return (mBeautyHdriTileCount && mBeautyHdriTileCountValid) ? &mBeautyHdriTileCountTbl : nullptr;
+}
+
 finline float
 FbMsgSingleFrame::getProgressFraction() const
 {
@@ -259,6 +259,54 @@ GlobalNodeInfo::setMergeSendFeedbackBps(const float bytesPerSec) // Byte/Sec
     mInfoCodec.setFloat("mergeSendFeedbackBps", bytesPerSec, &mMergeSendFeedbackBps);
 }
 
+void
+GlobalNodeInfo::setMergeFeedbackTileDeltaRatio(const float ratio) // fraction
+{
+    mInfoCodec.setFloat("mergeFeedbackTileDeltaRatio", ratio, &mMergeFeedbackTileDeltaRatio);
+}
+
+void
+GlobalNodeInfo::setMergePartialMergeTiles(const int total)
+{
+    mInfoCodec.setInt("mergePartialMergeTiles", total, &mMergePartialMergeTiles);
+}
+
+void
+GlobalNodeInfo::setMergePartialMergeCost(const float ms) // millisec
+{
+    mInfoCodec.setFloat("mergePartialMergeCost", ms, &mMergePartialMergeCost);
+}
+
+void
+GlobalNodeInfo::setMergeMemFbByte(const size_t byte)
+{
+    mInfoCodec.setSizeT("mergeMemFbByte", byte, &mMergeMemFbByte);
+}
+
+void
+GlobalNodeInfo::setMergeMemQueuedByte(const size_t byte)
+{
+    mInfoCodec.setSizeT("mergeMemQueuedByte", byte, &mMergeMemQueuedByte);
+}
+
+void
+GlobalNodeInfo::setMergeMemSendBufferByte(const size_t byte)
+{
+    mInfoCodec.setSizeT("mergeMemSendBufferByte", byte, &mMergeMemSendBufferByte);
+}
+
+void
+GlobalNodeInfo::setMergeMemTrackerByte(const size_t byte)
+{
+    mInfoCodec.setSizeT("mergeMemTrackerByte", byte, &mMergeMemTrackerByte);
+}
+
+void
+GlobalNodeInfo::setMergeMemBudget(const size_t byte)
+{
+    mInfoCodec.setSizeT("mergeMemBudget", byte, &mMergeMemBudget);
+}
+
 //------------------------------------------------------------------------------------------
 
 int
@@ -420,6 +468,9 @@ GlobalNodeInfo::encode(std::string& outputData)
 bool
 GlobalNodeInfo::decode(const std::string& inputData)
 {
+    // decode() might be called by multiple message receive threads at the same time.
+    std::lock_guard<std::mutex> lock(mDecodeMutex);
+
     auto decodeMcrtNodeInfoMap = [&](int id, std::string& itemInfoData) -> bool {
         if (mMcrtNodeInfoMap.find(id) == mMcrtNodeInfoMap.end()) {
             mMcrtNodeInfoMap[id].reset(new McrtNodeInfo(mInfoCodec.getDecodeOnly(),
@@ -507,6 +558,22 @@ GlobalNodeInfo::decode(const std::string& inputData)
                 setMergeSendFeedbackFps(f);
             } else if (mInfoCodec.getFloat("mergeSendFeedbackBps", f)) {
                 setMergeSendFeedbackBps(f);
+            } else if (mInfoCodec.getFloat("mergeFeedbackTileDeltaRatio", f)) {
+                setMergeFeedbackTileDeltaRatio(f);
+            } else if (mInfoCodec.getInt("mergePartialMergeTiles", i)) {
+                setMergePartialMergeTiles(i);
+            } else if (mInfoCodec.getFloat("mergePartialMergeCost", f)) {
+                setMergePartialMergeCost(f);
+            } else if (mInfoCodec.getSizeT("mergeMemFbByte", t)) {
+                setMergeMemFbByte(t);
+            } else if (mInfoCodec.getSizeT("mergeMemQueuedByte", t)) {
+                setMergeMemQueuedByte(t);
+            } else if (mInfoCodec.getSizeT("mergeMemSendBufferByte", t)) {
+                setMergeMemSendBufferByte(t);
+            } else if (mInfoCodec.getSizeT("mergeMemTrackerByte", t)) {
+                setMergeMemTrackerByte(t);
+            } else if (mInfoCodec.getSizeT("mergeMemBudget", t)) {
+                setMergeMemBudget(t);
 
             } else if (mInfoCodec.decodeTable("mcrtNodeInfoMap", itemKeyStr, str)) {
                 return decodeMcrtNodeInfoMap(std::stoi(itemKeyStr), str);
@@ -954,6 +1021,13 @@ GlobalNodeInfo::showMergeInfo() const
          << "  mMergeRecvBps:" << bytesPerSecShow(mMergeRecvBps) << '\n'
          << "  mMergeSendBps:" << bytesPerSecShow(mMergeSendBps) << '\n'
          << "  mMergeProgress:" << pctShow(mMergeProgress) << '\n'
+         << "  mMergePartialMergeTiles:" << mMergePartialMergeTiles << '\n'
+         << "  mMergePartialMergeCost:" << msShow(mMergePartialMergeCost) << '\n'
+         << "  mMergeMemFbByte:" << scene_rdl2::str_util::byteStr(mMergeMemFbByte) << '\n'
+         << "  mMergeMemQueuedByte:" << scene_rdl2::str_util::byteStr(mMergeMemQueuedByte) << '\n'
+         << "  mMergeMemSendBufferByte:" << scene_rdl2::str_util::byteStr(mMergeMemSendBufferByte) << '\n'
+         << "  mMergeMemTrackerByte:" << scene_rdl2::str_util::byteStr(mMergeMemTrackerByte) << '\n'
+         << "  mMergeMemBudget:" << scene_rdl2::str_util::byteStr(mMergeMemBudget) << '\n'
          << addIndent(showMergeFeedbackInfo()) << '\n'
          << "}";
     return ostr.str();
@@ -985,7 +1059,13 @@ GlobalNodeInfo::showMergeFeedbackInfo() const
         ostr << "  mMergeFeedbackInterval:" << mMergeFeedbackInterval << " sec\n"
              << "  mMergeEvalFeedbackTime:" << msShow(mMergeEvalFeedbackTime) << '\n'
              << "  mMergeSendFeedbackFps:" << mMergeSendFeedbackFps << '\n'
-             << "  mMergeSendFeedbackBps:" << bytesPerSecShow(mMergeSendFeedbackBps) << '\n';
+             << "  mMergeSendFeedbackBps:" << bytesPerSecShow(mMergeSendFeedbackBps) << '\n'
+             << "  mMergeFeedbackTileDeltaRatio:" << mMergeFeedbackTileDeltaRatio << '\n';
+        if (mMergeFeedbackTileDeltaRatio > 0.0f && mMergeFeedbackTileDeltaRatio < 1.0f) {
+            // estimated bandwidth which is saved by the feedback tile delta
+            const float fullBps = mMergeSendFeedbackBps / mMergeFeedbackTileDeltaRatio;
+            ostr << "  feedbackTileDeltaSaved:" << bytesPerSecShow(fullBps - mMergeSendFeedbackBps) << '\n';
+        }
     }
     ostr << "}";
     return ostr.str();
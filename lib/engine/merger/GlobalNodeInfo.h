@@ -13,6 +13,7 @@
 
 #include <functional>
 #include <memory> // shared_ptr
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -99,6 +100,16 @@ public:
     void setMergeEvalFeedbackTime(const float ms); // MTsafe millisec
     void setMergeSendFeedbackFps(const float fps); // MTsafe fps
     void setMergeSendFeedbackBps(const float bytesPerSec); // MTsafe Byte/Sec
+    void setMergeFeedbackTileDeltaRatio(const float ratio); // MTsafe fraction
+
+    void setMergePartialMergeTiles(const int total); // MTsafe
+    void setMergePartialMergeCost(const float ms); // MTsafe millisec
+
+    void setMergeMemFbByte(const size_t byte); // MTsafe byte
+    void setMergeMemQueuedByte(const size_t byte); // MTsafe byte
+    void setMergeMemSendBufferByte(const size_t byte); // MTsafe byte
+    void setMergeMemTrackerByte(const size_t byte); // MTsafe byte
+    void setMergeMemBudget(const size_t byte); // MTsafe byte : 0 = unlimited
 
     const std::string& getMergeHostName() const { return mMergeHostName; }
     int getMergeClockDeltaSvrPort() const { return mMergeClockDeltaSvrPort; }
@@ -121,6 +132,16 @@ public:
     float getMergeEvalFeedbackTime() const { return mMergeEvalFeedbackTime; } // millisec
     float getMergeSendFeedbackFps() const { return mMergeSendFeedbackFps; } // fps
     float getMergeSendFeedbackBps() const { return mMergeSendFeedbackBps; } // Byte/Sec
+    float getMergeFeedbackTileDeltaRatio() const { return mMergeFeedbackTileDeltaRatio; } // fraction
+
+    int getMergePartialMergeTiles() const { return mMergePartialMergeTiles; }
+    float getMergePartialMergeCost() const { return mMergePartialMergeCost; } // millisec
+
+    size_t getMergeMemFbByte() const { return mMergeMemFbByte; } // byte
+    size_t getMergeMemQueuedByte() const { return mMergeMemQueuedByte; } // byte
+    size_t getMergeMemSendBufferByte() const { return mMergeMemSendBufferByte; } // byte
+    size_t getMergeMemTrackerByte() const { return mMergeMemTrackerByte; } // byte
+    size_t getMergeMemBudget() const { return mMergeMemBudget; } // byte
 
     ValueTimeTrackerShPtr getMergeNetRecvVtt() const { return mMergeNetRecvVtt; }
     ValueTimeTrackerShPtr getMergeNetSendVtt() const { return mMergeNetSendVtt; }
@@ -218,6 +239,19 @@ private:
     float mMergeEvalFeedbackTime {0.0f}; // merge computation feedback evaluation cost : millisec
     float mMergeSendFeedbackFps {0.0f};  // merge computation outgoing feedback message send fps
     float mMergeSendFeedbackBps {0.0f};  // merge computation outgoing feedback message bandwidth : Byte/Sec
+    float mMergeFeedbackTileDeltaRatio {1.0f}; // sent tiles / full feedback tiles by feedback tile delta
+
+    int mMergePartialMergeTiles {0};       // partial merge tiles total decided by closed-loop control
+    float mMergePartialMergeCost {0.0f};   // measured partial merge cost (fbReset + accumulate) : millisec
+
+    // memory accounting by MergeMemAccountant
+    size_t mMergeMemFbByte {0};         // per-machine Fbs : byte
+    size_t mMergeMemQueuedByte {0};     // queued payloads which are not decoded yet : byte
+    size_t mMergeMemSendBufferByte {0}; // MergeFbSender work buffers : byte
+    size_t mMergeMemTrackerByte {0};    // MergeActionTracker streams : byte
+    size_t mMergeMemBudget {0};         // memory budget : byte. 0 = unlimited
+
+    std::mutex mDecodeMutex; // serialize decode() from the concurrent message ingest
 
     std::mutex mMergeGenericCommentMutex;
     std::string mMergeGenericComment; // merge computation's generic comment data for any purpose
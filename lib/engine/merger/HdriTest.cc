@@ -0,0 +1,147 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "HdriTest.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif // end __AVX2__
+
+namespace {
+
+inline bool
+isBeautyHdriPix(const scene_rdl2::math::Vec4f& c)
+{
+    return (c.x > 1.0f || c.y > 1.0f || c.z > 1.0f || c.w > 1.0f);
+}
+
+inline bool
+isRenderOutputHdriPix(const float* p, const unsigned int ns, const size_t pixFloatCount)
+{
+    if (ns == 0) return false;
+    const float max = static_cast<float>(ns);
+    for (size_t j = 0; j < pixFloatCount; ++j) {
+        if (p[j] > max) return true;
+    }
+    return false;
+}
+
+#ifdef __AVX2__
+inline unsigned
+beautyHdriMask8Pix(const float* p, const __m256 one)
+//
+// Return HDRI pixel mask of 8 pixels (= 32 floats). Bit (i * 4) is set if pixel i is HDRI.
+//
+{
+    const unsigned m0 = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p     ), one, _CMP_GT_OQ));
+    const unsigned m1 = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p +  8), one, _CMP_GT_OQ));
+    const unsigned m2 = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p + 16), one, _CMP_GT_OQ));
+    const unsigned m3 = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p + 24), one, _CMP_GT_OQ));
+    unsigned m = m0 | (m1 << 8) | (m2 << 16) | (m3 << 24); // 4 bits (= xyzw) per pixel
+    m |= m >> 1;
+    m |= m >> 2;
+    return m & 0x11111111;
+}
+#endif // end __AVX2__
+
+} // namespace
+
+namespace mcrt_dataio {
+
+// static function
+unsigned
+HdriTest::countBeautyPix(const Vec4f* c, const size_t pixTotal)
+{
+    unsigned total = 0;
+    size_t pixId = 0;
+#ifdef __AVX2__
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const float* p = reinterpret_cast<const float*>(c);
+    for (; pixId + 8 <= pixTotal; pixId += 8) {
+        total += __builtin_popcount(beautyHdriMask8Pix(p + pixId * 4, one));
+    }
+#endif // end __AVX2__
+    for (; pixId < pixTotal; ++pixId) {
+        if (isBeautyHdriPix(c[pixId])) total++;
+    }
+    return total;
+}
+
+// static function
+bool
+HdriTest::scanBeautyPix(const Vec4f* c,
+                        const size_t startPix,
+                        const size_t endPix,
+                        const size_t hdriLimit,
+                        size_t& hdriTotal)
+{
+    size_t pixId = startPix;
+#ifdef __AVX2__
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const float* p = reinterpret_cast<const float*>(c);
+    for (; pixId + 8 <= endPix; pixId += 8) {
+        const unsigned mask = beautyHdriMask8Pix(p + pixId * 4, one);
+        if (!mask) continue;
+        hdriTotal += __builtin_popcount(mask);
+        if (hdriTotal > hdriLimit) return true;
+    }
+#endif // end __AVX2__
+    for (; pixId < endPix; ++pixId) {
+        if (isBeautyHdriPix(c[pixId])) {
+            if (++hdriTotal > hdriLimit) return true;
+        }
+    }
+    return false;
+}
+
+// static function
+bool
+HdriTest::scanRenderOutputPix(const float* p,
+                              const unsigned int* ns,
+                              const size_t pixFloatCount,
+                              const size_t startPix,
+                              const size_t endPix,
+                              const size_t hdriLimit,
+                              size_t& hdriTotal)
+{
+    size_t pixId = startPix;
+#ifdef __AVX2__
+    if (pixFloatCount == 1) {
+        // FLOAT : 8 pixels at once. numSample is small enough to be converted as signed int.
+        const __m256i zero = _mm256_setzero_si256();
+        for (; pixId + 8 <= endPix; pixId += 8) {
+            const __m256i nsv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ns + pixId));
+            const __m256 valid = _mm256_castsi256_ps(_mm256_cmpgt_epi32(nsv, zero));
+            const __m256 hdri = _mm256_cmp_ps(_mm256_loadu_ps(p + pixId), _mm256_cvtepi32_ps(nsv), _CMP_GT_OQ);
+            const unsigned mask = _mm256_movemask_ps(_mm256_and_ps(hdri, valid));
+            if (!mask) continue;
+            hdriTotal += __builtin_popcount(mask);
+            if (hdriTotal > hdriLimit) return true;
+        }
+    } else if (pixFloatCount == 4) {
+        // FLOAT4 : 2 pixels at once
+        for (; pixId + 2 <= endPix; pixId += 2) {
+            const unsigned ns0 = ns[pixId];
+            const unsigned ns1 = ns[pixId + 1];
+            if (ns0 == 0 && ns1 == 0) continue;
+            const float max0 = static_cast<float>(ns0);
+            const float max1 = static_cast<float>(ns1);
+            const __m256 max = _mm256_setr_ps(max0, max0, max0, max0, max1, max1, max1, max1);
+            unsigned mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p + pixId * 4), max, _CMP_GT_OQ));
+            if (ns0 == 0) mask &= 0xf0;
+            if (ns1 == 0) mask &= 0x0f;
+            if (!mask) continue;
+            hdriTotal += ((mask & 0x0f) ? 1 : 0) + ((mask & 0xf0) ? 1 : 0);
+            if (hdriTotal > hdriLimit) return true;
+        }
+    }
+#endif // end __AVX2__
+    for (; pixId < endPix; ++pixId) {
+        if (isRenderOutputHdriPix(p + pixId * pixFloatCount, ns[pixId], pixFloatCount)) {
+            if (++hdriTotal > hdriLimit) return true;
+        }
+    }
+    return false;
+}
+
+} // namespace mcrt_dataio
@@ -0,0 +1,49 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+//
+// -- HDRI pixel test kernels --
+//
+// HDRI pixel count/scan functions which are used by the runtime precision decision of
+// MergeFbSender. All functions assume tiled buffer layout (64 pixels per tile) and use AVX2
+// when the build target supports it. Otherwise fall back to the scalar implementation.
+// The result is the same regardless of the implementation.
+//
+
+#include <scene_rdl2/common/math/Vec4.h>
+
+#include <cstddef>
+
+namespace mcrt_dataio {
+
+class HdriTest
+{
+public:
+    using Vec4f = scene_rdl2::math::Vec4f;
+
+    // Return total number of the beauty pixels which have at least one channel greater than 1.0
+    static unsigned countBeautyPix(const Vec4f* c, const size_t pixTotal);
+
+    // Scan beauty pixels between startPix and endPix and add the number of HDRI pixels to hdriTotal.
+    // Return true (early exit) when hdriTotal exceeds hdriLimit.
+    static bool scanBeautyPix(const Vec4f* c,
+                              const size_t startPix,
+                              const size_t endPix,
+                              const size_t hdriLimit,
+                              size_t& hdriTotal);
+
+    // Scan renderOutput (float based AOV) pixels between startPix and endPix. A pixel is HDRI if one
+    // of the channels is greater than the numSample of the pixel. Pixels which have no sample are
+    // skipped. Return true (early exit) when hdriTotal exceeds hdriLimit.
+    static bool scanRenderOutputPix(const float* p,
+                                    const unsigned int* ns,
+                                    const size_t pixFloatCount,
+                                    const size_t startPix,
+                                    const size_t endPix,
+                                    const size_t hdriLimit,
+                                    size_t& hdriTotal);
+}; // HdriTest
+
+} // namespace mcrt_dataio
@@ -4,8 +4,12 @@
 #include "MergeActionTracker.h"
 #include "MergeSequenceDequeue.h"
 
+#include <scene_rdl2/common/rec_time/RecTime.h>
 #include <scene_rdl2/render/util/StrUtil.h>
 
+#include <algorithm>
+#include <iomanip>
+
 //#define DEBUG_MSG_RESET_ENCODE  // debug message for MergeActionTracker::resetEncode()
 //#define DEBUG_MSG_DECODEALL     // debug message for MergeActionTracker::decodeAll()
 //#define DEBUG_MSG_MERGE_FULL    // debug message for MergeActionTracker::mergeFull()
@@ -162,74 +166,89 @@ MergeActionTracker::mergeFull()
 
 void
 MergeActionTracker::mergePartial(const std::vector<char>& partialMergeTilesTbl)
+//
+// The merged tiles are converted to the runs of the tile id first. Then the runs are encoded by
+// mergeTileSingle/mergeTileRange for each run. If compact tile set is on (see setCompactTileSet()), the
+// smallest encoding of mergeTileSingle/mergeTileRange, run-length or bitmap is used instead. The same size
+// prefers mergeTileSingle/mergeTileRange, then run-length.
+//
 {
 #   ifdef DEBUG_MSG_MERGE_PARTIAL
     std::cerr << ">> MergeActionTracker.cc mergePartial() start. mMachineId:" << mMachineId << '\n';
 #   endif // end DEBUG_MSG_MERGE_PARTIAL
 
-    unsigned activeStartId, activeEndId;
-
-    auto resetActiveRange = [&]() { activeStartId = ~0; activeEndId = ~0; };
-    auto startActiveRange = [&](unsigned id) { activeStartId = activeEndId = id; };
-    auto extendActiveRange = [&](unsigned id) { activeEndId = id; };
-    auto isRangeActive = [&]() -> bool { return (activeStartId != ~(static_cast<unsigned>(0))); };
-    auto flushActiveRange = [&]() {
-        if (activeStartId == activeEndId) {
-            mEnq.mergeTileSingle(static_cast<int>(activeStartId));
-#           ifdef DEBUG_MSG_MERGE_PARTIAL
-            {
-                std::cerr << ">> MergeActionTracker.cc mergePartial() flushActiveRange"
-                          << " single:" << activeStartId << " mMachineId:" << mMachineId << '\n';
-            }
-#           endif // end DEBUG_MSG_MERGE_PARTIAL            
-#           ifdef MERGE_ACTION_TRACKER_DEBUG_ENCODE_INFO
-            {
-                std::ostringstream ostr;
-                ostr << "mergePartial(single:" << activeStartId << ')';
-                pushBackDebugEncodeSequence(ostr.str());
+    //
+    // In order to minimize encoded data size, we will try to store range tile id
+    // (for example, from 10 to 15) instead of individual tile id (like 10, 11, 12, 13, 14, 15).
+    // This is the main logic to find the range tile id from the input partialMergeTilesTbl.
+    //                                                            
+    mTileRunWork.clear();
+    bool runActive = false;
+    for (unsigned id = 0; id < static_cast<unsigned>(partialMergeTilesTbl.size()); ++id) {
+        if (static_cast<bool>(partialMergeTilesTbl[id])) {
+            if (!runActive) {
+                mTileRunWork.emplace_back(id, id);
+                runActive = true;
+            } else {
+                mTileRunWork.back().second = id;
             }
-#           endif // end MERGE_ACTION_TRACKER_DEBUG_ENCODE_INFO
         } else {
-            mEnq.mergeTileRange(static_cast<int>(activeStartId), static_cast<int>(activeEndId));
-#           ifdef DEBUG_MSG_MERGE_PARTIAL
-            {
-                std::cerr << ">> MergeActionTracker.cc mergePartial() flushActiveRange"
-                          << " range start:" << activeStartId << " end:" << activeEndId
-                          << " mMachineId:" << mMachineId << '\n';
+            runActive = false;
+        }
+    }
+    if (mTileRunWork.empty()) return;
+
+    const size_t rangeSize = MergeSequenceEnqueue::calcMergeTileRangeSize(mTileRunWork);
+    const size_t runLengthSize =
+        (mCompactTileSet) ? MergeSequenceEnqueue::calcMergeTileRunLengthSize(mTileRunWork) : 0;
+    const size_t bitmapSize = (mCompactTileSet) ? MergeSequenceEnqueue::calcMergeTileBitmapSize(mTileRunWork) : 0;
+
+    if (!mCompactTileSet || (rangeSize <= runLengthSize && rangeSize <= bitmapSize)) {
+        for (const MergeSequenceEnqueue::TileRun& run : mTileRunWork) {
+            if (run.first == run.second) {
+                mEnq.mergeTileSingle(run.first);
+            } else {
+                mEnq.mergeTileRange(run.first, run.second);
             }
-#           endif // end DEBUG_MSG_MERGE_PARTIAL            
+#           ifdef DEBUG_MSG_MERGE_PARTIAL
+            std::cerr << ">> MergeActionTracker.cc mergePartial()"
+                      << " range start:" << run.first << " end:" << run.second
+                      << " mMachineId:" << mMachineId << '\n';
+#           endif // end DEBUG_MSG_MERGE_PARTIAL
 #           ifdef MERGE_ACTION_TRACKER_DEBUG_ENCODE_INFO
             {
                 std::ostringstream ostr;
-                ostr << "mergePartial(range:" << activeStartId << '-' << activeEndId << ')';
+                if (run.first == run.second) ostr << "mergePartial(single:" << run.first << ')';
+                else ostr << "mergePartial(range:" << run.first << '-' << run.second << ')';
                 pushBackDebugEncodeSequence(ostr.str());
             }
 #           endif // end MERGE_ACTION_TRACKER_DEBUG_ENCODE_INFO
         }
-        mLastPartialMergeTileId = activeEndId;
-    };
-
-    //
-    // In order to minimize encoded data size, we will try to store range tile id
-    // (for example, from 10 to 15) instead of individual tile id (like 10, 11, 12, 13, 14, 15).
-    // This is the main logic to find the range tile id from the input partialMergeTilesTbl.
-    //                                                            
-    resetActiveRange();
-    for (unsigned id = 0; id < static_cast<unsigned>(partialMergeTilesTbl.size()); ++id) {
-        if (static_cast<bool>(partialMergeTilesTbl[id])) {
-            if (!isRangeActive()) startActiveRange(id);
-            else extendActiveRange(id);
-        } else {
-            if (isRangeActive()) {
-                flushActiveRange();
-                resetActiveRange();
-            }
+    } else if (runLengthSize <= bitmapSize) {
+        mEnq.mergeTileRunLength(mTileRunWork);
+#       ifdef MERGE_ACTION_TRACKER_DEBUG_ENCODE_INFO
+        {
+            std::ostringstream ostr;
+            ostr << "mergePartial(runLength runs:" << mTileRunWork.size() << " byte:" << runLengthSize << ')';
+            pushBackDebugEncodeSequence(ostr.str());
         }
+#       endif // end MERGE_ACTION_TRACKER_DEBUG_ENCODE_INFO
+    } else {
+        mEnq.mergeTileBitmap(mTileRunWork);
+#       ifdef MERGE_ACTION_TRACKER_DEBUG_ENCODE_INFO
+        {
+            std::ostringstream ostr;
+            ostr << "mergePartial(bitmap runs:" << mTileRunWork.size() << " byte:" << bitmapSize << ')';
+            pushBackDebugEncodeSequence(ostr.str());
+        }
+#       endif // end MERGE_ACTION_TRACKER_DEBUG_ENCODE_INFO
     }
-    if (isRangeActive()) flushActiveRange();
+    mLastPartialMergeTileId = mTileRunWork.back().second;
 
 #   ifdef DEBUG_MSG_MERGE_PARTIAL
-    std::cerr << ">> MergeActionTracker.cc mergePartial() done mMachineId:" << mMachineId << '\n';
+    std::cerr << ">> MergeActionTracker.cc mergePartial() done"
+              << " rangeSize:" << rangeSize << " runLengthSize:" << runLengthSize << " bitmapSize:" << bitmapSize
+              << " mMachineId:" << mMachineId << '\n';
 #   endif // end DEBUG_MSG_MERGE_PARTIAL
 }
 
@@ -321,6 +340,97 @@ MergeActionTracker::dumpData() const
     return ostr.str();
 }
 
+// static function
+std::string
+MergeActionTracker::benchTileSet(const unsigned loopMax)
+//
+// Tile patterns of 4K resolution (480 x 270 tiles) : checker, cluster (4 tiles every 200 tiles) and
+// random (30%). The decode time includes the expansion to the mergeTileSingle/mergeTileRange callbacks.
+//
+{
+    constexpr unsigned totalTiles = 480 * 270;
+
+    auto genRuns = [&](const std::string& pattern) {
+        MergeSequenceEnqueue::TileRunArray runs;
+        uint32_t seed = 12345;
+        bool runActive = false;
+        for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+            bool flag = false;
+            if (pattern == "checker") {
+                flag = tileId % 2;
+            } else if (pattern == "cluster") {
+                flag = tileId % 200 < 4;
+            } else {
+                seed = seed * 1664525 + 1013904223; // LCG
+                flag = (seed >> 16) % 100 < 30;
+            }
+            if (flag && runActive) runs.back().second = tileId;
+            else if (flag) runs.emplace_back(tileId, tileId);
+            runActive = flag;
+        }
+        return runs;
+    };
+
+    auto encode = [](const MergeSequenceEnqueue::TileRunArray& runs, const int encoding, std::string& data) {
+        data.clear();
+        MergeSequenceEnqueue enq(&data);
+        if (encoding == 0) {
+            for (const auto& run : runs) {
+                if (run.first == run.second) enq.mergeTileSingle(run.first);
+                else enq.mergeTileRange(run.first, run.second);
+            }
+        } else if (encoding == 1) {
+            enq.mergeTileRunLength(runs);
+        } else {
+            enq.mergeTileBitmap(runs);
+        }
+        enq.endOfData();
+    };
+
+    auto decode = [](const std::string& data) {
+        unsigned tileTotal = 0;
+        std::string error;
+        MergeSequenceDequeue deq(data.data(), data.size());
+        deq.decodeLoop(error,
+                       [](unsigned) { return true; },
+                       [](unsigned, unsigned) { return true; },
+                       [&](unsigned) { tileTotal++; return true; },
+                       [&](unsigned start, unsigned end) { tileTotal += end - start + 1; return true; },
+                       []() { return true; },
+                       []() { return true; });
+        return tileTotal;
+    };
+
+    const unsigned loop = std::max(loopMax, 1u);
+    std::ostringstream ostr;
+    ostr << "MergeActionTracker tile set bench (loopMax:" << loop << " totalTiles:" << totalTiles << ") {\n";
+    for (const std::string pattern : {"checker", "cluster", "random"}) {
+        const MergeSequenceEnqueue::TileRunArray runs = genRuns(pattern);
+        ostr << "  " << pattern << " (runs:" << runs.size() << ") {\n";
+        for (int encoding = 0; encoding < 3; ++encoding) {
+            std::string data;
+            unsigned tileTotal = 0;
+            scene_rdl2::rec_time::RecTime recTime;
+            recTime.start();
+            for (unsigned i = 0; i < loop; ++i) encode(runs, encoding, data);
+            const float encodeSec = recTime.end();
+            recTime.start();
+            for (unsigned i = 0; i < loop; ++i) tileTotal = decode(data);
+            const float decodeSec = recTime.end();
+
+            ostr << "    " << std::setw(9) << ((encoding == 0) ? "range" : (encoding == 1) ? "runLength" : "bitmap")
+                 << " byte:" << std::setw(7) << data.size()
+                 << " encode:" << std::setw(9) << std::fixed << std::setprecision(2)
+                 << encodeSec * 1000000.0f / static_cast<float>(loop) << " us"
+                 << " decode:" << std::setw(9) << decodeSec * 1000000.0f / static_cast<float>(loop) << " us"
+                 << " (tiles:" << tileTotal << ")\n";
+        }
+        ostr << "  }\n";
+    }
+    ostr << "}";
+    return ostr.str();
+}
+
 //------------------------------------------------------------------------------------------
 
 // static function
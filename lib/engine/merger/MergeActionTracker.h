@@ -34,6 +34,13 @@ public:
 
     void setMachineId(unsigned machineId) { mMachineId = machineId; }
 
+    // The run-length and bitmap tile set encodings of mergePartial() are only decoded by the MCRT
+    // computation which has the same MergeSequenceDequeue. An older MCRT computation fails to decode them
+    // and loses the feedback. Off by default (mergeTileSingle/mergeTileRange only). Turn this on only when
+    // all MCRT computations support them.
+    void setCompactTileSet(const bool flag) { mCompactTileSet = flag; }
+    bool getCompactTileSet() const { return mCompactTileSet; }
+
     void resetEncode();
 
     void decodeAll(const std::vector<unsigned>& sendActionIdData);
@@ -53,6 +60,10 @@ public:
     unsigned getLastSendActionId() const { return mLastSendActionId; }
     unsigned getLastPartialMergeTileId() const { return mLastPartialMergeTileId; }
 
+    // Measure the encoded size and encode/decode time of each partial merge tile set encoding
+    // (range, run-length and bitmap) for the typical tile patterns of 4K resolution.
+    static std::string benchTileSet(const unsigned loopMax);
+
 private:
 
     static std::string dumpDataAsAscii(const std::string& data);
@@ -72,8 +83,11 @@ private:
     unsigned mLastSendActionId; // for debug
     unsigned mLastPartialMergeTileId; // for debug
 
+    bool mCompactTileSet {false}; // use run-length/bitmap tile set encodings for mergePartial()
+
     std::string mData;
     MergeSequenceEnqueue mEnq;
+    MergeSequenceEnqueue::TileRunArray mTileRunWork; // work memory for mergePartial()
 
 #   ifdef MERGE_ACTION_TRACKER_DEBUG_ENCODE_INFO
     std::string mDebugEncodeSequence;
@@ -2,12 +2,21 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "MergeFbSender.h"
+#include "HdriTest.h"
+#include "SubMergeAovNumSample.h"
 
 #include <scene_rdl2/common/grid_util/FbReferenceType.h>
 #include <scene_rdl2/common/grid_util/PackTiles.h>
 #include <scene_rdl2/common/grid_util/ProgressiveFrameBufferName.h>
+#include <scene_rdl2/common/rec_time/RecTime.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
 
 //#define DEBUG_MSG
+//#define SINGLE_THREAD
 
 namespace mcrt_dataio {
 
@@ -24,6 +33,12 @@ MergeFbSender::init(const scene_rdl2::math::Viewport &rezedViewport)
     mMax = 0;
 }
 
+void
+MergeFbSender::setSharedFbActivePixels(scene_rdl2::grid_util::FbActivePixels* fbActivePixels)
+{
+    mFbActivePixelsPtr = (fbActivePixels) ? fbActivePixels : &mFbActivePixels;
+}
+
 void
 MergeFbSender::setHeaderInfoAndFbReset(FbMsgSingleFrame* currFbMsgSingleFrame,
                                        const mcrt::BaseFrame::Status* overwriteFrameStatusPtr)
@@ -47,9 +62,62 @@ MergeFbSender::setHeaderInfoAndFbReset(FbMsgSingleFrame* currFbMsgSingleFrame,
 
     if (mFrameStatus == mcrt::BaseFrame::STARTED) {
         fbReset(); // we need to reset previous fb result to create activePixels information properly.
+        setDirtyTilesTbl(nullptr);
+        setBeautyHdriTileCountTbl(nullptr);
+    } else {
+        // updated tiles by the last merge. nullptr if dirty tiles tracking is disabled.
+        setDirtyTilesTbl(currFbMsgSingleFrame->getMergedDirtyTilesTbl());
+        // beauty HDRI pixel count of each tile by the last merge. nullptr if not tracked.
+        setBeautyHdriTileCountTbl(currFbMsgSingleFrame->getBeautyHdriTileCountTbl());
     }
 
     mBeautyHDRITest = HdriTestCondition::INIT; // condition of HDRI test for beauty buffer
+    mFeedbackDelta = false; // feedback delta tiles are set by setFeedbackDeltaTilesTbl() after the snapshot
+}
+
+void
+MergeFbSender::setDirtyTilesTbl(const std::vector<char>* dirtyTilesTbl)
+{
+    if (!dirtyTilesTbl) {
+        mDirtyTilesAll = true;
+    } else {
+        mDirtyTilesAll = false;
+        mDirtyTilesTbl = *dirtyTilesTbl;
+    }
+}
+
+void
+MergeFbSender::setBeautyHdriTileCountTbl(const std::vector<unsigned char>* countTbl)
+{
+    if (!countTbl) {
+        mBeautyHdriTileCountValid = false;
+    } else {
+        mBeautyHdriTileCountValid = true;
+        mBeautyHdriTileCountTbl = *countTbl;
+    }
+}
+
+void
+MergeFbSender::setFeedbackDeltaTilesTbl(const std::vector<char>* deltaTilesTbl)
+{
+    const scene_rdl2::fb_util::ActivePixels& activePixels = mFbActivePixelsPtr->getActivePixels();
+    const unsigned numTiles = (activePixels.getAlignedWidth() >> 3) * (activePixels.getAlignedHeight() >> 3);
+    if (!deltaTilesTbl || deltaTilesTbl->size() != numTiles) {
+        mFeedbackDelta = false;
+        mFeedbackDeltaTilesTotal = numTiles;
+        return;
+    }
+
+    mFeedbackDelta = true;
+    mFeedbackDeltaTilesTotal = 0;
+    mFeedbackDeltaActivePixels.copy(activePixels);
+    for (unsigned tileId = 0; tileId < numTiles; ++tileId) {
+        if ((*deltaTilesTbl)[tileId]) {
+            mFeedbackDeltaTilesTotal++;
+        } else {
+            mFeedbackDeltaActivePixels.setTileMask(tileId, 0x0);
+        }
+    }
 }
 
 void
@@ -66,6 +134,7 @@ MergeFbSender::addBeautyBuff(mcrt::BaseFrame::Ptr message)
 {
     static const bool sha1HashSw = false;
 
+    MergeSendBufferPool::Buffer work = mBufferPool.acquire(mLastBeautyBufferSize);
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_START_BEAUTY);
     {
         PackTilePrecision packTilePrecision =
@@ -74,13 +143,12 @@ MergeFbSender::addBeautyBuff(mcrt::BaseFrame::Ptr message)
                                   [&]() -> PackTilePrecision { // runtimeDecisionFunc for coarse pass
                                       return getBeautyHDRITestResult();
                                   });
-        mWork.clear();
         mLastBeautyBufferSize =
             scene_rdl2::grid_util::PackTiles::
             encode(false,
-                   mFbActivePixels.getActivePixels(),
+                   getBeautyActivePixels(),
                    mFb.getRenderBufferTiled(),
-                   mWork,
+                   *work,
                    packTilePrecision,
                    mFb.getRenderBufferCoarsePassPrecision(),
                    mFb.getRenderBufferFinePassPrecision(),
@@ -89,7 +157,7 @@ MergeFbSender::addBeautyBuff(mcrt::BaseFrame::Ptr message)
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_END_BEAUTY);
 
     /* runtime verify
-    if (!scene_rdl2::grid_util::PackTiles::verifyEncodeResultMerge(mWork.data(), mWork.size(), mFb)) {
+    if (!scene_rdl2::grid_util::PackTiles::verifyEncodeResultMerge(work->data(), work->size(), mFb)) {
         std::cerr << "verify NG" << std::endl;
     } else {
         std::cerr << "verify OK" << std::endl;
@@ -98,7 +166,7 @@ MergeFbSender::addBeautyBuff(mcrt::BaseFrame::Ptr message)
 
     /* SHA1 hash verify for debug
     if (sha1HashSw) {
-        if (!scene_rdl2::grid_util::PackTiles::verifyDecodeHash(mWork.data(), mWork.size())) {
+        if (!scene_rdl2::grid_util::PackTiles::verifyDecodeHash(work->data(), work->size())) {
             std::cerr << ">> MergeFbSender.cc hashVerify NG" << std::endl;
         } else {
             std::cerr << ">> MergeFbSender.cc hashVerify OK" << std::endl;
@@ -107,11 +175,11 @@ MergeFbSender::addBeautyBuff(mcrt::BaseFrame::Ptr message)
     */
     /* useful debug dump
     std::cerr << scene_rdl2::grid_util::PackTiles::showHash(">> progmcrt_merge MergeFbSender.cc ",
-                                                       (const unsigned char *)mWork.data())
+                                                       (const unsigned char *)work->data())
               << std::endl;
     */
 
-    message->addBuffer(mcrt::makeValPtr(duplicateWorkData(mWork)),
+    message->addBuffer(MergeSendBufferPool::toDataPtr(work),
                        mLastBeautyBufferSize,
                        scene_rdl2::grid_util::ProgressiveFrameBufferName::Beauty,
                        mcrt::BaseFrame::ENCODING_UNKNOWN);
@@ -124,6 +192,7 @@ MergeFbSender::MergeFbSender::addBeautyBuffWithNumSample(mcrt::BaseFrame::Ptr me
 {
     static const bool sha1HashSw = false;
 
+    MergeSendBufferPool::Buffer work = mBufferPool.acquire(mLastBeautyBufferNumSampleSize);
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_START_BEAUTY_NUMSAMPLE);
     {
         PackTilePrecision packTilePrecision =
@@ -132,14 +201,13 @@ MergeFbSender::MergeFbSender::addBeautyBuffWithNumSample(mcrt::BaseFrame::Ptr me
                                   [&]() -> PackTilePrecision { // runtimeDecisionFunc for coarse pass
                                       return getBeautyHDRITestResult();
                                   });
-        mWork.clear();
         mLastBeautyBufferNumSampleSize =
             scene_rdl2::grid_util::PackTiles::
             encode(false, // renderBufferOdd
-                   mFbActivePixels.getActivePixels(),
+                   getBeautyActivePixels(),
                    mFb.getRenderBufferTiled(),
                    mFb.getNumSampleBufferTiled(),
-                   mWork,
+                   *work,
                    packTilePrecision,
                    mFb.getRenderBufferCoarsePassPrecision(),
                    mFb.getRenderBufferFinePassPrecision(),
@@ -147,7 +215,7 @@ MergeFbSender::MergeFbSender::addBeautyBuffWithNumSample(mcrt::BaseFrame::Ptr me
     }
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_END_BEAUTY_NUMSAMPLE);
 
-    message->addBuffer(mcrt::makeValPtr(duplicateWorkData(mWork)),
+    message->addBuffer(MergeSendBufferPool::toDataPtr(work),
                        mLastBeautyBufferNumSampleSize,
                        scene_rdl2::grid_util::ProgressiveFrameBufferName::Beauty,
                        mcrt::BaseFrame::ENCODING_UNKNOWN);
@@ -160,17 +228,17 @@ MergeFbSender::addPixelInfo(mcrt::BaseFrame::Ptr message)
 {
     static const bool sha1HashSw = false;
 
+    MergeSendBufferPool::Buffer work = mBufferPool.acquire(mLastPixelInfoSize);
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_START_PIXELINFO);
     {
         PackTilePrecision packTilePrecision =
             calcPackTilePrecision(mFb.getPixelInfoCoarsePassPrecision(),
                                   mFb.getPixelInfoFinePassPrecision());
-        mWork.clear();
         mLastPixelInfoSize =
             scene_rdl2::grid_util::PackTiles::
-            encodePixelInfo(mFbActivePixels.getActivePixelsPixelInfo(),
+            encodePixelInfo(mFbActivePixelsPtr->getActivePixelsPixelInfo(),
                             mFb.getPixelInfoBufferTiled(),
-                            mWork,
+                            *work,
                             packTilePrecision,
                             mFb.getPixelInfoCoarsePassPrecision(),
                             mFb.getPixelInfoFinePassPrecision(),
@@ -178,7 +246,7 @@ MergeFbSender::addPixelInfo(mcrt::BaseFrame::Ptr message)
     }
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_END_PIXELINFO);
 
-    message->addBuffer(mcrt::makeValPtr(duplicateWorkData(mWork)),
+    message->addBuffer(MergeSendBufferPool::toDataPtr(work),
                        mLastPixelInfoSize,
                        mFb.getPixelInfoName().c_str(),
                        mcrt::BaseFrame::ENCODING_UNKNOWN);
@@ -191,19 +259,19 @@ MergeFbSender::addHeatMap(mcrt::BaseFrame::Ptr message)
 {
     static const bool sha1HashSw = false;
 
+    MergeSendBufferPool::Buffer work = mBufferPool.acquire(mLastHeatMapSize);
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_START_HEATMAP);
     {
-        mWork.clear();
         mLastHeatMapSize =
             scene_rdl2::grid_util::PackTiles::
-            encodeHeatMap(mFbActivePixels.getActivePixelsHeatMap(),
+            encodeHeatMap(mFbActivePixelsPtr->getActivePixelsHeatMap(),
                           mFb.getHeatMapSecBufferTiled(),
-                          mWork,
+                          *work,
                           sha1HashSw);
     }
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_END_HEATMAP);
 
-    message->addBuffer(mcrt::makeValPtr(duplicateWorkData(mWork)),
+    message->addBuffer(MergeSendBufferPool::toDataPtr(work),
                        mLastHeatMapSize,
                        mFb.getHeatMapName().c_str(),
                        mcrt::BaseFrame::ENCODING_UNKNOWN);
@@ -216,21 +284,21 @@ MergeFbSender::addHeatMapWithNumSample(mcrt::BaseFrame::Ptr message)
 {
     static const bool sha1HashSw = false;
 
+    MergeSendBufferPool::Buffer work = mBufferPool.acquire(mLastHeatMapNumSampleSize);
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_START_HEATMAP_NUMSAMPLE);
     {
-        mWork.clear();
         mLastHeatMapNumSampleSize =
             scene_rdl2::grid_util::PackTiles::
-            encodeHeatMap(mFbActivePixels.getActivePixelsHeatMap(),
+            encodeHeatMap(mFbActivePixelsPtr->getActivePixelsHeatMap(),
                           mFb.getHeatMapSecBufferTiled(),
                           mFb.getWeightBufferTiled(),
-                          mWork,
+                          *work,
                           false, // noNumSampleMode
                           sha1HashSw);
     }
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_END_HEATMAP_NUMSAMPLE);
 
-    message->addBuffer(mcrt::makeValPtr(duplicateWorkData(mWork)),
+    message->addBuffer(MergeSendBufferPool::toDataPtr(work),
                        mLastHeatMapNumSampleSize,
                        mFb.getHeatMapName().c_str(),
                        mcrt::BaseFrame::ENCODING_UNKNOWN);
@@ -243,17 +311,17 @@ MergeFbSender::addWeightBuffer(mcrt::BaseFrame::Ptr message)
 {
     static const bool sha1HashSw = false;
 
+    MergeSendBufferPool::Buffer work = mBufferPool.acquire(mLastWeightBufferSize);
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_START_WEIGHTBUFFER);
     {
         PackTilePrecision packTilePrecision =
             calcPackTilePrecision(mFb.getWeightBufferCoarsePassPrecision(),
                                   mFb.getWeightBufferFinePassPrecision());
-        mWork.clear();
         mLastWeightBufferSize =
             scene_rdl2::grid_util::PackTiles::
-            encodeWeightBuffer(mFbActivePixels.getActivePixelsWeightBuffer(),
+            encodeWeightBuffer(mFbActivePixelsPtr->getActivePixelsWeightBuffer(),
                                mFb.getWeightBufferTiled(),
-                               mWork,
+                               *work,
                                packTilePrecision,
                                mFb.getWeightBufferCoarsePassPrecision(),
                                mFb.getWeightBufferFinePassPrecision(),
@@ -261,7 +329,7 @@ MergeFbSender::addWeightBuffer(mcrt::BaseFrame::Ptr message)
     }
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_END_WEIGHTBUFFER);
 
-    message->addBuffer(mcrt::makeValPtr(duplicateWorkData(mWork)),
+    message->addBuffer(MergeSendBufferPool::toDataPtr(work),
                        mLastWeightBufferSize,
                        mFb.getWeightBufferName().c_str(),
                        mcrt::BaseFrame::ENCODING_UNKNOWN);
@@ -274,6 +342,7 @@ MergeFbSender::addRenderBufferOdd(mcrt::BaseFrame::Ptr message)
 {
     static const bool sha1HashSw = false;
 
+    MergeSendBufferPool::Buffer work = mBufferPool.acquire(mLastRenderBufferOddSize);
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_START_RENDERBUFFERODD);
     {
         PackTilePrecision packTilePrecision =
@@ -282,14 +351,13 @@ MergeFbSender::addRenderBufferOdd(mcrt::BaseFrame::Ptr message)
                                   [&]() -> PackTilePrecision { // runtimeDecisionFunc for coarse pass
                                       return getBeautyHDRITestResult(); // access shared beauty HDRI test result
                                   });
-        mWork.clear();
         // Actually we don't have {coarse, fine}PassPrecision info for renderBufferOdd.
         mLastRenderBufferOddSize =
             scene_rdl2::grid_util::PackTiles::
             encode(true,
-                   mFbActivePixels.getActivePixelsRenderBufferOdd(),
+                   mFbActivePixelsPtr->getActivePixelsRenderBufferOdd(),
                    mFb.getRenderBufferOddTiled(),
-                   mWork,
+                   *work,
                    packTilePrecision,
                    mFb.getRenderBufferCoarsePassPrecision(), // dummy value
                    mFb.getRenderBufferFinePassPrecision(), // dummy value
@@ -297,7 +365,7 @@ MergeFbSender::addRenderBufferOdd(mcrt::BaseFrame::Ptr message)
     }
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_END_RENDERBUFFERODD);
 
-    message->addBuffer(mcrt::makeValPtr(duplicateWorkData(mWork)),
+    message->addBuffer(MergeSendBufferPool::toDataPtr(work),
                        mLastRenderBufferOddSize,
                        scene_rdl2::grid_util::ProgressiveFrameBufferName::RenderBufferOdd,
                        mcrt::BaseFrame::ENCODING_UNKNOWN);
@@ -310,6 +378,7 @@ MergeFbSender::addRenderBufferOddWithNumSample(mcrt::BaseFrame::Ptr message)
 {
     static const bool sha1HashSw = false;
 
+    MergeSendBufferPool::Buffer work = mBufferPool.acquire(mLastRenderBufferOddNumSampleSize);
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_START_RENDERBUFFERODD_NUMSAMPLE);
     {
         PackTilePrecision packTilePrecision =
@@ -318,15 +387,14 @@ MergeFbSender::addRenderBufferOddWithNumSample(mcrt::BaseFrame::Ptr message)
                                   [&]() -> PackTilePrecision { // runtimeDecisionFunc for coarse pass
                                       return getBeautyHDRITestResult(); // access shared beauty HDRI test result
                                   });
-        mWork.clear();
         // Actually we don't have {coarse, fine}PassPrecision info for renderBufferOdd.
         mLastRenderBufferOddNumSampleSize =
             scene_rdl2::grid_util::PackTiles::
             encode(true, // renderBufferOdd
-                   mFbActivePixels.getActivePixelsRenderBufferOdd(),
+                   mFbActivePixelsPtr->getActivePixelsRenderBufferOdd(),
                    mFb.getRenderBufferOddTiled(),
                    mFb.getWeightBufferTiled(),
-                   mWork,
+                   *work,
                    packTilePrecision,
                    mFb.getRenderBufferCoarsePassPrecision(), // dummy value
                    mFb.getRenderBufferFinePassPrecision(), // dummy value
@@ -335,7 +403,7 @@ MergeFbSender::addRenderBufferOddWithNumSample(mcrt::BaseFrame::Ptr message)
     }
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_END_RENDERBUFFERODD_NUMSAMPLE);
 
-    message->addBuffer(mcrt::makeValPtr(duplicateWorkData(mWork)),
+    message->addBuffer(MergeSendBufferPool::toDataPtr(work),
                        mLastRenderBufferOddNumSampleSize,
                        scene_rdl2::grid_util::ProgressiveFrameBufferName::RenderBufferOdd,
                        mcrt::BaseFrame::ENCODING_UNKNOWN);
@@ -345,76 +413,179 @@ MergeFbSender::addRenderBufferOddWithNumSample(mcrt::BaseFrame::Ptr message)
 
 void    
 MergeFbSender::addRenderOutput(mcrt::BaseFrame::Ptr message)
+//
+// All AOVs are encoded concurrently by individual tasks with their own work buffer. The addBuffer() order
+// is always the activeRenderOutputCrawler() order regardless of the task completion order.
+// The encode time of each AOV is recorded with MERGE_ENCODE_END_RENDEROUTPUT by microsec in the same
+// order as addBuffer().
+//
 {
     static const bool sha1HashSw = false;
 
+    struct EncodeTask {
+        scene_rdl2::grid_util::Fb::FbAovShPtr mFbAov;
+        const scene_rdl2::fb_util::ActivePixels* mActivePixels {nullptr};
+        size_t* mLastDataSize {nullptr}; // last encoded data size of this AOV
+        MergeSendBufferPool::Buffer mWork;
+        size_t mDataSize {0};
+        uint32_t mEncodeTimeMicroSec {0};
+    };
+
     mLastRenderOutputSize = 0;
 
-    mFbActivePixels.activeRenderOutputCrawler
+    //
+    // setup encode tasks by single thread. The task order is the addBuffer() order.
+    //
+    std::vector<EncodeTask> taskTbl;
+    mFbActivePixelsPtr->activeRenderOutputCrawler
         ([&](const std::string &aovName, const scene_rdl2::fb_util::ActivePixels &activePixels) {
             if (!mFb.findAov(aovName)) return;
             scene_rdl2::grid_util::Fb::FbAovShPtr fbAov = mFb.getAov(aovName);
 
             if (!fbAov->getStatus()) return; // just in case
 
-            size_t dataSize = 0;
-            mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_START_RENDEROUTPUT);
-            {
-                mWork.clear();
-                if (fbAov->getReferenceType() == scene_rdl2::grid_util::FbReferenceType::UNDEF) {
-                    // regular AOV buffer
-                    PackTilePrecision packTilePrecision =
-                        calcPackTilePrecision(fbAov->getCoarsePassPrecision(),
-                                              fbAov->getFinePassPrecision(),
-                                              [&]() -> PackTilePrecision { // coarsePass runtimeDecisionFunc
-                                                  if (renderOutputHDRITest(fbAov)) {
-                                                      return PackTilePrecision::H16;
-                                                  } else {
-                                                      return PackTilePrecision::UC8;
-                                                  }
-                                              });
-                    dataSize =
-                        scene_rdl2::grid_util::PackTiles::
-                        encodeRenderOutputMerge(activePixels,
-                                                fbAov->getBufferTiled(),
-                                                fbAov->getDefaultValue(),
-                                                mWork,
-                                                packTilePrecision,
-                                                fbAov->getClosestFilterStatus(),
-                                                fbAov->getCoarsePassPrecision(),
-                                                fbAov->getFinePassPrecision(),
-                                                sha1HashSw);
-                } else {
-                    // reference type AOV buffer
-                    dataSize =
-                        scene_rdl2::grid_util::PackTiles::
-                        encodeRenderOutputReference(fbAov->getReferenceType(),
-                                                    mWork,
-                                                    sha1HashSw);
-                }
-            }
-            mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_END_RENDEROUTPUT);
+            EncodeTask task;
+            task.mFbAov = fbAov;
+            task.mActivePixels = &activePixels;
+            // The encoded data size of the last send is used for the pre-sizing of the buffer.
+            task.mLastDataSize = &mLastRenderOutputSizeTbl[aovName];
+            task.mWork = mBufferPool.acquire(*task.mLastDataSize);
+            taskTbl.push_back(std::move(task));
+        });
+    if (taskTbl.empty()) return;
+
+    auto encodeAov = [&](EncodeTask& task) {
+        scene_rdl2::rec_time::RecTime recTime;
+        recTime.start();
+
+        const scene_rdl2::grid_util::Fb::FbAovShPtr& fbAov = task.mFbAov;
+        if (fbAov->getReferenceType() == scene_rdl2::grid_util::FbReferenceType::UNDEF) {
+            // regular AOV buffer
+            PackTilePrecision packTilePrecision =
+                calcPackTilePrecision(fbAov->getCoarsePassPrecision(),
+                                      fbAov->getFinePassPrecision(),
+                                      [&]() -> PackTilePrecision { // coarsePass runtimeDecisionFunc
+                                          if (renderOutputHDRITest(fbAov)) {
+                                              return PackTilePrecision::H16;
+                                          } else {
+                                              return PackTilePrecision::UC8;
+                                          }
+                                      });
+            task.mDataSize =
+                scene_rdl2::grid_util::PackTiles::
+                encodeRenderOutputMerge(*task.mActivePixels,
+                                        fbAov->getBufferTiled(),
+                                        fbAov->getDefaultValue(),
+                                        *task.mWork,
+                                        packTilePrecision,
+                                        fbAov->getClosestFilterStatus(),
+                                        fbAov->getCoarsePassPrecision(),
+                                        fbAov->getFinePassPrecision(),
+                                        sha1HashSw);
+        } else {
+            // reference type AOV buffer
+            task.mDataSize =
+                scene_rdl2::grid_util::PackTiles::
+                encodeRenderOutputReference(fbAov->getReferenceType(),
+                                            *task.mWork,
+                                            sha1HashSw);
+        }
+
+        task.mEncodeTimeMicroSec = static_cast<uint32_t>(recTime.end() * 1000000.0f);
+    };
 
-            // for performance analyze
-            mLastRenderOutputSize += dataSize;
+    //
+    // encode
+    //
+    mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_START_RENDEROUTPUT);
+#   ifdef SINGLE_THREAD
+    for (EncodeTask& task : taskTbl) encodeAov(task);
+#   else // else SINGLE_THREAD
+    // grainsize = 1 : the encode cost of each AOV is big enough and very different between AOVs.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, taskTbl.size(), 1),
+                      [&](const tbb::blocked_range<size_t> &r) {
+                          for (size_t taskId = r.begin(); taskId < r.end(); ++taskId) {
+                              encodeAov(taskTbl[taskId]);
+                          }
+                      });
+#   endif // end !SINGLE_THREAD
+    std::vector<uint32_t> encodeTimeTbl(taskTbl.size());
+    for (size_t taskId = 0; taskId < taskTbl.size(); ++taskId) {
+        encodeTimeTbl[taskId] = taskTbl[taskId].mEncodeTimeMicroSec;
+    }
+    mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ENCODE_END_RENDEROUTPUT, encodeTimeTbl);
 
-            message->addBuffer(mcrt::makeValPtr(duplicateWorkData(mWork)),
-                               dataSize,
-                               fbAov->getAovName().c_str(),
-                               mcrt::BaseFrame::ENCODING_UNKNOWN);
-            mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ADDBUFFER_END_RENDEROUTPUT);
-            mLatencyLog.addDataSize(dataSize);
-        });
+    //
+    // addBuffer by deterministic order
+    //
+    for (EncodeTask& task : taskTbl) {
+        // for performance analyze
+        mLastRenderOutputSize += task.mDataSize;
+        *task.mLastDataSize = task.mDataSize;
+
+        message->addBuffer(MergeSendBufferPool::toDataPtr(task.mWork),
+                           task.mDataSize,
+                           task.mFbAov->getAovName().c_str(),
+                           mcrt::BaseFrame::ENCODING_UNKNOWN);
+        mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_ADDBUFFER_END_RENDEROUTPUT);
+        mLatencyLog.addDataSize(task.mDataSize);
+    }
 }
 
 void    
 MergeFbSender::addRenderOutputWithNumSample(mcrt::BaseFrame::Ptr message)
+//
+// Used by the sub-merge output of the hierarchical merge. PackTiles does not have a renderOutput encoding
+// which includes numSample. The AOVs are encoded in the same way as addRenderOutput() and the numSample
+// of each regular AOV is sent by an additional SubMergeAovNumSample buffer which uses the same
+// activePixels as the AOV data. The root merge (sub-merge input mode) applies it to the decoded AOVs.
+//
 {
-    //
-    // We don't need this API at this moment but might be needed in the future when we need to send
-    // back AOV info from Merge to MCRT computation by progressiveFeedback message for some reason.
-    // This API is reserved for that purpose.
-    //
+    addRenderOutput(message);
+
+    std::vector<SubMergeAovNumSample::Aov> aovTbl;
+    mFbActivePixelsPtr->activeRenderOutputCrawler
+        ([&](const std::string &aovName, const scene_rdl2::fb_util::ActivePixels &activePixels) {
+            if (!mFb.findAov(aovName)) return;
+            scene_rdl2::grid_util::Fb::FbAovShPtr fbAov = mFb.getAov(aovName);
+            if (!fbAov->getStatus() ||
+                fbAov->getReferenceType() != scene_rdl2::grid_util::FbReferenceType::UNDEF) {
+                return; // reference type AOV does not have own numSample
+            }
+            aovTbl.push_back(SubMergeAovNumSample::Aov {aovName,
+                                                        &activePixels,
+                                                        fbAov->getNumSampleBufferTiled().getData()});
+        });
+    if (aovTbl.empty()) return;
+
+    MergeSendBufferPool::Buffer work = mBufferPool.acquire(0);
+    scene_rdl2::rdl2::ValueContainerEnq cEnq(work.get());
+    SubMergeAovNumSample::encode(mFb.getTotalTiles(), aovTbl, cEnq);
+    size_t dataSize = cEnq.finalize();
+
+    message->addBuffer(MergeSendBufferPool::toDataPtr(work),
+                       dataSize,
+                       SubMergeAovNumSample::sBuffName,
+                       mcrt::BaseFrame::ENCODING_UNKNOWN);
+}
+
+void
+MergeFbSender::addSubMergeOutput(mcrt::BaseFrame::Ptr message)
+//
+// Add all the buffers of the sub-merge result for the hierarchical merge. Unlike the regular merge output
+// to the client, every buffer carries numSample, so the root merge can accumulate each sub-merge result
+// as one machine. All buffers are encoded by F32 regardless of the precision control because the root
+// merge accumulates them again and the quantization error of each tier would be accumulated.
+//
+{
+    mSubMergeOutput = true;
+    addBeautyBuffWithNumSample(message);
+    if (mFb.getPixelInfoStatus()) addPixelInfo(message);
+    if (mFb.getHeatMapStatus()) addHeatMapWithNumSample(message);
+    if (mFb.getWeightBufferStatus()) addWeightBuffer(message);
+    if (mFb.getRenderBufferOddStatus()) addRenderBufferOddWithNumSample(message);
+    if (mFb.getRenderOutputStatus()) addRenderOutputWithNumSample(message);
+    mSubMergeOutput = false;
 }
 
 void
@@ -459,8 +630,8 @@ MergeFbSender::addLatencyLog(mcrt::BaseFrame::Ptr message)
     }
 
     {
-        mWork.clear();              // We have to clear work
-        scene_rdl2::rdl2::ValueContainerEnq vContainerEnq(&mWork);
+        MergeSendBufferPool::Buffer work = mBufferPool.acquire(0);
+        scene_rdl2::rdl2::ValueContainerEnq vContainerEnq(work.get());
 
         mLatencyLog.encode(vContainerEnq);
 
@@ -471,14 +642,14 @@ MergeFbSender::addLatencyLog(mcrt::BaseFrame::Ptr message)
         {
             scene_rdl2::grid_util::LatencyLog tmpLog;
 
-            scene_rdl2::rdl2::ValueContainerDeq vContainerDeq(mWork.data(), dataSize);
+            scene_rdl2::rdl2::ValueContainerDeq vContainerDeq(work->data(), dataSize);
             tmpLog.decode(vContainerDeq);
             std::cerr << ">> progmcrt_merge MergeFbSender.cc dataSize:" << dataSize << " {\n"
                       << tmpLog.show("  ") << '\n'
                       << "}" << std::endl;
         }
         */
-        message->addBuffer(mcrt::makeValPtr(duplicateWorkData(mWork)),
+        message->addBuffer(MergeSendBufferPool::toDataPtr(work),
                            dataSize,
                            scene_rdl2::grid_util::ProgressiveFrameBufferName::LatencyLog,
                            mcrt::BaseFrame::ENCODING_UNKNOWN);
@@ -489,7 +660,11 @@ MergeFbSender::addLatencyLog(mcrt::BaseFrame::Ptr message)
     // upstream latency log
     //
     if (mUpstreamLatencyLogWork.size()) {
-        message->addBuffer(mcrt::makeValPtr(duplicateWorkData(mUpstreamLatencyLogWork)),
+        // mUpstreamLatencyLogWork is kept for the next call and we need a copy here. The copy is done
+        // into the pooled buffer in order to avoid the heap allocation.
+        MergeSendBufferPool::Buffer work = mBufferPool.acquire(mUpstreamLatencyLogWork.size());
+        work->assign(mUpstreamLatencyLogWork);
+        message->addBuffer(MergeSendBufferPool::toDataPtr(work),
                            mUpstreamLatencyLogWork.size(),
                            scene_rdl2::grid_util::ProgressiveFrameBufferName::LatencyLogUpstream,
                            mcrt::BaseFrame::ENCODING_UNKNOWN);
@@ -500,18 +675,44 @@ void
 MergeFbSender::addAuxInfo(mcrt::BaseFrame::Ptr message,
                           const std::vector<std::string> &infoDataArray)
 {
-    mWork.clear();              // We have to clear work buffer
-    scene_rdl2::rdl2::ValueContainerEnq cEnq(&mWork);
+    MergeSendBufferPool::Buffer work = mBufferPool.acquire(0);
+    scene_rdl2::rdl2::ValueContainerEnq cEnq(work.get());
 
     cEnq.enqStringVector(infoDataArray);
     size_t dataSize = cEnq.finalize();
 
-    message->addBuffer(mcrt::makeValPtr(duplicateWorkData(mWork)),
+    message->addBuffer(MergeSendBufferPool::toDataPtr(work),
                        dataSize,
                        scene_rdl2::grid_util::ProgressiveFrameBufferName::AuxInfo,                       
                        mcrt::BaseFrame::ENCODING_UNKNOWN);
 }
 
+void
+MergeFbSender::addFeedbackTileDelta(mcrt::BaseFrame::Ptr message)
+{
+    MergeSendBufferPool::Buffer work = mBufferPool.acquire(0);
+    scene_rdl2::rdl2::ValueContainerEnq cEnq(work.get());
+
+    cEnq.enqBool(mFeedbackDelta);
+    cEnq.enqVLUInt(mFeedbackDeltaTilesTotal);
+    size_t dataSize = cEnq.finalize();
+
+    message->addBuffer(MergeSendBufferPool::toDataPtr(work),
+                       dataSize,
+                       sFeedbackTileDeltaBuffName,
+                       mcrt::BaseFrame::ENCODING_UNKNOWN);
+}
+
+size_t
+MergeFbSender::getWorkByte() const
+{
+    return (FbMsgFbPool::calcFbByte(mFb) +
+            mBufferPool.getCachedByte() +
+            mUpstreamLatencyLogWork.capacity() +
+            mDirtyTilesTbl.capacity() +
+            mBeautyHdriTileCountTbl.capacity());
+}
+
 void
 MergeFbSender::fbReset()
 //
@@ -523,6 +724,12 @@ MergeFbSender::fbReset()
     mLatencyLog.enq(scene_rdl2::grid_util::LatencyItem::Key::MERGE_FBRESET_END);
 }
 
+const scene_rdl2::fb_util::ActivePixels&
+MergeFbSender::getBeautyActivePixels() const
+{
+    return (mFeedbackDelta) ? mFeedbackDeltaActivePixels : mFbActivePixelsPtr->getActivePixels();
+}
+
 MergeFbSender::PackTilePrecision
 MergeFbSender::getBeautyHDRITestResult()
 //
@@ -552,19 +759,38 @@ MergeFbSender::beautyHDRITest() const
     // We want to use minLimit in order to ignore small number of HDRI pixels like firefly
     // Use experimental number here. This cost was around 0.5ms~2ms range in my HD reso test scene.
     // Future enhancement related ticket is MOONRAY-3588
-    size_t minLimit = (size_t)((float)area * 0.005f); // 0.5% of whole pixels
+    // We only test dirty tiles if dirty tiles info is available and minLimit is based on the dirty area
+    // in this case (see setDirtyTilesTbl()).
+    const size_t totalTiles = area / 64;
+    size_t minLimit = (size_t)((float)calcDirtyPixTotal(totalTiles) * 0.005f); // 0.5% of dirty pixels
+    // The test returns true when it finds the HDRI pixel after minLimit + 1 HDRI pixels.
+    const size_t hdriLimit = minLimit + 1;
+
+    if (mBeautyHdriTileCountValid && mBeautyHdriTileCountTbl.size() == totalTiles) {
+        // Per-tile HDRI pixel count is already computed by the merge. We don't need the pixel scan.
+        return beautyHDRITestByTileCount(totalTiles, hdriLimit);
+    }
+
     const scene_rdl2::math::Vec4f *c = mFb.getRenderBufferTiled().getData();
+    size_t totalHDRI = 0;
+    return crawlDirtyTilesPix(totalTiles, [&](const size_t startPix, const size_t endPix) -> bool {
+            return HdriTest::scanBeautyPix(c, startPix, endPix, hdriLimit, totalHDRI);
+        });
+}
 
+bool
+MergeFbSender::beautyHDRITestByTileCount(const size_t totalTiles, const size_t hdriLimit) const
+//
+// Beauty HDRI test by per-tile HDRI pixel count table. The cost is O(dirty tiles).
+//
+{
+    const bool dirtyTilesAll = (mDirtyTilesAll || mDirtyTilesTbl.size() != totalTiles);
     size_t totalHDRI = 0;
-    for (size_t i = 0; i < area; ++i, ++c) {
-        if (c->x > 1.0f || c->y > 1.0f || c->z > 1.0f || c->w > 1.0f) {
-            if (totalHDRI > minLimit) {
-                return true;
-            }
-            totalHDRI++;
-        }
+    for (size_t tileId = 0; tileId < totalTiles; ++tileId) {
+        if (!dirtyTilesAll && !mDirtyTilesTbl[tileId]) continue;
+        totalHDRI += mBeautyHdriTileCountTbl[tileId];
+        if (totalHDRI > hdriLimit) return true;
     }
-
     return false;
 }
 
@@ -591,30 +817,26 @@ MergeFbSender::renderOutputHDRITest(const scene_rdl2::grid_util::Fb::FbAovShPtr
     }
 
     size_t area = activePixels.getAlignedWidth() * activePixels.getAlignedHeight();
-    size_t minLimit = static_cast<size_t>((float)area * 0.005f); // 0.5% of whole pixels
+    const size_t totalTiles = area / 64;
+    size_t minLimit = static_cast<size_t>((float)calcDirtyPixTotal(totalTiles) * 0.005f); // 0.5% of dirty pixels
     unsigned pixByte = buff.getSizeOfPixel();
     size_t pixFloatCount = pixByte / sizeof(float);
     const float *p = reinterpret_cast<const float *>(buff.getData());
     const unsigned int *ns = numSampleBuff.getData();
 
     size_t totalHDRI = 0;
-    for (size_t i = 0; i < area; ++i, ++ns) {
-        if (*ns > 0) {
-            float max = static_cast<float>(*ns);
-            int currTotalHDRIchan = 0;
-            for (size_t j = 0; j < pixFloatCount ; ++j) {
-                if (p[j] > max) currTotalHDRIchan++;
-            }
-            p += pixFloatCount;
-            if (currTotalHDRIchan > 0) {
-                if (totalHDRI > minLimit) {
-                    return true; // HDRI fb
-                }
-                totalHDRI++;
-            }
-        }
-    }
-    return false; // non HDRI fb
+    return crawlDirtyTilesPix(totalTiles, [&](const size_t startPix, const size_t endPix) -> bool {
+            // return true as HDRI fb when it finds the HDRI pixel after minLimit + 1 HDRI pixels.
+            return HdriTest::scanRenderOutputPix(p, ns, pixFloatCount, startPix, endPix,
+                                                 minLimit + 1, totalHDRI);
+        });
+}
+
+size_t
+MergeFbSender::calcDirtyPixTotal(const size_t totalTiles) const
+{
+    if (mDirtyTilesAll || mDirtyTilesTbl.size() != totalTiles) return totalTiles * 64;
+    return std::count(mDirtyTilesTbl.begin(), mDirtyTilesTbl.end(), static_cast<char>(true)) * 64;
 }
 
 MergeFbSender::PackTilePrecision
@@ -654,6 +876,7 @@ MergeFbSender::calcPackTilePrecision(const CoarsePassPrecision coarsePassPrecisi
     };
 
     PackTilePrecision precision = PackTilePrecision::F32;
+    if (mSubMergeOutput) return precision; // full precision between the hierarchical merge tiers
 
     switch (mPrecisionControl) {
     case PrecisionControl::FULL32 :
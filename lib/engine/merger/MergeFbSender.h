@@ -12,6 +12,7 @@
 //
 
 #include "FbMsgSingleFrame.h"
+#include "MergeSendBufferPool.h"
 
 #include <mcrt_messages/BaseFrame.h>
 #include <scene_rdl2/common/fb_util/FbTypes.h>
@@ -22,6 +23,8 @@
 #include <scene_rdl2/common/grid_util/PackTilesPassPrecision.h>
 #include <scene_rdl2/common/platform/Platform.h> // finline
 
+#include <unordered_map>
+
 namespace mcrt_dataio {
 
 class MergeFbSender
@@ -62,9 +65,37 @@ public:
     // w, h are original size and not need to be tile size aligned
     void init(const scene_rdl2::math::Viewport &rezedViewport);
 
-    scene_rdl2::grid_util::FbActivePixels &getFbActivePixels() { return mFbActivePixels; }
+    // Snapshot result which is also used as the snapshot history of the next snapshot.
+    scene_rdl2::grid_util::FbActivePixels &getFbActivePixels() { return *mFbActivePixelsPtr; }
+
+    // Use an external FbActivePixels instead of the own one. This is used by MergeFbSenderDoubleBuffer
+    // in order to share one snapshot history between 2 senders. nullptr means the own one.
+    // The external FbActivePixels should be initialized by the owner.
+    void setSharedFbActivePixels(scene_rdl2::grid_util::FbActivePixels* fbActivePixels);
     scene_rdl2::grid_util::Fb &getFb() { return mFb; }
 
+    // Set updated tiles by the last merge (i.e. FbMsgSingleFrame::getMergedDirtyTilesTbl()).
+    // nullptr means all tiles are dirty. This table is only used by the beauty and renderOutput HDRI tests
+    // for the runtime precision decision and they only scan the dirty tiles. The snapshot and the encode
+    // are not limited by this table. In this case, the HDRI test threshold (0.5% of the pixels) is relative
+    // to the dirty area instead of the whole image, because the pixels which are changed from the previous
+    // snapshot (i.e. encoded pixels) are inside the dirty tiles if every merge result is sent. Without dirty
+    // tiles info (dirty tiles tracking is off by default), the threshold is relative to the whole image.
+    void setDirtyTilesTbl(const std::vector<char>* dirtyTilesTbl);
+
+    // Set per-tile beauty HDRI pixel count table which is computed by the last merge
+    // (i.e. FbMsgSingleFrame::getBeautyHdriTileCountTbl()). If this table is available, the beauty HDRI
+    // test for runtime precision decision is done by table lookup of the dirty tiles instead of a pixel scan.
+    // nullptr means no table and the beauty HDRI test falls back to the pixel scan.
+    void setBeautyHdriTileCountTbl(const std::vector<unsigned char>* countTbl);
+
+    // Set the delta tiles of the progressiveFeedback message (i.e. FbMsgSingleFrame::calcFeedbackDeltaTiles()).
+    // Beauty buffer encode (addBeautyBuff() and addBeautyBuffWithNumSample()) only encodes the active pixels
+    // of the delta tiles. nullptr means full feedback. This should be called after the mFbActivePixels snapshot.
+    // setHeaderInfoAndFbReset() resets to the full condition.
+    void setFeedbackDeltaTilesTbl(const std::vector<char>* deltaTilesTbl);
+    bool isFeedbackDelta() const { return mFeedbackDelta; }
+
     void setHeaderInfoAndFbReset(FbMsgSingleFrame* currFbMsgSingleFrame,
                                  const mcrt::BaseFrame::Status* overwriteFrameStatusPtr = nullptr);
     mcrt::BaseFrame::Status getFrameStatus() const { return mFrameStatus; }
@@ -89,6 +120,16 @@ public:
     void addLatencyLog(mcrt::BaseFrame::Ptr message);
     void addAuxInfo(mcrt::BaseFrame::Ptr message, const std::vector<std::string> &infoDataArray);
 
+    // Tile delta condition of the feedback message. MCRT computation patches the beauty buffer into its
+    // feedback Fb if the delta condition is true. Otherwise the beauty buffer is a full feedback image.
+    void addFeedbackTileDelta(mcrt::BaseFrame::Ptr message);
+    static constexpr const char* sFeedbackTileDeltaBuffName = "feedbackTileDelta";
+
+    // Sub-merge output of the hierarchical merge tree. Adds all active buffers with numSample by F32
+    // (renderOutput AOVs carry their own numSample by a SubMergeAovNumSample buffer).
+    // The root merge should set FbMsgSingleFrame::setSubMergeInput(true) to receive this output.
+    void addSubMergeOutput(mcrt::BaseFrame::Ptr message);
+
     finline void timeLogReset() { mStartCondition = false; }
     finline void timeLogStart() { if (!mStartCondition){ mLatencyLog.start(); mStartCondition = true; } }
     finline void timeLogEnq(const scene_rdl2::grid_util::LatencyItem::Key key) { mLatencyLog.enq(key); }
@@ -96,6 +137,12 @@ public:
 
     scene_rdl2::grid_util::LatencyLog &getLatencyLog() { return mLatencyLog; }
 
+    // Estimated byte of the work buffers (Fb, cached encode buffers and latencyLog work) for the memory
+    // accounting (see MergeMemAccountant::Category::SEND_BUFFER).
+    size_t getWorkByte() const;
+
+    std::string showBufferPool() const { return mBufferPool.show(); }
+
 protected:
     using PackTilePrecision = scene_rdl2::grid_util::PackTiles::PrecisionMode;
     using PackTilePrecisionCalcFunc = std::function<PackTilePrecision()>;
@@ -103,8 +150,10 @@ protected:
     using FinePassPrecision = scene_rdl2::grid_util::FinePassPrecision;
 
     PrecisionControl mPrecisionControl {PrecisionControl::AUTO16};
+    bool mSubMergeOutput {false}; // true during addSubMergeOutput() : always uses F32
 
     scene_rdl2::grid_util::FbActivePixels mFbActivePixels; // snapshot result
+    scene_rdl2::grid_util::FbActivePixels* mFbActivePixelsPtr {&mFbActivePixels}; // own or shared snapshot
     scene_rdl2::grid_util::Fb mFb;
 
     //------------------------------
@@ -121,7 +170,10 @@ protected:
     size_t mMin {0};                              // for performance analyze. packet size min info
     size_t mMax {0};                              // for performance analyze. packet size max info
 
-    std::string mWork; // work memory for encoding
+    // Recycling pool of the encoded data buffers. Encoded data is directly written into the pooled buffer
+    // and handed to the message without copy. mLast*Size is used for the pre-sizing of the buffer.
+    MergeSendBufferPool mBufferPool;
+    std::unordered_map<std::string, size_t> mLastRenderOutputSizeTbl; // last encoded data size of each AOV
 
     //------------------------------
 
@@ -145,9 +197,19 @@ protected:
     // status of execution of HDRI test for beauty buffer after done snapshotDelta
     HdriTestCondition mBeautyHDRITest {HdriTestCondition::INIT};
 
+    bool mDirtyTilesAll {true};       // all tiles are dirty
+    std::vector<char> mDirtyTilesTbl; // updated tiles by the last merge
+
+    bool mBeautyHdriTileCountValid {false};           // mBeautyHdriTileCountTbl is ready to use
+    std::vector<unsigned char> mBeautyHdriTileCountTbl; // [tileId] : beauty HDRI pixel count (0 ~ 64)
+
+    bool mFeedbackDelta {false};  // beauty buffer encode is limited to the feedback delta tiles
+    unsigned mFeedbackDeltaTilesTotal {0};
+    scene_rdl2::fb_util::ActivePixels mFeedbackDeltaActivePixels; // active pixels of the delta tiles
+
     //------------------------------
 
-    // We need separate work buffer for upstreamLatencyLog from mWork
+    // We need separate work buffer for upstreamLatencyLog from the pooled buffers
     std::string mUpstreamLatencyLogWork; // updated by encodeUpstreamLatencyLog()
 
     //------------------------------
@@ -156,14 +218,40 @@ protected:
 
     PackTilePrecision getBeautyHDRITestResult();
     bool beautyHDRITest() const;
+    bool beautyHDRITestByTileCount(const size_t totalTiles, const size_t hdriLimit) const;
     bool renderOutputHDRITest(const scene_rdl2::grid_util::Fb::FbAovShPtr fbAov) const;
+    const scene_rdl2::fb_util::ActivePixels& getBeautyActivePixels() const;
     PackTilePrecision calcPackTilePrecision(const CoarsePassPrecision coarsePassPrecision,
                                             const FinePassPrecision finePassPrecision,
                                             PackTilePrecisionCalcFunc runtimeDecisionFunc = nullptr) const;
 
-    finline uint8_t *duplicateWorkData(const std::string &work);
+    size_t calcDirtyPixTotal(const size_t totalTiles) const;
+    template <typename F> bool crawlDirtyTilesPix(const size_t totalTiles, F pixRangeFunc) const;
 }; // MergeFbSender
 
+template <typename F>
+bool
+MergeFbSender::crawlDirtyTilesPix(const size_t totalTiles, F pixRangeFunc) const
+//
+// Call pixRangeFunc(startPixOffset, endPixOffset) for each run of continuous dirty tiles.
+// pixRangeFunc returns true when it wants to stop crawling and this function returns true in this case.
+//
+{
+    constexpr size_t tilePixTotal = 64; // 8 x 8 pixels
+    if (mDirtyTilesAll || mDirtyTilesTbl.size() != totalTiles) {
+        return pixRangeFunc(0, totalTiles * tilePixTotal);
+    }
+
+    size_t tileId = 0;
+    while (tileId < totalTiles) {
+        if (!mDirtyTilesTbl[tileId]) { ++tileId; continue; }
+        const size_t startTileId = tileId;
+        while (tileId < totalTiles && mDirtyTilesTbl[tileId]) ++tileId;
+        if (pixRangeFunc(startTileId * tilePixTotal, tileId * tilePixTotal)) return true;
+    }
+    return false;
+}
+
 finline void
 MergeFbSender::timeLogEnq(const scene_rdl2::grid_util::LatencyItem::Key key,
                           const std::vector<uint32_t> &data)
@@ -171,12 +259,4 @@ MergeFbSender::timeLogEnq(const scene_rdl2::grid_util::LatencyItem::Key key,
     mLatencyLog.enq(key, data);
 }
 
-finline uint8_t *
-MergeFbSender::duplicateWorkData(const std::string &work)
-{
-    uint8_t *data = new uint8_t[work.size()];
-    std::memcpy(data, work.data(), work.size());
-    return data;
-}
-
 } // namespace mcrt_dataio
@@ -0,0 +1,88 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MergeFbSenderDoubleBuffer.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace mcrt_dataio {
+
+void
+MergeFbSenderDoubleBuffer::setPrecisionControl(MergeFbSender::PrecisionControl &precisionControl)
+{
+    waitEncode();
+    mSlot[0].setPrecisionControl(precisionControl);
+    mSlot[1].setPrecisionControl(precisionControl);
+}
+
+void
+MergeFbSenderDoubleBuffer::init(const scene_rdl2::math::Viewport &rezedViewport)
+{
+    waitEncode(); // We should not change the resolution during the background encode
+
+    mFbActivePixels.init(rezedViewport.width(), rezedViewport.height());
+    mSlot[0].init(rezedViewport);
+    mSlot[1].init(rezedViewport);
+    mMergeSlotId = 0;
+}
+
+void
+MergeFbSenderDoubleBuffer::startEncode(const EncodeFunc& encodeFunc)
+{
+    if (mMergeIntervalTime.isInit()) {
+        mLastMergeIntervalSec = 0.0f;
+    } else {
+        mLastMergeIntervalSec = mMergeIntervalTime.end();
+    }
+    mMergeIntervalTime.start();
+
+    if (mEncodeRunning) {
+        scene_rdl2::rec_time::RecTime recTime;
+        recTime.start();
+        waitEncode();
+        mLastWaitSec = recTime.end();
+        mEncodeWaitTotal++;
+    } else {
+        mLastWaitSec = 0.0f;
+    }
+
+    MergeFbSender& encodeSender = mSlot[mMergeSlotId];
+    mMergeSlotId ^= 1; // The next decode/merge cycle uses the other slot.
+
+    mEncodeRunning = true;
+    mEncodeTaskGroup.run([&, encodeFunc]() {
+        scene_rdl2::rec_time::RecTime recTime;
+        recTime.start();
+        encodeFunc(encodeSender);
+        mLastEncodeSec = recTime.end();
+    });
+    mEncodeTotal++;
+}
+
+void
+MergeFbSenderDoubleBuffer::waitEncode()
+{
+    if (!mEncodeRunning) return;
+    mEncodeTaskGroup.wait();
+    mEncodeRunning = false;
+}
+
+std::string
+MergeFbSenderDoubleBuffer::show() const
+{
+    std::ostringstream ostr;
+    ostr << "MergeFbSenderDoubleBuffer {\n"
+         << "  mMergeSlotId:" << mMergeSlotId << '\n'
+         << "  mEncodeRunning:" << ((mEncodeRunning) ? "true" : "false") << '\n'
+         << "  mLastEncodeSec:" << std::setw(7) << std::fixed << std::setprecision(5) << mLastEncodeSec.load() << '\n'
+         << "  mLastWaitSec:" << std::setw(7) << std::fixed << std::setprecision(5) << mLastWaitSec << '\n'
+         << "  mLastMergeIntervalSec:" << std::setw(7) << std::fixed << std::setprecision(5)
+         << mLastMergeIntervalSec << '\n'
+         << "  mEncodeTotal:" << mEncodeTotal << '\n'
+         << "  mEncodeWaitTotal:" << mEncodeWaitTotal << '\n'
+         << "}";
+    return ostr.str();
+}
+
+} // namespace mcrt_dataio
@@ -0,0 +1,112 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+//
+// Double buffered MergeFbSender for merge computation
+//
+// Without this class, merge and encode are executed back to back on the same thread.
+// FbMsgSingleFrame::merge() writes into MergeFbSender::getFb() and then add*() APIs encode the same
+// buffer by PackTiles. This class keeps 2 MergeFbSender slots. The encoder works on the completed
+// slot in the background while the next decode/merge cycle fills the other slot. As a result,
+// merge-to-send latency becomes max(merge, encode) instead of merge + encode.
+//
+// Typical usage at the merge computation is as follows.
+//
+//   MergeFbSender& sender = doubleBuffer.getMergeSlot();
+//   fbMsgSingleFrame->merge(partialMergeTilesTotal, sender.getFb(), latencyLog);
+//   sender.setHeaderInfoAndFbReset(fbMsgSingleFrame);
+//   sender.encodeUpstreamLatencyLog(fbMsgSingleFrame);
+//   doubleBuffer.startEncode([&](MergeFbSender& encodeSender) {
+//       ... snapshot, add*() and send message by encodeSender ...
+//   });
+//
+// startEncode() waits for the completion of the previous encode, swaps slots and then starts
+// encoding the just merged slot in the background. Every FbMsgSingleFrame related operation
+// (merge, setHeaderInfoAndFbReset, encodeUpstreamLatencyLog) should be done on the merge slot before
+// calling startEncode(), because FbMsgSingleFrame is updated by the next decode/merge cycle while
+// the encode is running. The encode function should only access the MergeFbSender given by the argument.
+//
+// Both slots share one snapshot history (FbActivePixels) which is owned by this class. Encodes are
+// serialized by startEncode(), so the snapshot history is always updated in the send order and every
+// send only includes the pixels which are changed from the previous send regardless of the slot.
+// (If each slot kept its own history, a pixel which changed A -> B -> A over 3 sends would be compared
+// against the A of 2 sends ago at the 3rd send and the downstream would keep B.) The dirty tiles and
+// beauty HDRI tile count tables of a slot are computed by the merge of that slot and they describe
+// exactly the changes since the previous send as well.
+// For the same reason, every merge result has to be a complete image. Incremental merge
+// (FbMsgSingleFrame::setIncrementalMerge()) and partial merge keep the not-merged tiles of the previous
+// merge result and require the same output fb for every merge() call. The merge target fb alternates
+// between 2 slots here, so FbMsgSingleFrame automatically falls back to the full merge under double
+// buffer mode.
+//
+
+#include "MergeFbSender.h"
+
+#include <scene_rdl2/common/rec_time/RecTime.h>
+
+#include <tbb/task_group.h>
+
+#include <atomic>
+#include <functional>
+
+namespace mcrt_dataio {
+
+class MergeFbSenderDoubleBuffer
+{
+public:
+    using EncodeFunc = std::function<void(MergeFbSender& sender)>;
+
+    MergeFbSenderDoubleBuffer()
+    {
+        mSlot[0].setSharedFbActivePixels(&mFbActivePixels);
+        mSlot[1].setSharedFbActivePixels(&mFbActivePixels);
+    }
+    ~MergeFbSenderDoubleBuffer() { waitEncode(); }
+
+    // Non-copyable
+    MergeFbSenderDoubleBuffer &operator = (const MergeFbSenderDoubleBuffer) = delete;
+    MergeFbSenderDoubleBuffer(const MergeFbSenderDoubleBuffer &) = delete;
+
+    void setPrecisionControl(MergeFbSender::PrecisionControl &precisionControl);
+
+    // w, h are original size and not need to be tile size aligned
+    void init(const scene_rdl2::math::Viewport &rezedViewport);
+
+    // Merge target slot. Never accessed by the background encode.
+    MergeFbSender &getMergeSlot() { return mSlot[mMergeSlotId]; }
+
+    // Swap slots and start encode of the just merged slot in the background. This function waits for
+    // the completion of the previous encode first.
+    void startEncode(const EncodeFunc& encodeFunc);
+
+    // Wait for the completion of the background encode. Does nothing if no encode is running.
+    void waitEncode();
+    bool isEncodeRunning() const { return mEncodeRunning; }
+
+    float getLastEncodeSec() const { return mLastEncodeSec.load(); } // background encode time
+    float getLastWaitSec() const { return mLastWaitSec; }         // blocked time by previous encode
+    float getLastMergeIntervalSec() const { return mLastMergeIntervalSec; } // startEncode() call interval
+
+    std::string show() const;
+
+private:
+    scene_rdl2::grid_util::FbActivePixels mFbActivePixels; // snapshot history shared by both slots
+    MergeFbSender mSlot[2];
+    unsigned mMergeSlotId {0};
+
+    tbb::task_group mEncodeTaskGroup;
+    bool mEncodeRunning {false};
+
+    //------------------------------
+
+    scene_rdl2::rec_time::RecTime mMergeIntervalTime;
+    std::atomic<float> mLastEncodeSec {0.0f}; // updated by the background encode
+    float mLastWaitSec {0.0f};
+    float mLastMergeIntervalSec {0.0f};
+    uint64_t mEncodeTotal {0};
+    uint64_t mEncodeWaitTotal {0}; // total number of startEncode() which was blocked by previous encode
+}; // MergeFbSenderDoubleBuffer
+
+} // namespace mcrt_dataio
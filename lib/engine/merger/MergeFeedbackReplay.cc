@@ -0,0 +1,326 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MergeFeedbackReplay.h"
+#include "MergeKernel.h"
+#include "MergeSequenceDequeue.h"
+
+#include <scene_rdl2/common/rec_time/RecTime.h>
+#include <scene_rdl2/render/util/StrUtil.h>
+
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+constexpr unsigned sTilePixTotal = 64; // 8 x 8 pixels
+
+} // namespace
+
+namespace mcrt_dataio {
+
+bool
+MergeFeedbackReplay::setSequence(const std::string& data, std::string& error)
+{
+    mStepTbl.clear();
+    mDecodeIdTbl.clear();
+    mTileRunTbl.clear();
+    mPayloadTbl.clear();
+    if (data.empty()) return true; // no merge action
+
+    MergeSequenceDequeue deq(data.data(), data.size());
+    if (!deq.decodeLoop(error,
+                        [&](unsigned sendImageActionId) -> bool { // decodeSingle
+                            pushDecode(sendImageActionId);
+                            return true;
+                        },
+                        [&](unsigned start, unsigned end) -> bool { // decodeRange
+                            if (start > end) return false;
+                            for (unsigned id = start; id <= end; ++id) pushDecode(id);
+                            return true;
+                        },
+                        [&](unsigned tileId) -> bool { // tileSingle
+                            pushMergeTiles(tileId, tileId);
+                            return true;
+                        },
+                        [&](unsigned start, unsigned end) -> bool { // tileRange
+                            if (start > end) return false;
+                            pushMergeTiles(start, end);
+                            return true;
+                        },
+                        [&]() -> bool { // tileAll
+                            mStepTbl.push_back(Step {StepType::MERGE_ALL_TILES, 0, 0});
+                            return true;
+                        },
+                        [&]() -> bool { // endOfData
+                            return true;
+                        })) {
+        mStepTbl.clear();
+        error = "MergeFeedbackReplay::setSequence() failed. " + error;
+        return false;
+    }
+    return true;
+}
+
+bool
+MergeFeedbackReplay::replay(const PayloadFunc& payloadFunc, Fb& decodedFb, Fb& mergedFb, std::string& error)
+{
+    scene_rdl2::rec_time::RecTime recTime;
+    recTime.start();
+
+    const unsigned totalTiles = decodedFb.getTotalTiles();
+    if (mergedFb.getTotalTiles() != totalTiles) {
+        error = "MergeFeedbackReplay::replay() resolution mismatch between decodedFb and mergedFb";
+        return false;
+    }
+    if (!setupPayloads(payloadFunc, totalTiles, error)) return false;
+
+    if (mSerial) {
+        replaySerial(decodedFb, mergedFb);
+    } else {
+#       ifdef SINGLE_THREAD
+        replayTiles(0, totalTiles, decodedFb, mergedFb);
+#       else // else SINGLE_THREAD
+        tbb::blocked_range<unsigned> range(0, totalTiles);
+        tbb::parallel_for(range, [&](const tbb::blocked_range<unsigned>& r) {
+                replayTiles(r.begin(), r.end(), decodedFb, mergedFb);
+            });
+#       endif // end !SINGLE_THREAD
+    }
+
+    mReplayTotal++;
+    mLastReplayMs = recTime.end() * 1000.0f;
+    return true;
+}
+
+std::string
+MergeFeedbackReplay::show() const
+{
+    using scene_rdl2::str_util::boolStr;
+
+    auto stepTotal = [&](const StepType type) {
+        return std::count_if(mStepTbl.begin(), mStepTbl.end(), [&](const Step& step) { return step.mType == type; });
+    };
+
+    std::ostringstream ostr;
+    ostr << "MergeFeedbackReplay {\n"
+         << "  mSerial:" << boolStr(mSerial) << '\n'
+         << "  mStepTbl (total:" << mStepTbl.size() << ") {\n"
+         << "    decode:" << stepTotal(StepType::DECODE) << '\n'
+         << "    mergeTiles:" << stepTotal(StepType::MERGE_TILES) << '\n'
+         << "    mergeAllTiles:" << stepTotal(StepType::MERGE_ALL_TILES) << '\n'
+         << "  }\n"
+         << "  mDecodeIdTbl.size():" << mDecodeIdTbl.size() << '\n'
+         << "  mTileRunTbl.size():" << mTileRunTbl.size() << '\n'
+         << "  mReplayTotal:" << mReplayTotal << '\n'
+         << "  mLastReplayMs:" << mLastReplayMs << " ms\n"
+         << "}";
+    return ostr.str();
+}
+
+void
+MergeFeedbackReplay::pushDecode(const unsigned sendImageActionId)
+{
+    const unsigned id = static_cast<unsigned>(mDecodeIdTbl.size());
+    mDecodeIdTbl.push_back(sendImageActionId);
+    if (!mStepTbl.empty() && mStepTbl.back().mType == StepType::DECODE) {
+        mStepTbl.back().mEnd = id + 1;
+    } else {
+        mStepTbl.push_back(Step {StepType::DECODE, id, id + 1});
+    }
+}
+
+void
+MergeFeedbackReplay::pushMergeTiles(const unsigned startTileId, const unsigned endTileId)
+//
+// Tile runs are combined into the current merge step only if they keep the ascending order. Otherwise
+// (i.e. 2 merges without decode) a new merge step is started.
+//
+{
+    const unsigned id = static_cast<unsigned>(mTileRunTbl.size());
+    mTileRunTbl.emplace_back(startTileId, endTileId);
+    if (!mStepTbl.empty() && mStepTbl.back().mType == StepType::MERGE_TILES &&
+        mTileRunTbl[id - 1].second < startTileId) {
+        mStepTbl.back().mEnd = id + 1;
+    } else {
+        mStepTbl.push_back(Step {StepType::MERGE_TILES, id, id + 1});
+    }
+}
+
+bool
+MergeFeedbackReplay::setupPayloads(const PayloadFunc& payloadFunc, const unsigned totalTiles, std::string& error)
+{
+    mPayloadTbl.resize(mDecodeIdTbl.size());
+    for (size_t i = 0; i < mDecodeIdTbl.size(); ++i) {
+        const Fb* payload = payloadFunc(mDecodeIdTbl[i]);
+        if (!payload || payload->getTotalTiles() != totalTiles) {
+            std::ostringstream ostr;
+            ostr << "MergeFeedbackReplay::replay() "
+                 << ((!payload) ? "payload is not available" : "payload resolution mismatch")
+                 << " sendImageActionId:" << mDecodeIdTbl[i];
+            error = ostr.str();
+            return false;
+        }
+        mPayloadTbl[i] = payload;
+    }
+
+    for (const auto& run : mTileRunTbl) {
+        if (run.second >= totalTiles) {
+            std::ostringstream ostr;
+            ostr << "MergeFeedbackReplay::replay() tileId is out of range."
+                 << " tileId:" << run.second << " totalTiles:" << totalTiles;
+            error = ostr.str();
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+MergeFeedbackReplay::replayTiles(const unsigned startTileId,
+                                 const unsigned endTileId,
+                                 Fb& decodedFb,
+                                 Fb& mergedFb) const
+//
+// Replay all the steps for the tiles between startTileId and endTileId.
+//
+{
+    auto& decodedActivePixels = decodedFb.getActivePixels();
+
+    for (const Step& step : mStepTbl) {
+        switch (step.mType) {
+        case StepType::DECODE : {
+            for (unsigned tileId = startTileId; tileId < endTileId; ++tileId) {
+                // The latest payload wins. Scan payloads from the latest one and copy each pixel once.
+                uint64_t remainMask = ~static_cast<uint64_t>(0);
+                for (unsigned id = step.mEnd; id > step.mStart; --id) {
+                    const Fb& payload = *mPayloadTbl[id - 1];
+                    const uint64_t pixMask = payload.getActivePixels().getTileMask(tileId) & remainMask;
+                    if (!pixMask) continue;
+                    decodeTile(tileId, pixMask, payload, decodedFb);
+                    remainMask &= ~pixMask;
+                    if (!remainMask) break;
+                }
+                if (~remainMask) {
+                    decodedActivePixels.setTileMask(tileId, decodedActivePixels.getTileMask(tileId) | ~remainMask);
+                }
+            }
+        } break;
+        case StepType::MERGE_TILES : {
+            // Runs are sorted. Find the 1st run which might overlap with startTileId.
+            auto itr = std::lower_bound(mTileRunTbl.begin() + step.mStart,
+                                        mTileRunTbl.begin() + step.mEnd,
+                                        startTileId,
+                                        [](const MergeSequenceEnqueue::TileRun& run, const unsigned tileId) {
+                                            return run.second < tileId;
+                                        });
+            for (; itr != mTileRunTbl.begin() + step.mEnd && itr->first < endTileId; ++itr) {
+                const unsigned start = std::max(itr->first, startTileId);
+                const unsigned end = std::min(itr->second + 1, endTileId);
+                for (unsigned tileId = start; tileId < end; ++tileId) mergeTile(tileId, decodedFb, mergedFb);
+            }
+        } break;
+        case StepType::MERGE_ALL_TILES : {
+            for (unsigned tileId = startTileId; tileId < endTileId; ++tileId) mergeTile(tileId, decodedFb, mergedFb);
+        } break;
+        }
+    }
+}
+
+void
+MergeFeedbackReplay::replaySerial(Fb& decodedFb, Fb& mergedFb) const
+//
+// Reference implementation. Each action is replayed over the whole image in order.
+//
+{
+    const unsigned totalTiles = decodedFb.getTotalTiles();
+    auto& decodedActivePixels = decodedFb.getActivePixels();
+
+    for (const Step& step : mStepTbl) {
+        switch (step.mType) {
+        case StepType::DECODE : {
+            for (unsigned id = step.mStart; id < step.mEnd; ++id) {
+                const Fb& payload = *mPayloadTbl[id];
+                for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+                    const uint64_t pixMask = payload.getActivePixels().getTileMask(tileId);
+                    if (!pixMask) continue;
+                    decodeTile(tileId, pixMask, payload, decodedFb);
+                    decodedActivePixels.setTileMask(tileId, decodedActivePixels.getTileMask(tileId) | pixMask);
+                }
+            }
+        } break;
+        case StepType::MERGE_TILES : {
+            for (unsigned runId = step.mStart; runId < step.mEnd; ++runId) {
+                const auto& run = mTileRunTbl[runId];
+                for (unsigned tileId = run.first; tileId <= run.second; ++tileId) {
+                    mergeTile(tileId, decodedFb, mergedFb);
+                }
+            }
+        } break;
+        case StepType::MERGE_ALL_TILES : {
+            for (unsigned tileId = 0; tileId < totalTiles; ++tileId) mergeTile(tileId, decodedFb, mergedFb);
+        } break;
+        }
+    }
+}
+
+// static function
+void
+MergeFeedbackReplay::decodeTile(const unsigned tileId, const uint64_t pixMask, const Fb& payload, Fb& decodedFb)
+//
+// Copy the pixels which are set by pixMask. Same as the progressiveFrame decode of the merge computation.
+//
+{
+    const size_t pixOffset = static_cast<size_t>(tileId) * sTilePixTotal;
+    const auto* srcC = payload.getRenderBufferTiled().getData() + pixOffset;
+    const unsigned* srcNumSample = payload.getNumSampleBufferTiled().getData() + pixOffset;
+    auto* dstC = decodedFb.getRenderBufferTiled().getData() + pixOffset;
+    unsigned* dstNumSample = decodedFb.getNumSampleBufferTiled().getData() + pixOffset;
+
+    for (unsigned pixId = 0; pixId < sTilePixTotal; ++pixId) {
+        if (!(pixMask & (static_cast<uint64_t>(0x1) << pixId))) continue;
+        dstC[pixId] = srcC[pixId];
+        dstNumSample[pixId] = srcNumSample[pixId];
+    }
+}
+
+// static function
+void
+MergeFeedbackReplay::mergeTile(const unsigned tileId, Fb& decodedFb, Fb& mergedFb)
+//
+// Same as the merge computation : clear the tile and accumulate the decoded tile by MergeKernel. Only this
+// machine's decoded tile exists here, so the result is a copy of the active pixels which have samples.
+//
+{
+    const size_t pixOffset = static_cast<size_t>(tileId) * sTilePixTotal;
+    const float* srcC = reinterpret_cast<const float*>(decodedFb.getRenderBufferTiled().getData() + pixOffset);
+    const unsigned* srcNumSample = decodedFb.getNumSampleBufferTiled().getData() + pixOffset;
+    auto* dstC = mergedFb.getRenderBufferTiled().getData() + pixOffset;
+    unsigned* dstNumSample = mergedFb.getNumSampleBufferTiled().getData() + pixOffset;
+
+    std::fill(dstC, dstC + sTilePixTotal, scene_rdl2::math::Vec4f(0.0f, 0.0f, 0.0f, 0.0f));
+    std::fill(dstNumSample, dstNumSample + sTilePixTotal, 0);
+
+    const uint64_t pixMask = decodedFb.getActivePixels().getTileMask(tileId);
+    mergedFb.getActivePixels().setTileMask(tileId, pixMask);
+    if (!pixMask) return;
+    MergeKernel::accumulateRgbaTile(pixMask, srcC, srcNumSample, reinterpret_cast<float*>(dstC), dstNumSample);
+}
+
+void
+MergeFeedbackReplay::parserConfigure()
+{
+    mParser.description("MergeFeedbackReplay command");
+    mParser.opt("serial", "<on|off|show>", "set serial reference replay mode on/off",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mSerial = (arg++).as<bool>(0);
+                    return arg.fmtMsg("serial %s\n", scene_rdl2::str_util::boolStr(mSerial).c_str());
+                });
+    mParser.opt("show", "", "show internal info",
+                [&](Arg& arg) -> bool { return arg.msg(show() + '\n'); });
+}
+
+} // namespace mcrt_dataio
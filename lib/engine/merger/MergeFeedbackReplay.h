@@ -0,0 +1,130 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+//
+// Parallel replay of the merge action sequence on the MCRT computation
+//
+// Under feedback mode, the MCRT computation receives the merge action sequence which is recorded by
+// MergeActionTracker on the merge computation and re-simulates the same decode/merge operations with its
+// own sent images in order to rebuild its own contribution to the merged image (the "merged" image of
+// verifyMcrtFeedback). A straightforward replay executes each action in order over the whole image and
+// this cost directly reduces the render throughput of the MCRT computation.
+//
+// Every tile is independent under all the merge actions. So this class converts the action sequence to
+// a short list of steps once and replays all the steps for each tile range in parallel.
+//
+//   decode step : Consecutive DECODE_SINGLE/DECODE_RANGE actions are combined into a single step. The
+//                 payloads are scanned from the latest one for each tile and each pixel is only copied
+//                 once from the latest payload which has this pixel as active.
+//   merge step  : Consecutive MERGE_TILE_SINGLE/MERGE_TILE_RANGE actions (including the expanded
+//                 run-length and bitmap tile sets) are combined into a single sorted tile run array.
+//                 Each tile of the merged image is cleared and the decoded tile is accumulated by
+//                 MergeKernel::accumulateRgbaTile() like the merge computation. The MCRT computation only
+//                 has its own decoded tile, so the result is a copy of the active pixels which have samples.
+//
+// Only the beauty is replayed : the RGBA render buffer, its numSample buffer and the active pixels. This
+// is the same scope as verifyMcrtFeedback (beauty and beautyNumSample). Other buffers of the payloads
+// (pixelInfo, heatMap, weight, beautyOdd, renderOutput AOVs) are neither decoded nor merged, and
+// decodedFb/mergedFb only need to have the beauty buffers.
+//
+// The payload of each sendImageActionId is the image which was sent by that progressiveFrame message
+// (i.e. only the active pixels are updated). The serial mode replays each action over the whole image
+// in order.
+//
+// Nothing in this library calls this class. The intended owner is the feedback logic of the MCRT
+// computation (outside of mcrt_dataio). It keeps the sent image of each sendImageActionId, calls
+// setSequence() with the MergeActionTracker data of each progressiveFeedback message (see
+// MergeActionTracker::decodeDataOnMCRTComputation()) and replay() before comparing the merged image
+// with the feedback image.
+//
+
+#include "MergeSequenceEnqueue.h"
+
+#include <scene_rdl2/common/grid_util/Arg.h>
+#include <scene_rdl2/common/grid_util/Fb.h>
+#include <scene_rdl2/common/grid_util/Parser.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace mcrt_dataio {
+
+class MergeFeedbackReplay
+{
+public:
+    using Arg = scene_rdl2::grid_util::Arg;
+    using Parser = scene_rdl2::grid_util::Parser;
+    using Fb = scene_rdl2::grid_util::Fb;
+
+    // Return the payload image of sendImageActionId. Return nullptr if the payload is not available.
+    // This function is called only once for each decode action before the parallel replay.
+    using PayloadFunc = std::function<const Fb*(const unsigned sendImageActionId)>;
+
+    MergeFeedbackReplay() { parserConfigure(); }
+
+    // Non-copyable
+    MergeFeedbackReplay &operator = (const MergeFeedbackReplay) = delete;
+    MergeFeedbackReplay(const MergeFeedbackReplay &) = delete;
+
+    void setSerial(const bool flag) { mSerial = flag; }
+    bool getSerial() const { return mSerial; }
+
+    // Convert the merge action sequence data (see MergeActionTracker::getData()) to the replay steps.
+    bool setSequence(const std::string& data, std::string& error);
+
+    // Replay the steps of the last setSequence(). decodedFb and mergedFb keep their contents between the
+    // feedbacks and they should have the same resolution as all the payloads.
+    bool replay(const PayloadFunc& payloadFunc, Fb& decodedFb, Fb& mergedFb, std::string& error);
+
+    float getLastReplayMs() const { return mLastReplayMs; }
+
+    std::string show() const;
+
+    Parser& getParser() { return mParser; }
+
+private:
+    enum class StepType : char {
+        DECODE,         // decode mDecodeIdTbl[mStart] ~ mDecodeIdTbl[mEnd - 1]
+        MERGE_TILES,    // merge mTileRunTbl[mStart] ~ mTileRunTbl[mEnd - 1]
+        MERGE_ALL_TILES // merge all tiles
+    };
+
+    struct Step {
+        StepType mType;
+        unsigned mStart;
+        unsigned mEnd;
+    };
+
+    void pushDecode(const unsigned sendImageActionId);
+    void pushMergeTiles(const unsigned startTileId, const unsigned endTileId);
+
+    bool setupPayloads(const PayloadFunc& payloadFunc, const unsigned totalTiles, std::string& error);
+
+    void replayTiles(const unsigned startTileId, const unsigned endTileId, Fb& decodedFb, Fb& mergedFb) const;
+    void replaySerial(Fb& decodedFb, Fb& mergedFb) const;
+
+    static void decodeTile(const unsigned tileId, const uint64_t pixMask, const Fb& payload, Fb& decodedFb);
+    static void mergeTile(const unsigned tileId, Fb& decodedFb, Fb& mergedFb);
+
+    void parserConfigure();
+
+    //------------------------------
+
+    bool mSerial {false};
+
+    std::vector<Step> mStepTbl;
+    std::vector<unsigned> mDecodeIdTbl;              // sendImageActionId of all decode steps
+    MergeSequenceEnqueue::TileRunArray mTileRunTbl;  // tile runs of all merge steps
+    std::vector<const Fb*> mPayloadTbl;              // same order as mDecodeIdTbl
+
+    uint64_t mReplayTotal {0};
+    float mLastReplayMs {0.0f};
+
+    Parser mParser;
+}; // MergeFeedbackReplay
+
+} // namespace mcrt_dataio
@@ -0,0 +1,215 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MergeFeedbackScheduler.h"
+#include "GlobalNodeInfo.h"
+
+#include <scene_rdl2/render/util/StrUtil.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <sstream>
+
+namespace mcrt_dataio {
+
+void
+MergeFeedbackScheduler::reset()
+{
+    mMachineTbl.clear();
+    mUpdateTotal = 0;
+}
+
+void
+MergeFeedbackScheduler::update(GlobalNodeInfo& globalNodeInfo)
+{
+    if (!mActive) return;
+
+    const float mergeEvalFeedbackMs = globalNodeInfo.getMergeEvalFeedbackTime();
+    globalNodeInfo.crawlAllMcrtNodeInfo([&](GlobalNodeInfo::McrtNodeInfoShPtr nodeInfo) -> bool {
+            if (!nodeInfo->getFeedbackActive()) return true;
+
+            Measurement measurement;
+            measurement.mProgress = nodeInfo->getProgress();
+            measurement.mEvalFeedbackMs = nodeInfo->getEvalFeedbackTime();
+            measurement.mFeedbackLatencyMs = nodeInfo->getFeedbackLatency();
+            measurement.mRecvFeedbackBps = nodeInfo->getRecvFeedbackBps();
+            updateMachine(nodeInfo->getMachineId(), measurement, mergeEvalFeedbackMs);
+            return true;
+        });
+    mUpdateTotal++;
+
+    if (!mMachineTbl.empty()) globalNodeInfo.setMergeFeedbackInterval(getShortestInterval());
+}
+
+float
+MergeFeedbackScheduler::updateMachine(const int machineId,
+                                      const Measurement& measurement,
+                                      const float mergeEvalFeedbackMs)
+{
+    const bool newMachine = (mMachineTbl.find(machineId) == mMachineTbl.end());
+    MachineState& state = mMachineTbl[machineId];
+
+    const float targetSec = calcTargetInterval(state, measurement, mergeEvalFeedbackMs);
+    if (newMachine || measurement.mProgress < state.mProgress || targetSec >= state.mIntervalSec) {
+        // new machine, new frame or back off
+        state.mIntervalSec = targetSec;
+    } else {
+        state.mIntervalSec += mSmoothing * (targetSec - state.mIntervalSec);
+    }
+    state.mProgress = measurement.mProgress;
+    return state.mIntervalSec;
+}
+
+bool
+MergeFeedbackScheduler::isFeedbackDue(const int machineId, const double nowSec) const
+{
+    auto itr = mMachineTbl.find(machineId);
+    if (itr == mMachineTbl.end() || !itr->second.mSent) return true;
+    return (nowSec - itr->second.mLastSentSec) >= static_cast<double>(itr->second.mIntervalSec);
+}
+
+void
+MergeFeedbackScheduler::feedbackSent(const int machineId, const double nowSec)
+{
+    MachineState& state = mMachineTbl[machineId];
+    if (state.mIntervalSec == 0.0f) state.mIntervalSec = mMinIntervalSec; // not updated yet
+    state.mSent = true;
+    state.mLastSentSec = nowSec;
+}
+
+float
+MergeFeedbackScheduler::getInterval(const int machineId) const
+{
+    auto itr = mMachineTbl.find(machineId);
+    if (itr == mMachineTbl.end()) return mMaxIntervalSec;
+    return itr->second.mIntervalSec;
+}
+
+float
+MergeFeedbackScheduler::getShortestInterval() const
+{
+    if (mMachineTbl.empty()) return mMaxIntervalSec;
+
+    float shortest = mMaxIntervalSec;
+    for (const auto& itr : mMachineTbl) shortest = std::min(shortest, itr.second.mIntervalSec);
+    return shortest;
+}
+
+std::string
+MergeFeedbackScheduler::show() const
+{
+    using scene_rdl2::str_util::boolStr;
+
+    std::ostringstream ostr;
+    ostr << "MergeFeedbackScheduler {\n"
+         << "  mActive:" << boolStr(mActive) << '\n'
+         << "  mMinIntervalSec:" << mMinIntervalSec << " sec\n"
+         << "  mMaxIntervalSec:" << mMaxIntervalSec << " sec\n"
+         << "  mConvergedProgress:" << mConvergedProgress << '\n'
+         << "  mMcrtCostBudget:" << mMcrtCostBudget << '\n'
+         << "  mMergeCostBudget:" << mMergeCostBudget << '\n'
+         << "  mLatencyRatio:" << mLatencyRatio << '\n'
+         << "  mMaxBps:" << mMaxBps << " Byte/Sec\n"
+         << "  mSmoothing:" << mSmoothing << '\n'
+         << "  mUpdateTotal:" << mUpdateTotal << '\n'
+         << "  mMachineTbl (total:" << mMachineTbl.size() << ") {\n";
+    const std::map<int, MachineState> sortedTbl(mMachineTbl.begin(), mMachineTbl.end());
+    for (const auto& itr : sortedTbl) {
+        ostr << "    machineId:" << itr.first
+             << " interval:" << itr.second.mIntervalSec << " sec"
+             << " progress:" << itr.second.mProgress << '\n';
+    }
+    ostr << "  }\n"
+         << "}";
+    return ostr.str();
+}
+
+float
+MergeFeedbackScheduler::calcTargetInterval(const MachineState& state,
+                                           const Measurement& measurement,
+                                           const float mergeEvalFeedbackMs) const
+{
+    // convergence : geometric interpolation between min and max interval
+    const float convergence =
+        std::min(std::max(measurement.mProgress / std::max(mConvergedProgress, 0.01f), 0.0f), 1.0f);
+    float targetSec = mMinIntervalSec * std::pow(mMaxIntervalSec / mMinIntervalSec, convergence);
+
+    // feedback evaluation cost on both sides
+    if (measurement.mEvalFeedbackMs > 0.0f) {
+        targetSec = std::max(targetSec, measurement.mEvalFeedbackMs / 1000.0f / mMcrtCostBudget);
+    }
+    if (mergeEvalFeedbackMs > 0.0f) {
+        targetSec = std::max(targetSec, mergeEvalFeedbackMs / 1000.0f / mMergeCostBudget);
+    }
+
+    // feedback latency
+    targetSec = std::max(targetSec, measurement.mFeedbackLatencyMs / 1000.0f * mLatencyRatio);
+
+    // received bandwidth is measured under the current interval
+    if (mMaxBps > 0.0f && measurement.mRecvFeedbackBps > mMaxBps && state.mIntervalSec > 0.0f) {
+        targetSec = std::max(targetSec, state.mIntervalSec * measurement.mRecvFeedbackBps / mMaxBps);
+    }
+
+    return std::min(std::max(targetSec, mMinIntervalSec), mMaxIntervalSec);
+}
+
+void
+MergeFeedbackScheduler::parserConfigure()
+{
+    mParser.description("MergeFeedbackScheduler command");
+    mParser.opt("active", "<on|off|show>", "set adaptive feedback interval on/off",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mActive = (arg++).as<bool>(0);
+                    return arg.fmtMsg("active %s\n", scene_rdl2::str_util::boolStr(mActive).c_str());
+                });
+    mParser.opt("interval", "<minSec> <maxSec>", "set min and max feedback interval",
+                [&](Arg& arg) -> bool {
+                    mMinIntervalSec = std::max((arg++).as<float>(0), 0.001f);
+                    mMaxIntervalSec = std::max((arg++).as<float>(0), mMinIntervalSec);
+                    return arg.fmtMsg("interval min:%f max:%f sec\n", mMinIntervalSec, mMaxIntervalSec);
+                });
+    mParser.opt("convergedProgress", "<fraction|show>", "set progress which is treated as converged",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mConvergedProgress = std::min(std::max((arg++).as<float>(0), 0.01f), 1.0f);
+                    return arg.fmtMsg("convergedProgress %f\n", mConvergedProgress);
+                });
+    mParser.opt("mcrtCostBudget", "<ratio|show>", "set max feedback evaluation cost ratio of MCRT",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mMcrtCostBudget = std::max((arg++).as<float>(0), 0.001f);
+                    return arg.fmtMsg("mcrtCostBudget %f\n", mMcrtCostBudget);
+                });
+    mParser.opt("mergeCostBudget", "<ratio|show>", "set max feedback evaluation cost ratio of merge",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mMergeCostBudget = std::max((arg++).as<float>(0), 0.001f);
+                    return arg.fmtMsg("mergeCostBudget %f\n", mMergeCostBudget);
+                });
+    mParser.opt("latencyRatio", "<ratio|show>", "set min interval ratio to the feedback latency",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mLatencyRatio = std::max((arg++).as<float>(0), 0.0f);
+                    return arg.fmtMsg("latencyRatio %f\n", mLatencyRatio);
+                });
+    mParser.opt("maxBps", "<bytesPerSec|show>", "set max received feedback bandwidth of each MCRT. 0:unlimited",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mMaxBps = std::max((arg++).as<float>(0), 0.0f);
+                    return arg.fmtMsg("maxBps %f\n", mMaxBps);
+                });
+    mParser.opt("smoothing", "<weight|show>", "set EMA weight of the new target when shortening the interval",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mSmoothing = std::min(std::max((arg++).as<float>(0), 0.01f), 1.0f);
+                    return arg.fmtMsg("smoothing %f\n", mSmoothing);
+                });
+    mParser.opt("reset", "", "reset scheduler",
+                [&](Arg& arg) -> bool { reset(); return arg.msg("reset\n"); });
+    mParser.opt("show", "", "show internal info",
+                [&](Arg& arg) -> bool { return arg.msg(show() + '\n'); });
+}
+
+} // namespace mcrt_dataio
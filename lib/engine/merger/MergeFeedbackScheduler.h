@@ -0,0 +1,110 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+//
+// Adaptive per-machine feedback interval scheduler
+//
+// The feedback interval of the merge computation is a fixed setting without this scheduler. This scheduler
+// decides the feedback interval of each MCRT computation by the measurements which are already reported
+// to GlobalNodeInfo and McrtNodeInfo.
+//
+//   convergence : The interval grows geometrically from minInterval to maxInterval by the render progress
+//                 of the machine (progress / convergedProgress). Feedback is frequent while the image is
+//                 still noisy and sparse after the image is converged.
+//   MCRT cost   : The interval is never shorter than evalFeedbackTime / mcrtCostBudget in order to keep
+//                 the feedback evaluation cost under the budget ratio of the MCRT render time.
+//   merge cost  : The interval is never shorter than mergeEvalFeedbackTime / mergeCostBudget.
+//   latency     : The interval is never shorter than feedbackLatency x latencyRatio. A new feedback before
+//                 the arrival of the previous one does not help.
+//   bandwidth   : If maxBps is set, the interval is never shorter than the interval which keeps the
+//                 received feedback bandwidth of the machine under maxBps.
+//
+// The interval backs off immediately and is shortened by smoothing. It is reset to the target immediately
+// when the progress goes back (i.e. a new frame is started).
+//
+
+#include <scene_rdl2/common/grid_util/Arg.h>
+#include <scene_rdl2/common/grid_util/Parser.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace mcrt_dataio {
+
+class GlobalNodeInfo;
+
+class MergeFeedbackScheduler
+{
+public:
+    using Arg = scene_rdl2::grid_util::Arg;
+    using Parser = scene_rdl2::grid_util::Parser;
+
+    // Measurement of a single MCRT computation (see McrtNodeInfo)
+    struct Measurement {
+        float mProgress {0.0f};         // render progress 0.0~1.0
+        float mEvalFeedbackMs {0.0f};   // MCRT side feedback evaluation cost : millisec
+        float mFeedbackLatencyMs {0.0f}; // feedback latency : millisec
+        float mRecvFeedbackBps {0.0f};  // MCRT side received feedback bandwidth : Byte/Sec
+    };
+
+    MergeFeedbackScheduler() { parserConfigure(); }
+
+    void setActive(const bool flag) { mActive = flag; }
+    bool getActive() const { return mActive; }
+
+    void reset(); // all machines are back to the initial condition
+
+    // Update the intervals of all machines by GlobalNodeInfo and McrtNodeInfo measurements. The shortest
+    // interval of all machines is set to GlobalNodeInfo as the merge computation feedback interval.
+    void update(GlobalNodeInfo& globalNodeInfo);
+
+    // Update the interval of a single machine and return the new interval : sec
+    float updateMachine(const int machineId, const Measurement& measurement, const float mergeEvalFeedbackMs);
+
+    // Feedback send timing control. nowSec is any monotonic clock of the caller.
+    bool isFeedbackDue(const int machineId, const double nowSec) const;
+    void feedbackSent(const int machineId, const double nowSec);
+
+    float getInterval(const int machineId) const; // sec. Return maxInterval if the machine is unknown
+    float getShortestInterval() const; // sec. Return maxInterval if there is no machine
+
+    std::string show() const;
+
+    Parser& getParser() { return mParser; }
+
+private:
+    struct MachineState {
+        float mIntervalSec {0.0f};
+        float mProgress {0.0f};
+        bool mSent {false};
+        double mLastSentSec {0.0};
+    };
+
+    bool mActive {false};
+
+    float mMinIntervalSec {0.1f};     // shortest interval while the image is noisy
+    float mMaxIntervalSec {5.0f};     // longest interval after the image is converged
+    float mConvergedProgress {0.9f};  // progress which is treated as converged
+    float mMcrtCostBudget {0.05f};    // max feedback evaluation cost ratio of the MCRT render time
+    float mMergeCostBudget {0.25f};   // max feedback evaluation cost ratio of the merge computation time
+    float mLatencyRatio {1.0f};       // interval >= feedback latency x this ratio
+    float mMaxBps {0.0f};             // max received feedback bandwidth of each machine. 0 = unlimited
+    float mSmoothing {0.3f};          // EMA weight of the new target when the interval is shortened
+
+    std::unordered_map<int, MachineState> mMachineTbl; // key is machineId
+
+    uint64_t mUpdateTotal {0};
+
+    Parser mParser;
+
+    float calcTargetInterval(const MachineState& state,
+                             const Measurement& measurement,
+                             const float mergeEvalFeedbackMs) const;
+
+    void parserConfigure();
+}; // MergeFeedbackScheduler
+
+} // namespace mcrt_dataio
@@ -0,0 +1,140 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MergeFeedbackTileDelta.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace mcrt_dataio {
+
+void
+MergeFeedbackTileDelta::reset(const unsigned numMachines, const unsigned totalTiles)
+{
+    mTotalTiles = totalTiles;
+    mMergeGen = 0;
+    mTileGen.assign(totalTiles, 0);
+    mSentGen.assign(numMachines, 0);
+    mSentValid.assign(numMachines, static_cast<char>(false));
+
+    mDeltaTilesTbl.clear();
+    mDeltaTilesTotal = 0;
+    mDeltaFull = true;
+
+    mFeedbackTotal = 0;
+    mFullFeedbackTotal = 0;
+    mSentTilesTotal = 0;
+    mFullTilesTotal = 0;
+}
+
+void
+MergeFeedbackTileDelta::updateMergedTiles(const unsigned totalTiles, const std::vector<char>* mergedTilesTbl)
+{
+    if (totalTiles != mTotalTiles) {
+        // resolution changed
+        mTotalTiles = totalTiles;
+        mTileGen.assign(totalTiles, 0);
+        invalidateAll();
+    }
+    if (mMergeGen == std::numeric_limits<uint32_t>::max()) {
+        // generation wraps around. We need a full feedback for all machines.
+        mMergeGen = 0;
+        std::fill(mTileGen.begin(), mTileGen.end(), 0);
+        invalidateAll();
+    }
+    mMergeGen++;
+
+    if (!mergedTilesTbl || mergedTilesTbl->size() != mTileGen.size()) {
+        std::fill(mTileGen.begin(), mTileGen.end(), mMergeGen);
+        return;
+    }
+    for (size_t tileId = 0; tileId < mTileGen.size(); ++tileId) {
+        if ((*mergedTilesTbl)[tileId]) mTileGen[tileId] = mMergeGen;
+    }
+}
+
+void
+MergeFeedbackTileDelta::invalidate(const unsigned machineId)
+{
+    if (machineId < mSentValid.size()) mSentValid[machineId] = static_cast<char>(false);
+}
+
+void
+MergeFeedbackTileDelta::invalidateAll()
+{
+    std::fill(mSentValid.begin(), mSentValid.end(), static_cast<char>(false));
+}
+
+const std::vector<char>*
+MergeFeedbackTileDelta::calcDeltaTiles(const unsigned machineId)
+{
+    if (machineId >= mSentValid.size() || !mSentValid[machineId]) {
+        mDeltaFull = true;
+        mDeltaTilesTotal = mTotalTiles;
+        return nullptr;
+    }
+
+    const uint32_t sentGen = mSentGen[machineId];
+    mDeltaTilesTbl.resize(mTileGen.size());
+    mDeltaTilesTotal = 0;
+    for (size_t tileId = 0; tileId < mTileGen.size(); ++tileId) {
+        const bool delta = mTileGen[tileId] > sentGen;
+        mDeltaTilesTbl[tileId] = static_cast<char>(delta);
+        if (delta) mDeltaTilesTotal++;
+    }
+    mDeltaFull = false;
+    return &mDeltaTilesTbl;
+}
+
+void
+MergeFeedbackTileDelta::markSent(const unsigned machineId)
+{
+    if (machineId >= mSentValid.size()) return;
+
+    mSentGen[machineId] = mMergeGen;
+    mSentValid[machineId] = static_cast<char>(true);
+
+    mFeedbackTotal++;
+    if (mDeltaFull) mFullFeedbackTotal++;
+    mSentTilesTotal += mDeltaTilesTotal;
+    mFullTilesTotal += mTotalTiles;
+}
+
+bool
+MergeFeedbackTileDelta::isSameDelta(const unsigned machineIdA, const unsigned machineIdB) const
+{
+    if (machineIdA >= mSentValid.size() || machineIdB >= mSentValid.size()) return false;
+    if (!mSentValid[machineIdA] || !mSentValid[machineIdB]) {
+        return !mSentValid[machineIdA] && !mSentValid[machineIdB]; // both are full feedback
+    }
+    return mSentGen[machineIdA] == mSentGen[machineIdB];
+}
+
+float
+MergeFeedbackTileDelta::getSentTilesRatio() const
+{
+    if (!mFullTilesTotal) return 1.0f;
+    return static_cast<float>(static_cast<double>(mSentTilesTotal) / static_cast<double>(mFullTilesTotal));
+}
+
+std::string
+MergeFeedbackTileDelta::show() const
+{
+    const size_t fullRequired = std::count(mSentValid.begin(), mSentValid.end(), static_cast<char>(false));
+
+    std::ostringstream ostr;
+    ostr << "MergeFeedbackTileDelta {\n"
+         << "  mTotalTiles:" << mTotalTiles << '\n'
+         << "  mMergeGen:" << mMergeGen << '\n'
+         << "  machines:" << mSentValid.size() << " (fullFeedbackRequired:" << fullRequired << ")\n"
+         << "  mFeedbackTotal:" << mFeedbackTotal << '\n'
+         << "  mFullFeedbackTotal:" << mFullFeedbackTotal << '\n'
+         << "  mSentTilesTotal:" << mSentTilesTotal << '\n'
+         << "  mFullTilesTotal:" << mFullTilesTotal << '\n'
+         << "  sentTilesRatio:" << getSentTilesRatio() << '\n'
+         << "}";
+    return ostr.str();
+}
+
+} // namespace mcrt_dataio
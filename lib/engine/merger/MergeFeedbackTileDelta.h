@@ -0,0 +1,81 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+//
+// Tile delta tracking of the progressiveFeedback image for each MCRT computation
+//
+// Under feedback mode, the merged image is sent back to all MCRT computations by every feedback interval.
+// Most of the tiles of the merged image are not changed between 2 feedback messages (especially under
+// the partial merge mode). This class keeps the merge generation of the last update of each tile and
+// the merge generation of the last feedback which was sent to each machine. The tiles which are updated
+// since the last feedback of the machine (delta tiles) are the only tiles that need to be sent to that
+// machine and the MCRT computation patches them into its own feedback Fb.
+//
+// A full feedback is required for the very first feedback of each machine, after invalidate() (i.e.
+// MCRT computation restarted or a feedback message might be lost) and after the resolution change.
+//
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mcrt_dataio {
+
+class MergeFeedbackTileDelta
+{
+public:
+    MergeFeedbackTileDelta() = default;
+
+    // Non-copyable
+    MergeFeedbackTileDelta &operator = (const MergeFeedbackTileDelta) = delete;
+    MergeFeedbackTileDelta(const MergeFeedbackTileDelta &) = delete;
+
+    // All machines need a full feedback after reset. Statistical info is also cleared.
+    void reset(const unsigned numMachines, const unsigned totalTiles);
+
+    // Update by the tiles which are changed by the last merge. nullptr means all tiles are changed.
+    // If totalTiles is different from the current one (i.e. resolution changed), all machines need a
+    // full feedback.
+    void updateMergedTiles(const unsigned totalTiles, const std::vector<char>* mergedTilesTbl);
+
+    void invalidate(const unsigned machineId); // next feedback of this machine is a full feedback
+    void invalidateAll();
+
+    // Compute the tiles which are updated since the last feedback of this machine. Return nullptr if a full
+    // feedback is required. Returned table is valid until the next calcDeltaTiles() call.
+    const std::vector<char>* calcDeltaTiles(const unsigned machineId);
+    unsigned getDeltaTilesTotal() const { return mDeltaTilesTotal; } // result of the last calcDeltaTiles()
+
+    // Should be called right after the feedback message which is created by the last calcDeltaTiles()
+    // is sent to this machine.
+    void markSent(const unsigned machineId);
+
+    // Return true if both machines get the same delta tiles. The caller can share a single feedback
+    // message between these machines.
+    bool isSameDelta(const unsigned machineIdA, const unsigned machineIdB) const;
+
+    // Ratio of the sent tiles to the tiles of the full feedback since reset (0.0 ~ 1.0)
+    float getSentTilesRatio() const;
+
+    std::string show() const;
+
+private:
+    unsigned mTotalTiles {0};
+    uint32_t mMergeGen {0};              // incremented by each updateMergedTiles()
+    std::vector<uint32_t> mTileGen;      // [tileId] : merge generation of the last update
+    std::vector<uint32_t> mSentGen;      // [machineId] : merge generation of the last feedback
+    std::vector<char> mSentValid;        // [machineId] : false means a full feedback is required
+
+    std::vector<char> mDeltaTilesTbl;    // result of the last calcDeltaTiles()
+    unsigned mDeltaTilesTotal {0};
+    bool mDeltaFull {true};              // last calcDeltaTiles() requires a full feedback
+
+    uint64_t mFeedbackTotal {0};         // statistical info since reset
+    uint64_t mFullFeedbackTotal {0};
+    uint64_t mSentTilesTotal {0};
+    uint64_t mFullTilesTotal {0};        // sent tiles total if all the feedbacks are full feedback
+}; // MergeFeedbackTileDelta
+
+} // namespace mcrt_dataio
@@ -0,0 +1,447 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MergeKernel.h"
+
+#include <scene_rdl2/common/rec_time/RecTime.h>
+
+#include <tbb/parallel_for.h>
+
+#include <atomic>
+#include <functional>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MERGE_KERNEL_X86
+#include <immintrin.h>
+#endif // end __x86_64__ || _M_X64
+
+namespace {
+
+constexpr unsigned sTilePixTotal = 64; // 8 x 8 pixels
+
+constexpr unsigned sRgbaChanTotal = 4; // RGBA float
+
+#ifdef MERGE_KERNEL_X86
+//
+// Lane index table which converts the SIMD lane to the pixel index for the numChan interleaved buffer.
+// mIdx8[numChan - 1][vecId][lane] = (vecId * 8 + lane) / numChan : for AVX2 (8 pixels per loop)
+// mIdx16[numChan - 1][vecId][lane] = (vecId * 16 + lane) / numChan : for AVX-512 (16 pixels per loop)
+//
+struct LaneIdxTbl
+{
+    LaneIdxTbl()
+    {
+        for (int numChan = 1; numChan <= 4; ++numChan) {
+            for (int vecId = 0; vecId < 4; ++vecId) {
+                for (int lane = 0; lane < 8; ++lane) {
+                    mIdx8[numChan - 1][vecId][lane] = (vecId * 8 + lane) / numChan;
+                }
+                for (int lane = 0; lane < 16; ++lane) {
+                    mIdx16[numChan - 1][vecId][lane] = (vecId * 16 + lane) / numChan;
+                }
+            }
+        }
+    }
+
+    alignas(64) int mIdx8[4][4][8];
+    alignas(64) int mIdx16[4][4][16];
+};
+
+const LaneIdxTbl sLaneIdxTbl;
+#endif // end MERGE_KERNEL_X86
+
+//------------------------------------------------------------------------------------------
+
+template <unsigned C>
+void
+accumulateTileScalar(const uint64_t pixMask,
+                     const float* src, const unsigned* srcNumSample,
+                     float* dst, unsigned* dstNumSample)
+{
+    for (unsigned pixId = 0; pixId < sTilePixTotal; ++pixId) {
+        if (!(pixMask & (static_cast<uint64_t>(0x1) << pixId))) continue;
+        const unsigned currSrcNumSample = srcNumSample[pixId];
+        if (!currSrcNumSample) continue;
+
+        const unsigned currDstNumSample = dstNumSample[pixId];
+        const unsigned totalNumSample = currDstNumSample + currSrcNumSample;
+        const float* s = src + pixId * C;
+        float* d = dst + pixId * C;
+        if (!currDstNumSample) {
+            for (unsigned chanId = 0; chanId < C; ++chanId) d[chanId] = s[chanId];
+        } else {
+            const float srcW = static_cast<float>(currSrcNumSample);
+            const float dstW = static_cast<float>(currDstNumSample);
+            const float totalW = static_cast<float>(totalNumSample);
+            for (unsigned chanId = 0; chanId < C; ++chanId) {
+                d[chanId] = (d[chanId] * dstW + s[chanId] * srcW) / totalW;
+            }
+        }
+        dstNumSample[pixId] = totalNumSample;
+    }
+}
+
+void
+orTileMasksScalar(const uint64_t* src, uint64_t* dst, const size_t tileTotal)
+{
+    for (size_t tileId = 0; tileId < tileTotal; ++tileId) dst[tileId] |= src[tileId];
+}
+
+#ifdef MERGE_KERNEL_X86
+//
+// numSample is converted to float by signed int conversion. This is safe because numSample never
+// exceeds 2^31 in practice.
+//
+template <unsigned C>
+__attribute__((target("avx2")))
+void
+accumulateTileAvx2(const uint64_t pixMask,
+                   const float* src, const unsigned* srcNumSample,
+                   float* dst, unsigned* dstNumSample)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i bitSel = _mm256_setr_epi32(0x1, 0x2, 0x4, 0x8, 0x10, 0x20, 0x40, 0x80);
+
+    for (unsigned basePixId = 0; basePixId < sTilePixTotal; basePixId += 8) {
+        const int bits = static_cast<int>((pixMask >> basePixId) & 0xff);
+        if (!bits) continue;
+
+        const __m256i srcNs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcNumSample + basePixId));
+        const __m256i dstNs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dstNumSample + basePixId));
+        const __m256i maskOn = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(bits), bitSel), bitSel);
+        const __m256i active = _mm256_andnot_si256(_mm256_cmpeq_epi32(srcNs, zero), maskOn);
+        if (_mm256_testz_si256(active, active)) continue;
+
+        const __m256i dstEmpty = _mm256_cmpeq_epi32(dstNs, zero);
+        const __m256i totalNs = _mm256_add_epi32(dstNs, srcNs);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dstNumSample + basePixId),
+                            _mm256_blendv_epi8(dstNs, totalNs, active));
+
+        const __m256 srcW = _mm256_cvtepi32_ps(srcNs);
+        const __m256 dstW = _mm256_cvtepi32_ps(dstNs);
+        const __m256 totalW = _mm256_cvtepi32_ps(totalNs);
+        for (unsigned vecId = 0; vecId < C; ++vecId) {
+            const __m256i idx =
+                _mm256_load_si256(reinterpret_cast<const __m256i*>(sLaneIdxTbl.mIdx8[C - 1][vecId]));
+            const __m256 activeLane = _mm256_castsi256_ps(_mm256_permutevar8x32_epi32(active, idx));
+            const __m256 emptyLane = _mm256_castsi256_ps(_mm256_permutevar8x32_epi32(dstEmpty, idx));
+
+            const float* s = src + basePixId * C + vecId * 8;
+            float* d = dst + basePixId * C + vecId * 8;
+            const __m256 sv = _mm256_loadu_ps(s);
+            const __m256 dv = _mm256_loadu_ps(d);
+            __m256 result = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(dv, _mm256_permutevar8x32_ps(dstW, idx)),
+                                                        _mm256_mul_ps(sv, _mm256_permutevar8x32_ps(srcW, idx))),
+                                          _mm256_permutevar8x32_ps(totalW, idx));
+            result = _mm256_blendv_ps(result, sv, emptyLane);
+            _mm256_storeu_ps(d, _mm256_blendv_ps(dv, result, activeLane));
+        }
+    }
+}
+
+template <unsigned C>
+__attribute__((target("avx512f")))
+void
+accumulateTileAvx512(const uint64_t pixMask,
+                     const float* src, const unsigned* srcNumSample,
+                     float* dst, unsigned* dstNumSample)
+{
+    const __m512i zero = _mm512_setzero_si512();
+
+    for (unsigned basePixId = 0; basePixId < sTilePixTotal; basePixId += 16) {
+        const __mmask16 maskOn = static_cast<__mmask16>((pixMask >> basePixId) & 0xffff);
+        if (!maskOn) continue;
+
+        const __m512i srcNs = _mm512_loadu_si512(srcNumSample + basePixId);
+        const __m512i dstNs = _mm512_loadu_si512(dstNumSample + basePixId);
+        const __mmask16 active = _mm512_mask_cmpneq_epi32_mask(maskOn, srcNs, zero);
+        if (!active) continue;
+
+        const __mmask16 dstEmpty = _mm512_cmpeq_epi32_mask(dstNs, zero);
+        const __m512i totalNs = _mm512_add_epi32(dstNs, srcNs);
+        _mm512_mask_storeu_epi32(dstNumSample + basePixId, active, totalNs);
+
+        const __m512 srcW = _mm512_cvtepi32_ps(srcNs);
+        const __m512 dstW = _mm512_cvtepi32_ps(dstNs);
+        const __m512 totalW = _mm512_cvtepi32_ps(totalNs);
+        const __m512i activeV = _mm512_maskz_set1_epi32(active, -1);
+        const __m512i emptyV = _mm512_maskz_set1_epi32(dstEmpty, -1);
+        for (unsigned vecId = 0; vecId < C; ++vecId) {
+            const __m512i idx = _mm512_load_si512(sLaneIdxTbl.mIdx16[C - 1][vecId]);
+            const __m512i activeLaneV = _mm512_permutexvar_epi32(idx, activeV);
+            const __m512i emptyLaneV = _mm512_permutexvar_epi32(idx, emptyV);
+            const __mmask16 activeLane = _mm512_test_epi32_mask(activeLaneV, activeLaneV);
+            const __mmask16 emptyLane = _mm512_test_epi32_mask(emptyLaneV, emptyLaneV);
+
+            const float* s = src + basePixId * C + vecId * 16;
+            float* d = dst + basePixId * C + vecId * 16;
+            const __m512 sv = _mm512_loadu_ps(s);
+            const __m512 dv = _mm512_loadu_ps(d);
+            __m512 result = _mm512_div_ps(_mm512_add_ps(_mm512_mul_ps(dv, _mm512_permutexvar_ps(idx, dstW)),
+                                                        _mm512_mul_ps(sv, _mm512_permutexvar_ps(idx, srcW))),
+                                          _mm512_permutexvar_ps(idx, totalW));
+            result = _mm512_mask_blend_ps(emptyLane, result, sv);
+            _mm512_mask_storeu_ps(d, activeLane, result);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+void
+orTileMasksAvx2(const uint64_t* src, uint64_t* dst, const size_t tileTotal)
+{
+    size_t tileId = 0;
+    for (; tileId + 4 <= tileTotal; tileId += 4) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + tileId));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + tileId));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + tileId), _mm256_or_si256(s, d));
+    }
+    orTileMasksScalar(src + tileId, dst + tileId, tileTotal - tileId);
+}
+
+__attribute__((target("avx512f")))
+void
+orTileMasksAvx512(const uint64_t* src, uint64_t* dst, const size_t tileTotal)
+{
+    size_t tileId = 0;
+    for (; tileId + 8 <= tileTotal; tileId += 8) {
+        const __m512i s = _mm512_loadu_si512(src + tileId);
+        const __m512i d = _mm512_loadu_si512(dst + tileId);
+        _mm512_storeu_si512(dst + tileId, _mm512_or_si512(s, d));
+    }
+    orTileMasksScalar(src + tileId, dst + tileId, tileTotal - tileId);
+}
+#endif // end MERGE_KERNEL_X86
+
+//------------------------------------------------------------------------------------------
+
+mcrt_dataio::MergeKernel::Isa
+detectIsa()
+{
+    using Isa = mcrt_dataio::MergeKernel::Isa;
+
+#   ifdef MERGE_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Isa::AVX512;
+    if (__builtin_cpu_supports("avx2")) return Isa::AVX2;
+#   endif // end MERGE_KERNEL_X86
+    return Isa::SCALAR; // non x86 host (i.e. arm64) or x86 without AVX2
+}
+
+const mcrt_dataio::MergeKernel::Isa sSupportedIsa = detectIsa();
+std::atomic<mcrt_dataio::MergeKernel::Isa> sIsa {sSupportedIsa};
+
+} // namespace
+
+namespace mcrt_dataio {
+
+// static function
+MergeKernel::Isa
+MergeKernel::getSupportedIsa()
+{
+    return sSupportedIsa;
+}
+
+// static function
+MergeKernel::Isa
+MergeKernel::getIsa()
+{
+    return sIsa.load(std::memory_order_relaxed);
+}
+
+// static function
+bool
+MergeKernel::setIsa(const Isa isa)
+{
+    if (!isSupported(isa)) return false;
+    sIsa.store(isa);
+    return true;
+}
+
+// static function
+bool
+MergeKernel::isSupported(const Isa isa)
+{
+    return static_cast<int>(isa) <= static_cast<int>(sSupportedIsa);
+}
+
+// static function
+std::string
+MergeKernel::isaStr(const Isa isa)
+{
+    switch (isa) {
+    case Isa::SCALAR : return "SCALAR";
+    case Isa::AVX2 : return "AVX2";
+    case Isa::AVX512 : return "AVX512";
+    default : return "?";
+    }
+}
+
+// static function
+void
+MergeKernel::accumulateTile(const Isa isa,
+                            const unsigned numChan,
+                            const uint64_t pixMask,
+                            const float* src, const unsigned* srcNumSample,
+                            float* dst, unsigned* dstNumSample)
+{
+#define DISPATCH(func)                                                  \
+    switch (numChan) {                                                  \
+    case 1 : func<1>(pixMask, src, srcNumSample, dst, dstNumSample); break; \
+    case 2 : func<2>(pixMask, src, srcNumSample, dst, dstNumSample); break; \
+    case 3 : func<3>(pixMask, src, srcNumSample, dst, dstNumSample); break; \
+    case 4 : func<4>(pixMask, src, srcNumSample, dst, dstNumSample); break; \
+    default : break;                                                    \
+    }
+
+    switch (isa) {
+#   ifdef MERGE_KERNEL_X86
+    case Isa::AVX512 : DISPATCH(accumulateTileAvx512); break;
+    case Isa::AVX2 : DISPATCH(accumulateTileAvx2); break;
+#   endif // end MERGE_KERNEL_X86
+    default : DISPATCH(accumulateTileScalar); break;
+    }
+
+#undef DISPATCH
+}
+
+// static function
+void
+MergeKernel::orTileMasks(const Isa isa, const uint64_t* src, uint64_t* dst, const size_t tileTotal)
+{
+    switch (isa) {
+#   ifdef MERGE_KERNEL_X86
+    case Isa::AVX512 : orTileMasksAvx512(src, dst, tileTotal); break;
+    case Isa::AVX2 : orTileMasksAvx2(src, dst, tileTotal); break;
+#   endif // end MERGE_KERNEL_X86
+    default : orTileMasksScalar(src, dst, tileTotal); break;
+    }
+}
+
+// static function
+void
+MergeKernel::accumulateRenderBuffer(const std::vector<char>* tilesTbl,
+                                    scene_rdl2::grid_util::Fb& src,
+                                    scene_rdl2::grid_util::Fb& dst)
+{
+    const unsigned totalTiles = dst.getTotalTiles();
+    if (src.getTotalTiles() != totalTiles) return; // resolution mismatch. just in case
+
+#   ifdef SINGLE_THREAD
+    accumulateRenderBufferTiles(tilesTbl, 0, totalTiles, src, dst);
+#   else // else SINGLE_THREAD
+    tbb::blocked_range<unsigned> range(0, totalTiles);
+    tbb::parallel_for(range, [&](const tbb::blocked_range<unsigned>& r) {
+            accumulateRenderBufferTiles(tilesTbl, r.begin(), r.end(), src, dst);
+        });
+#   endif // end !SINGLE_THREAD
+}
+
+// static function
+void
+MergeKernel::accumulateRenderBufferTiles(const std::vector<char>* tilesTbl,
+                                         const unsigned startTileId,
+                                         const unsigned endTileId,
+                                         const scene_rdl2::grid_util::Fb& src,
+                                         scene_rdl2::grid_util::Fb& dst)
+{
+    if (src.getTotalTiles() != dst.getTotalTiles()) return; // resolution mismatch. just in case
+
+    const Isa isa = getIsa();
+    const float* srcC = reinterpret_cast<const float*>(src.getRenderBufferTiled().getData());
+    const unsigned* srcNumSample = src.getNumSampleBufferTiled().getData();
+    float* dstC = reinterpret_cast<float*>(dst.getRenderBufferTiled().getData());
+    unsigned* dstNumSample = dst.getNumSampleBufferTiled().getData();
+    const auto& srcActivePixels = src.getActivePixels();
+    auto& dstActivePixels = dst.getActivePixels();
+
+    for (unsigned tileId = startTileId; tileId < endTileId; ++tileId) {
+        if (tilesTbl && !(*tilesTbl)[tileId]) continue;
+        const uint64_t pixMask = srcActivePixels.getTileMask(tileId);
+        if (!pixMask) continue;
+
+        const size_t pixOffset = static_cast<size_t>(tileId) * sTilePixTotal;
+        accumulateTile(isa, sRgbaChanTotal, pixMask,
+                       srcC + pixOffset * sRgbaChanTotal, srcNumSample + pixOffset,
+                       dstC + pixOffset * sRgbaChanTotal, dstNumSample + pixOffset);
+        dstActivePixels.setTileMask(tileId, dstActivePixels.getTileMask(tileId) | pixMask);
+    }
+}
+
+// static function
+std::string
+MergeKernel::bench(const unsigned loopMax)
+{
+    constexpr size_t tileTotal = 32640; // 1920 x 1088
+    constexpr size_t pixTotal = tileTotal * sTilePixTotal;
+
+    std::mt19937 mt(0);
+    std::uniform_real_distribution<float> valDist(0.0f, 4.0f);
+    std::uniform_int_distribution<unsigned> nsDist(1, 16);
+
+    std::vector<float> srcV(pixTotal * sRgbaChanTotal); // big enough for FLOAT ~ FLOAT4
+    std::vector<float> dstV(pixTotal * sRgbaChanTotal);
+    std::vector<unsigned> srcNs(pixTotal);
+    std::vector<unsigned> dstNs(pixTotal);
+    std::vector<uint64_t> srcMask(tileTotal);
+    std::vector<uint64_t> dstMask(tileTotal);
+    for (auto& v : srcV) v = valDist(mt);
+    for (auto& v : srcNs) v = nsDist(mt);
+    for (auto& v : srcMask) v = (static_cast<uint64_t>(mt()) << 32) | mt();
+
+    auto resetDst = [&]() {
+        std::fill(dstV.begin(), dstV.end(), 0.0f);
+        std::fill(dstNs.begin(), dstNs.end(), 0);
+        std::fill(dstMask.begin(), dstMask.end(), 0);
+    };
+
+    auto bench = [&](const std::function<void()>& func, const size_t byte) -> float { // return GB/s
+        resetDst();
+        func(); // warm up
+        scene_rdl2::rec_time::RecTime recTime;
+        recTime.start();
+        for (unsigned i = 0; i < loopMax; ++i) func();
+        const float sec = recTime.end();
+        if (sec <= 0.0f) return 0.0f;
+        return static_cast<float>(byte) * static_cast<float>(loopMax) / sec / (1024.0f * 1024.0f * 1024.0f);
+    };
+
+    std::ostringstream ostr;
+    ostr << "MergeKernel bench (loopMax:" << loopMax << " tileTotal:" << tileTotal
+         << " supportedIsa:" << isaStr(getSupportedIsa()) << " currentIsa:" << isaStr(getIsa()) << ") {\n";
+    for (int isaId = 0; isaId <= static_cast<int>(Isa::AVX512); ++isaId) {
+        const Isa isa = static_cast<Isa>(isaId);
+        if (!isSupported(isa)) continue;
+
+        ostr << "  " << isaStr(isa) << " {\n";
+        for (unsigned numChan = 1; numChan <= sRgbaChanTotal; ++numChan) {
+            // read src value/numSample + read/write dst value/numSample
+            const size_t byte = pixTotal * (numChan * sizeof(float) + sizeof(unsigned)) * 3;
+            const float gbps = bench([&]() {
+                    for (size_t tileId = 0; tileId < tileTotal; ++tileId) {
+                        const size_t pixOffset = tileId * sTilePixTotal;
+                        accumulateTile(isa, numChan, ~static_cast<uint64_t>(0),
+                                       srcV.data() + pixOffset * numChan, srcNs.data() + pixOffset,
+                                       dstV.data() + pixOffset * numChan, dstNs.data() + pixOffset);
+                    }
+                }, byte);
+            ostr << "    accumulate" << ((numChan == 4) ? "Rgba/Float4" : "Float" + std::to_string(numChan))
+                 << ": " << std::setw(8) << std::fixed << std::setprecision(3) << gbps << " GB/s\n";
+        }
+        {
+            const size_t byte = tileTotal * sizeof(uint64_t) * 3; // read src/dst + write dst
+            const float gbps = bench([&]() {
+                    orTileMasks(isa, srcMask.data(), dstMask.data(), tileTotal);
+                }, byte);
+            ostr << "    orTileMasks: " << std::setw(8) << std::fixed << std::setprecision(3) << gbps << " GB/s\n";
+        }
+        ostr << "  }\n";
+    }
+    ostr << "}";
+    return ostr.str();
+}
+
+} // namespace mcrt_dataio
@@ -0,0 +1,98 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+//
+// -- SIMD merge kernels --
+//
+// Project-local merge kernels for the hot cases of the merge accumulation. Each kernel has scalar,
+// AVX2 and AVX-512 versions and the version is selected at runtime based on the CPU of the running
+// host. The SIMD versions are only compiled for x86-64. Other architectures (i.e. arm64) and x86 CPUs
+// without AVX2 use the scalar version. The ISA can be overwritten by setIsa() for debugging and
+// benchmarking purposes.
+//
+// All tile kernels process a single 8x8 tile (64 pixels, tiled buffer layout) and only update the
+// pixels which are set by pixMask (bit N = pixel N inside the tile) and have non zero source numSample.
+// The accumulation is a numSample weighted average as follows.
+//
+//   dst = (dst * dstNumSample + src * srcNumSample) / (dstNumSample + srcNumSample)
+//   dstNumSample += srcNumSample
+//
+// If dstNumSample is 0, src is simply copied to dst.
+//
+
+#include <scene_rdl2/common/grid_util/Fb.h>
+
+#include <string>
+#include <vector>
+
+namespace mcrt_dataio {
+
+class MergeKernel
+{
+public:
+    enum class Isa : char {
+        SCALAR,
+        AVX2,
+        AVX512
+    };
+
+    static Isa getSupportedIsa(); // best ISA of the running CPU
+    static Isa getIsa();          // current ISA
+    static bool setIsa(const Isa isa); // return false if the isa is not supported by the running CPU
+    static bool isSupported(const Isa isa);
+    static std::string isaStr(const Isa isa);
+
+    // RGBA float (beauty) numSample weighted accumulate of 1 tile.
+    static void accumulateRgbaTile(const uint64_t pixMask,
+                                   const float* srcC, const unsigned* srcNumSample,
+                                   float* dstC, unsigned* dstNumSample)
+    {
+        accumulateTile(getIsa(), 4, pixMask, srcC, srcNumSample, dstC, dstNumSample);
+    }
+
+    // FLOAT/FLOAT2/FLOAT3/FLOAT4 (renderOutput) numSample weighted accumulate of 1 tile.
+    // numChan should be 1 ~ 4.
+    static void accumulateFloatNTile(const unsigned numChan,
+                                     const uint64_t pixMask,
+                                     const float* srcV, const unsigned* srcNumSample,
+                                     float* dstV, unsigned* dstNumSample)
+    {
+        accumulateTile(getIsa(), numChan, pixMask, srcV, srcNumSample, dstV, dstNumSample);
+    }
+
+    // ActivePixels tile masks merge : dst[i] |= src[i]
+    static void orTileMasks(const uint64_t* src, uint64_t* dst, const size_t tileTotal)
+    {
+        orTileMasks(getIsa(), src, dst, tileTotal);
+    }
+
+    // ISA specified versions for unit test and benchmark. isa should be supported by the running CPU.
+    static void accumulateTile(const Isa isa,
+                               const unsigned numChan,
+                               const uint64_t pixMask,
+                               const float* src, const unsigned* srcNumSample,
+                               float* dst, unsigned* dstNumSample);
+    static void orTileMasks(const Isa isa, const uint64_t* src, uint64_t* dst, const size_t tileTotal);
+
+    // Beauty buffer merge by accumulateRgbaTile(). This is the replacement of
+    // Fb::accumulateRenderBuffer() and updates the render buffer, the numSample buffer and the
+    // active pixels of dst. Only processes the tiles which are set by tilesTbl (nullptr : all tiles).
+    static void accumulateRenderBuffer(const std::vector<char>* tilesTbl,
+                                       scene_rdl2::grid_util::Fb& src,
+                                       scene_rdl2::grid_util::Fb& dst);
+    // Single thread version of accumulateRenderBuffer() which only processes the tile range
+    // startTileId ~ endTileId-1 (and set by tilesTbl if tilesTbl is not nullptr). Different tile ranges
+    // can be processed concurrently on the same dst.
+    static void accumulateRenderBufferTiles(const std::vector<char>* tilesTbl,
+                                            const unsigned startTileId,
+                                            const unsigned endTileId,
+                                            const scene_rdl2::grid_util::Fb& src,
+                                            scene_rdl2::grid_util::Fb& dst);
+
+    // Measure the throughput (GB/s) of each kernel for all supported ISAs.
+    static std::string bench(const unsigned loopMax);
+}; // MergeKernel
+
+} // namespace mcrt_dataio
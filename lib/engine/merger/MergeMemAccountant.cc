@@ -0,0 +1,117 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MergeMemAccountant.h"
+#include "GlobalNodeInfo.h"
+
+#include <scene_rdl2/render/util/StrUtil.h>
+
+#include <sstream>
+
+namespace mcrt_dataio {
+
+MergeMemAccountant::MergeMemAccountant()
+{
+    for (auto& currByte : mByte) currByte = 0;
+    for (auto& currTotal : mActionTotal) currTotal = 0;
+}
+
+void
+MergeMemAccountant::setByte(const Category category, const size_t byte)
+{
+    mByte[static_cast<unsigned>(category)].store(byte, std::memory_order_relaxed);
+
+    const size_t totalByte = getTotalByte();
+    size_t highWaterByte = mHighWaterByte.load(std::memory_order_relaxed);
+    while (highWaterByte < totalByte &&
+           !mHighWaterByte.compare_exchange_weak(highWaterByte, totalByte, std::memory_order_relaxed)) {}
+}
+
+size_t
+MergeMemAccountant::getByte(const Category category) const
+{
+    return mByte[static_cast<unsigned>(category)].load(std::memory_order_relaxed);
+}
+
+size_t
+MergeMemAccountant::getTotalByte() const
+{
+    size_t total = 0;
+    for (const auto& currByte : mByte) total += currByte.load(std::memory_order_relaxed);
+    return total;
+}
+
+bool
+MergeMemAccountant::isOverBudget() const
+{
+    const size_t budget = getBudget();
+    return budget && getTotalByte() > budget;
+}
+
+size_t
+MergeMemAccountant::getOverBudgetByte() const
+{
+    const size_t budget = getBudget();
+    const size_t totalByte = getTotalByte();
+    return (budget && totalByte > budget) ? totalByte - budget : 0;
+}
+
+void
+MergeMemAccountant::publish() const
+{
+    if (!mGlobalNodeInfo) return;
+
+    mGlobalNodeInfo->setMergeMemFbByte(getByte(Category::FB));
+    mGlobalNodeInfo->setMergeMemQueuedByte(getByte(Category::QUEUED_PAYLOAD));
+    mGlobalNodeInfo->setMergeMemSendBufferByte(getByte(Category::SEND_BUFFER));
+    mGlobalNodeInfo->setMergeMemTrackerByte(getByte(Category::ACTION_TRACKER));
+    mGlobalNodeInfo->setMergeMemBudget(getBudget());
+}
+
+// static function
+std::string
+MergeMemAccountant::categoryStr(const Category category)
+{
+    switch (category) {
+    case Category::FB : return "FB";
+    case Category::QUEUED_PAYLOAD : return "QUEUED_PAYLOAD";
+    case Category::SEND_BUFFER : return "SEND_BUFFER";
+    case Category::ACTION_TRACKER : return "ACTION_TRACKER";
+    default : return "?";
+    }
+}
+
+// static function
+std::string
+MergeMemAccountant::actionStr(const Action action)
+{
+    switch (action) {
+    case Action::FORCE_GC : return "FORCE_GC";
+    case Action::COALESCE : return "COALESCE";
+    case Action::DROP_FRAME : return "DROP_FRAME";
+    default : return "?";
+    }
+}
+
+std::string
+MergeMemAccountant::show() const
+{
+    using scene_rdl2::str_util::byteStr;
+
+    std::ostringstream ostr;
+    ostr << "MergeMemAccountant {\n"
+         << "  mBudget:" << ((getBudget()) ? byteStr(getBudget()) : "unlimited") << '\n';
+    for (unsigned i = 0; i < sCategoryTotal; ++i) {
+        ostr << "  " << categoryStr(static_cast<Category>(i)) << ':' << byteStr(mByte[i]) << '\n';
+    }
+    ostr << "  total:" << byteStr(getTotalByte()) << '\n'
+         << "  mHighWaterByte:" << byteStr(mHighWaterByte) << '\n'
+         << "  overBudget:" << scene_rdl2::str_util::boolStr(isOverBudget()) << '\n';
+    for (unsigned i = 0; i < sActionTotal; ++i) {
+        ostr << "  " << actionStr(static_cast<Action>(i)) << ':' << mActionTotal[i] << '\n';
+    }
+    ostr << "}";
+    return ostr.str();
+}
+
+} // namespace mcrt_dataio
@@ -0,0 +1,94 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+//
+// -- Memory accounting of the merge computation --
+//
+// Keeps the byte size of the major memory consumers of the merge computation by category and
+// publishes them to the client by GlobalNodeInfo. Each category is updated by its owner
+// (FbMsgMultiFrames::updateMemAccount() and each FbMsgMultiFrames::push() for the per-machine Fbs, queued
+// payloads and MergeActionTracker streams, MergeFbSender::getWorkByte() for the sender side work buffers).
+//
+// If the total exceeds the budget (0 = unlimited), the merge computation is considered under memory
+// pressure and the owners take the following actions in order to reduce memory.
+//   - FbMsgSingleFrame executes garbageCollectUnusedBuffers() without waiting for the
+//     5 messages / 500 ms heuristic.
+//   - FbMsgSingleFrame decodes the queued payloads of the machine at push() instead of keeping them until
+//     the next decodeAll(). Latest-wins coalescing is used if FbMsgSingleFrame::setCoalesceDecode(true).
+//   - FbMsgMultiFrames drops stale (i.e. newer than the display frame and older than the newly received
+//     syncFrameId) frames under SYNCID_LINEUP mode. The display frame is never dropped.
+// Each action is counted by countAction().
+//
+// setByte(), countAction() and isOverBudget() are MTsafe.
+//
+
+#include <array>
+#include <atomic>
+#include <string>
+
+namespace mcrt_dataio {
+
+class GlobalNodeInfo;
+
+class MergeMemAccountant
+{
+public:
+    enum class Category : unsigned {
+        FB,             // per-machine Fbs of all frames
+        QUEUED_PAYLOAD, // received FbMsgSingleChan payloads which are not decoded yet
+        SEND_BUFFER,    // MergeFbSender work buffers (Fb, pooled encode buffers)
+        ACTION_TRACKER, // MergeActionTracker encoded streams
+        SIZE
+    };
+
+    enum class Action : unsigned {
+        FORCE_GC,       // garbageCollectUnusedBuffers() ahead of the heuristic
+        COALESCE,       // queued payloads are decoded at push()
+        DROP_FRAME,     // stale frame is dropped
+        SIZE
+    };
+
+    MergeMemAccountant();
+
+    // Non-copyable
+    MergeMemAccountant &operator = (const MergeMemAccountant) = delete;
+    MergeMemAccountant(const MergeMemAccountant &) = delete;
+
+    void setGlobalNodeInfo(GlobalNodeInfo* globalNodeInfo) { mGlobalNodeInfo = globalNodeInfo; }
+
+    void setBudget(const size_t byte) { mBudget = byte; } // 0 : unlimited
+    size_t getBudget() const { return mBudget; }
+
+    void setByte(const Category category, const size_t byte); // MTsafe
+    size_t getByte(const Category category) const;
+    size_t getTotalByte() const;
+    size_t getHighWaterByte() const { return mHighWaterByte; }
+
+    bool isOverBudget() const; // MTsafe
+    size_t getOverBudgetByte() const; // 0 if not over budget
+
+    void countAction(const Action action) { mActionTotal[static_cast<unsigned>(action)]++; } // MTsafe
+    uint64_t getActionTotal(const Action action) const { return mActionTotal[static_cast<unsigned>(action)]; }
+
+    // Send all the category bytes and the budget to the client by GlobalNodeInfo.
+    void publish() const;
+
+    static std::string categoryStr(const Category category);
+    static std::string actionStr(const Action action);
+
+    std::string show() const;
+
+private:
+    static constexpr unsigned sCategoryTotal = static_cast<unsigned>(Category::SIZE);
+    static constexpr unsigned sActionTotal = static_cast<unsigned>(Action::SIZE);
+
+    GlobalNodeInfo* mGlobalNodeInfo {nullptr};
+
+    std::atomic<size_t> mBudget {0};
+    std::array<std::atomic<size_t>, sCategoryTotal> mByte;           // [category]
+    std::atomic<size_t> mHighWaterByte {0};                         // max total byte
+    std::array<std::atomic<uint64_t>, sActionTotal> mActionTotal;   // [action]
+}; // MergeMemAccountant
+
+} // namespace mcrt_dataio
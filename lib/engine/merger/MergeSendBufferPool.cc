@@ -0,0 +1,165 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MergeSendBufferPool.h"
+
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace mcrt_dataio {
+
+class MergeSendBufferPoolImpl
+{
+public:
+    static constexpr unsigned sMinClassLog2 = 12; // 4KB
+    static constexpr unsigned sMaxClassLog2 = 30; // 1GB
+    static constexpr unsigned sClassTotal = sMaxClassLog2 - sMinClassLog2 + 1;
+
+    MergeSendBufferPoolImpl() : mFreeList(sClassTotal) {}
+    ~MergeSendBufferPoolImpl()
+    {
+        for (auto& currList : mFreeList) {
+            for (std::string* buff : currList) delete buff;
+        }
+    }
+
+    std::string* get(const size_t sizeHint)
+    {
+        const unsigned classId = calcClassId(sizeHint, true);
+        std::string* buff = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mAcquireTotal++;
+            if (!mFreeList[classId].empty()) {
+                buff = mFreeList[classId].back();
+                mFreeList[classId].pop_back();
+                mCachedByte -= buff->capacity();
+                mReuseTotal++;
+            } else {
+                mAllocTotal++;
+            }
+        }
+        if (!buff) {
+            buff = new std::string;
+            buff->reserve(static_cast<size_t>(1) << (classId + sMinClassLog2));
+        }
+        return buff;
+    }
+
+    void put(std::string* buff)
+    {
+        buff->clear(); // keep capacity
+        const unsigned classId = calcClassId(buff->capacity(), false);
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mFreeList[classId].size() < mMaxFreePerClass) {
+                mFreeList[classId].push_back(buff);
+                mCachedByte += buff->capacity();
+                buff = nullptr;
+            } else {
+                mDiscardTotal++;
+            }
+        }
+        delete buff; // nullptr if the buffer is cached
+    }
+
+    void setMaxFreePerClass(const size_t max)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mMaxFreePerClass = max;
+    }
+
+    size_t getCachedByte() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mCachedByte;
+    }
+
+    std::string show() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::ostringstream ostr;
+        ostr << "MergeSendBufferPool {\n"
+             << "  mMaxFreePerClass:" << mMaxFreePerClass << '\n'
+             << "  mAcquireTotal:" << mAcquireTotal << '\n'
+             << "  mReuseTotal:" << mReuseTotal << '\n'
+             << "  mAllocTotal:" << mAllocTotal << '\n'
+             << "  mDiscardTotal:" << mDiscardTotal << '\n'
+             << "  mCachedByte:" << mCachedByte << '\n';
+        for (unsigned classId = 0; classId < sClassTotal; ++classId) {
+            if (mFreeList[classId].empty()) continue;
+            ostr << "  class:" << (static_cast<size_t>(1) << (classId + sMinClassLog2))
+                 << " free:" << mFreeList[classId].size() << '\n';
+        }
+        ostr << "}";
+        return ostr.str();
+    }
+
+private:
+    static unsigned calcClassId(const size_t size, const bool roundUp)
+    //
+    // roundUp = true  : smallest class which can store size byte (for acquire)
+    // roundUp = false : largest class which is not bigger than size byte (for release)
+    //
+    {
+        unsigned log2 = sMinClassLog2;
+        while (log2 < sMaxClassLog2 && (static_cast<size_t>(1) << (log2 + 1)) <= size) ++log2;
+        if (roundUp && log2 < sMaxClassLog2 && (static_cast<size_t>(1) << log2) < size) ++log2;
+        return log2 - sMinClassLog2;
+    }
+
+    mutable std::mutex mMutex;
+    std::vector<std::vector<std::string*>> mFreeList; // [classId]
+    size_t mMaxFreePerClass {32};
+
+    uint64_t mAcquireTotal {0};
+    uint64_t mReuseTotal {0};
+    uint64_t mAllocTotal {0};
+    uint64_t mDiscardTotal {0};
+    size_t mCachedByte {0};
+};
+
+//------------------------------------------------------------------------------------------
+
+MergeSendBufferPool::MergeSendBufferPool()
+    : mImpl(std::make_shared<MergeSendBufferPoolImpl>())
+{
+}
+
+MergeSendBufferPool::Buffer
+MergeSendBufferPool::acquire(const size_t sizeHint)
+{
+    std::string* buff = mImpl->get(sizeHint);
+    buff->reserve(sizeHint); // buffer might be smaller than the class size if it was shrunk. just in case
+
+    // The buffer might be released after this pool is destructed. We use weak_ptr for this case.
+    std::weak_ptr<MergeSendBufferPoolImpl> weakImpl = mImpl;
+    return Buffer(buff, [weakImpl](std::string* ptr) {
+            if (std::shared_ptr<MergeSendBufferPoolImpl> impl = weakImpl.lock()) {
+                impl->put(ptr);
+            } else {
+                delete ptr;
+            }
+        });
+}
+
+void
+MergeSendBufferPool::setMaxFreePerClass(const size_t max)
+{
+    mImpl->setMaxFreePerClass(max);
+}
+
+size_t
+MergeSendBufferPool::getCachedByte() const
+{
+    return mImpl->getCachedByte();
+}
+
+std::string
+MergeSendBufferPool::show() const
+{
+    return mImpl->show();
+}
+
+} // namespace mcrt_dataio
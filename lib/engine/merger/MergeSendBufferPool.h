@@ -0,0 +1,55 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+//
+// Recycling pool of the output buffers for the message construction
+//
+// MergeFbSender encodes each buffer by PackTiles into a std::string and hands it to the message by
+// BaseFrame::addBuffer(). Without this pool, every addBuffer() requires a new heap allocation and a
+// full memcpy of the encoded data. This pool keeps size-classed (power of 2 capacity) std::string
+// buffers. The encoder writes directly into the acquired buffer and the buffer is handed to the message
+// without copy by toDataPtr(). The buffer automatically goes back to the pool when the message releases
+// the data. Buffers might be released by another thread (i.e. message send thread) and might outlive
+// the pool itself. Both cases are safely handled.
+//
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace mcrt_dataio {
+
+class MergeSendBufferPoolImpl;
+
+class MergeSendBufferPool
+{
+public:
+    using Buffer = std::shared_ptr<std::string>;
+    using DataPtr = std::shared_ptr<uint8_t>; // same as mcrt::BaseFrame::DataPtr
+
+    MergeSendBufferPool();
+
+    // Non-copyable
+    MergeSendBufferPool &operator = (const MergeSendBufferPool) = delete;
+    MergeSendBufferPool(const MergeSendBufferPool &) = delete;
+
+    // Return an empty buffer which has at least sizeHint byte capacity. sizeHint is typically the
+    // encoded data size of the last send.
+    Buffer acquire(const size_t sizeHint);
+
+    // Convert the buffer to the message data pointer without copy. The buffer is kept alive until both
+    // of the returned DataPtr and the Buffer are released.
+    static DataPtr toDataPtr(const Buffer& buff) { return DataPtr(buff, reinterpret_cast<uint8_t*>(&(*buff)[0])); }
+
+    void setMaxFreePerClass(const size_t max); // max number of the cached buffers for each size class
+    size_t getCachedByte() const; // total capacity of the cached buffers
+
+    std::string show() const;
+
+private:
+    std::shared_ptr<MergeSendBufferPoolImpl> mImpl;
+}; // MergeSendBufferPool
+
+} // namespace mcrt_dataio
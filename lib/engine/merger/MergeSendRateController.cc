@@ -0,0 +1,173 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MergeSendRateController.h"
+
+#include <mcrt_dataio/engine/mcrt/McrtControl.h>
+
+#include <scene_rdl2/render/util/StrUtil.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace mcrt_dataio {
+
+void
+MergeSendRateController::reset()
+{
+    mBacklog = false;
+    mCostMs = 0.0f;
+    mHintIntervalMs = 0.0f;
+    mCalmCount = 0;
+    mSent = false;
+    mSentSyncId = 0;
+    mSentIntervalMs = 0.0f;
+    mUpdateTotal = 0;
+    mBacklogTotal = 0;
+    mSendTotal = 0;
+}
+
+bool
+MergeSendRateController::update(const uint32_t syncId,
+                                const float recvIntervalMs,
+                                const size_t queueDepth,
+                                const float decodeMs,
+                                const float mergeMs)
+{
+    if (!mActive) return false;
+
+    const float costMs = decodeMs + mergeMs;
+    if (mUpdateTotal == 0) {
+        mCostMs = costMs;
+    } else {
+        mCostMs = mSmoothing * costMs + (1.0f - mSmoothing) * mCostMs;
+    }
+    mUpdateTotal++;
+
+    const bool deepQueue = queueDepth > mMaxQueueDepth;
+    const bool busy = recvIntervalMs > 0.0f && mCostMs > recvIntervalMs * mBusyRatio;
+    mBacklog = deepQueue || busy;
+
+    const float minIntervalMs = mCostMs * mHeadroom;
+    if (mBacklog) {
+        mBacklogTotal++;
+        mCalmCount = 0;
+
+        float targetMs = minIntervalMs;
+        if (deepQueue && recvIntervalMs > 0.0f) {
+            // The queue should be drained by a single merge cycle
+            const float depthRatio =
+                static_cast<float>(queueDepth) / static_cast<float>(std::max(mMaxQueueDepth, size_t(1)));
+            targetMs = std::max(targetMs, recvIntervalMs * depthRatio);
+        }
+        mHintIntervalMs = std::max(mHintIntervalMs, targetMs); // never relax under backlog
+    } else if (mHintIntervalMs > 0.0f) {
+        if (++mCalmCount >= mReleaseCount) {
+            mCalmCount = 0;
+            mHintIntervalMs *= mRelaxRatio;
+            if (mHintIntervalMs < minIntervalMs) mHintIntervalMs = 0.0f; // release the hint
+        }
+    }
+
+    return sendHint(syncId);
+}
+
+bool
+MergeSendRateController::sendHint(const uint32_t syncId)
+{
+    if (!mSent && mHintIntervalMs == 0.0f) return false; // nothing to tell
+
+    bool send = !mSent || syncId != mSentSyncId;
+    if (!send) {
+        if (mHintIntervalMs == 0.0f || mSentIntervalMs == 0.0f) {
+            send = (mHintIntervalMs != mSentIntervalMs);
+        } else {
+            send = std::fabs(mHintIntervalMs - mSentIntervalMs) > mSentIntervalMs * mMinChangeRatio;
+        }
+    }
+    if (!send) return false;
+
+    if (mMsgSendHandler) {
+        mMsgSendHandler->sendMessage(McrtControl::msgGen_sendRateHint(syncId, mHintIntervalMs));
+    }
+    mSent = (mHintIntervalMs > 0.0f); // released hint does not need to be sent again for the new syncId
+    mSentSyncId = syncId;
+    mSentIntervalMs = mHintIntervalMs;
+    mSendTotal++;
+    return true;
+}
+
+std::string
+MergeSendRateController::show() const
+{
+    using scene_rdl2::str_util::boolStr;
+
+    std::ostringstream ostr;
+    ostr << "MergeSendRateController {\n"
+         << "  mActive:" << boolStr(mActive) << '\n'
+         << "  mMaxQueueDepth:" << mMaxQueueDepth << '\n'
+         << "  mBusyRatio:" << mBusyRatio << '\n'
+         << "  mHeadroom:" << mHeadroom << '\n'
+         << "  mReleaseCount:" << mReleaseCount << '\n'
+         << "  mRelaxRatio:" << mRelaxRatio << '\n'
+         << "  mMinChangeRatio:" << mMinChangeRatio << '\n'
+         << "  mSmoothing:" << mSmoothing << '\n'
+         << "  mBacklog:" << boolStr(mBacklog) << '\n'
+         << "  mCostMs:" << mCostMs << " ms\n"
+         << "  mHintIntervalMs:" << mHintIntervalMs << " ms\n"
+         << "  mSentIntervalMs:" << mSentIntervalMs << " ms (syncId:" << mSentSyncId << ")\n"
+         << "  mUpdateTotal:" << mUpdateTotal << '\n'
+         << "  mBacklogTotal:" << mBacklogTotal << '\n'
+         << "  mSendTotal:" << mSendTotal << '\n'
+         << "}";
+    return ostr.str();
+}
+
+void
+MergeSendRateController::parserConfigure()
+{
+    mParser.description("MergeSendRateController command");
+    mParser.opt("active", "<on|off|show>", "set send-rate backpressure on/off",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mActive = (arg++).as<bool>(0);
+                    return arg.fmtMsg("active %s\n", scene_rdl2::str_util::boolStr(mActive).c_str());
+                });
+    mParser.opt("maxQueueDepth", "<n|show>", "set queue depth threshold of the backlog",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mMaxQueueDepth = std::max((arg++).as<size_t>(0), size_t(1));
+                    return arg.fmtMsg("maxQueueDepth %zu\n", mMaxQueueDepth);
+                });
+    mParser.opt("busyRatio", "<ratio|show>", "set cost / receive interval ratio threshold of the backlog",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mBusyRatio = std::max((arg++).as<float>(0), 0.01f);
+                    return arg.fmtMsg("busyRatio %f\n", mBusyRatio);
+                });
+    mParser.opt("headroom", "<ratio|show>", "set hint interval ratio to the cost",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mHeadroom = std::max((arg++).as<float>(0), 1.0f);
+                    return arg.fmtMsg("headroom %f\n", mHeadroom);
+                });
+    mParser.opt("releaseCount", "<n|show>", "set non-backlog update count to relax the hint",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mReleaseCount = std::max((arg++).as<unsigned>(0), 1U);
+                    return arg.fmtMsg("releaseCount %d\n", mReleaseCount);
+                });
+    mParser.opt("relaxRatio", "<ratio|show>", "set hint interval ratio of each relax step (0.0 < r < 1.0)",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mRelaxRatio = std::min(std::max((arg++).as<float>(0), 0.1f), 0.99f);
+                    return arg.fmtMsg("relaxRatio %f\n", mRelaxRatio);
+                });
+    mParser.opt("reset", "", "reset controller",
+                [&](Arg& arg) -> bool { reset(); return arg.msg("reset\n"); });
+    mParser.opt("show", "", "show internal info",
+                [&](Arg& arg) -> bool { return arg.msg(show() + '\n'); });
+}
+
+} // namespace mcrt_dataio
@@ -0,0 +1,112 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+//
+// Send-rate backpressure from the merge computation to the MCRT computations
+//
+// If the merge computation can not keep up with the incoming messages, MCRT computations keep sending
+// messages at full rate and the queued messages (and the end-to-end latency) grow without limit.
+// This controller detects the backlog by the queue depth of the received messages and by the
+// decode + merge cost versus the message receive interval of a single MCRT computation. Under backlog,
+// it asks all MCRT computations to slow down their snapshot/send cadence by the "sendRateHint"
+// McrtControl command (see McrtControl::msgGen_sendRateHint()).
+//
+// The hint interval is cost x headroom (or longer if the queue is deep) and it is never decreased while
+// the backlog continues. After releaseCount consecutive updates without backlog, the hint interval is
+// relaxed by relaxRatio and finally released (interval = 0) when it becomes shorter than the cost with
+// headroom. A new hint is only sent if the interval changes more than minChangeRatio, is released,
+// or the syncId changes.
+//
+// Compatibility with older MCRT computations : The hint is a plain McrtControl command string and the
+// merge computation does not know whether each MCRT computation understands it. An older McrtControl
+// does not have the sendRateHint definition, so McrtControl::isCommand() returns false and
+// McrtControl::run() returns false without any callback. The MCRT computation handles it in the same way
+// as any other unknown message (i.e. ignores it) and keeps sending at its own cadence. Nothing breaks,
+// but the backlog is not reduced and the controller keeps the hint (only resent by the change of the
+// interval or the syncId). The controller is inactive by default and should only be activated when all
+// the MCRT computations support the sendRateHint command.
+//
+
+#include "MsgSendHandler.h"
+
+#include <scene_rdl2/common/grid_util/Arg.h>
+#include <scene_rdl2/common/grid_util/Parser.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace mcrt_dataio {
+
+class MergeSendRateController
+{
+public:
+    using Arg = scene_rdl2::grid_util::Arg;
+    using Parser = scene_rdl2::grid_util::Parser;
+    using MsgSendHandlerShPtr = std::shared_ptr<MsgSendHandler>;
+
+    MergeSendRateController() { parserConfigure(); }
+
+    void setMsgSendHandler(MsgSendHandlerShPtr msgSendHandler) { mMsgSendHandler = msgSendHandler; }
+
+    void setActive(const bool flag) { mActive = flag; }
+    bool getActive() const { return mActive; }
+
+    void reset();
+
+    // Update the controller by the measurement of the last merge cycle and send a new hint to the MCRT
+    // computations if needed. Return true if a new hint is sent.
+    //   recvIntervalMs : average message receive interval of a single MCRT computation (0 : unknown)
+    //   queueDepth : max queued messages of a single MCRT computation before the decode
+    //                (see FbMsgSingleFrame::getQueuedDepthMax())
+    //   decodeMs, mergeMs : decode and merge cost of the last merge cycle
+    bool update(const uint32_t syncId,
+                const float recvIntervalMs,
+                const size_t queueDepth,
+                const float decodeMs,
+                const float mergeMs);
+
+    float getHintIntervalMs() const { return mHintIntervalMs; } // 0 : no hint
+    bool isBacklog() const { return mBacklog; }
+    float getCostMs() const { return mCostMs; }
+
+    std::string show() const;
+
+    Parser& getParser() { return mParser; }
+
+private:
+    MsgSendHandlerShPtr mMsgSendHandler;
+
+    bool mActive {false};
+
+    size_t mMaxQueueDepth {4};      // backlog if the queue depth exceeds this value
+    float mBusyRatio {0.9f};        // backlog if cost exceeds this ratio of the receive interval
+    float mHeadroom {1.25f};        // hint interval = cost x headroom
+    unsigned mReleaseCount {10};    // consecutive non-backlog updates to relax the hint
+    float mRelaxRatio {0.8f};       // hint interval ratio of each relax step
+    float mMinChangeRatio {0.1f};   // hint is not sent if the change is smaller than this ratio
+    float mSmoothing {0.3f};        // EMA weight of the newest cost measurement
+
+    bool mBacklog {false};
+    float mCostMs {0.0f};           // smoothed decode + merge cost : millisec
+    float mHintIntervalMs {0.0f};   // current hint interval : millisec. 0 = no hint
+    unsigned mCalmCount {0};        // consecutive non-backlog updates
+
+    bool mSent {false};
+    uint32_t mSentSyncId {0};
+    float mSentIntervalMs {0.0f};   // last sent hint interval : millisec
+
+    uint64_t mUpdateTotal {0};
+    uint64_t mBacklogTotal {0};
+    uint64_t mSendTotal {0};
+
+    Parser mParser;
+
+    bool sendHint(const uint32_t syncId);
+
+    void parserConfigure();
+}; // MergeSendRateController
+
+} // namespace mcrt_dataio
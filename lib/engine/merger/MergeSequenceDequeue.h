@@ -6,6 +6,7 @@
 #include "MergeSequenceKey.h"
 #include <scene_rdl2/render/cache/CacheDequeue.h>
 
+#include <algorithm>
 #include <cstddef>              // size_t
 #include <string>
 
@@ -14,6 +15,10 @@ namespace mcrt_dataio {
 class MergeSequenceDequeue
 //
 // MergeSequenceDequeue is a decoder of merge sequence action binary data generated by MergeSequenceEnqueue.
+// The tile set actions (MERGE_TILE_RUNLENGTH and MERGE_TILE_BITMAP) are expanded to the same
+// mergeTileSingleFunc / mergeTileRangeFunc call sequence as the tile set was encoded by
+// MergeSequenceEnqueue::mergeTileSingle() / mergeTileRange() for each run. So the callers do not need
+// to care which encoding was picked by the encoder.
 //
 {
 public:
@@ -75,6 +80,18 @@ public:
                     return false;
                 }
             } break;
+            case MergeSequenceKey::MERGE_TILE_RUNLENGTH : {
+                if (!decodeTileRunLength(mergeTileSingleFunc, mergeTileRangeFunc)) {
+                    pushError("ERROR : MergeSequenceDequeue() mergeTileRunLength decode failed");
+                    return false;
+                }
+            } break;
+            case MergeSequenceKey::MERGE_TILE_BITMAP : {
+                if (!decodeTileBitmap(mergeTileSingleFunc, mergeTileRangeFunc)) {
+                    pushError("ERROR : MergeSequenceDequeue() mergeTileBitmap decode failed");
+                    return false;
+                }
+            } break;
             case MergeSequenceKey::MERGE_ALL_TILES : {
                 if (!mergeAllTilesFunc()) {
                     pushError("ERROR : MergeSequenceDequeue() mergeFullFunc() failed");
@@ -101,6 +118,68 @@ public:
     }
 
 private:
+    template <typename MergeTileSingleFunc, typename MergeTileRangeFunc>
+    bool flushTileRun(const unsigned int startTileId,
+                      const unsigned int endTileId,
+                      MergeTileSingleFunc& mergeTileSingleFunc,
+                      MergeTileRangeFunc& mergeTileRangeFunc)
+    {
+        if (startTileId == endTileId) return mergeTileSingleFunc(startTileId);
+        return mergeTileRangeFunc(startTileId, endTileId);
+    }
+
+    template <typename MergeTileSingleFunc, typename MergeTileRangeFunc>
+    bool decodeTileRunLength(MergeTileSingleFunc& mergeTileSingleFunc,
+                             MergeTileRangeFunc& mergeTileRangeFunc)
+    {
+        const unsigned int runTotal = mDequeue.deqVLUInt();
+        unsigned int prevEndTileId = 0;
+        for (unsigned int runId = 0; runId < runTotal; ++runId) {
+            const unsigned int offset = mDequeue.deqVLUInt();
+            const unsigned int startTileId = (runId == 0) ? offset : prevEndTileId + offset + 2; // gap - 1
+            const unsigned int endTileId = startTileId + mDequeue.deqVLUInt(); // length - 1
+            if (!flushTileRun(startTileId, endTileId, mergeTileSingleFunc, mergeTileRangeFunc)) return false;
+            prevEndTileId = endTileId;
+        }
+        return true;
+    }
+
+    template <typename MergeTileSingleFunc, typename MergeTileRangeFunc>
+    bool decodeTileBitmap(MergeTileSingleFunc& mergeTileSingleFunc,
+                          MergeTileRangeFunc& mergeTileRangeFunc)
+    {
+        const unsigned int startTileId = mDequeue.deqVLUInt();
+        const unsigned int tileSpan = mDequeue.deqVLUInt();
+
+        // The bitmap is dequeued by the same chunk size as MergeSequenceEnqueue::mergeTileBitmap()
+        unsigned char chunk[64];
+        bool runActive = false;
+        unsigned int runStartTileId = 0;
+        for (unsigned int offset = 0; offset < tileSpan; ) {
+            const unsigned int chunkBits =
+                std::min(tileSpan - offset, static_cast<unsigned int>(sizeof(chunk) * 8));
+            mDequeue.deqByteData(chunk, (chunkBits + 7) / 8);
+            for (unsigned int bitId = 0; bitId < chunkBits; ++bitId) {
+                const bool active = chunk[bitId >> 3] & (0x1 << (bitId & 0x7));
+                const unsigned int tileId = startTileId + offset + bitId;
+                if (active && !runActive) {
+                    runActive = true;
+                    runStartTileId = tileId;
+                } else if (!active && runActive) {
+                    runActive = false;
+                    if (!flushTileRun(runStartTileId, tileId - 1, mergeTileSingleFunc, mergeTileRangeFunc)) {
+                        return false;
+                    }
+                }
+            }
+            offset += chunkBits;
+        }
+        if (runActive) {
+            return flushTileRun(runStartTileId, startTileId + tileSpan - 1, mergeTileSingleFunc, mergeTileRangeFunc);
+        }
+        return true;
+    }
+
     scene_rdl2::cache::CacheDequeue mDequeue;
 };
 
@@ -5,9 +5,118 @@
 
 #include <scene_rdl2/render/util/StrUtil.h>
 
+#include <algorithm>
+
 namespace mcrt_dataio {
 
-std::string    
+void
+MergeSequenceEnqueue::mergeTileRunLength(const TileRunArray& runs)
+{
+    if (runs.empty()) return;
+
+    mEnqueue.enqVLUInt(static_cast<unsigned int>(MergeSequenceKey::MERGE_TILE_RUNLENGTH));
+    mEnqueue.enqVLUInt(static_cast<unsigned int>(runs.size()));
+    for (size_t i = 0; i < runs.size(); ++i) {
+        if (i == 0) mEnqueue.enqVLUInt(runs[i].first);
+        else mEnqueue.enqVLUInt(runs[i].first - runs[i - 1].second - 2); // gap - 1
+        mEnqueue.enqVLUInt(runs[i].second - runs[i].first); // length - 1
+    }
+}
+
+void
+MergeSequenceEnqueue::mergeTileBitmap(const TileRunArray& runs)
+//
+// The bitmap is enqueued by a small chunk in order to avoid a heap allocation.
+//
+{
+    if (runs.empty()) return;
+
+    const unsigned int startTileId = runs.front().first;
+    const unsigned int tileSpan = runs.back().second - startTileId + 1;
+
+    mEnqueue.enqVLUInt(static_cast<unsigned int>(MergeSequenceKey::MERGE_TILE_BITMAP));
+    mEnqueue.enqVLUInt(startTileId);
+    mEnqueue.enqVLUInt(tileSpan);
+
+    unsigned char chunk[64];
+    unsigned int chunkStartTileId = startTileId; // tileId of the 1st bit of the chunk
+    size_t runId = 0;
+    while (chunkStartTileId < startTileId + tileSpan) {
+        const unsigned int chunkBits = std::min(tileSpan - (chunkStartTileId - startTileId),
+                                                static_cast<unsigned int>(sizeof(chunk) * 8));
+        const size_t chunkByte = (chunkBits + 7) / 8;
+        std::fill(chunk, chunk + chunkByte, 0x0);
+
+        const unsigned int chunkEndTileId = chunkStartTileId + chunkBits - 1;
+        while (runId < runs.size() && runs[runId].first <= chunkEndTileId) {
+            const unsigned int start = std::max(runs[runId].first, chunkStartTileId);
+            const unsigned int end = std::min(runs[runId].second, chunkEndTileId);
+            for (unsigned int tileId = start; tileId <= end; ++tileId) {
+                const unsigned int bitId = tileId - chunkStartTileId;
+                chunk[bitId >> 3] |= static_cast<unsigned char>(0x1 << (bitId & 0x7));
+            }
+            if (runs[runId].second > chunkEndTileId) break; // this run continues to the next chunk
+            ++runId;
+        }
+
+        mEnqueue.enqByteData(chunk, chunkByte);
+        chunkStartTileId += chunkBits;
+    }
+}
+
+// static function
+size_t
+MergeSequenceEnqueue::calcMergeTileRangeSize(const TileRunArray& runs)
+{
+    // MERGE_TILE_SINGLE and MERGE_TILE_RANGE keys are both 1 byte
+    size_t size = 0;
+    for (const TileRun& run : runs) {
+        size += 1 + calcVLUIntSize(run.first);
+        if (run.first != run.second) size += calcVLUIntSize(run.second);
+    }
+    return size;
+}
+
+// static function
+size_t
+MergeSequenceEnqueue::calcMergeTileRunLengthSize(const TileRunArray& runs)
+{
+    if (runs.empty()) return 0;
+
+    size_t size = 1 + calcVLUIntSize(static_cast<unsigned int>(runs.size())); // key + runTotal
+    for (size_t i = 0; i < runs.size(); ++i) {
+        if (i == 0) size += calcVLUIntSize(runs[i].first);
+        else size += calcVLUIntSize(runs[i].first - runs[i - 1].second - 2);
+        size += calcVLUIntSize(runs[i].second - runs[i].first);
+    }
+    return size;
+}
+
+// static function
+size_t
+MergeSequenceEnqueue::calcMergeTileBitmapSize(const TileRunArray& runs)
+{
+    if (runs.empty()) return 0;
+
+    const unsigned int startTileId = runs.front().first;
+    const unsigned int tileSpan = runs.back().second - startTileId + 1;
+    return 1 + calcVLUIntSize(startTileId) + calcVLUIntSize(tileSpan) + (tileSpan + 7) / 8;
+}
+
+// static function
+size_t
+MergeSequenceEnqueue::calcVLUIntSize(unsigned int v)
+{
+    // 7 bits for each byte. Same as CacheEnqueue::enqVLUInt()
+    size_t size = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+std::string
 MergeSequenceEnqueue::showDebug() const
 {
     return scene_rdl2::str_util::stringCat("MergeSequenceEnqueue {\n",
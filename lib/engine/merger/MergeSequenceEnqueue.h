@@ -7,6 +7,9 @@
 
 #include <scene_rdl2/render/cache/CacheEnqueue.h>
 
+#include <utility> // std::pair
+#include <vector>
+
 namespace mcrt_dataio {
 
 class MergeSequenceEnqueue
@@ -15,8 +18,21 @@ class MergeSequenceEnqueue
 // is converted to variable length items and would convert to single binary data by CacheEnqueue.
 // In order to decode this data, Please use MergeSequenceDequeue object.
 //
+// An arbitrary partial merge tile set is expressed by one of 3 encodings. mergeTileSingle() / mergeTileRange()
+// for each run, mergeTileRunLength() or mergeTileBitmap(). calcMergeTile{Range,RunLength,Bitmap}Size()
+// return the encoded byte size of each encoding in order to pick the smallest one. The run-length and bitmap
+// encodings are only emitted by MergeActionTracker when they are explicitly enabled
+// (see MergeActionTracker::setCompactTileSet()) because an older MergeSequenceDequeue can not decode them.
+//   run-length : runTotal, startTileId of the 1st run, (length - 1) of the 1st run, then
+//                (gap - 1) from the previous run and (length - 1) for each following run.
+//   bitmap     : startTileId of the 1st run, tileSpan (= endTileId of the last run - startTileId + 1),
+//                then (tileSpan + 7) / 8 bytes of bitmap (LSB first).
+//
 {
 public:
+    using TileRun = std::pair<unsigned int, unsigned int>; // startTileId, endTileId (inclusive)
+    using TileRunArray = std::vector<TileRun>; // sorted, non-overlapped and non-adjacent runs
+
     MergeSequenceEnqueue(std::string* bytes)
         : mEnqueue(bytes)
     {}
@@ -25,9 +41,17 @@ public:
     inline void decodeRange(unsigned int startSendImageActionId, unsigned int endSendImageActionId);
     inline void mergeTileSingle(unsigned int tileId);
     inline void mergeTileRange(unsigned int startTileId, unsigned int endTileId);
+    void mergeTileRunLength(const TileRunArray& runs);
+    void mergeTileBitmap(const TileRunArray& runs);
     inline void mergeAllTiles();
     inline void endOfData();
 
+    // Encoded byte size of the runs by each encoding.
+    static size_t calcMergeTileRangeSize(const TileRunArray& runs); // mergeTileSingle/mergeTileRange for each run
+    static size_t calcMergeTileRunLengthSize(const TileRunArray& runs);
+    static size_t calcMergeTileBitmapSize(const TileRunArray& runs);
+    static size_t calcVLUIntSize(unsigned int v); // byte size of the variable length coded unsigned int
+
     std::string showDebug() const;
 
 private:
@@ -7,6 +7,7 @@ namespace mcrt_dataio {
 
 //
 // This is a sequence-action key that uses for Merge Sequence Encode/Decode operation.
+// New keys are added after EOD in order to keep the values of the existing keys.
 //
 enum class MergeSequenceKey : unsigned int {
     DECODE_SINGLE = 0, // decode single progressiveFrame message action
@@ -14,7 +15,9 @@ enum class MergeSequenceKey : unsigned int {
     MERGE_TILE_SINGLE, // partial merge single tile action
     MERGE_TILE_RANGE,  // partial merge multiple tiles action (specified by range)
     MERGE_ALL_TILES,   // full merge action
-    EOD                // end of data
+    EOD,               // end of data
+    MERGE_TILE_RUNLENGTH, // partial merge arbitrary tile set action (specified by run-length)
+    MERGE_TILE_BITMAP     // partial merge arbitrary tile set action (specified by bitmap)
 };
 
 } // namespace mcrt_dataio
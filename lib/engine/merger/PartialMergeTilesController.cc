@@ -0,0 +1,121 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PartialMergeTilesController.h"
+
+#include <scene_rdl2/render/util/StrUtil.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace mcrt_dataio {
+
+void
+PartialMergeTilesController::reset()
+{
+    mTilesTotal = 0;
+    mCostPerTileMs = 0.0f;
+    mLastTilesTotal = 0;
+    mLastFbResetMs = 0.0f;
+    mLastAccumulateMs = 0.0f;
+    mUpdateTotal = 0;
+    mOverBudgetTotal = 0;
+}
+
+unsigned
+PartialMergeTilesController::getTilesTotal(const unsigned totalTiles, const unsigned initialTilesTotal)
+{
+    if (mTilesTotal == 0) mTilesTotal = initialTilesTotal;
+
+    // The resolution might be changed. We have to clamp the value every time.
+    const unsigned minTilesTotal = std::min(std::max(mMinTilesTotal, 1U), totalTiles);
+    return std::max(std::min(mTilesTotal, totalTiles), minTilesTotal);
+}
+
+void
+PartialMergeTilesController::update(const unsigned tilesTotal, const float fbResetMs, const float accumulateMs)
+{
+    if (tilesTotal == 0) return;
+
+    mLastTilesTotal = tilesTotal;
+    mLastFbResetMs = fbResetMs;
+    mLastAccumulateMs = accumulateMs;
+
+    const float costMs = fbResetMs + accumulateMs;
+    const float costPerTileMs = costMs / static_cast<float>(tilesTotal);
+    if (mUpdateTotal == 0) {
+        mCostPerTileMs = costPerTileMs;
+    } else {
+        mCostPerTileMs = mSmoothing * costPerTileMs + (1.0f - mSmoothing) * mCostPerTileMs;
+    }
+    mUpdateTotal++;
+
+    if (costMs > mTargetMs) {
+        // Over budget. We use the latest measurement directly in order to recover quickly.
+        mOverBudgetTotal++;
+        mCostPerTileMs = std::max(mCostPerTileMs, costPerTileMs);
+    }
+
+    if (mCostPerTileMs <= 0.0f) return; // just in case
+
+    const float idealTilesTotal = mTargetMs / mCostPerTileMs;
+    const float maxTilesTotal = static_cast<float>(tilesTotal) * mMaxStepRatio;
+    mTilesTotal = std::max(static_cast<unsigned>(std::min(idealTilesTotal, maxTilesTotal)), 1U);
+}
+
+std::string
+PartialMergeTilesController::show() const
+{
+    std::ostringstream ostr;
+    ostr << "PartialMergeTilesController {\n"
+         << "  mTargetMs:" << mTargetMs << " ms\n"
+         << "  mMinTilesTotal:" << mMinTilesTotal << '\n'
+         << "  mSmoothing:" << mSmoothing << '\n'
+         << "  mMaxStepRatio:" << mMaxStepRatio << '\n'
+         << "  mTilesTotal:" << mTilesTotal << '\n'
+         << "  mCostPerTileMs:" << std::setprecision(5) << mCostPerTileMs << " ms\n"
+         << "  mLastTilesTotal:" << mLastTilesTotal << '\n'
+         << "  mLastFbResetMs:" << mLastFbResetMs << " ms\n"
+         << "  mLastAccumulateMs:" << mLastAccumulateMs << " ms\n"
+         << "  mUpdateTotal:" << mUpdateTotal << '\n'
+         << "  mOverBudgetTotal:" << mOverBudgetTotal << '\n'
+         << "}";
+    return ostr.str();
+}
+
+void
+PartialMergeTilesController::parserConfigure()
+{
+    mParser.description("PartialMergeTilesController command");
+    mParser.opt("target", "<ms|show>", "set merge time budget by millisec",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mTargetMs = (arg++).as<float>(0);
+                    return arg.fmtMsg("target %f ms\n", mTargetMs);
+                });
+    mParser.opt("minTiles", "<n|show>", "set minimum partial merge tiles total",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mMinTilesTotal = (arg++).as<unsigned>(0);
+                    return arg.fmtMsg("minTiles %d\n", mMinTilesTotal);
+                });
+    mParser.opt("smoothing", "<fraction|show>", "set EMA weight of the newest measurement (0.0 < w <= 1.0)",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mSmoothing = std::min(std::max((arg++).as<float>(0), 0.01f), 1.0f);
+                    return arg.fmtMsg("smoothing %f\n", mSmoothing);
+                });
+    mParser.opt("maxStep", "<ratio|show>", "set max increase ratio of tiles total per merge",
+                [&](Arg& arg) -> bool {
+                    if (arg() == "show") arg++;
+                    else mMaxStepRatio = std::max((arg++).as<float>(0), 1.0f);
+                    return arg.fmtMsg("maxStep %f\n", mMaxStepRatio);
+                });
+    mParser.opt("reset", "", "reset controller",
+                [&](Arg& arg) -> bool { reset(); return arg.msg("reset\n"); });
+    mParser.opt("show", "", "show internal info",
+                [&](Arg& arg) -> bool { return arg.msg(show() + '\n'); });
+}
+
+} // namespace mcrt_dataio
@@ -0,0 +1,78 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+//
+// Closed-loop controller of the partial merge tiles total
+//
+// partialMergeTilesTotal of FbMsgSingleFrame::merge() is a static value by default. The cost of the
+// partial merge depends on the number of MCRT computations, the resolution and the AOV setup and these
+// might change during the session. This controller measures the cost of each partial merge
+// (fb reset and accumulate stages, the same stages which are recorded as MERGE_DEQ_FBRESET and
+// MERGE_DEQ_ACCUMULATE by LatencyLog) and adjusts the partial merge tiles total of the next merge
+// in order to keep the merge time inside the target budget.
+//
+// The model is simply cost = costPerTile x tilesTotal. costPerTile is smoothed by an exponential
+// moving average. The tiles total is immediately decreased if the budget is exceeded, but the increase
+// is limited by maxStepRatio per merge in order to avoid oscillation.
+//
+
+#include <scene_rdl2/common/grid_util/Arg.h>
+#include <scene_rdl2/common/grid_util/Parser.h>
+
+#include <string>
+
+namespace mcrt_dataio {
+
+class PartialMergeTilesController
+{
+public:
+    using Arg = scene_rdl2::grid_util::Arg;
+    using Parser = scene_rdl2::grid_util::Parser;
+
+    PartialMergeTilesController() { parserConfigure(); }
+
+    void reset();
+
+    void setTargetMs(const float ms) { mTargetMs = ms; } // merge time budget : millisec
+    float getTargetMs() const { return mTargetMs; }
+    void setMinTilesTotal(const unsigned total) { mMinTilesTotal = total; }
+
+    // Return partial merge tiles total for the next merge. initialTilesTotal is used until the first
+    // measurement is done.
+    unsigned getTilesTotal(const unsigned totalTiles, const unsigned initialTilesTotal);
+
+    // Update the controller by the measured result of the last partial merge.
+    void update(const unsigned tilesTotal, const float fbResetMs, const float accumulateMs);
+
+    unsigned getLastTilesTotal() const { return mLastTilesTotal; }
+    float getLastCostMs() const { return mLastFbResetMs + mLastAccumulateMs; }
+    float getCostPerTileMs() const { return mCostPerTileMs; }
+
+    std::string show() const;
+
+    Parser& getParser() { return mParser; }
+
+private:
+    float mTargetMs {8.0f};         // merge time budget : millisec
+    unsigned mMinTilesTotal {16};   // never less than this value
+    float mSmoothing {0.3f};        // EMA weight of the newest measurement
+    float mMaxStepRatio {2.0f};     // max increase ratio per merge
+
+    unsigned mTilesTotal {0};       // partial merge tiles total for the next merge. 0 = not initialized
+    float mCostPerTileMs {0.0f};    // smoothed cost per tile : millisec
+
+    unsigned mLastTilesTotal {0};   // last measured partial merge tiles total
+    float mLastFbResetMs {0.0f};    // last measured fb reset cost : millisec
+    float mLastAccumulateMs {0.0f}; // last measured accumulate cost : millisec
+
+    uint64_t mUpdateTotal {0};
+    uint64_t mOverBudgetTotal {0};
+
+    Parser mParser;
+
+    void parserConfigure();
+}; // PartialMergeTilesController
+
+} // namespace mcrt_dataio
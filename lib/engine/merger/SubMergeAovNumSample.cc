@@ -0,0 +1,91 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SubMergeAovNumSample.h"
+
+#include <scene_rdl2/common/fb_util/ActivePixels.h>
+#include <scene_rdl2/scene/rdl2/ValueContainerDeq.h>
+#include <scene_rdl2/scene/rdl2/ValueContainerEnq.h>
+
+#include <sstream>
+
+namespace mcrt_dataio {
+
+// static function
+void
+SubMergeAovNumSample::encode(const unsigned totalTiles,
+                             const std::vector<Aov>& aovTbl,
+                             scene_rdl2::rdl2::ValueContainerEnq& cEnq)
+{
+    cEnq.enqVLUInt(totalTiles);
+    cEnq.enqVLUInt(static_cast<unsigned>(aovTbl.size()));
+    for (const Aov& aov : aovTbl) {
+        cEnq.enqString(aov.mName);
+
+        unsigned activeTileTotal = 0;
+        for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+            if (aov.mActivePixels->getTileMask(tileId)) activeTileTotal++;
+        }
+        cEnq.enqVLUInt(activeTileTotal);
+
+        for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+            uint64_t mask = aov.mActivePixels->getTileMask(tileId);
+            if (!mask) continue;
+            cEnq.enqVLUInt(tileId);
+            cEnq.enqVLSizeT(static_cast<size_t>(mask));
+            const unsigned* numSample = aov.mNumSample + tileId * 64;
+            while (mask) {
+                cEnq.enqVLUInt(numSample[__builtin_ctzll(mask)]);
+                mask &= mask - 1;
+            }
+        }
+    }
+}
+
+// static function
+bool
+SubMergeAovNumSample::decode(const void* data,
+                             const size_t dataSize,
+                             const NumSampleBuffFunc& numSampleBuffFunc,
+                             std::string& error)
+//
+// Newer data should be decoded later. Each call overwrites the numSample of the pixels which are active
+// in this data only, the same as the decode of the AOV data itself.
+//
+{
+    try {
+        scene_rdl2::rdl2::ValueContainerDeq cDeq(data, dataSize);
+
+        const unsigned totalTiles = cDeq.deqVLUInt();
+        const unsigned aovTotal = cDeq.deqVLUInt();
+        for (unsigned aovId = 0; aovId < aovTotal; ++aovId) {
+            const std::string aovName = cDeq.deqString();
+            unsigned* numSample = numSampleBuffFunc(aovName, totalTiles);
+
+            const unsigned activeTileTotal = cDeq.deqVLUInt();
+            for (unsigned i = 0; i < activeTileTotal; ++i) {
+                const unsigned tileId = cDeq.deqVLUInt();
+                if (tileId >= totalTiles) {
+                    std::ostringstream ostr;
+                    ostr << "SubMergeAovNumSample::decode() failed. aovName:" << aovName
+                         << " tileId:" << tileId << " >= totalTiles:" << totalTiles;
+                    error = ostr.str();
+                    return false;
+                }
+                uint64_t mask = static_cast<uint64_t>(cDeq.deqVLSizeT());
+                while (mask) {
+                    const unsigned currNumSample = cDeq.deqVLUInt(); // always dequeued even if skipped
+                    if (numSample) numSample[tileId * 64 + __builtin_ctzll(mask)] = currNumSample;
+                    mask &= mask - 1;
+                }
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        error = std::string("SubMergeAovNumSample::decode() failed. ") + e.what();
+        return false;
+    }
+    return true;
+}
+
+} // namespace mcrt_dataio
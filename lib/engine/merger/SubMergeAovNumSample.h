@@ -0,0 +1,69 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+//
+// -- Per AOV numSample of the sub-merge output --
+//
+// PackTiles does not have a renderOutput encoding which includes numSample. Under the hierarchical merge,
+// each AOV of the sub-merge result has its own numSample (i.e. AOV pixels are not always sampled by the
+// same count as the beauty pixel) and the root merge needs it as the weight of the accumulation.
+// The sub-merge node sends the numSample of all regular AOVs as an additional side buffer (sBuffName)
+// of the same message by MergeFbSender::addRenderOutputWithNumSample() and the root merge applies it to
+// the numSample buffer of the decoded AOVs (see FbMsgMultiChans::setSubMergeInput()).
+//
+// Data format
+//   VLUInt totalTiles
+//   VLUInt aovTotal
+//   aovTotal x {
+//     String aovName
+//     VLUInt activeTileTotal
+//     activeTileTotal x {
+//       VLUInt tileId
+//       VLSizeT pixMask
+//       popcount(pixMask) x VLUInt numSample : pixel order inside the tile
+//     }
+//   }
+//
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace scene_rdl2 {
+    namespace fb_util { class ActivePixels; }
+    namespace rdl2 { class ValueContainerEnq; }
+}
+
+namespace mcrt_dataio {
+
+class SubMergeAovNumSample
+{
+public:
+    using ActivePixels = scene_rdl2::fb_util::ActivePixels;
+
+    static constexpr const char* sBuffName = "subMergeAovNumSample";
+
+    struct Aov {
+        std::string mName;
+        const ActivePixels* mActivePixels {nullptr}; // same activePixels as the AOV data encode
+        const unsigned* mNumSample {nullptr};        // tiled numSample buffer
+    };
+
+    // Return the tiled numSample buffer of the AOV to be updated. Return nullptr to skip this AOV
+    // (unknown AOV or resolution mismatch).
+    using NumSampleBuffFunc = std::function<unsigned*(const std::string& aovName, const unsigned totalTiles)>;
+
+    static void encode(const unsigned totalTiles,
+                       const std::vector<Aov>& aovTbl,
+                       scene_rdl2::rdl2::ValueContainerEnq& cEnq);
+
+    // Overwrite the numSample of the active pixels of each AOV. Return false if the data is broken.
+    static bool decode(const void* data,
+                       const size_t dataSize,
+                       const NumSampleBuffFunc& numSampleBuffFunc,
+                       std::string& error);
+}; // SubMergeAovNumSample
+
+} // namespace mcrt_dataio
@@ -0,0 +1,111 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TestFbMsgFbPool.h"
+
+#include <mcrt_dataio/engine/merger/FbMsgFbPool.h>
+
+#include <scene_rdl2/common/math/Viewport.h>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+void
+TestFbMsgFbPool::testReuse()
+{
+    const scene_rdl2::math::Viewport viewport(0, 0, 63, 47); // 8 x 6 tiles
+
+    FbMsgFbPool pool;
+    FbMsgFbPool::FbShPtr fbA = pool.acquire(viewport);
+    FbMsgFbPool::FbShPtr fbB = pool.acquire(viewport);
+    const size_t fbByte = FbMsgFbPool::calcFbByte(*fbA);
+    CPPUNIT_ASSERT(fbByte > 0);
+    CPPUNIT_ASSERT(pool.getTotalByte() == fbByte * 2);
+    CPPUNIT_ASSERT(pool.getLiveTotal() == 2);
+
+    const scene_rdl2::grid_util::Fb* ptrA = fbA.get();
+    pool.release(std::move(fbA));
+    CPPUNIT_ASSERT(!fbA);
+    CPPUNIT_ASSERT(pool.getLiveTotal() == 1 && pool.getFreeTotal() == 1);
+    CPPUNIT_ASSERT(pool.getFreeByte() == fbByte);
+
+    FbMsgFbPool::FbShPtr fbC = pool.acquire(viewport);
+    CPPUNIT_ASSERT("reused" && fbC.get() == ptrA);
+    CPPUNIT_ASSERT(pool.getTotalByte() == fbByte * 2);
+    CPPUNIT_ASSERT(pool.getFreeTotal() == 0);
+
+    // Fb which is not returned to the pool is simply freed
+    fbB.reset();
+    CPPUNIT_ASSERT(pool.getTotalByte() == fbByte);
+}
+
+void
+TestFbMsgFbPool::testViewportChange()
+{
+    const scene_rdl2::math::Viewport viewportA(0, 0, 63, 47);  // 8 x 6 tiles
+    const scene_rdl2::math::Viewport viewportB(0, 0, 127, 47); // 16 x 6 tiles
+
+    FbMsgFbPool pool;
+    pool.release(pool.acquire(viewportA));
+    CPPUNIT_ASSERT(pool.getFreeTotal() == 1);
+
+    // Pooled Fb of a different resolution is freed and a new Fb is allocated
+    FbMsgFbPool::FbShPtr fb = pool.acquire(viewportB);
+    CPPUNIT_ASSERT(fb->getRezedViewport() == viewportB);
+    CPPUNIT_ASSERT(pool.getFreeTotal() == 0);
+    CPPUNIT_ASSERT(pool.getTotalByte() == FbMsgFbPool::calcFbByte(*fb));
+}
+
+void
+TestFbMsgFbPool::testShrink()
+{
+    const scene_rdl2::math::Viewport viewport(0, 0, 63, 47); // 8 x 6 tiles
+
+    FbMsgFbPool pool;
+    FbMsgFbPool::FbShPtr fbA = pool.acquire(viewport);
+    FbMsgFbPool::FbShPtr fbB = pool.acquire(viewport);
+    FbMsgFbPool::FbShPtr fbC = pool.acquire(viewport);
+    const size_t fbByte = FbMsgFbPool::calcFbByte(*fbA);
+    pool.release(std::move(fbA));
+    pool.release(std::move(fbB));
+
+    pool.shrink(fbByte * 2); // free only 1 pooled Fb
+    CPPUNIT_ASSERT(pool.getTotalByte() == fbByte * 2);
+    CPPUNIT_ASSERT(pool.getFreeTotal() == 1);
+
+    pool.shrink(0); // acquired Fb is never freed by shrink
+    CPPUNIT_ASSERT(pool.getTotalByte() == fbByte);
+    CPPUNIT_ASSERT(pool.getFreeTotal() == 0 && pool.getLiveTotal() == 1);
+}
+
+void
+TestFbMsgFbPool::testUpdateByte()
+//
+// AOV buffers are allocated after acquire() and updateByte() should account for them.
+// release() frees the AOV buffers and the pooled byte should be the byte after the release.
+//
+{
+    const scene_rdl2::math::Viewport viewport(0, 0, 63, 47); // 8 x 6 tiles
+
+    FbMsgFbPool pool;
+    FbMsgFbPool::FbShPtr fb = pool.acquire(viewport);
+    const size_t fbByte = pool.getTotalByte();
+    CPPUNIT_ASSERT(fbByte == FbMsgFbPool::calcFbByte(*fb));
+
+    fb->getAov("testAov")->getActivePixels().init(viewport.width(), viewport.height());
+    const size_t aovFbByte = FbMsgFbPool::calcFbByte(*fb);
+    CPPUNIT_ASSERT("aovByte" && aovFbByte > fbByte);
+    CPPUNIT_ASSERT("notUpdated" && pool.getTotalByte() == fbByte);
+    pool.updateByte(fb);
+    CPPUNIT_ASSERT("updated" && pool.getTotalByte() == aovFbByte);
+    CPPUNIT_ASSERT("highWater" && pool.getHighWaterByte() == aovFbByte);
+
+    pool.release(std::move(fb));
+    CPPUNIT_ASSERT("released" && pool.getFreeByte() == pool.getTotalByte());
+    CPPUNIT_ASSERT("gc" && pool.getTotalByte() <= aovFbByte);
+    pool.clear();
+    CPPUNIT_ASSERT("freed" && pool.getTotalByte() == 0);
+}
+
+} // namespace unittest
+} // namespace mcrt_dataio
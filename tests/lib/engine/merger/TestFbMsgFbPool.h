@@ -0,0 +1,32 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+class TestFbMsgFbPool : public CppUnit::TestFixture
+{
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    void testReuse();
+    void testViewportChange();
+    void testShrink();
+    void testUpdateByte();
+
+    CPPUNIT_TEST_SUITE(TestFbMsgFbPool);
+    CPPUNIT_TEST(testReuse);
+    CPPUNIT_TEST(testViewportChange);
+    CPPUNIT_TEST(testShrink);
+    CPPUNIT_TEST(testUpdateByte);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+} // namespace unittest
+} // namespace mcrt_dataio
@@ -0,0 +1,73 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TestHdriTest.h"
+
+#include <mcrt_dataio/engine/merger/HdriTest.h>
+
+#include <random>
+#include <vector>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+void
+TestHdriTest::testRenderOutputPix()
+{
+    CPPUNIT_ASSERT("Float1" && renderOutputPixMain(1));
+    CPPUNIT_ASSERT("Float2" && renderOutputPixMain(2));
+    CPPUNIT_ASSERT("Float3" && renderOutputPixMain(3));
+    CPPUNIT_ASSERT("Float4" && renderOutputPixMain(4));
+}
+
+bool
+TestHdriTest::renderOutputPixMain(const unsigned pixFloatCount) const
+//
+// The tiled AOV buffer has storage for every pixel including the pixels which have no sample. The scan
+// should access each pixel by pixel offset. Pixels without sample have big values here, so the result
+// is wrong if the data pointer only advances at the pixels which have samples.
+//
+{
+    constexpr size_t pixTotal = 64 * 3 + 5; // 3 tiles + remainder for the SIMD loop
+    std::mt19937 mt(0);
+
+    std::vector<float> p(pixTotal * pixFloatCount);
+    std::vector<unsigned> ns(pixTotal);
+    size_t expectTotal = 0;
+    for (size_t pixId = 0; pixId < pixTotal; ++pixId) {
+        ns[pixId] = (mt() % 2) ? mt() % 4 + 1 : 0;
+        const bool hdri = (ns[pixId] > 0) && (mt() % 5 == 0);
+        for (unsigned j = 0; j < pixFloatCount; ++j) {
+            float v = static_cast<float>(ns[pixId]) * 0.5f; // non HDRI value
+            if (ns[pixId] == 0) v = 100.0f;                 // not tested
+            else if (hdri && j == pixFloatCount - 1) v = static_cast<float>(ns[pixId]) * 2.0f;
+            p[pixId * pixFloatCount + j] = v;
+        }
+        if (hdri) expectTotal++;
+    }
+
+    size_t hdriTotal = 0;
+    if (HdriTest::scanRenderOutputPix(p.data(), ns.data(), pixFloatCount, 0, pixTotal, pixTotal, hdriTotal)) {
+        return false; // never exceeds the limit
+    }
+    if (hdriTotal != expectTotal) return false;
+
+    // split scan should count the same
+    hdriTotal = 0;
+    HdriTest::scanRenderOutputPix(p.data(), ns.data(), pixFloatCount, 0, 64, pixTotal, hdriTotal);
+    HdriTest::scanRenderOutputPix(p.data(), ns.data(), pixFloatCount, 64, pixTotal, pixTotal, hdriTotal);
+    if (hdriTotal != expectTotal) return false;
+
+    // early exit
+    if (expectTotal > 0) {
+        hdriTotal = 0;
+        if (!HdriTest::scanRenderOutputPix(p.data(), ns.data(), pixFloatCount, 0, pixTotal, expectTotal - 1,
+                                           hdriTotal)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace unittest
+} // namespace mcrt_dataio
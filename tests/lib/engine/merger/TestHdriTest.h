@@ -0,0 +1,29 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+class TestHdriTest : public CppUnit::TestFixture
+{
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    void testRenderOutputPix();
+
+    CPPUNIT_TEST_SUITE(TestHdriTest);
+    CPPUNIT_TEST(testRenderOutputPix);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    bool renderOutputPixMain(const unsigned pixFloatCount) const;
+};
+
+} // namespace unittest
+} // namespace mcrt_dataio
@@ -0,0 +1,113 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TestMergeFbSenderDoubleBuffer.h"
+
+#include <mcrt_dataio/engine/merger/MergeFbSenderDoubleBuffer.h>
+
+#include <scene_rdl2/common/math/Vec4.h>
+#include <scene_rdl2/common/math/Viewport.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+void
+TestMergeFbSenderDoubleBuffer::testSwapDuringEncode()
+//
+// The merge slot is updated and the slots are swapped while the background encode is still running.
+// The encode should only see its own slot and the next startEncode() should wait for the encode.
+//
+{
+    MergeFbSenderDoubleBuffer doubleBuffer;
+    doubleBuffer.init(scene_rdl2::math::Viewport(0, 0, 63, 47));
+
+    std::atomic<bool> encodeRelease {false};
+    std::atomic<int> encodeTotal {0};
+    std::atomic<MergeFbSender*> lastEncodeSender {nullptr};
+    auto encodeFunc = [&](MergeFbSender& sender) {
+        while (!encodeRelease) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        lastEncodeSender = &sender;
+        encodeTotal++;
+    };
+
+    MergeFbSender* slot0 = &doubleBuffer.getMergeSlot();
+    doubleBuffer.startEncode(encodeFunc);
+
+    // encode of slot0 is in flight (it can not finish until encodeRelease)
+    MergeFbSender* slot1 = &doubleBuffer.getMergeSlot();
+    CPPUNIT_ASSERT("running" && doubleBuffer.isEncodeRunning());
+    CPPUNIT_ASSERT("swap" && slot1 != slot0);
+    slot1->getFb().reset(); // merge into the other slot during the encode
+    CPPUNIT_ASSERT("lastEncodeSec" && doubleBuffer.getLastEncodeSec() >= 0.0f);
+    CPPUNIT_ASSERT("notDone" && encodeTotal == 0);
+
+    // The 2nd startEncode() blocks until the 1st encode is done.
+    std::thread releaseThread([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            encodeRelease = true;
+        });
+    doubleBuffer.startEncode(encodeFunc);
+    CPPUNIT_ASSERT("1stDone" && encodeTotal >= 1);
+    CPPUNIT_ASSERT("wait" && doubleBuffer.getLastWaitSec() > 0.0f);
+    CPPUNIT_ASSERT("swapBack" && &doubleBuffer.getMergeSlot() == slot0);
+
+    doubleBuffer.waitEncode();
+    releaseThread.join();
+    CPPUNIT_ASSERT("2ndDone" && encodeTotal == 2);
+    CPPUNIT_ASSERT("2ndSlot" && lastEncodeSender == slot1);
+    CPPUNIT_ASSERT("idle" && !doubleBuffer.isEncodeRunning());
+    CPPUNIT_ASSERT("encodeSec" && doubleBuffer.getLastEncodeSec() > 0.0f);
+}
+
+void
+TestMergeFbSenderDoubleBuffer::testRevertedPixel()
+//
+// A pixel changes A -> B -> A over 3 merges and the merges alternate between 2 slots. The 3rd send has
+// to include the pixel because the downstream has B. The encode emulates the snapshot by comparing the
+// merged pixel against the snapshot history held by the sender's FbActivePixels. If the history is
+// held per slot, the 3rd merge is compared against the 1st one (A) and the pixel is not sent.
+//
+{
+    MergeFbSenderDoubleBuffer doubleBuffer;
+    doubleBuffer.init(scene_rdl2::math::Viewport(0, 0, 63, 47));
+
+    using Color = scene_rdl2::math::Vec4f;
+    const Color colA(0.25f, 0.5f, 0.75f, 1.0f);
+    const Color colB(1.0f, 0.0f, 0.0f, 1.0f);
+
+    std::map<const void*, Color> snapshotHistory; // last snapshot pixel value of each snapshot history
+    Color downstream(0.0f, 0.0f, 0.0f, 0.0f);      // pixel value at the downstream
+    std::vector<bool> sendTbl;
+    auto encodeFunc = [&](MergeFbSender& sender) {
+        const Color curr = sender.getFb().getRenderBufferTiled().getData()[0];
+        const void* history = &sender.getFbActivePixels();
+        auto itr = snapshotHistory.find(history);
+        const bool changed = (itr == snapshotHistory.end() || itr->second != curr);
+        snapshotHistory[history] = curr;
+        if (changed) downstream = curr; // send
+        sendTbl.push_back(changed);
+    };
+
+    for (const Color& col : {colA, colB, colA}) {
+        MergeFbSender& sender = doubleBuffer.getMergeSlot();
+        sender.getFb().reset();
+        sender.getFb().getRenderBufferTiled().getData()[0] = col; // merge result
+        doubleBuffer.startEncode(encodeFunc);
+        doubleBuffer.waitEncode();
+        CPPUNIT_ASSERT("downstream" && downstream == col);
+    }
+    CPPUNIT_ASSERT("sendTotal" && sendTbl.size() == 3);
+    CPPUNIT_ASSERT("sendA" && sendTbl[0]);
+    CPPUNIT_ASSERT("sendB" && sendTbl[1]);
+    CPPUNIT_ASSERT("resendA" && sendTbl[2]);
+    CPPUNIT_ASSERT("sharedHistory" && snapshotHistory.size() == 1);
+}
+
+} // namespace unittest
+} // namespace mcrt_dataio
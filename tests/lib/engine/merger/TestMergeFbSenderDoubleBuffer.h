@@ -0,0 +1,28 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+class TestMergeFbSenderDoubleBuffer : public CppUnit::TestFixture
+{
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    void testSwapDuringEncode();
+    void testRevertedPixel();
+
+    CPPUNIT_TEST_SUITE(TestMergeFbSenderDoubleBuffer);
+    CPPUNIT_TEST(testSwapDuringEncode);
+    CPPUNIT_TEST(testRevertedPixel);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+} // namespace unittest
+} // namespace mcrt_dataio
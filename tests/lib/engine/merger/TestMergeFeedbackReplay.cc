@@ -0,0 +1,465 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TestMergeFeedbackReplay.h"
+
+#include <mcrt_dataio/engine/merger/MergeActionTracker.h>
+#include <mcrt_dataio/engine/merger/MergeFeedbackReplay.h>
+#include <mcrt_dataio/engine/merger/MergeKernel.h>
+#include <mcrt_dataio/engine/merger/MergeSequenceDequeue.h>
+
+#include <scene_rdl2/common/math/Viewport.h>
+#include <scene_rdl2/render/cache/CacheDequeue.h>
+#include <scene_rdl2/render/cache/CacheEnqueue.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Fb = scene_rdl2::grid_util::Fb;
+using PayloadArray = std::vector<std::unique_ptr<Fb>>;
+
+const scene_rdl2::math::Viewport sViewport(0, 0, 63, 47); // 8 x 6 tiles
+
+void
+randomPayload(std::mt19937& mt, Fb& fb)
+{
+    std::uniform_real_distribution<float> valDist(0.0f, 2.0f);
+
+    fb.init(sViewport);
+    fb.reset();
+
+    const unsigned totalTiles = fb.getTotalTiles();
+    scene_rdl2::math::Vec4f* c = fb.getRenderBufferTiled().getData();
+    unsigned* ns = fb.getNumSampleBufferTiled().getData();
+    for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+        const uint64_t mask = (mt() % 3 == 0) ? 0x0 : (static_cast<uint64_t>(mt()) << 32) | mt();
+        fb.getActivePixels().setTileMask(tileId, mask);
+        for (unsigned pixId = 0; pixId < 64; ++pixId) {
+            const unsigned offset = tileId * 64 + pixId;
+            const bool active = mask & (static_cast<uint64_t>(0x1) << pixId);
+            c[offset] = scene_rdl2::math::Vec4f(valDist(mt), valDist(mt), valDist(mt), valDist(mt));
+            ns[offset] = (active) ? mt() % 8 + 1 : 0;
+        }
+    }
+}
+
+bool
+isSameFb(Fb& a, Fb& b)
+{
+    const unsigned totalTiles = a.getTotalTiles();
+    if (b.getTotalTiles() != totalTiles) return false;
+
+    const scene_rdl2::math::Vec4f* aC = a.getRenderBufferTiled().getData();
+    const scene_rdl2::math::Vec4f* bC = b.getRenderBufferTiled().getData();
+    const unsigned* aNs = a.getNumSampleBufferTiled().getData();
+    const unsigned* bNs = b.getNumSampleBufferTiled().getData();
+    for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+        if (a.getActivePixels().getTileMask(tileId) != b.getActivePixels().getTileMask(tileId)) return false;
+        for (unsigned pixId = 0; pixId < 64; ++pixId) {
+            const unsigned offset = tileId * 64 + pixId;
+            if (aNs[offset] != bNs[offset]) return false;
+            if (!aNs[offset]) continue;
+            if (aC[offset].x != bC[offset].x || aC[offset].y != bC[offset].y ||
+                aC[offset].z != bC[offset].z || aC[offset].w != bC[offset].w) return false;
+        }
+    }
+    return true;
+}
+
+std::string
+sendToMcrt(mcrt_dataio::MergeActionTracker& tracker)
+//
+// Encode on the merge computation and decode on the MCRT computation. Return decoded sequence data.
+//
+{
+    std::string data;
+    scene_rdl2::cache::CacheEnqueue enqueue(&data);
+    tracker.encodeData(enqueue);
+    enqueue.finalize();
+
+    scene_rdl2::cache::CacheDequeue dequeue(data.data(), data.size());
+    mcrt_dataio::MergeActionTracker mcrtTracker;
+    mcrtTracker.decodeDataOnMCRTComputation(dequeue);
+    return mcrtTracker.getData();
+}
+
+bool
+referenceReplay(const std::string& sequence, PayloadArray& payloads, Fb& decodedFb, Fb& mergedFb)
+//
+// Independent reference of MergeFeedbackReplay. Each action of the decoded sequence is executed in order
+// by the same operations as the merge computation : the progressiveFrame decode overwrites the active
+// pixels and the merge clears the tile and accumulates the decoded tile by MergeKernel.
+//
+{
+    const unsigned totalTiles = decodedFb.getTotalTiles();
+
+    auto decode = [&](const unsigned sendImageActionId) -> bool {
+        if (sendImageActionId >= payloads.size()) return false;
+        Fb& payload = *payloads[sendImageActionId];
+        const scene_rdl2::math::Vec4f* srcC = payload.getRenderBufferTiled().getData();
+        const unsigned* srcNs = payload.getNumSampleBufferTiled().getData();
+        scene_rdl2::math::Vec4f* dstC = decodedFb.getRenderBufferTiled().getData();
+        unsigned* dstNs = decodedFb.getNumSampleBufferTiled().getData();
+        for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+            const uint64_t mask = payload.getActivePixels().getTileMask(tileId);
+            for (unsigned pixId = 0; pixId < 64; ++pixId) {
+                if (!(mask & (static_cast<uint64_t>(0x1) << pixId))) continue;
+                const unsigned offset = tileId * 64 + pixId;
+                dstC[offset] = srcC[offset];
+                dstNs[offset] = srcNs[offset];
+            }
+            decodedFb.getActivePixels().setTileMask(tileId, decodedFb.getActivePixels().getTileMask(tileId) | mask);
+        }
+        return true;
+    };
+    auto merge = [&](const unsigned tileId) -> bool {
+        if (tileId >= totalTiles) return false;
+        scene_rdl2::math::Vec4f* c = mergedFb.getRenderBufferTiled().getData() + tileId * 64;
+        unsigned* ns = mergedFb.getNumSampleBufferTiled().getData() + tileId * 64;
+        std::fill(c, c + 64, scene_rdl2::math::Vec4f(0.0f, 0.0f, 0.0f, 0.0f));
+        std::fill(ns, ns + 64, 0);
+        mergedFb.getActivePixels().setTileMask(tileId, 0x0);
+        mcrt_dataio::MergeKernel::accumulateRenderBufferTiles(nullptr, tileId, tileId + 1, decodedFb, mergedFb);
+        return true;
+    };
+
+    std::string error;
+    mcrt_dataio::MergeSequenceDequeue deq(sequence.data(), sequence.size());
+    return deq.decodeLoop(error,
+                          [&](unsigned id) -> bool { return decode(id); },
+                          [&](unsigned start, unsigned end) -> bool {
+                              for (unsigned id = start; id <= end; ++id) if (!decode(id)) return false;
+                              return true;
+                          },
+                          [&](unsigned tileId) -> bool { return merge(tileId); },
+                          [&](unsigned start, unsigned end) -> bool {
+                              for (unsigned tileId = start; tileId <= end; ++tileId) if (!merge(tileId)) return false;
+                              return true;
+                          },
+                          [&]() -> bool {
+                              for (unsigned tileId = 0; tileId < totalTiles; ++tileId) merge(tileId);
+                              return true;
+                          },
+                          [&]() -> bool { return true; });
+}
+
+bool
+runReplay(const bool serial, const std::string& sequence, PayloadArray& payloads, Fb& decodedFb, Fb& mergedFb)
+{
+    auto payloadFunc = [&](const unsigned sendImageActionId) -> const Fb* {
+        return (sendImageActionId < payloads.size()) ? payloads[sendImageActionId].get() : nullptr;
+    };
+
+    mcrt_dataio::MergeFeedbackReplay replay;
+    replay.setSerial(serial);
+    std::string error;
+    if (!replay.setSequence(sequence, error)) return false;
+    return replay.replay(payloadFunc, decodedFb, mergedFb, error);
+}
+
+void
+initFb(const scene_rdl2::math::Viewport& viewport, Fb& fb)
+{
+    fb.init(viewport);
+    fb.reset();
+}
+
+void
+combineMerged(Fb& mcrtMergedFb, Fb& mergedAllFb)
+//
+// Same as Fb::merge() of verifyMcrtFeedback (Mcrt::combineMergedAll()) : numSample weighted average of
+// the RGB beauty.
+//
+{
+    const unsigned pixTotal = mergedAllFb.getTotalTiles() * 64;
+    const scene_rdl2::math::Vec4f* currC = mcrtMergedFb.getRenderBufferTiled().getData();
+    const unsigned* currNs = mcrtMergedFb.getNumSampleBufferTiled().getData();
+    scene_rdl2::math::Vec4f* allC = mergedAllFb.getRenderBufferTiled().getData();
+    unsigned* allNs = mergedAllFb.getNumSampleBufferTiled().getData();
+    for (unsigned offset = 0; offset < pixTotal; ++offset) {
+        const float totalN = static_cast<float>(allNs[offset] + currNs[offset]);
+        if (totalN > 0.0f) {
+            const float scaleA = static_cast<float>(allNs[offset]) / totalN;
+            const float scaleB = static_cast<float>(currNs[offset]) / totalN;
+            allC[offset] = allC[offset] * scaleA + currC[offset] * scaleB;
+        } else {
+            allC[offset] = scene_rdl2::math::Vec4f(0.0f, 0.0f, 0.0f, 0.0f);
+        }
+        allNs[offset] += currNs[offset];
+    }
+}
+
+bool
+isSameBeauty(Fb& a, Fb& b)
+//
+// Same tolerance as Fb::isSame() of verifyMcrtFeedback. Only RGB and numSample are compared.
+//
+{
+    constexpr float maxThresh = 0.05f / 255.0f;
+
+    const unsigned pixTotal = a.getTotalTiles() * 64;
+    if (b.getTotalTiles() * 64 != pixTotal) return false;
+    const scene_rdl2::math::Vec4f* aC = a.getRenderBufferTiled().getData();
+    const scene_rdl2::math::Vec4f* bC = b.getRenderBufferTiled().getData();
+    const unsigned* aNs = a.getNumSampleBufferTiled().getData();
+    const unsigned* bNs = b.getNumSampleBufferTiled().getData();
+    for (unsigned offset = 0; offset < pixTotal; ++offset) {
+        if (aNs[offset] != bNs[offset]) return false;
+        if (!aNs[offset]) continue;
+        if (std::fabs(aC[offset].x - bC[offset].x) > maxThresh ||
+            std::fabs(aC[offset].y - bC[offset].y) > maxThresh ||
+            std::fabs(aC[offset].z - bC[offset].z) > maxThresh) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+namespace mcrt_dataio {
+namespace unittest {
+
+void
+TestMergeFeedbackReplay::testReplay()
+//
+// Compare the serial and parallel replay with the independent reference replay of the sequence which
+// is encoded by MergeActionTracker and decoded on the MCRT computation side.
+//
+{
+    std::mt19937 mt(0);
+
+    constexpr unsigned payloadTotal = 10;
+    PayloadArray payloads;
+    for (unsigned id = 0; id < payloadTotal; ++id) {
+        payloads.emplace_back(new Fb);
+        randomPayload(mt, *payloads.back());
+    }
+    const unsigned totalTiles = payloads[0]->getTotalTiles();
+
+    auto randomTilesTbl = [&]() {
+        std::vector<char> tbl(totalTiles);
+        for (auto& v : tbl) v = static_cast<char>(mt() % 2);
+        return tbl;
+    };
+
+    // decode range, partial merge, decode single, 2 partial merges, full merge and so on
+    MergeActionTracker tracker;
+    tracker.decodeAll({0, 1, 2, 3});
+    tracker.mergePartial(randomTilesTbl());
+    tracker.decodeAll({4});
+    tracker.mergePartial(randomTilesTbl());
+    tracker.mergePartial(randomTilesTbl());
+    tracker.decodeAll({5, 7});
+    tracker.mergeFull();
+    tracker.decodeAll({8, 9});
+    tracker.mergePartial(randomTilesTbl());
+    const std::string sequence = sendToMcrt(tracker);
+
+    Fb refDecodedFb, refMergedFb;
+    initFb(sViewport, refDecodedFb);
+    initFb(sViewport, refMergedFb);
+    CPPUNIT_ASSERT("reference" && referenceReplay(sequence, payloads, refDecodedFb, refMergedFb));
+
+    for (const bool serial : {true, false}) {
+        Fb decodedFb, mergedFb;
+        initFb(sViewport, decodedFb);
+        initFb(sViewport, mergedFb);
+        CPPUNIT_ASSERT("replay" && runReplay(serial, sequence, payloads, decodedFb, mergedFb));
+        CPPUNIT_ASSERT("decoded" && isSameFb(refDecodedFb, decodedFb));
+        CPPUNIT_ASSERT("merged" && isSameFb(refMergedFb, mergedFb));
+    }
+}
+
+void
+TestMergeFeedbackReplay::testLatestWins()
+//
+// Hand-computed single tile case. The latest decoded payload wins for each pixel and the merged image
+// only changes by the merge action.
+//
+{
+    const scene_rdl2::math::Viewport viewport(0, 0, 7, 7); // 1 tile
+
+    auto setPix = [](Fb& fb, const unsigned pixId, const float v, const unsigned numSample) {
+        fb.getRenderBufferTiled().getData()[pixId] = scene_rdl2::math::Vec4f(v, v, v, 1.0f);
+        fb.getNumSampleBufferTiled().getData()[pixId] = numSample;
+        const uint64_t mask = fb.getActivePixels().getTileMask(0) | (static_cast<uint64_t>(0x1) << pixId);
+        fb.getActivePixels().setTileMask(0, mask);
+    };
+    auto checkPix = [](Fb& fb, const unsigned pixId, const float v, const unsigned numSample) {
+        return (fb.getRenderBufferTiled().getData()[pixId].x == v &&
+                fb.getNumSampleBufferTiled().getData()[pixId] == numSample);
+    };
+
+    PayloadArray payloads;
+    for (unsigned id = 0; id < 3; ++id) {
+        payloads.emplace_back(new Fb);
+        initFb(viewport, *payloads.back());
+    }
+    setPix(*payloads[0], 0, 1.0f, 1);
+    setPix(*payloads[0], 1, 1.0f, 1);
+    setPix(*payloads[1], 0, 2.0f, 3);
+    setPix(*payloads[2], 1, 5.0f, 2);
+
+    MergeActionTracker tracker;
+    tracker.decodeAll({0, 1});
+    tracker.mergeFull();
+    tracker.decodeAll({2});
+    const std::string sequence = sendToMcrt(tracker);
+
+    for (const bool serial : {true, false}) {
+        Fb decodedFb, mergedFb;
+        initFb(viewport, decodedFb);
+        initFb(viewport, mergedFb);
+        CPPUNIT_ASSERT("replay" && runReplay(serial, sequence, payloads, decodedFb, mergedFb));
+
+        CPPUNIT_ASSERT("decoded mask" && decodedFb.getActivePixels().getTileMask(0) == 0x3);
+        CPPUNIT_ASSERT("decoded pix0" && checkPix(decodedFb, 0, 2.0f, 3));
+        CPPUNIT_ASSERT("decoded pix1" && checkPix(decodedFb, 1, 5.0f, 2));
+
+        CPPUNIT_ASSERT("merged mask" && mergedFb.getActivePixels().getTileMask(0) == 0x3);
+        CPPUNIT_ASSERT("merged pix0" && checkPix(mergedFb, 0, 2.0f, 3));
+        CPPUNIT_ASSERT("merged pix1" && checkPix(mergedFb, 1, 1.0f, 1)); // payload 2 is not merged yet
+        CPPUNIT_ASSERT("merged pix2" && checkPix(mergedFb, 2, 0.0f, 0));
+    }
+}
+
+void
+TestMergeFeedbackReplay::testVerifyFeedback()
+//
+// Same check as verifyMcrtFeedback with multiple machines. The merge computation decodes the payloads of
+// each machine and merges all machines by MergeKernel. This merged image is sent back to all machines as
+// the feedback. Each machine replays its own merged image by MergeFeedbackReplay. Then the combined image
+// of all machines' merged images (verifyMcrtFeedback : verifyReconstructMergeWithFeedback) has to be the
+// same as the feedback and each machine's decoded image has to be the same as the decoded image of this
+// machine on the merge computation (verifyMcrtFeedback : verifyMergeWithMcrtDecoded).
+//
+{
+    std::mt19937 mt(1);
+
+    constexpr unsigned machineTotal = 3;
+    constexpr unsigned payloadTotal = 8;
+    std::vector<PayloadArray> payloads(machineTotal);
+    for (auto& machinePayloads : payloads) {
+        for (unsigned id = 0; id < payloadTotal; ++id) {
+            machinePayloads.emplace_back(new Fb);
+            randomPayload(mt, *machinePayloads.back());
+        }
+    }
+    const unsigned totalTiles = payloads[0][0]->getTotalTiles();
+
+    // merge computation
+    std::vector<Fb> decodedFb(machineTotal);
+    for (auto& fb : decodedFb) initFb(sViewport, fb);
+    Fb feedbackFb;
+    initFb(sViewport, feedbackFb);
+    std::vector<MergeActionTracker> tracker(machineTotal);
+
+    auto decode = [&](const unsigned machineId, const std::vector<unsigned>& idTbl) {
+        for (const unsigned id : idTbl) {
+            Fb& payload = *payloads[machineId][id];
+            const scene_rdl2::math::Vec4f* srcC = payload.getRenderBufferTiled().getData();
+            const unsigned* srcNs = payload.getNumSampleBufferTiled().getData();
+            scene_rdl2::math::Vec4f* dstC = decodedFb[machineId].getRenderBufferTiled().getData();
+            unsigned* dstNs = decodedFb[machineId].getNumSampleBufferTiled().getData();
+            auto& dstActivePixels = decodedFb[machineId].getActivePixels();
+            for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+                const uint64_t mask = payload.getActivePixels().getTileMask(tileId);
+                for (unsigned pixId = 0; pixId < 64; ++pixId) {
+                    if (!(mask & (static_cast<uint64_t>(0x1) << pixId))) continue;
+                    dstC[tileId * 64 + pixId] = srcC[tileId * 64 + pixId];
+                    dstNs[tileId * 64 + pixId] = srcNs[tileId * 64 + pixId];
+                }
+                dstActivePixels.setTileMask(tileId, dstActivePixels.getTileMask(tileId) | mask);
+            }
+        }
+        tracker[machineId].decodeAll(idTbl);
+    };
+    auto merge = [&](const std::vector<char>* tilesTbl) {
+        for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+            if (tilesTbl && !(*tilesTbl)[tileId]) continue;
+            scene_rdl2::math::Vec4f* c = feedbackFb.getRenderBufferTiled().getData() + tileId * 64;
+            unsigned* ns = feedbackFb.getNumSampleBufferTiled().getData() + tileId * 64;
+            std::fill(c, c + 64, scene_rdl2::math::Vec4f(0.0f, 0.0f, 0.0f, 0.0f));
+            std::fill(ns, ns + 64, 0);
+            feedbackFb.getActivePixels().setTileMask(tileId, 0x0);
+        }
+        for (unsigned machineId = 0; machineId < machineTotal; ++machineId) {
+            MergeKernel::accumulateRenderBufferTiles(tilesTbl, 0, totalTiles, decodedFb[machineId], feedbackFb);
+            if (tilesTbl) tracker[machineId].mergePartial(*tilesTbl);
+            else tracker[machineId].mergeFull();
+        }
+    };
+    auto randomTilesTbl = [&]() {
+        std::vector<char> tbl(totalTiles);
+        for (auto& v : tbl) v = static_cast<char>(mt() % 2);
+        return tbl;
+    };
+
+    decode(0, {0, 1, 2});
+    decode(1, {0});
+    decode(2, {0, 1});
+    merge(nullptr);
+    decode(0, {3});
+    decode(1, {1, 2, 3});
+    const std::vector<char> tilesTblA = randomTilesTbl();
+    merge(&tilesTblA);
+    decode(1, {4, 5});
+    decode(2, {2, 3, 4, 5, 6});
+    const std::vector<char> tilesTblB = randomTilesTbl();
+    merge(&tilesTblB);
+    decode(0, {4, 5, 6, 7});
+    merge(nullptr);
+
+    // MCRT computations
+    std::vector<std::string> sequence(machineTotal);
+    for (unsigned machineId = 0; machineId < machineTotal; ++machineId) {
+        sequence[machineId] = sendToMcrt(tracker[machineId]);
+    }
+    for (const bool serial : {true, false}) {
+        Fb combinedFb;
+        initFb(sViewport, combinedFb);
+        for (unsigned machineId = 0; machineId < machineTotal; ++machineId) {
+            Fb mcrtDecodedFb, mcrtMergedFb;
+            initFb(sViewport, mcrtDecodedFb);
+            initFb(sViewport, mcrtMergedFb);
+            CPPUNIT_ASSERT("replay" &&
+                           runReplay(serial, sequence[machineId], payloads[machineId], mcrtDecodedFb, mcrtMergedFb));
+            CPPUNIT_ASSERT("decoded" && isSameBeauty(decodedFb[machineId], mcrtDecodedFb));
+            combineMerged(mcrtMergedFb, combinedFb);
+        }
+        CPPUNIT_ASSERT("feedback" && isSameBeauty(feedbackFb, combinedFb));
+    }
+}
+
+void
+TestMergeFeedbackReplay::testMissingPayload()
+{
+    Fb payload;
+    std::mt19937 mt(0);
+    randomPayload(mt, payload);
+
+    MergeActionTracker tracker;
+    tracker.decodeAll({0, 1});
+    tracker.mergeFull();
+
+    MergeFeedbackReplay replay;
+    std::string error;
+    CPPUNIT_ASSERT("setSequence" && replay.setSequence(sendToMcrt(tracker), error));
+
+    Fb decodedFb, mergedFb;
+    initFb(sViewport, decodedFb);
+    initFb(sViewport, mergedFb);
+    auto payloadFunc = [&](const unsigned sendImageActionId) -> const Fb* {
+        return (sendImageActionId == 0) ? &payload : nullptr;
+    };
+    CPPUNIT_ASSERT("missing" && !replay.replay(payloadFunc, decodedFb, mergedFb, error));
+    CPPUNIT_ASSERT("error" && !error.empty());
+}
+
+} // namespace unittest
+} // namespace mcrt_dataio
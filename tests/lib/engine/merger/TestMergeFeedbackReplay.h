@@ -0,0 +1,32 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+class TestMergeFeedbackReplay : public CppUnit::TestFixture
+{
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    void testReplay();
+    void testLatestWins();
+    void testVerifyFeedback();
+    void testMissingPayload();
+
+    CPPUNIT_TEST_SUITE(TestMergeFeedbackReplay);
+    CPPUNIT_TEST(testReplay);
+    CPPUNIT_TEST(testLatestWins);
+    CPPUNIT_TEST(testVerifyFeedback);
+    CPPUNIT_TEST(testMissingPayload);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+} // namespace unittest
+} // namespace mcrt_dataio
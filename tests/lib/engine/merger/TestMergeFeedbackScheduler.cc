@@ -0,0 +1,64 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TestMergeFeedbackScheduler.h"
+
+#include <mcrt_dataio/engine/merger/MergeFeedbackScheduler.h>
+
+#include <cmath>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+void
+TestMergeFeedbackScheduler::testConvergence()
+{
+    // default : interval 0.1 ~ 5.0 sec, converged at progress 0.9
+    MergeFeedbackScheduler scheduler;
+    MergeFeedbackScheduler::Measurement measurement;
+
+    measurement.mProgress = 0.0f;
+    CPPUNIT_ASSERT("noisy" && std::fabs(scheduler.updateMachine(0, measurement, 0.0f) - 0.1f) < 1.0e-5f);
+
+    // interval grows toward the max interval by the progress
+    measurement.mProgress = 0.9f;
+    CPPUNIT_ASSERT("converged" && std::fabs(scheduler.updateMachine(0, measurement, 0.0f) - 5.0f) < 1.0e-4f);
+
+    // new frame : progress goes back and the interval is reset immediately
+    measurement.mProgress = 0.0f;
+    CPPUNIT_ASSERT("newFrame" && std::fabs(scheduler.updateMachine(0, measurement, 0.0f) - 0.1f) < 1.0e-5f);
+
+    // the shortest interval of all machines
+    measurement.mProgress = 0.9f;
+    scheduler.updateMachine(1, measurement, 0.0f);
+    CPPUNIT_ASSERT("shortest" && std::fabs(scheduler.getShortestInterval() - 0.1f) < 1.0e-5f);
+}
+
+void
+TestMergeFeedbackScheduler::testBackoff()
+{
+    MergeFeedbackScheduler scheduler;
+    MergeFeedbackScheduler::Measurement measurement;
+
+    // 50ms MCRT evaluation cost with 5% budget requires 1.0 sec interval
+    measurement.mEvalFeedbackMs = 50.0f;
+    CPPUNIT_ASSERT("mcrtCost" && std::fabs(scheduler.updateMachine(0, measurement, 0.0f) - 1.0f) < 1.0e-5f);
+
+    // interval is shortened by smoothing after the cost goes down
+    measurement.mEvalFeedbackMs = 0.0f;
+    const float interval = scheduler.updateMachine(0, measurement, 0.0f);
+    CPPUNIT_ASSERT("smoothing" && interval < 1.0f && interval > 0.1f);
+
+    // feedback latency
+    measurement.mFeedbackLatencyMs = 2000.0f;
+    CPPUNIT_ASSERT("latency" && std::fabs(scheduler.updateMachine(0, measurement, 0.0f) - 2.0f) < 1.0e-5f);
+
+    // send timing
+    CPPUNIT_ASSERT("first send" && scheduler.isFeedbackDue(0, 0.0));
+    scheduler.feedbackSent(0, 10.0);
+    CPPUNIT_ASSERT("not due" && !scheduler.isFeedbackDue(0, 11.0));
+    CPPUNIT_ASSERT("due" && scheduler.isFeedbackDue(0, 12.0));
+}
+
+} // namespace unittest
+} // namespace mcrt_dataio
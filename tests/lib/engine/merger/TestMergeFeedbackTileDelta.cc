@@ -0,0 +1,77 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TestMergeFeedbackTileDelta.h"
+
+#include <mcrt_dataio/engine/merger/MergeFeedbackTileDelta.h>
+
+#include <vector>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+void
+TestMergeFeedbackTileDelta::testDelta()
+{
+    MergeFeedbackTileDelta tileDelta;
+    tileDelta.reset(2, 8);
+
+    // very first feedback is always a full feedback
+    tileDelta.updateMergedTiles(8, nullptr);
+    CPPUNIT_ASSERT("first" && tileDelta.calcDeltaTiles(0) == nullptr);
+    tileDelta.markSent(0);
+
+    // machine 1 has not received any feedback yet
+    const std::vector<char> mergedA = {1, 1, 0, 0, 0, 0, 0, 0};
+    tileDelta.updateMergedTiles(8, &mergedA);
+    CPPUNIT_ASSERT("not sent" && tileDelta.calcDeltaTiles(1) == nullptr);
+    tileDelta.markSent(1);
+
+    // machine 0 gets the union of the merged tiles since its last feedback
+    const std::vector<char> mergedB = {0, 0, 0, 0, 0, 0, 1, 0};
+    tileDelta.updateMergedTiles(8, &mergedB);
+    const std::vector<char>* delta0 = tileDelta.calcDeltaTiles(0);
+    CPPUNIT_ASSERT("delta0" && delta0 && *delta0 == std::vector<char>({1, 1, 0, 0, 0, 0, 1, 0}));
+    CPPUNIT_ASSERT("delta0 total" && tileDelta.getDeltaTilesTotal() == 3);
+    CPPUNIT_ASSERT("not same" && !tileDelta.isSameDelta(0, 1));
+    tileDelta.markSent(0);
+
+    const std::vector<char>* delta1 = tileDelta.calcDeltaTiles(1);
+    CPPUNIT_ASSERT("delta1" && delta1 && *delta1 == mergedB);
+    tileDelta.markSent(1);
+    CPPUNIT_ASSERT("same" && tileDelta.isSameDelta(0, 1));
+
+    // no merge since the last feedback
+    const std::vector<char>* delta2 = tileDelta.calcDeltaTiles(0);
+    CPPUNIT_ASSERT("empty" && delta2 && tileDelta.getDeltaTilesTotal() == 0);
+    tileDelta.markSent(0);
+
+    // sent tiles : 8 + 8 + 3 + 1 + 0 = 20 of 40
+    CPPUNIT_ASSERT("ratio" && tileDelta.getSentTilesRatio() == 0.5f);
+}
+
+void
+TestMergeFeedbackTileDelta::testInvalidate()
+{
+    MergeFeedbackTileDelta tileDelta;
+    tileDelta.reset(1, 4);
+    tileDelta.updateMergedTiles(4, nullptr);
+    tileDelta.calcDeltaTiles(0);
+    tileDelta.markSent(0);
+
+    const std::vector<char> merged = {0, 1, 0, 0};
+    tileDelta.updateMergedTiles(4, &merged);
+    CPPUNIT_ASSERT("delta" && tileDelta.calcDeltaTiles(0) != nullptr);
+
+    tileDelta.invalidate(0);
+    CPPUNIT_ASSERT("invalidate" && tileDelta.calcDeltaTiles(0) == nullptr);
+    tileDelta.markSent(0);
+    CPPUNIT_ASSERT("recover" && tileDelta.calcDeltaTiles(0) != nullptr);
+
+    // resolution change requires a full feedback
+    tileDelta.updateMergedTiles(6, nullptr);
+    CPPUNIT_ASSERT("resolution" && tileDelta.calcDeltaTiles(0) == nullptr);
+}
+
+} // namespace unittest
+} // namespace mcrt_dataio
@@ -0,0 +1,28 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+class TestMergeFeedbackTileDelta : public CppUnit::TestFixture
+{
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    void testDelta();
+    void testInvalidate();
+
+    CPPUNIT_TEST_SUITE(TestMergeFeedbackTileDelta);
+    CPPUNIT_TEST(testDelta);
+    CPPUNIT_TEST(testInvalidate);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+} // namespace unittest
+} // namespace mcrt_dataio
@@ -0,0 +1,183 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TestMergeKernel.h"
+
+#include <mcrt_dataio/engine/merger/MergeKernel.h>
+
+#include <scene_rdl2/common/math/Viewport.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+bool
+isSameValue(const float a, const float b)
+{
+    // SIMD version might use a different operation order (e.g. FMA) from the scalar version
+    return std::fabs(a - b) <= 1.0e-5f * std::max(1.0f, std::fabs(b));
+}
+
+} // namespace
+
+namespace mcrt_dataio {
+namespace unittest {
+
+void
+TestMergeKernel::testAccumulateTile()
+{
+    CPPUNIT_ASSERT("Float1" && accumulateTileMain(1));
+    CPPUNIT_ASSERT("Float2" && accumulateTileMain(2));
+    CPPUNIT_ASSERT("Float3" && accumulateTileMain(3));
+    CPPUNIT_ASSERT("Float4/Rgba" && accumulateTileMain(4));
+}
+
+void
+TestMergeKernel::testOrTileMasks()
+//
+// Compare all supported versions of MergeKernel::orTileMasks() with the existing ActivePixels::orOp()
+//
+{
+    const scene_rdl2::math::Viewport viewport(0, 0, 295, 39); // 37 x 5 tiles : not a multiple of SIMD width
+    std::mt19937 mt(0);
+
+    scene_rdl2::grid_util::Fb src;
+    scene_rdl2::grid_util::Fb dst;
+    src.init(viewport);
+    dst.init(viewport);
+    src.reset();
+    dst.reset();
+
+    const unsigned totalTiles = src.getTotalTiles();
+    std::vector<uint64_t> srcMask(totalTiles);
+    std::vector<uint64_t> dstMask(totalTiles);
+    for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+        srcMask[tileId] = (static_cast<uint64_t>(mt()) << 32) | mt();
+        dstMask[tileId] = (tileId % 3) ? ((static_cast<uint64_t>(mt()) << 32) | mt()) : 0x0; // includes empty tile
+        src.getActivePixels().setTileMask(tileId, srcMask[tileId]);
+        dst.getActivePixels().setTileMask(tileId, dstMask[tileId]);
+    }
+    (void)dst.getActivePixels().orOp(src.getActivePixels()); // existing path
+
+    for (int isaId = 0; isaId <= static_cast<int>(MergeKernel::Isa::AVX512); ++isaId) {
+        const MergeKernel::Isa isa = static_cast<MergeKernel::Isa>(isaId);
+        if (!MergeKernel::isSupported(isa)) continue;
+
+        std::vector<uint64_t> result = dstMask;
+        MergeKernel::orTileMasks(isa, srcMask.data(), result.data(), totalTiles);
+        for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+            CPPUNIT_ASSERT("orTileMasks" && result[tileId] == dst.getActivePixels().getTileMask(tileId));
+        }
+    }
+}
+
+void
+TestMergeKernel::testAccumulateRenderBuffer()
+//
+// Compare MergeKernel::accumulateRenderBuffer() with the existing Fb::accumulateRenderBuffer()
+//
+{
+    const scene_rdl2::math::Viewport viewport(0, 0, 63, 47); // 8 x 6 tiles
+    std::mt19937 mt(0);
+    std::uniform_real_distribution<float> valDist(0.0f, 2.0f);
+
+    constexpr int srcTotal = 3;
+    scene_rdl2::grid_util::Fb src[srcTotal];
+    for (int srcId = 0; srcId < srcTotal; ++srcId) {
+        src[srcId].init(viewport);
+        src[srcId].reset();
+
+        const unsigned totalTiles = src[srcId].getTotalTiles();
+        scene_rdl2::math::Vec4f* c = src[srcId].getRenderBufferTiled().getData();
+        unsigned* ns = src[srcId].getNumSampleBufferTiled().getData();
+        for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+            const uint64_t mask = (static_cast<uint64_t>(mt()) << 32) | mt();
+            src[srcId].getActivePixels().setTileMask(tileId, mask);
+            for (unsigned pixId = 0; pixId < 64; ++pixId) {
+                const unsigned offset = tileId * 64 + pixId;
+                const bool active = mask & (static_cast<uint64_t>(0x1) << pixId);
+                c[offset] = scene_rdl2::math::Vec4f(valDist(mt), valDist(mt), valDist(mt), valDist(mt));
+                ns[offset] = (active) ? mt() % 8 : 0;
+            }
+        }
+    }
+
+    scene_rdl2::grid_util::Fb target; // existing Fb path
+    scene_rdl2::grid_util::Fb result; // MergeKernel path
+    target.init(viewport);
+    result.init(viewport);
+    target.reset();
+    result.reset();
+    for (int srcId = 0; srcId < srcTotal; ++srcId) {
+        target.accumulateRenderBuffer(nullptr, src[srcId]);
+        MergeKernel::accumulateRenderBuffer(nullptr, src[srcId], result);
+    }
+
+    const unsigned totalTiles = target.getTotalTiles();
+    const scene_rdl2::math::Vec4f* targetC = target.getRenderBufferTiled().getData();
+    const scene_rdl2::math::Vec4f* resultC = result.getRenderBufferTiled().getData();
+    const unsigned* targetNs = target.getNumSampleBufferTiled().getData();
+    const unsigned* resultNs = result.getNumSampleBufferTiled().getData();
+    for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+        CPPUNIT_ASSERT("activePixels" &&
+                       target.getActivePixels().getTileMask(tileId) == result.getActivePixels().getTileMask(tileId));
+        for (unsigned pixId = 0; pixId < 64; ++pixId) {
+            const unsigned offset = tileId * 64 + pixId;
+            CPPUNIT_ASSERT("numSample" && targetNs[offset] == resultNs[offset]);
+            if (!targetNs[offset]) continue;
+            CPPUNIT_ASSERT("beauty" &&
+                           isSameValue(resultC[offset].x, targetC[offset].x) &&
+                           isSameValue(resultC[offset].y, targetC[offset].y) &&
+                           isSameValue(resultC[offset].z, targetC[offset].z) &&
+                           isSameValue(resultC[offset].w, targetC[offset].w));
+        }
+    }
+}
+
+bool
+TestMergeKernel::accumulateTileMain(const unsigned numChan) const
+//
+// Compare all supported SIMD versions with the scalar reference version
+//
+{
+    std::mt19937 mt(numChan);
+    std::uniform_real_distribution<float> valDist(0.0f, 10.0f);
+
+    for (int testId = 0; testId < 100; ++testId) {
+        std::vector<float> src(64 * numChan);
+        std::vector<float> dst(64 * numChan);
+        std::vector<unsigned> srcNumSample(64);
+        std::vector<unsigned> dstNumSample(64);
+        for (auto& v : src) v = valDist(mt);
+        for (auto& v : dst) v = valDist(mt);
+        for (auto& v : srcNumSample) v = mt() % 4; // includes 0 sample pixels
+        for (auto& v : dstNumSample) v = mt() % 4;
+        const uint64_t pixMask = (static_cast<uint64_t>(mt()) << 32) | mt();
+
+        std::vector<float> target = dst;
+        std::vector<unsigned> targetNumSample = dstNumSample;
+        MergeKernel::accumulateTile(MergeKernel::Isa::SCALAR, numChan, pixMask,
+                                    src.data(), srcNumSample.data(), target.data(), targetNumSample.data());
+
+        for (int isaId = 1; isaId <= static_cast<int>(MergeKernel::Isa::AVX512); ++isaId) {
+            const MergeKernel::Isa isa = static_cast<MergeKernel::Isa>(isaId);
+            if (!MergeKernel::isSupported(isa)) continue;
+
+            std::vector<float> result = dst;
+            std::vector<unsigned> resultNumSample = dstNumSample;
+            MergeKernel::accumulateTile(isa, numChan, pixMask,
+                                        src.data(), srcNumSample.data(), result.data(), resultNumSample.data());
+            if (resultNumSample != targetNumSample) return false;
+            for (size_t i = 0; i < result.size(); ++i) {
+                if (!isSameValue(result[i], target[i])) return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace unittest
+} // namespace mcrt_dataio
@@ -0,0 +1,33 @@
+// Copyright 2023-2024 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+class TestMergeKernel : public CppUnit::TestFixture
+{
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    void testAccumulateTile();
+    void testOrTileMasks();
+    void testAccumulateRenderBuffer();
+
+    CPPUNIT_TEST_SUITE(TestMergeKernel);
+    CPPUNIT_TEST(testAccumulateTile);
+    CPPUNIT_TEST(testOrTileMasks);
+    CPPUNIT_TEST(testAccumulateRenderBuffer);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    bool accumulateTileMain(const unsigned numChan) const;
+};
+
+} // namespace unittest
+} // namespace mcrt_dataio
@@ -0,0 +1,60 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TestMergeMemAccountant.h"
+
+#include <mcrt_dataio/engine/merger/MergeMemAccountant.h>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+void
+TestMergeMemAccountant::testTotal()
+{
+    using Category = MergeMemAccountant::Category;
+
+    MergeMemAccountant accountant;
+    CPPUNIT_ASSERT(accountant.getTotalByte() == 0);
+
+    accountant.setByte(Category::FB, 1000);
+    accountant.setByte(Category::QUEUED_PAYLOAD, 200);
+    accountant.setByte(Category::SEND_BUFFER, 30);
+    accountant.setByte(Category::ACTION_TRACKER, 4);
+    CPPUNIT_ASSERT(accountant.getByte(Category::QUEUED_PAYLOAD) == 200);
+    CPPUNIT_ASSERT(accountant.getTotalByte() == 1234);
+
+    // each category keeps the latest value and high water mark keeps the max total
+    accountant.setByte(Category::FB, 0);
+    CPPUNIT_ASSERT(accountant.getTotalByte() == 234);
+    CPPUNIT_ASSERT(accountant.getHighWaterByte() == 1234);
+}
+
+void
+TestMergeMemAccountant::testBudget()
+{
+    using Category = MergeMemAccountant::Category;
+    using Action = MergeMemAccountant::Action;
+
+    MergeMemAccountant accountant;
+    accountant.setByte(Category::FB, 1000);
+    CPPUNIT_ASSERT("unlimited" && !accountant.isOverBudget());
+    CPPUNIT_ASSERT(accountant.getOverBudgetByte() == 0);
+
+    accountant.setBudget(1000);
+    CPPUNIT_ASSERT(!accountant.isOverBudget());
+
+    accountant.setByte(Category::QUEUED_PAYLOAD, 24);
+    CPPUNIT_ASSERT(accountant.isOverBudget());
+    CPPUNIT_ASSERT(accountant.getOverBudgetByte() == 24);
+
+    accountant.countAction(Action::DROP_FRAME);
+    accountant.countAction(Action::DROP_FRAME);
+    CPPUNIT_ASSERT(accountant.getActionTotal(Action::DROP_FRAME) == 2);
+    CPPUNIT_ASSERT(accountant.getActionTotal(Action::FORCE_GC) == 0);
+
+    accountant.setByte(Category::QUEUED_PAYLOAD, 0);
+    CPPUNIT_ASSERT(!accountant.isOverBudget());
+}
+
+} // namespace unittest
+} // namespace mcrt_dataio
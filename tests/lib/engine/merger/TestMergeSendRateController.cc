@@ -0,0 +1,158 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TestMergeSendRateController.h"
+
+#include <mcrt_dataio/engine/merger/MergeSendRateController.h>
+
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+class HintCatcher
+//
+// Keeps all the sendRateHint messages which are sent by the controller
+// ("MCRT-control sendRateHint <syncId> <intervalMs>")
+//
+{
+public:
+    std::shared_ptr<mcrt_dataio::MsgSendHandler> gen()
+    {
+        auto handler = std::make_shared<mcrt_dataio::MsgSendHandler>();
+        handler->set([&](const std::string& msg) { mMsgTbl.push_back(msg); });
+        return handler;
+    }
+
+    size_t getTotal() const { return mMsgTbl.size(); }
+
+    bool isLast(const unsigned syncId, const float intervalMs) const
+    {
+        if (mMsgTbl.empty()) return false;
+        std::istringstream istr(mMsgTbl.back());
+        std::string cmd, name;
+        unsigned currSyncId = 0;
+        float currIntervalMs = 0.0f;
+        istr >> cmd >> name >> currSyncId >> currIntervalMs;
+        return name == "sendRateHint" && currSyncId == syncId && std::fabs(currIntervalMs - intervalMs) < 0.01f;
+    }
+
+private:
+    std::vector<std::string> mMsgTbl;
+};
+
+bool
+isNear(const float a, const float b)
+{
+    return std::fabs(a - b) < 0.01f;
+}
+
+} // namespace
+
+namespace mcrt_dataio {
+namespace unittest {
+
+void
+TestMergeSendRateController::testRateUpDown()
+//
+// Backlog raises the hint at once, calm updates relax it step by step (hysteresis) and finally release it.
+// Default parameters : busyRatio 0.9, headroom 1.25, releaseCount 10, relaxRatio 0.8, minChangeRatio 0.1,
+// smoothing 0.3
+//
+{
+    HintCatcher catcher;
+    MergeSendRateController controller;
+    controller.setMsgSendHandler(catcher.gen());
+    controller.setActive(true);
+
+    // rate down : cost 100ms > recvInterval 100ms x 0.9 -> hint = 100ms x 1.25
+    CPPUNIT_ASSERT("backlog send" && controller.update(1, 100.0f, 0, 50.0f, 50.0f));
+    CPPUNIT_ASSERT("backlog" && controller.isBacklog());
+    CPPUNIT_ASSERT("backlog hint" && isNear(controller.getHintIntervalMs(), 125.0f));
+    CPPUNIT_ASSERT("backlog msg" && catcher.isLast(1, 125.0f));
+
+    // smaller target under backlog never decreases the hint : cost 0.3 x 20 + 0.7 x 100 = 76 > 50 x 0.9
+    CPPUNIT_ASSERT("keep" && !controller.update(1, 50.0f, 0, 10.0f, 10.0f));
+    CPPUNIT_ASSERT("keep backlog" && controller.isBacklog());
+    CPPUNIT_ASSERT("keep hint" && isNear(controller.getHintIntervalMs(), 125.0f));
+
+    // calm updates : the hint is kept until releaseCount consecutive calm updates
+    for (unsigned i = 0; i < 9; ++i) {
+        CPPUNIT_ASSERT("calm" && !controller.update(1, 100.0f, 0, 10.0f, 10.0f));
+        CPPUNIT_ASSERT("calm backlog" && !controller.isBacklog());
+        CPPUNIT_ASSERT("calm hint" && isNear(controller.getHintIntervalMs(), 125.0f));
+    }
+    CPPUNIT_ASSERT("relax send" && controller.update(1, 100.0f, 0, 10.0f, 10.0f));
+    CPPUNIT_ASSERT("relax hint" && isNear(controller.getHintIntervalMs(), 100.0f));
+    CPPUNIT_ASSERT("relax msg" && catcher.isLast(1, 100.0f));
+
+    // backlog again resets the calm count and raises the hint
+    CPPUNIT_ASSERT("rate down again" && controller.update(1, 10.0f, 0, 500.0f, 500.0f));
+    const float hintMs = controller.getHintIntervalMs();
+    CPPUNIT_ASSERT("rate down again hint" && hintMs > 100.0f);
+    for (unsigned i = 0; i < 9; ++i) controller.update(1, 1000.0f, 0, 1.0f, 1.0f);
+    CPPUNIT_ASSERT("no relax" && isNear(controller.getHintIntervalMs(), hintMs));
+
+    // rate up : relax step by step until the hint is shorter than the cost with headroom, then release
+    const size_t sentTotal = catcher.getTotal();
+    unsigned loop = 0;
+    while (controller.getHintIntervalMs() > 0.0f && loop++ < 1000) {
+        controller.update(1, 1000.0f, 0, 1.0f, 1.0f);
+    }
+    CPPUNIT_ASSERT("released" && controller.getHintIntervalMs() == 0.0f);
+    CPPUNIT_ASSERT("relax steps sent" && catcher.getTotal() > sentTotal + 1);
+    CPPUNIT_ASSERT("released msg" && catcher.isLast(1, 0.0f));
+
+    // released hint is not sent again even if the syncId changes
+    const size_t releasedTotal = catcher.getTotal();
+    CPPUNIT_ASSERT("no hint" && !controller.update(2, 1000.0f, 0, 1.0f, 1.0f));
+    CPPUNIT_ASSERT("no msg" && catcher.getTotal() == releasedTotal);
+}
+
+void
+TestMergeSendRateController::testEdges()
+//
+// Threshold and clamp edges of the backlog detection and the hint send
+//
+{
+    HintCatcher catcher;
+    MergeSendRateController controller;
+    controller.setMsgSendHandler(catcher.gen());
+
+    // inactive controller never sends
+    CPPUNIT_ASSERT("inactive" && !controller.update(1, 100.0f, 100, 500.0f, 500.0f));
+    CPPUNIT_ASSERT("inactive hint" && controller.getHintIntervalMs() == 0.0f);
+    controller.setActive(true);
+
+    // unknown receive interval (0) is not busy and queue depth at the threshold (4) is not deep
+    CPPUNIT_ASSERT("unknown interval" && !controller.update(1, 0.0f, 4, 500.0f, 500.0f));
+    CPPUNIT_ASSERT("unknown interval backlog" && !controller.isBacklog());
+    CPPUNIT_ASSERT("no msg" && catcher.getTotal() == 0);
+
+    // cost exactly at recvInterval x busyRatio is not busy
+    controller.reset();
+    CPPUNIT_ASSERT("busy edge" && !controller.update(1, 100.0f, 0, 45.0f, 45.0f));
+    CPPUNIT_ASSERT("busy edge backlog" && !controller.isBacklog());
+
+    // deep queue : hint is clamped up to drain the queue by a single merge cycle (100ms x 8 / 4)
+    controller.reset();
+    CPPUNIT_ASSERT("deep" && controller.update(1, 100.0f, 8, 5.0f, 5.0f));
+    CPPUNIT_ASSERT("deep hint" && isNear(controller.getHintIntervalMs(), 200.0f));
+    CPPUNIT_ASSERT("deep msg" && catcher.isLast(1, 200.0f));
+
+    // change which is not larger than minChangeRatio is not sent, but syncId change resends the hint
+    controller.reset();
+    CPPUNIT_ASSERT("base" && controller.update(1, 100.0f, 0, 50.0f, 50.0f)); // 125ms
+    const size_t sentTotal = catcher.getTotal();
+    CPPUNIT_ASSERT("small change" && !controller.update(1, 100.0f, 0, 60.0f, 60.0f)); // 0.3x120+0.7x100=106
+    CPPUNIT_ASSERT("small change hint" && isNear(controller.getHintIntervalMs(), 132.5f));
+    CPPUNIT_ASSERT("small change no msg" && catcher.getTotal() == sentTotal);
+    CPPUNIT_ASSERT("new syncId" && controller.update(2, 100.0f, 0, 60.0f, 60.0f));
+    CPPUNIT_ASSERT("new syncId msg" && catcher.isLast(2, controller.getHintIntervalMs()));
+}
+
+} // namespace unittest
+} // namespace mcrt_dataio
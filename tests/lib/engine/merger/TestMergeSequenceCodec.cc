@@ -3,11 +3,14 @@
 
 #include "TestMergeSequenceCodec.h"
 
+#include <mcrt_dataio/engine/merger/MergeActionTracker.h>
 #include <mcrt_dataio/engine/merger/MergeSequenceEnqueue.h>
 #include <mcrt_dataio/engine/merger/MergeSequenceDequeue.h>
 
 #include <scene_rdl2/common/grid_util/Arg.h>
 
+#include <algorithm>
+#include <iostream>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -31,6 +34,54 @@ TestMergeSequenceCodec::testSequence()
                                     "endOfData")));
 }
     
+void
+TestMergeSequenceCodec::testTileSet()
+{
+    CPPUNIT_ASSERT("testTileSet small" &&
+                   verifyTileSet("small", genTilesTbl("t t f f f t f f t t t", 0)));
+    CPPUNIT_ASSERT("testTileSet single" && verifyTileSet("single", genTilesTbl("f f f t", 0)));
+    CPPUNIT_ASSERT("testTileSet checker" && verifyTileSet("checker", genTilesTbl("checker", 1000)));
+    CPPUNIT_ASSERT("testTileSet cluster" && verifyTileSet("cluster", genTilesTbl("cluster", 20000)));
+    CPPUNIT_ASSERT("testTileSet random" && verifyTileSet("random", genTilesTbl("random", 5000)));
+
+    // single run over the bitmap chunk boundary (512 tiles)
+    std::vector<char> tilesTbl(2000, static_cast<char>(false));
+    for (unsigned tileId = 500; tileId <= 1200; ++tileId) tilesTbl[tileId] = static_cast<char>(true);
+    CPPUNIT_ASSERT("testTileSet chunkBoundary" && verifyTileSet("chunkBoundary", tilesTbl));
+}
+
+void
+TestMergeSequenceCodec::testTileSetSize()
+//
+// 4K resolution (480 x 270 tiles). Each encoding is decoded to the same sequence and the run-length/bitmap
+// encodings are smaller than the range encoding on the typical patterns.
+//
+{
+    constexpr unsigned totalTiles = 480 * 270;
+
+    for (const std::string pattern : {"checker", "cluster", "random"}) {
+        const TileRunArray runs = convertToRuns(genTilesTbl(pattern, totalTiles));
+        const std::string target = decodeToStr(encodeTileSet(runs, TileSetEncoding::RANGE));
+
+        size_t minSize = ~static_cast<size_t>(0);
+        for (const TileSetEncoding encoding :
+                 {TileSetEncoding::RANGE, TileSetEncoding::RUNLENGTH, TileSetEncoding::BITMAP}) {
+            CPPUNIT_ASSERT("testTileSetSize decode" && decodeToStr(encodeTileSet(runs, encoding)) == target);
+            minSize = std::min(minSize, calcTileSetSize(runs, encoding));
+        }
+
+        if (pattern == "checker") {
+            CPPUNIT_ASSERT("checker bitmap" &&
+                           calcTileSetSize(runs, TileSetEncoding::BITMAP) == minSize);
+        } else if (pattern == "cluster") {
+            CPPUNIT_ASSERT("cluster runLength" &&
+                           calcTileSetSize(runs, TileSetEncoding::RUNLENGTH) == minSize);
+        }
+        CPPUNIT_ASSERT("smaller than range" &&
+                       minSize < calcTileSetSize(runs, TileSetEncoding::RANGE));
+    }
+}
+
 bool
 TestMergeSequenceCodec::main(const std::string& input) const
 {
@@ -70,6 +121,166 @@ TestMergeSequenceCodec::main(const std::string& input) const
 
     //------------------------------
 
+    const std::string output = decodeToStr(data);
+
+    if (input != output) {
+        std::cerr << " input:" << input << '\n'
+                  << "output:" << output << '\n';
+    }
+
+    return input == output;
+}
+
+bool
+TestMergeSequenceCodec::verifyTileSet(const std::string& name, const std::vector<char>& tilesTbl) const
+//
+// All the encodings should be decoded to the same mergeTileSingle/mergeTileRange sequence and the
+// encoded size should be the same as MergeSequenceEnqueue::calcMergeTile*Size(). MergeActionTracker
+// should only use the range encoding by default and pick one of the smallest encodings under compact
+// tile set.
+//
+{
+    const TileRunArray runs = convertToRuns(tilesTbl);
+    const size_t emptySize = encodeTileSet(TileRunArray(), TileSetEncoding::RANGE).size();
+    const std::string target = decodeToStr(encodeTileSet(runs, TileSetEncoding::RANGE));
+
+    bool result = true;
+    size_t minSize = ~static_cast<size_t>(0);
+    for (const TileSetEncoding encoding :
+             {TileSetEncoding::RANGE, TileSetEncoding::RUNLENGTH, TileSetEncoding::BITMAP}) {
+        const std::string data = encodeTileSet(runs, encoding);
+        const std::string output = decodeToStr(data);
+        if (output != target) {
+            std::cerr << "ERROR : " << name << ' ' << encodingStr(encoding) << " decode mismatch\n"
+                      << " target:" << target << '\n'
+                      << " output:" << output << '\n';
+            result = false;
+        }
+        if (data.size() - emptySize != calcTileSetSize(runs, encoding)) {
+            std::cerr << "ERROR : " << name << ' ' << encodingStr(encoding) << " size mismatch"
+                      << " encoded:" << data.size() - emptySize
+                      << " calc:" << calcTileSetSize(runs, encoding) << '\n';
+            result = false;
+        }
+        minSize = std::min(minSize, calcTileSetSize(runs, encoding));
+    }
+
+    auto trackerEncode = [&](const bool compactTileSet) {
+        MergeActionTracker mergeActionTracker;
+        mergeActionTracker.setCompactTileSet(compactTileSet);
+        mergeActionTracker.mergePartial(tilesTbl);
+        std::string trackerData;
+        {
+            scene_rdl2::cache::CacheEnqueue enqueue(&trackerData);
+            mergeActionTracker.encodeData(enqueue);
+            enqueue.finalize();
+        }
+        scene_rdl2::cache::CacheDequeue dequeue(trackerData.data(), trackerData.size());
+        MergeActionTracker decodeTracker;
+        decodeTracker.decodeDataOnMCRTComputation(dequeue);
+        return decodeTracker.getData();
+    };
+
+    const std::string defaultData = trackerEncode(false);
+    if (defaultData.size() - emptySize != calcTileSetSize(runs, TileSetEncoding::RANGE)) {
+        std::cerr << "ERROR : " << name << " MergeActionTracker did not use the range encoding by default."
+                  << " encoded:" << defaultData.size() - emptySize
+                  << " range:" << calcTileSetSize(runs, TileSetEncoding::RANGE) << '\n';
+        result = false;
+    }
+    const std::string compactData = trackerEncode(true);
+    if (compactData.size() - emptySize != minSize) {
+        std::cerr << "ERROR : " << name << " MergeActionTracker did not pick the smallest encoding."
+                  << " encoded:" << compactData.size() - emptySize << " min:" << minSize << '\n';
+        result = false;
+    }
+    if (decodeToStr(defaultData) != target || decodeToStr(compactData) != target) {
+        std::cerr << "ERROR : " << name << " MergeActionTracker decode mismatch\n";
+        result = false;
+    }
+    return result;
+}
+
+// static function
+std::vector<char>
+TestMergeSequenceCodec::genTilesTbl(const std::string& pattern, const unsigned totalTiles)
+//
+// pattern : "checker", "cluster" (4 tiles every 200 tiles), "random" (30%) or 't'/'f' sequence
+//
+{
+    std::vector<char> tbl;
+    if (pattern == "checker") {
+        for (unsigned tileId = 0; tileId < totalTiles; ++tileId) tbl.push_back(static_cast<char>(tileId % 2));
+    } else if (pattern == "cluster") {
+        for (unsigned tileId = 0; tileId < totalTiles; ++tileId) tbl.push_back(static_cast<char>(tileId % 200 < 4));
+    } else if (pattern == "random") {
+        uint32_t seed = 12345;
+        for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+            seed = seed * 1664525 + 1013904223; // LCG
+            tbl.push_back(static_cast<char>((seed >> 16) % 100 < 30));
+        }
+    } else {
+        std::stringstream ss{pattern};
+        std::string work;
+        while (ss >> work) tbl.push_back(static_cast<char>(work == "t"));
+    }
+    return tbl;
+}
+
+// static function
+TestMergeSequenceCodec::TileRunArray
+TestMergeSequenceCodec::convertToRuns(const std::vector<char>& tilesTbl)
+{
+    TileRunArray runs;
+    bool runActive = false;
+    for (unsigned tileId = 0; tileId < static_cast<unsigned>(tilesTbl.size()); ++tileId) {
+        if (tilesTbl[tileId]) {
+            if (!runActive) runs.emplace_back(tileId, tileId);
+            else runs.back().second = tileId;
+            runActive = true;
+        } else {
+            runActive = false;
+        }
+    }
+    return runs;
+}
+
+// static function
+std::string
+TestMergeSequenceCodec::encodeTileSet(const TileRunArray& runs, const TileSetEncoding encoding)
+{
+    std::string data;
+    MergeSequenceEnqueue enq(&data);
+    switch (encoding) {
+    case TileSetEncoding::RANGE :
+        for (const auto& run : runs) {
+            if (run.first == run.second) enq.mergeTileSingle(run.first);
+            else enq.mergeTileRange(run.first, run.second);
+        }
+        break;
+    case TileSetEncoding::RUNLENGTH : enq.mergeTileRunLength(runs); break;
+    case TileSetEncoding::BITMAP : enq.mergeTileBitmap(runs); break;
+    }
+    enq.endOfData();
+    return data;
+}
+
+// static function
+size_t
+TestMergeSequenceCodec::calcTileSetSize(const TileRunArray& runs, const TileSetEncoding encoding)
+{
+    switch (encoding) {
+    case TileSetEncoding::RANGE : return MergeSequenceEnqueue::calcMergeTileRangeSize(runs);
+    case TileSetEncoding::RUNLENGTH : return MergeSequenceEnqueue::calcMergeTileRunLengthSize(runs);
+    case TileSetEncoding::BITMAP : return MergeSequenceEnqueue::calcMergeTileBitmapSize(runs);
+    }
+    return 0;
+}
+
+// static function
+std::string
+TestMergeSequenceCodec::decodeToStr(const std::string& data)
+{
     mcrt_dataio::MergeSequenceDequeue deq(data.data(), data.size());
 
     std::string output;
@@ -111,13 +322,19 @@ TestMergeSequenceCodec::main(const std::string& input) const
                         })) {
         std::cerr << "ERROR : decode failed. " << errorMsg << '\n';
     }
-    
-    if (input != output) {
-        std::cerr << " input:" << input << '\n'
-                  << "output:" << output << '\n';
-    }
+    return output;
+}
 
-    return input == output;
+// static function
+std::string
+TestMergeSequenceCodec::encodingStr(const TileSetEncoding encoding)
+{
+    switch (encoding) {
+    case TileSetEncoding::RANGE : return "range";
+    case TileSetEncoding::RUNLENGTH : return "runLength";
+    case TileSetEncoding::BITMAP : return "bitmap";
+    }
+    return "?";
 }
 
 } // namespace unittest
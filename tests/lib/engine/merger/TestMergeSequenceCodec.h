@@ -3,9 +3,14 @@
 
 #pragma once
 
+#include <mcrt_dataio/engine/merger/MergeSequenceEnqueue.h>
+
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/TestFixture.h>
 
+#include <string>
+#include <vector>
+
 namespace mcrt_dataio {
 namespace unittest {
 
@@ -16,14 +21,30 @@ public:
     void tearDown() {}
 
     void testSequence();
+    void testTileSet();
+    void testTileSetSize();
 
     CPPUNIT_TEST_SUITE(TestMergeSequenceCodec);
     CPPUNIT_TEST(testSequence);
+    CPPUNIT_TEST(testTileSet);
+    CPPUNIT_TEST(testTileSetSize);
     CPPUNIT_TEST_SUITE_END();
 
 private:
+    using TileRunArray = MergeSequenceEnqueue::TileRunArray;
+
+    enum class TileSetEncoding { RANGE, RUNLENGTH, BITMAP };
 
     bool main(const std::string& input) const;
+
+    bool verifyTileSet(const std::string& name, const std::vector<char>& tilesTbl) const;
+
+    static std::vector<char> genTilesTbl(const std::string& pattern, const unsigned totalTiles);
+    static TileRunArray convertToRuns(const std::vector<char>& tilesTbl);
+    static std::string encodeTileSet(const TileRunArray& runs, const TileSetEncoding encoding);
+    static size_t calcTileSetSize(const TileRunArray& runs, const TileSetEncoding encoding);
+    static std::string decodeToStr(const std::string& data);
+    static std::string encodingStr(const TileSetEncoding encoding);
 };
 
 } // namespace unittest
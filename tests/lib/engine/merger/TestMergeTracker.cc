@@ -24,6 +24,22 @@ TestMergeTracker::testCodec()
                                     "}")));
 }
 
+void
+TestMergeTracker::testCodecCompactTileSet()
+{
+    // Same merge actions as testCodec(). The partial merge tiles are encoded by bitmap.
+    CPPUNIT_ASSERT("testCodecCompactTileSet" &&
+                   main(std::string("compactTileSet 1,"
+                                    "decodeAll 12 13 15 16 17 -1,"
+                                    "mergeFull,"
+                                    "mergePartial t t f f f t f f t t t e"),
+                        std::string("MergeActionTracker {\n"
+                                    "  mData.size():21\n"
+                                    "  decodeRange 12 13,decodeRange 15 17,tileAll,tileRange 0 1,"
+                                    "tileSingle 5,tileRange 8 10,endOfData\n"
+                                    "}")));
+}
+
 bool
 TestMergeTracker::main(const std::string& input, const std::string& target) const
 {
@@ -66,6 +82,8 @@ TestMergeTracker::encodeTestData(const std::string& input, std::string& outData)
             ostr << -1;
             std::cerr << ostr.str() << '\n';
 #           endif // DEBUG_MSG
+        } else if (cmd == "compactTileSet") {
+            mergeActionTracker.setCompactTileSet((arg++).as<bool>(0));
         } else if (cmd == "mergeFull") {
             mergeActionTracker.mergeFull();
 
@@ -18,9 +18,11 @@ public:
     void tearDown() {}
 
     void testCodec();
+    void testCodecCompactTileSet();
 
     CPPUNIT_TEST_SUITE(TestMergeTracker);
     CPPUNIT_TEST(testCodec);
+    CPPUNIT_TEST(testCodecCompactTileSet);
     CPPUNIT_TEST_SUITE_END();
 
 private:
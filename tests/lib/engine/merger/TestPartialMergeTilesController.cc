@@ -0,0 +1,88 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TestPartialMergeTilesController.h"
+
+#include <mcrt_dataio/engine/merger/PartialMergeTilesController.h>
+
+#include <vector>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+//
+// All tests use the default merge time budget (8 ms) and power of 2 costs in order to keep the
+// computation of the controller exact.
+//
+
+void
+TestPartialMergeTilesController::testOverBudget()
+//
+// Over budget measurement cuts the tiles total immediately to fit into the budget.
+//
+{
+    PartialMergeTilesController controller;
+    CPPUNIT_ASSERT("initial" && controller.getTilesTotal(4096, 128) == 128);
+
+    controller.update(128, 0.0f, 1.0f); // 1/128 ms per tile : 1024 tiles fit but limited by maxStep
+    CPPUNIT_ASSERT("grow" && controller.getTilesTotal(4096, 128) == 256);
+
+    controller.update(256, 4.0f, 28.0f); // 32 ms : 1/8 ms per tile
+    CPPUNIT_ASSERT("lastCost" && controller.getLastCostMs() == 32.0f);
+    CPPUNIT_ASSERT("costPerTile" && controller.getCostPerTileMs() == 0.125f); // latest measurement
+    CPPUNIT_ASSERT("cut" && controller.getTilesTotal(4096, 128) == 64);      // 8 ms / (1/8 ms)
+
+    // Back to the cheap cost. The smoothed cost per tile slowly recovers.
+    controller.update(64, 0.0f, 0.5f);
+    const unsigned tilesTotal = controller.getTilesTotal(4096, 128);
+    CPPUNIT_ASSERT("recover" && tilesTotal > 64 && tilesTotal < 128);
+}
+
+void
+TestPartialMergeTilesController::testMaxStep()
+//
+// The tiles total never grows more than maxStepRatio (2.0) per merge even if the budget allows more.
+//
+{
+    PartialMergeTilesController controller;
+
+    const std::vector<unsigned> expected = {16, 32, 64, 128, 256, 512};
+    for (const unsigned expectedTilesTotal : expected) {
+        const unsigned tilesTotal = controller.getTilesTotal(100000, 16);
+        CPPUNIT_ASSERT("step" && tilesTotal == expectedTilesTotal);
+        controller.update(tilesTotal, 0.0f, static_cast<float>(tilesTotal) / 128.0f); // 1/128 ms per tile
+    }
+
+    // Reached the budget (8 ms / (1/128 ms) = 1024 tiles) and stays there.
+    for (int i = 0; i < 4; ++i) {
+        const unsigned tilesTotal = controller.getTilesTotal(100000, 16);
+        CPPUNIT_ASSERT("budget" && tilesTotal >= 1023 && tilesTotal <= 1024);
+        controller.update(tilesTotal, 0.0f, static_cast<float>(tilesTotal) / 128.0f);
+    }
+}
+
+void
+TestPartialMergeTilesController::testClamp()
+//
+// The tiles total is clamped by the min tiles total and the total tiles of the current resolution.
+//
+{
+    PartialMergeTilesController controller;
+    CPPUNIT_ASSERT("initial" && controller.getTilesTotal(1000, 800) == 800);
+    CPPUNIT_ASSERT("shrink" && controller.getTilesTotal(300, 800) == 300);
+    CPPUNIT_ASSERT("enlarge" && controller.getTilesTotal(1000, 800) == 800);
+
+    controller.update(64, 0.0f, 256.0f); // 4 ms per tile : only 2 tiles fit
+    CPPUNIT_ASSERT("min" && controller.getTilesTotal(1000, 800) == 16);
+    controller.setMinTilesTotal(32);
+    CPPUNIT_ASSERT("newMin" && controller.getTilesTotal(1000, 800) == 32);
+    CPPUNIT_ASSERT("minOverTotal" && controller.getTilesTotal(8, 800) == 8);
+    controller.setMinTilesTotal(0);
+    CPPUNIT_ASSERT("zeroMin" && controller.getTilesTotal(1000, 800) == 2);
+
+    controller.reset();
+    CPPUNIT_ASSERT("reset" && controller.getTilesTotal(1000, 500) == 500);
+}
+
+} // namespace unittest
+} // namespace mcrt_dataio
@@ -0,0 +1,30 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+class TestPartialMergeTilesController : public CppUnit::TestFixture
+{
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    void testOverBudget();
+    void testMaxStep();
+    void testClamp();
+
+    CPPUNIT_TEST_SUITE(TestPartialMergeTilesController);
+    CPPUNIT_TEST(testOverBudget);
+    CPPUNIT_TEST(testMaxStep);
+    CPPUNIT_TEST(testClamp);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+} // namespace unittest
+} // namespace mcrt_dataio
@@ -0,0 +1,247 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TestSubMergeAovNumSample.h"
+
+#include <mcrt_dataio/engine/merger/SubMergeAovNumSample.h>
+
+#include <scene_rdl2/common/grid_util/Fb.h>
+#include <scene_rdl2/common/math/Viewport.h>
+#include <scene_rdl2/scene/rdl2/ValueContainerEnq.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Fb = scene_rdl2::grid_util::Fb;
+
+const scene_rdl2::math::Viewport sViewport(0, 0, 63, 47); // 8 x 6 tiles
+
+std::string
+encodeData(const unsigned totalTiles, const std::vector<mcrt_dataio::SubMergeAovNumSample::Aov>& aovTbl)
+{
+    std::string data;
+    scene_rdl2::rdl2::ValueContainerEnq cEnq(&data);
+    mcrt_dataio::SubMergeAovNumSample::encode(totalTiles, aovTbl, cEnq);
+    data.resize(cEnq.finalize());
+    return data;
+}
+
+//
+// Emulation of a single MCRT computation with one renderOutput AOV. The AOV is not always evaluated by
+// all the samples of the pixel, so the AOV numSample is less than or equal to the beauty numSample.
+//
+struct Machine {
+    std::vector<unsigned> mBeautyNumSample;
+    std::vector<unsigned> mAovNumSample;
+    std::vector<float> mAovValue; // average value of the AOV samples
+};
+
+void
+randomMachine(std::mt19937& mt, const unsigned pixTotal, Machine& machine)
+{
+    std::uniform_real_distribution<float> valDist(0.0f, 4.0f);
+    machine.mBeautyNumSample.resize(pixTotal);
+    machine.mAovNumSample.resize(pixTotal);
+    machine.mAovValue.resize(pixTotal);
+    for (unsigned pixOffset = 0; pixOffset < pixTotal; ++pixOffset) {
+        const unsigned beautyNumSample = (mt() % 4 == 0) ? 0 : mt() % 8 + 1;
+        machine.mBeautyNumSample[pixOffset] = beautyNumSample;
+        machine.mAovNumSample[pixOffset] = (beautyNumSample) ? mt() % (beautyNumSample + 1) : 0;
+        machine.mAovValue[pixOffset] = (machine.mAovNumSample[pixOffset]) ? valDist(mt) : 0.0f;
+    }
+}
+
+void
+mergeMachine(const std::vector<const std::vector<unsigned>*>& weightTbl,
+             const std::vector<const Machine*>& machineTbl,
+             Machine& merged)
+//
+// numSample weighted merge of the AOV. weightTbl[i] is the weight of machineTbl[i] which is used
+// by the merge computation.
+//
+{
+    const size_t pixTotal = machineTbl[0]->mAovValue.size();
+    merged.mBeautyNumSample.assign(pixTotal, 0);
+    merged.mAovNumSample.assign(pixTotal, 0);
+    merged.mAovValue.assign(pixTotal, 0.0f);
+    for (size_t pixOffset = 0; pixOffset < pixTotal; ++pixOffset) {
+        double sum = 0.0;
+        unsigned weightTotal = 0;
+        for (size_t id = 0; id < machineTbl.size(); ++id) {
+            const unsigned weight = (*weightTbl[id])[pixOffset];
+            sum += static_cast<double>(machineTbl[id]->mAovValue[pixOffset]) * weight;
+            weightTotal += weight;
+            merged.mBeautyNumSample[pixOffset] += machineTbl[id]->mBeautyNumSample[pixOffset];
+        }
+        merged.mAovNumSample[pixOffset] = weightTotal;
+        merged.mAovValue[pixOffset] = (weightTotal) ? static_cast<float>(sum / weightTotal) : 0.0f;
+    }
+}
+
+void
+setActivePixels(const Machine& machine, Fb& fb)
+{
+    fb.init(sViewport);
+    fb.reset();
+    for (unsigned tileId = 0; tileId < fb.getTotalTiles(); ++tileId) {
+        uint64_t mask = 0x0;
+        for (unsigned pixId = 0; pixId < 64; ++pixId) {
+            if (machine.mAovNumSample[tileId * 64 + pixId]) mask |= static_cast<uint64_t>(0x1) << pixId;
+        }
+        fb.getActivePixels().setTileMask(tileId, mask);
+    }
+}
+
+} // namespace
+
+namespace mcrt_dataio {
+namespace unittest {
+
+void
+TestSubMergeAovNumSample::testRoundTrip()
+{
+    std::mt19937 mt(0);
+
+    Fb fbA, fbB;
+    fbA.init(sViewport);
+    fbB.init(sViewport);
+    fbA.reset();
+    fbB.reset();
+    const unsigned totalTiles = fbA.getTotalTiles();
+    const unsigned pixTotal = totalTiles * 64;
+
+    auto randomAov = [&](Fb& fb, std::vector<unsigned>& numSample) {
+        numSample.resize(pixTotal);
+        for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+            const uint64_t mask = (mt() % 3 == 0) ? 0x0 : (static_cast<uint64_t>(mt()) << 32) | mt();
+            fb.getActivePixels().setTileMask(tileId, mask);
+        }
+        for (auto& v : numSample) v = mt() % 1000 + 1;
+    };
+    std::vector<unsigned> numSampleA, numSampleB;
+    randomAov(fbA, numSampleA);
+    randomAov(fbB, numSampleB);
+
+    const std::string data = encodeData(totalTiles, {{"aovA", &fbA.getActivePixels(), numSampleA.data()},
+                                                     {"aovB", &fbB.getActivePixels(), numSampleB.data()}});
+
+    constexpr unsigned initVal = ~static_cast<unsigned>(0);
+    std::vector<unsigned> decodedA(pixTotal, initVal);
+    auto numSampleBuffFunc = [&](const std::string& aovName, const unsigned currTotalTiles) -> unsigned* {
+        if (currTotalTiles != totalTiles) return nullptr;
+        return (aovName == "aovA") ? decodedA.data() : nullptr; // aovB is skipped
+    };
+    std::string error;
+    CPPUNIT_ASSERT("decode" && SubMergeAovNumSample::decode(data.data(), data.size(), numSampleBuffFunc, error));
+
+    for (unsigned tileId = 0; tileId < totalTiles; ++tileId) {
+        const uint64_t mask = fbA.getActivePixels().getTileMask(tileId);
+        for (unsigned pixId = 0; pixId < 64; ++pixId) {
+            const unsigned offset = tileId * 64 + pixId;
+            if (mask & (static_cast<uint64_t>(0x1) << pixId)) {
+                CPPUNIT_ASSERT("active pix" && decodedA[offset] == numSampleA[offset]);
+            } else {
+                CPPUNIT_ASSERT("inactive pix" && decodedA[offset] == initVal);
+            }
+        }
+    }
+
+}
+
+void
+TestSubMergeAovNumSample::testTwoTierMerge()
+//
+// Emulation of the hierarchical merge of 4 MCRT computations by 2 sub-merge computations and the root
+// merge. Each sub-merge sends its merged AOV with the SubMergeAovNumSample data and the root merge
+// accumulates them by the decoded AOV numSample. The result should be the same as the single tier merge
+// of all the MCRT computations. The data transfer between processes is emulated by the encoded data.
+//
+{
+    std::mt19937 mt(0);
+
+    Fb fb;
+    fb.init(sViewport);
+    const unsigned totalTiles = fb.getTotalTiles();
+    const unsigned pixTotal = totalTiles * 64;
+
+    constexpr unsigned machineTotal = 4;
+    std::vector<Machine> machineTbl(machineTotal);
+    for (Machine& machine : machineTbl) randomMachine(mt, pixTotal, machine);
+
+    // single tier merge
+    Machine direct;
+    mergeMachine({&machineTbl[0].mAovNumSample, &machineTbl[1].mAovNumSample,
+                  &machineTbl[2].mAovNumSample, &machineTbl[3].mAovNumSample},
+                 {&machineTbl[0], &machineTbl[1], &machineTbl[2], &machineTbl[3]},
+                 direct);
+
+    // sub-merge computations : each of them merges 2 MCRT computations and sends the result
+    Machine subMerge[2];
+    std::string subMergeData[2];
+    for (unsigned id = 0; id < 2; ++id) {
+        const Machine& m0 = machineTbl[id * 2];
+        const Machine& m1 = machineTbl[id * 2 + 1];
+        mergeMachine({&m0.mAovNumSample, &m1.mAovNumSample}, {&m0, &m1}, subMerge[id]);
+
+        Fb subMergeFb;
+        setActivePixels(subMerge[id], subMergeFb);
+        subMergeData[id] = encodeData(totalTiles, {{"aov", &subMergeFb.getActivePixels(),
+                                                    subMerge[id].mAovNumSample.data()}});
+    }
+
+    // root merge : AOV numSample is initialized by the beauty numSample and overwritten by the decoded data
+    Machine received[2];
+    std::vector<unsigned> beautyWeight[2];
+    for (unsigned id = 0; id < 2; ++id) {
+        received[id] = subMerge[id];
+        received[id].mAovNumSample = subMerge[id].mBeautyNumSample;
+        beautyWeight[id] = subMerge[id].mBeautyNumSample;
+
+        auto numSampleBuffFunc = [&](const std::string& aovName, const unsigned currTotalTiles) -> unsigned* {
+            if (aovName != "aov" || currTotalTiles != totalTiles) return nullptr;
+            return received[id].mAovNumSample.data();
+        };
+        std::string error;
+        CPPUNIT_ASSERT("decode" && SubMergeAovNumSample::decode(subMergeData[id].data(),
+                                                                subMergeData[id].size(),
+                                                                numSampleBuffFunc,
+                                                                error));
+    }
+    for (unsigned id = 0; id < 2; ++id) {
+        // Pixels without AOV sample are not active and keep the beauty numSample. The root merge does not
+        // use them because the AOV value is not updated.
+        for (unsigned pixOffset = 0; pixOffset < pixTotal; ++pixOffset) {
+            if (!subMerge[id].mAovNumSample[pixOffset]) {
+                received[id].mAovNumSample[pixOffset] = 0;
+                beautyWeight[id][pixOffset] = 0;
+            }
+        }
+    }
+
+    Machine root;
+    mergeMachine({&received[0].mAovNumSample, &received[1].mAovNumSample}, {&received[0], &received[1]}, root);
+    Machine rootByBeauty;
+    mergeMachine({&beautyWeight[0], &beautyWeight[1]}, {&received[0], &received[1]}, rootByBeauty);
+
+    auto isSameVal = [](const float a, const float b) {
+        return std::fabs(a - b) <= 1.0e-5f * std::max(1.0f, std::fabs(b));
+    };
+    unsigned beautyWeightDiffTotal = 0;
+    for (unsigned pixOffset = 0; pixOffset < pixTotal; ++pixOffset) {
+        CPPUNIT_ASSERT("numSample" && root.mAovNumSample[pixOffset] == direct.mAovNumSample[pixOffset]);
+        CPPUNIT_ASSERT("value" && isSameVal(root.mAovValue[pixOffset], direct.mAovValue[pixOffset]));
+        if (!isSameVal(rootByBeauty.mAovValue[pixOffset], direct.mAovValue[pixOffset])) {
+            beautyWeightDiffTotal++;
+        }
+    }
+    // The beauty numSample is not the right weight of the AOV
+    CPPUNIT_ASSERT("beauty weight" && beautyWeightDiffTotal > 0);
+}
+
+} // namespace unittest
+} // namespace mcrt_dataio
@@ -0,0 +1,28 @@
+// Copyright 2023-2025 DreamWorks Animation LLC
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+
+namespace mcrt_dataio {
+namespace unittest {
+
+class TestSubMergeAovNumSample : public CppUnit::TestFixture
+{
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    void testRoundTrip();
+    void testTwoTierMerge();
+
+    CPPUNIT_TEST_SUITE(TestSubMergeAovNumSample);
+    CPPUNIT_TEST(testRoundTrip);
+    CPPUNIT_TEST(testTwoTierMerge);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+} // namespace unittest
+} // namespace mcrt_dataio
@@ -1,8 +1,19 @@
 // Copyright 2023-2024 DreamWorks Animation LLC
 // SPDX-License-Identifier: Apache-2.0
 
+#include "TestFbMsgFbPool.h"
+#include "TestHdriTest.h"
+#include "TestMergeFbSenderDoubleBuffer.h"
+#include "TestMergeFeedbackReplay.h"
+#include "TestMergeFeedbackScheduler.h"
+#include "TestMergeFeedbackTileDelta.h"
+#include "TestMergeKernel.h"
+#include "TestMergeMemAccountant.h"
+#include "TestMergeSendRateController.h"
 #include "TestMergeSequenceCodec.h"
 #include "TestMergeTracker.h"
+#include "TestPartialMergeTilesController.h"
+#include "TestSubMergeAovNumSample.h"
 
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/HelperMacros.h>
@@ -13,8 +24,19 @@ main(int ac, char **av)
 {
     using namespace mcrt_dataio::unittest;
 
+    CPPUNIT_TEST_SUITE_REGISTRATION(TestFbMsgFbPool);
+    CPPUNIT_TEST_SUITE_REGISTRATION(TestHdriTest);
+    CPPUNIT_TEST_SUITE_REGISTRATION(TestMergeFbSenderDoubleBuffer);
+    CPPUNIT_TEST_SUITE_REGISTRATION(TestMergeFeedbackReplay);
+    CPPUNIT_TEST_SUITE_REGISTRATION(TestMergeFeedbackScheduler);
+    CPPUNIT_TEST_SUITE_REGISTRATION(TestMergeFeedbackTileDelta);
+    CPPUNIT_TEST_SUITE_REGISTRATION(TestMergeKernel);
+    CPPUNIT_TEST_SUITE_REGISTRATION(TestMergeMemAccountant);
+    CPPUNIT_TEST_SUITE_REGISTRATION(TestMergeSendRateController);
     CPPUNIT_TEST_SUITE_REGISTRATION(TestMergeSequenceCodec);
     CPPUNIT_TEST_SUITE_REGISTRATION(TestMergeTracker);
+    CPPUNIT_TEST_SUITE_REGISTRATION(TestPartialMergeTilesController);
+    CPPUNIT_TEST_SUITE_REGISTRATION(TestSubMergeAovNumSample);
 
     return pdevunit::run(ac, av);
 }